@@ -26,6 +26,8 @@
 
 #include <nuttx/config.h>
 
+#include <inttypes.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <unistd.h>
@@ -72,6 +74,62 @@
     } \
   while (0)
 
+/* Longest command line accepted from the UART (excluding the '\r') */
+
+#define SLCAN_MAXLINE      30
+
+/* Longest frame sent to the UART: T + 8 id + len + 16 data + '\r' */
+
+#define SLCAN_MAXFRAME     27
+
+/* Maximum number of CAN frames drained from the socket per select() */
+
+#define SLCAN_MAXBATCH     32
+
+#if CONFIG_CANUTILS_SLCAN_RXBUFSIZE <= SLCAN_MAXLINE
+#  error CONFIG_CANUTILS_SLCAN_RXBUFSIZE is too small
+#endif
+
+#if CONFIG_CANUTILS_SLCAN_TXBUFSIZE < SLCAN_MAXFRAME
+#  error CONFIG_CANUTILS_SLCAN_TXBUFSIZE is too small
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct slcan_s
+{
+  int fd;                              /* UART slcan channel */
+  int s;                               /* CAN socket */
+  int mode;                            /* 0: closed, 1: open */
+  int canspeed;                        /* Last requested bitrate */
+  FAR const char *candev;              /* CAN interface name */
+  struct sockaddr_can addr;
+  struct canfd_frame frame;
+  struct msghdr msg;
+  struct iovec iov;
+  char ctrlmsg[CMSG_SPACE(sizeof(struct timeval) +
+                          3 * sizeof(struct timespec) + sizeof(int))];
+
+  /* Data read from the UART but not yet parsed into command lines */
+
+  char rxbuf[CONFIG_CANUTILS_SLCAN_RXBUFSIZE];
+  size_t rxlen;
+  bool discard;                        /* Discarding an over-long line */
+
+  /* Responses and frames waiting to be written to the UART */
+
+  char txbuf[CONFIG_CANUTILS_SLCAN_TXBUFSIZE];
+  size_t txlen;
+
+#ifdef CONFIG_SLCAN_STATS
+  uint32_t rxframes;                   /* CAN -> UART frames */
+  uint32_t txframes;                   /* UART -> CAN frames */
+  time_t statstime;                    /* Start of the current second */
+#endif
+};
+
 /****************************************************************************
  * private data
  ****************************************************************************/
@@ -82,84 +140,126 @@ static char opening[] = "starting slcan\n";
 static char opening[] = "";
 #endif
 
-static void ok_return(int fd)
-{
-  write(fd, "\r", 1);
-}
+static const char g_hexchar[16] = "0123456789ABCDEF";
+
+/* ASCII hex digit to value plus one; zero marks a non-hex character */
 
-static void fail_return(int fd)
+static const uint8_t g_hexval[256] =
 {
-  write(fd, "\a", 1); /* BELL return for error */
-}
+  ['0'] = 1,  ['1'] = 2,  ['2'] = 3,  ['3'] = 4,  ['4'] = 5,
+  ['5'] = 6,  ['6'] = 7,  ['7'] = 8,  ['8'] = 9,  ['9'] = 10,
+  ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16,
+  ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+};
 
-static int readlinebuffer(int fd, char *buf, int maxlen)
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void flush_tx(FAR struct slcan_s *slcan)
 {
-  size_t n;
-  int meslen = 0;
-  int noeol  = 1;
-  uint8_t ch;
+  FAR const char *ptr = slcan->txbuf;
+  ssize_t n;
 
-  while ((meslen < maxlen) && noeol)
+  while (slcan->txlen > 0)
     {
-      n = read(fd, &ch, 1);
-      if (n > 0)
+      n = write(slcan->fd, ptr, slcan->txlen);
+      if (n < 0)
         {
-          /* valid input */
-
-          if (ch == '\r')
-            {
-              noeol = 0;
-              *buf  = '\0';
-            }
-          else
+          if (errno == EINTR)
             {
-              *buf++ = ch;
-              meslen++;
+              continue;
             }
+
+          syslog(LOG_ERR, "UART write error %d\n", errno);
+          break;
         }
-      else
+
+      ptr          += n;
+      slcan->txlen -= n;
+    }
+
+  slcan->txlen = 0;
+}
+
+static void queue_tx(FAR struct slcan_s *slcan, FAR const char *data,
+                     size_t len)
+{
+  if (slcan->txlen + len > sizeof(slcan->txbuf))
+    {
+      flush_tx(slcan);
+    }
+
+  memcpy(&slcan->txbuf[slcan->txlen], data, len);
+  slcan->txlen += len;
+}
+
+static void ok_return(FAR struct slcan_s *slcan)
+{
+  queue_tx(slcan, "\r", 1);
+}
+
+static void fail_return(FAR struct slcan_s *slcan)
+{
+  queue_tx(slcan, "\a", 1); /* BELL return for error */
+}
+
+static int gethex(FAR const char *str, int ndigits, FAR uint32_t *value)
+{
+  uint32_t val = 0;
+  uint8_t nibble;
+
+  while (ndigits-- > 0)
+    {
+      nibble = g_hexval[(uint8_t)*str++];
+      if (nibble == 0)
         {
-          return (meslen);
+          return -1;
         }
+
+      val = (val << 4) | (nibble - 1);
     }
-  return (meslen);
+
+  *value = val;
+  return 0;
 }
 
-static int caninit(char *candev, int *s, struct sockaddr_can *addr,
-                   char *ctrlmsg, struct canfd_frame *frame,
-                   struct msghdr *msg, struct iovec *iov)
+static int caninit(FAR struct slcan_s *slcan)
 {
   struct ifreq ifr;
 
   debug_print("slcanBus\n");
-  if ((*s = socket(PF_CAN, SOCK_RAW, CAN_RAW)) < 0)
+  if ((slcan->s = socket(PF_CAN, SOCK_RAW, CAN_RAW)) < 0)
     {
       syslog(LOG_ERR, "Error opening CAN socket\n");
       return -1;
     }
-  strlcpy(ifr.ifr_name, candev, IFNAMSIZ);
+
+  strlcpy(ifr.ifr_name, slcan->candev, IFNAMSIZ);
   ifr.ifr_ifindex = if_nametoindex(ifr.ifr_name);
   if (!ifr.ifr_ifindex)
     {
-      syslog(LOG_ERR, "error finding index %s\n", candev);
+      syslog(LOG_ERR, "error finding index %s\n", slcan->candev);
       return -1;
     }
-  memset(addr, 0, sizeof(struct sockaddr));
-  addr->can_family  = AF_CAN;
-  addr->can_ifindex = ifr.ifr_ifindex;
-  setsockopt(*s, SOL_CAN_RAW, CAN_RAW_FILTER, NULL, 0);
 
-  if (bind(*s, (struct sockaddr *)addr, sizeof(struct sockaddr)) < 0)
+  memset(&slcan->addr, 0, sizeof(struct sockaddr));
+  slcan->addr.can_family  = AF_CAN;
+  slcan->addr.can_ifindex = ifr.ifr_ifindex;
+  setsockopt(slcan->s, SOL_CAN_RAW, CAN_RAW_FILTER, NULL, 0);
+
+  if (bind(slcan->s, (struct sockaddr *)&slcan->addr,
+           sizeof(struct sockaddr)) < 0)
     {
       syslog(LOG_ERR, "bind error\n");
       return -1;
     }
 
-  iov->iov_base    = frame;
-  msg->msg_name    = addr;
-  msg->msg_iov     = iov;
-  msg->msg_iovlen  = 1;
-  msg->msg_control = ctrlmsg;
+  slcan->iov.iov_base    = &slcan->frame;
+  slcan->msg.msg_name    = &slcan->addr;
+  slcan->msg.msg_iov     = &slcan->iov;
+  slcan->msg.msg_iovlen  = 1;
+  slcan->msg.msg_control = slcan->ctrlmsg;
 
   /* CAN interface ready to be used */
 
@@ -168,40 +268,390 @@ static int caninit(char *candev, int *s, struct sockaddr_can *addr,
   return 0;
 }
 
+#ifdef CONFIG_SLCAN_STATS
+static void update_stats(FAR struct slcan_s *slcan)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (now.tv_sec != slcan->statstime)
+    {
+      if (slcan->rxframes != 0 || slcan->txframes != 0)
+        {
+          syslog(LOG_INFO, "slcan: rx %" PRIu32 " fps, tx %" PRIu32 " fps\n",
+                 slcan->rxframes, slcan->txframes);
+        }
+
+      slcan->rxframes  = 0;
+      slcan->txframes  = 0;
+      slcan->statstime = now.tv_sec;
+    }
+}
+#endif
+
 /****************************************************************************
- * Public Functions
+ * Name: format_frame
+ *
+ * Description:
+ *   Encode a CAN frame as an slcan 't' or 'T' line.  Returns the length.
+ *
  ****************************************************************************/
 
+static size_t format_frame(FAR const struct canfd_frame *frame,
+                           FAR char *buf)
+{
+  FAR char *ptr = buf;
+  uint32_t id;
+  int ndigits;
+  int i;
+
+  if (frame->can_id & CAN_EFF_FLAG)
+    {
+      /* 29 bit address */
+
+      *ptr++  = 'T';
+      id      = frame->can_id & CAN_EFF_MASK;
+      ndigits = 8;
+    }
+  else
+    {
+      /* 11 bit address */
+
+      *ptr++  = 't';
+      id      = frame->can_id & CAN_SFF_MASK;
+      ndigits = 3;
+    }
+
+  for (i = ndigits - 1; i >= 0; i--)
+    {
+      *ptr++ = g_hexchar[(id >> (4 * i)) & 0xf];
+    }
+
+  *ptr++ = g_hexchar[frame->len & 0xf];
+
+  for (i = 0; i < frame->len; i++)
+    {
+      *ptr++ = g_hexchar[frame->data[i] >> 4];
+      *ptr++ = g_hexchar[frame->data[i] & 0xf];
+    }
+
+  *ptr++ = '\r';
+  return ptr - buf;
+}
+
 /****************************************************************************
- * Name: slcan_main
+ * Name: can_receive
+ *
+ * Description:
+ *   Drain the frames pending on the CAN socket and forward them to the
+ *   UART with as few writes as possible.
+ *
  ****************************************************************************/
 
-int main(int argc, char *argv[])
+static void can_receive(FAR struct slcan_s *slcan)
 {
-  /* UART */
+  char sbuf[SLCAN_MAXFRAME];
+  int nbytes;
+  int count;
+
+  for (count = 0; count < SLCAN_MAXBATCH; count++)
+    {
+      slcan->iov.iov_len        = sizeof(slcan->frame);
+      slcan->msg.msg_namelen    = sizeof(slcan->addr);
+      slcan->msg.msg_controllen = sizeof(slcan->ctrlmsg);
+      slcan->msg.msg_flags      = 0;
+
+      /* The first frame is known to be available, do not block waiting
+       * for more.
+       */
+
+      nbytes = recvmsg(slcan->s, &slcan->msg,
+                       count == 0 ? 0 : MSG_DONTWAIT);
+      if (nbytes < 0)
+        {
+          break;
+        }
 
-  char buf[31];
-  int mode = 0;
-  size_t n;
-  int canspeed = 1000000; /* default to 1MBps */
-  int fd;                 /* UART slcan channel */
+      if (nbytes == CAN_MTU && slcan->frame.len <= CAN_MAX_DLEN)
+        {
+          debug_print("R, Id:0x%" PRIx32 "\n", slcan->frame.can_id);
+          queue_tx(slcan, sbuf, format_frame(&slcan->frame, sbuf));
+#ifdef CONFIG_SLCAN_STATS
+          slcan->rxframes++;
+#endif
+        }
+    }
 
-  /* CAN */
+  flush_tx(slcan);
+}
 
-  int s;
-  int nbytes;
-  int i;
-  int ret;
-  int reccount = 0;
-  struct sockaddr_can addr;
+/****************************************************************************
+ * Name: can_transmit
+ *
+ * Description:
+ *   Parse a 't' or 'T' command line and send the frame.
+ *
+ ****************************************************************************/
+
+static void can_transmit(FAR struct slcan_s *slcan, FAR const char *buf,
+                         size_t n)
+{
   struct canfd_frame frame;
-  struct msghdr msg;
-  struct iovec iov;
+  uint32_t idval;
+  uint32_t val;
+  size_t idlen;
+  int i;
+
+  /* Get the 29 bit or 11 bit CAN ID and the byte count */
+
+  idlen = buf[0] == 'T' ? 8 : 3;
+  if (n < idlen + 2 ||
+      gethex(&buf[1], idlen, &idval) < 0 ||
+      gethex(&buf[1 + idlen], 1, &val) < 0 ||
+      val > CAN_MAX_DLEN || n < idlen + 2 + 2 * val)
+    {
+      fail_return(slcan);
+      return;
+    }
+
+  memset(&frame, 0, sizeof(frame));
+  frame.len = val;
+
+  /* get canmessage */
+
+  for (i = 0; i < frame.len; i++)
+    {
+      if (gethex(&buf[idlen + 2 + 2 * i], 2, &val) < 0)
+        {
+          fail_return(slcan);
+          return;
+        }
+
+      frame.data[i] = val;
+    }
+
+  debug_print("Transmitt: 0x%" PRIX32 " len %d\n", idval, frame.len);
+
+  frame.can_id = buf[0] == 'T' ? (idval | CAN_EFF_FLAG) : idval;
+
+  if (write(slcan->s, &frame, CAN_MTU) != CAN_MTU)
+    {
+      syslog(LOG_ERR, "transmitt error\n");
+
+      /* TODO update error flags */
+    }
+#ifdef CONFIG_SLCAN_STATS
+  else
+    {
+      slcan->txframes++;
+    }
+#endif
+
+  ok_return(slcan);
+}
+
+/****************************************************************************
+ * Name: set_speed
+ ****************************************************************************/
+
+static void set_speed(FAR struct slcan_s *slcan, char code)
+{
+  static const int speeds[] =
+  {
+    10000, 20000, 50000, 100000, 125000, 250000, 500000, 800000, 1000000
+  };
+
+  struct ifreq ifr;
+  int canspeed;
+
+  if (code >= '0' && code <= '8')
+    {
+      slcan->canspeed = speeds[code - '0'];
+    }
+
+  canspeed = slcan->canspeed;
+
+  /* set the device name */
+
+  strlcpy(ifr.ifr_name, slcan->candev, IFNAMSIZ);
+  ifr.ifr_ifru.ifru_can_data.arbi_bitrate = canspeed;
+  ifr.ifr_ifru.ifru_can_data.arbi_samplep = 80;
+
+  if (ioctl(slcan->s, SIOCSCANBITRATE, &ifr) < 0)
+    {
+      syslog(LOG_ERR, "set speed %d failed\n", canspeed);
+      fail_return(slcan);
+    }
+  else
+    {
+      debug_print("set speed %d\n", canspeed);
+      ok_return(slcan);
+    }
+}
+
+/****************************************************************************
+ * Name: set_flags
+ ****************************************************************************/
+
+static void set_flags(FAR struct slcan_s *slcan, short flags, int mode)
+{
+  struct ifreq ifr;
+
+  strlcpy(ifr.ifr_name, slcan->candev, IFNAMSIZ);
+
+  ifr.ifr_flags = flags;
+  if (ioctl(slcan->s, SIOCSIFFLAGS, &ifr) < 0)
+    {
+      syslog(LOG_ERR, "%s interface failed\n", mode ? "Open" : "Close");
+      fail_return(slcan);
+    }
+  else
+    {
+      slcan->mode = mode;
+      debug_print("%s interface\n", mode ? "Open" : "Close");
+      ok_return(slcan);
+    }
+}
+
+/****************************************************************************
+ * Name: process_line
+ ****************************************************************************/
+
+static void process_line(FAR struct slcan_s *slcan, FAR const char *buf,
+                         size_t n)
+{
+  if (n == 0)
+    {
+      return;
+    }
+
+  switch (slcan->mode)
+    {
+    case 0: /* CAN channel not open */
+      if (buf[0] == 'F')
+        {
+          /* return clear flags */
+
+          queue_tx(slcan, "F00\r", 4);
+        }
+      else if (buf[0] == 'O')
+        {
+          /* open CAN interface */
+
+          set_flags(slcan, IFF_UP, 1);
+        }
+      else if (buf[0] == 'S')
+        {
+          /* set CAN interface speed */
+
+          set_speed(slcan, n > 1 ? buf[1] : '\0');
+        }
+      else
+        {
+          /* whatever */
+
+          ok_return(slcan);
+        }
+      break;
+
+    case 1: /* CAN task running open interface */
+      if (buf[0] == 'C')
+        {
+          /* close interface */
+
+          set_flags(slcan, 0, 0);
+        }
+      else if (buf[0] == 'T' || buf[0] == 't')
+        {
+          /* Transmit an extended 29 bit or an 11 bit CAN frame */
+
+          can_transmit(slcan, buf, n);
+        }
+      else
+        {
+          /* whatever */
+
+          ok_return(slcan);
+        }
+      break;
+
+    default: /* should not happen */
+      slcan->mode = 100;
+      break;
+    }
+}
+
+/****************************************************************************
+ * Name: uart_receive
+ *
+ * Description:
+ *   Read whatever is available from the UART in one call and process every
+ *   complete command line in it.  Any partial line is kept for the next
+ *   read.  The responses are written back with a single write.
+ *
+ ****************************************************************************/
+
+static void uart_receive(FAR struct slcan_s *slcan)
+{
+  FAR char *line;
+  FAR char *eol;
+  FAR char *end;
+  ssize_t n;
+
+  n = read(slcan->fd, &slcan->rxbuf[slcan->rxlen],
+           sizeof(slcan->rxbuf) - slcan->rxlen);
+  if (n <= 0)
+    {
+      return;
+    }
+
+  slcan->rxlen += n;
+  line = slcan->rxbuf;
+  end  = &slcan->rxbuf[slcan->rxlen];
+
+  while ((eol = memchr(line, '\r', end - line)) != NULL)
+    {
+      /* Lines longer than the protocol allows are dropped */
+
+      if (!slcan->discard && eol - line <= SLCAN_MAXLINE)
+        {
+          process_line(slcan, line, eol - line);
+        }
+
+      slcan->discard = false;
+      line = eol + 1;
+    }
+
+  /* Keep the partial line, unless it already cannot be valid */
+
+  slcan->rxlen = end - line;
+  if (slcan->rxlen > SLCAN_MAXLINE)
+    {
+      slcan->discard = true;
+      slcan->rxlen   = 0;
+    }
+  else if (slcan->rxlen > 0 && line != slcan->rxbuf)
+    {
+      memmove(slcan->rxbuf, line, slcan->rxlen);
+    }
+
+  flush_tx(slcan);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: slcan_main
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+  FAR struct slcan_s *slcan;
   fd_set rdfs;
-  char ctrlmsg[CMSG_SPACE(sizeof(struct timeval) +
-                          3 * sizeof(struct timespec) + sizeof(int))];
-  char sbuf[40];
-  char *sbp;
+  int nfds;
+  int ret;
 
   if (argc != 3)
     {
@@ -211,327 +661,78 @@ int main(int argc, char *argv[])
     }
 
   char *chrdev = argv[2];
-  char *candev = argv[1];
+
+  slcan = zalloc(sizeof(struct slcan_s));
+  if (slcan == NULL)
+    {
+      syslog(LOG_ERR, "Failed to allocate state\n");
+      return -1;
+    }
+
+  slcan->candev   = argv[1];
+  slcan->canspeed = 1000000; /* default to 1MBps */
 
   debug_print("Starting slcan on NuttX\n");
-  fd = open(chrdev, O_RDWR);
-  if (fd < 0)
+  slcan->fd = open(chrdev, O_RDWR);
+  if (slcan->fd < 0)
     {
       syslog(LOG_ERR, "Failed to open serial channel %s\n", chrdev);
+      free(slcan);
       return -1;
     }
-  else
+
+  /* Create CAN socket */
+
+  if (caninit(slcan) < 0)
     {
-      /* Create CAN socket */
+      syslog(LOG_ERR, "Failed to open CAN socket %s\n", slcan->candev);
+      close(slcan->fd);
+      free(slcan);
+      return -1;
+    }
 
-      if (caninit(candev, &s, &addr, &ctrlmsg[0], &frame, &msg, &iov) < 0)
-        {
-          syslog(LOG_ERR, "Failed to open CAN socket %s\n", candev);
-          close(fd);
-          return -1;
-        }
+  /* serial interface active */
+
+  debug_print("Serial interface open %s\n", chrdev);
+  write(slcan->fd, opening, (sizeof(opening) - 1));
 
-      /* serial interface active */
+  nfds = (slcan->s > slcan->fd ? slcan->s : slcan->fd) + 1;
+
+  while (slcan->mode < 100)
+    {
+      /* Setup ooll */
 
-      debug_print("Serial interface open %s\n", chrdev);
-      write(fd, opening, (sizeof(opening) - 1));
+      FD_ZERO(&rdfs);
+      FD_SET(slcan->s, &rdfs);  /* CAN Socket */
+      FD_SET(slcan->fd, &rdfs); /* UART */
 
-      while (mode < 100)
+      if ((ret = select(nfds, &rdfs, NULL, NULL, NULL)) <= 0)
         {
-          /* Setup ooll */
+          continue;
+        }
 
-          FD_ZERO(&rdfs);
-          FD_SET(s, &rdfs);  /* CAN Socket */
-          FD_SET(fd, &rdfs); /* UART */
+      if (FD_ISSET(slcan->s, &rdfs))
+        {
+          /* CAN received new message(s) in socketCAN input */
 
-          if ((ret = select(s + 1, &rdfs, NULL, NULL, NULL)) <= 0)
-            {
-              continue;
-            }
+          can_receive(slcan);
+        }
 
-          if (FD_ISSET(s, &rdfs))
-            {
-              /* CAN received new message in socketCAN input */
-
-              iov.iov_len        = sizeof(frame);
-              msg.msg_namelen    = sizeof(addr);
-              msg.msg_controllen = sizeof(ctrlmsg);
-              msg.msg_flags      = 0;
-              nbytes             = recvmsg(s, &msg, 0);
-
-              if (nbytes == CAN_MTU)
-                {
-                  reccount++;
-                  debug_print("R%d, Id:0x%" PRIx32 "\n",
-                              reccount, frame.can_id);
-                  if (frame.can_id & CAN_EFF_FLAG)
-                    {
-                      /* 29 bit address */
-
-                      frame.can_id = frame.can_id & ~CAN_EFF_FLAG;
-                      snprintf(sbuf, sizeof(sbuf), "T%08" PRIx32 "%d",
-                               frame.can_id, frame.len);
-                      sbp = &sbuf[10];
-                    }
-                  else
-                    {
-                      /* 11 bit address */
-
-                      snprintf(sbuf, sizeof(sbuf), "t%03" PRIx32 "%d",
-                               frame.can_id, frame.len);
-                      sbp = &sbuf[5];
-                    }
-
-                  for (i = 0; i < frame.len; i++)
-                    {
-                      snprintf(sbp, sizeof(sbuf) - (sbp - sbuf),
-                               "%02X", frame.data[i]);
-                      sbp += 2;
-                    }
-
-                  *sbp++ = '\r';
-                  *sbp   = '\0';
-                  write(fd, sbuf, strlen(sbuf));
-                }
-            }
+      if (FD_ISSET(slcan->fd, &rdfs))
+        {
+          /* UART receive */
 
-          if (FD_ISSET(fd, &rdfs))
-            {
-              /* UART receive */
-
-              n = readlinebuffer(fd, buf, 30);
-
-              switch (mode)
-                {
-                case 0: /* CAN channel not open */
-                  if (n > 0)
-                    {
-                      if (buf[0] == 'F')
-                        {
-                          /* return clear flags */
-
-                          write(fd, "F00\r", 4);
-                        }
-                      else if (buf[0] == 'O')
-                        {
-                          /* open CAN interface */
-
-                          struct ifreq ifr;
-
-                          strlcpy(ifr.ifr_name, argv[1], IFNAMSIZ);
-
-                          ifr.ifr_flags = IFF_UP;
-                          if (ioctl(s, SIOCSIFFLAGS, &ifr) < 0)
-                            {
-                              syslog(LOG_ERR, "Open interface failed\n");
-                              fail_return(fd);
-                            }
-                          else
-                            {
-                              mode = 1;
-                              debug_print("Open interface\n");
-                              ok_return(fd);
-                            }
-                        }
-                      else if (buf[0] == 'S')
-                        {
-                          /* set CAN interface speed */
-
-                          switch (buf[1])
-                            {
-                            case '0':
-                              canspeed = 10000;
-                              break;
-                            case '1':
-                              canspeed = 20000;
-                              break;
-                            case '2':
-                              canspeed = 50000;
-                              break;
-                            case '3':
-                              canspeed = 100000;
-                              break;
-                            case '4':
-                              canspeed = 125000;
-                              break;
-                            case '5':
-                              canspeed = 250000;
-                              break;
-                            case '6':
-                              canspeed = 500000;
-                              break;
-                            case '7':
-                              canspeed = 800000;
-                              break;
-                            case '8': /* set speed to 1Mbps */
-                              canspeed = 1000000;
-                              break;
-                            default:
-                              break;
-                            }
-
-                          struct ifreq ifr;
-
-                          /* set the device name */
-
-                          strlcpy(ifr.ifr_name, argv[1], IFNAMSIZ);
-                          ifr.ifr_ifru.ifru_can_data.arbi_bitrate = canspeed;
-                          ifr.ifr_ifru.ifru_can_data.arbi_samplep = 80;
-
-                          if (ioctl(s, SIOCSCANBITRATE, &ifr) < 0)
-                            {
-                              syslog(LOG_ERR, "set speed %d failed\n",
-                                     canspeed);
-                              fail_return(fd);
-                            }
-                          else
-                            {
-                              debug_print("set speed %d\n", canspeed);
-                              ok_return(fd);
-                            }
-                        }
-                      else
-                        {
-                          /* whatever */
-
-                          ok_return(fd);
-                        }
-                    }
-                  break;
-                case 1: /* CAN task running open interface */
-                  if (n > 0)
-                    {
-                      if (buf[0] == 'C')
-                        {
-                          /* close interface */
-
-                          struct ifreq ifr;
-
-                          strlcpy(ifr.ifr_name, argv[1], IFNAMSIZ);
-
-                          ifr.ifr_flags = 0;
-                          if (ioctl(s, SIOCSIFFLAGS, &ifr) < 0)
-                            {
-                              syslog(LOG_ERR, "Close interface failed\n");
-                              fail_return(fd);
-                            }
-                          else
-                            {
-                              mode = 0;
-                              debug_print("Close interface\n");
-                              ok_return(fd);
-                            }
-                        }
-                      else if (buf[0] == 'T')
-                        {
-                          /* Transmit an extended 29 bit CAN frame */
-
-                          char tbuf[9];
-                          int idval;
-                          int val;
-
-                          /* get 29bit CAN ID */
-
-                          strncpy(tbuf, &buf[1], 8);
-                          tbuf[8] = '\0';
-                          sscanf(tbuf, "%x", &idval);
-
-                          frame.len = buf[9] - '0'; /* get byte count */
-
-                          /* get canmessage */
-
-                          for (i = 0; i < frame.len; i++)
-                            {
-                              tbuf[0] = buf[10 + (2 * i)];
-                              tbuf[1] = buf[11 + (2 * i)];
-                              tbuf[2] = '\0';
-                              sscanf(tbuf, "%x", &val);
-                              frame.data[i] = val & 0xff;
-                            }
-
-                          debug_print("Transmitt: 0x%X ", idval);
-                          for (i = 0; i < frame.len; i++)
-                            {
-                              debug_print("0x%02X ", frame.data[i]);
-                            }
-
-                          debug_print("\n");
-
-                          frame.can_id = idval | CAN_EFF_FLAG; /* 29 bit */
-
-                          if (write(s, &frame, CAN_MTU) != CAN_MTU)
-                            {
-                              syslog(LOG_ERR, "transmitt error\n");
-
-                              /* TODO update error flags */
-                            }
-
-                          ok_return(fd);
-                        }
-                      else if (buf[0] == 't')
-                        {
-                          /* Transmit an 11 bit CAN frame */
-
-                          char tbuf[9];
-                          int idval;
-                          int val;
-
-                          /* get 11bit CAN ID */
-
-                          strncpy(tbuf, &buf[1], 3);
-                          tbuf[3] = '\0';
-                          sscanf(tbuf, "%x", &idval);
-
-                          frame.len = buf[4] - '0'; /* get byte count */
-
-                          /* get canmessage */
-
-                          for (i = 0; i < frame.len; i++)
-                            {
-                              tbuf[0] = buf[5 + (2 * i)];
-                              tbuf[1] = buf[6 + (2 * i)];
-                              tbuf[2] = '\0';
-                              sscanf(tbuf, "%x", &val);
-                              frame.data[i] = val & 0xff;
-                            }
-
-                          debug_print("Transmitt: 0x%X ", idval);
-                          for (i = 0; i < frame.len; i++)
-                            {
-                              debug_print("0x%02X ", frame.data[i]);
-                            }
-
-                          debug_print("\n");
-
-                          frame.can_id = idval; /* 11 bit address command */
-
-                          if (write(s, &frame, CAN_MTU) != CAN_MTU)
-                            {
-                              syslog(LOG_ERR, "transmitt error\n");
-
-                              /* TODO update error flags */
-                            }
-
-                          ok_return(fd);
-                        }
-                      else
-                        {
-                          /* whatever */
-
-                          ok_return(fd);
-                        }
-                    }
-                  break;
-                default: /* should not happen */
-                  mode = 100;
-                  break;
-                }
-            }
+          uart_receive(slcan);
         }
 
-      close(fd);
-      close(s);
+#ifdef CONFIG_SLCAN_STATS
+      update_stats(slcan);
+#endif
     }
 
+  close(slcan->fd);
+  close(slcan->s);
+  free(slcan);
+
   return 0;
 }
@@ -236,6 +236,9 @@ static int ft80x_showname(int fd, FAR struct ft80x_dlbuffer_s *buffer,
 static int ft80x_example(int fd, FAR struct ft80x_dlbuffer_s *buffer,
                          FAR const struct ft80x_exampleinfo_s *example)
 {
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+  struct ft80x_framestats_s stats;
+#endif
   int ret;
 
   ft80x_info("Example %s\n", example->name);
@@ -251,6 +254,10 @@ static int ft80x_example(int fd, FAR struct ft80x_dlbuffer_s *buffer,
 
   /* Then execute the example */
 
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+  ft80x_dl_resetstats(buffer);
+#endif
+
   ret = example->func(fd, buffer);
   if (ret < 0)
     {
@@ -258,6 +265,20 @@ static int ft80x_example(int fd, FAR struct ft80x_dlbuffer_s *buffer,
       return ret;
     }
 
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+  ft80x_dl_getstats(buffer, &stats);
+  if (stats.nframes > 0)
+    {
+      printf("%s: %lu display lists, last %lu bytes in %lu us "
+             "(%lu us writing), min/avg/max %lu/%lu/%lu us\n",
+             example->name, (unsigned long)stats.nframes,
+             (unsigned long)stats.dlsize, (unsigned long)stats.last,
+             (unsigned long)stats.xfer, (unsigned long)stats.min,
+             (unsigned long)(stats.total / stats.nframes),
+             (unsigned long)stats.max);
+    }
+#endif
+
   /* Wait a bit, then fade out */
 
   sleep(2);
@@ -303,6 +324,10 @@ int main(int argc, FAR char *argv[])
       return EXIT_FAILURE;
     }
 
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+  ft80x_dl_resetstats(buffer);
+#endif
+
 #ifdef CONFIG_EXAMPLES_FT80X_PRIMITIVES
   /* Perform tests on a few of the FT80x primitive functions */
 
@@ -0,0 +1,58 @@
+/****************************************************************************
+ * apps/examples/modbus/modbus.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_EXAMPLES_MODBUS_MODBUS_H
+#define __APPS_EXAMPLES_MODBUS_MODBUS_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_EXAMPLES_MODBUS_TCP
+
+/****************************************************************************
+ * Name: modbus_stress
+ *
+ * Description:
+ *   Open nclients loopback connections to the local Modbus TCP server and
+ *   run ntrans pipelined write/read-back transactions on each of them,
+ *   verifying every response.  Client n uses holding register
+ *   CONFIG_EXAMPLES_MODBUS_REG_HOLDING_START + n.
+ *
+ * Returned Value:
+ *   OK if all transactions succeeded, ERROR otherwise.
+ *
+ ****************************************************************************/
+
+int modbus_stress(uint16_t port, int nclients, int ntrans, int depth);
+
+#endif
+
+#endif /* __APPS_EXAMPLES_MODBUS_MODBUS_H */
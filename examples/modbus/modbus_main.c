@@ -57,6 +57,8 @@
 #include "modbus/mb.h"
 #include "modbus/mbport.h"
 
+#include "modbus.h"
+
 #ifdef CONFIG_EXAMPLES_MODBUS_REG_COILS_USERLEDS
 #  include <sys/types.h>
 #  include <sys/stat.h>
@@ -99,6 +101,10 @@
 #  define CONFIG_EXAMPLES_MODBUS_REG_HOLDING_NREGS 130
 #endif
 
+#ifndef CONFIG_EXAMPLES_MODBUS_TCP_PORT
+#  define CONFIG_EXAMPLES_MODBUS_TCP_PORT 502
+#endif
+
 #ifdef CONFIG_EXAMPLES_MODBUS_REG_COILS_USERLEDS
 #  define CONFIG_USERLEDS_DEVPATH "/dev/userleds"
 #endif
@@ -135,6 +141,9 @@ static inline int modbus_initialize(void);
 static void *modbus_pollthread(void *pvarg);
 static inline int modbus_create_pollthread(void);
 static void modbus_showusage(FAR const char *progname, int exitcode);
+#ifdef CONFIG_EXAMPLES_MODBUS_TCP
+static int modbus_run_stress(void);
+#endif
 
 /****************************************************************************
  * Private Data
@@ -185,6 +194,20 @@ static inline int modbus_initialize(void)
 
   status = ENODEV;
 
+#ifdef CONFIG_EXAMPLES_MODBUS_TCP
+  /* Initialize the FreeModBus library.
+   *
+   * CONFIG_EXAMPLES_MODBUS_TCP_PORT = TCP port, default=502
+   */
+
+  mberr = eMBTCPInit(CONFIG_EXAMPLES_MODBUS_TCP_PORT);
+  if (mberr != MB_ENOERR)
+    {
+      fprintf(stderr, "modbus_main: "
+              "ERROR: eMBTCPInit failed: %d\n", mberr);
+      goto errout_with_mutex;
+    }
+#else
   /* Initialize the FreeModBus library.
    *
    * MB_RTU                        = RTU mode
@@ -203,6 +226,7 @@ static inline int modbus_initialize(void)
               "ERROR: eMBInit failed: %d\n", mberr);
       goto errout_with_mutex;
     }
+#endif
 
   /* Set the slave ID
    *
@@ -393,6 +417,58 @@ static inline int modbus_create_pollthread(void)
   return ret;
 }
 
+#ifdef CONFIG_EXAMPLES_MODBUS_TCP
+/****************************************************************************
+ * Name: modbus_run_stress
+ *
+ * Description:
+ *   Run the loopback stress test against the local Modbus TCP server,
+ *   starting the ModBus polling thread for the duration of the test if it
+ *   is not running yet.
+ *
+ ****************************************************************************/
+
+static int modbus_run_stress(void)
+{
+  bool started = false;
+  int ret;
+  int i;
+
+  if (g_modbus.threadstate != RUNNING)
+    {
+      ret = modbus_create_pollthread();
+      if (ret != OK)
+        {
+          fprintf(stderr, "modbus_main: "
+                  "ERROR: modbus_create_pollthread failed: %d\n", ret);
+          return ERROR;
+        }
+
+      started = true;
+
+      /* Wait for the server to listen */
+
+      for (i = 0; i < 100 && g_modbus.threadstate != RUNNING; i++)
+        {
+          usleep(10000);
+        }
+    }
+
+  ret = modbus_stress(CONFIG_EXAMPLES_MODBUS_TCP_PORT,
+                      CONFIG_EXAMPLES_MODBUS_STRESS_CLIENTS,
+                      CONFIG_EXAMPLES_MODBUS_STRESS_REQUESTS,
+                      CONFIG_EXAMPLES_MODBUS_STRESS_DEPTH);
+
+  if (started)
+    {
+      g_modbus.threadstate = SHUTDOWN;
+      pthread_join(g_modbus.threadid, NULL);
+    }
+
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: modbus_showusage
  *
@@ -403,12 +479,19 @@ static inline int modbus_create_pollthread(void)
 
 static void modbus_showusage(FAR const char *progname, int exitcode)
 {
+#ifdef CONFIG_EXAMPLES_MODBUS_TCP
+  printf("USAGE: %s [-d|e|s|q|t|h]\n\n", progname);
+#else
   printf("USAGE: %s [-d|e|s|q|h]\n\n", progname);
+#endif
   printf("Where:\n");
   printf("  -d : Disable protocol stack\n");
   printf("  -e : Enable the protocol stack\n");
   printf("  -s : Show current status\n");
   printf("  -q : Quit application\n");
+#ifdef CONFIG_EXAMPLES_MODBUS_TCP
+  printf("  -t : Run the loopback stress test\n");
+#endif
   printf("  -h : Show this information\n");
   printf("\n");
   exit(exitcode);
@@ -434,7 +517,7 @@ int main(int argc, FAR char *argv[])
 
   /* Handle command line arguments */
 
-  while ((option = getopt(argc, argv, "desqh")) != ERROR)
+  while ((option = getopt(argc, argv, "desqth")) != ERROR)
     {
       switch (option)
         {
@@ -486,6 +569,16 @@ int main(int argc, FAR char *argv[])
             pthread_kill(g_modbus.threadid, 9);
             break;
 
+#ifdef CONFIG_EXAMPLES_MODBUS_TCP
+          case 't': /* Run the loopback stress test */
+            ret = modbus_run_stress();
+            if (ret != OK)
+              {
+                exit(EXIT_FAILURE);
+              }
+            break;
+
+#endif
           case 'h': /* Show help info */
             modbus_showusage(argv[0], EXIT_SUCCESS);
             break;
@@ -0,0 +1,325 @@
+/****************************************************************************
+ * apps/examples/modbus/modbus_stress.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Loopback stress test of the Modbus TCP server.  Every client thread
+ * keeps its own connection open and sends batches of requests without
+ * waiting for the individual responses.  A batch alternates between
+ * writing the client's holding register and reading it back, so a
+ * response that is lost, reordered or delivered to the wrong connection
+ * shows up as a mismatch.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+
+#include "modbus.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_MODBUS_REG_HOLDING_START
+#  define CONFIG_EXAMPLES_MODBUS_REG_HOLDING_START 2000
+#endif
+
+#define STRESS_REQ_SIZE     12  /* MBAP header + function + 4 data bytes */
+#define STRESS_READ_RSPSIZE 11  /* MBAP header + function + count + reg */
+
+#define STRESS_FUNC_READ    0x03
+#define STRESS_FUNC_WRITE   0x06
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct modbus_stress_s
+{
+  pthread_t thread;
+  uint16_t port;
+  int id;
+  int ntrans;
+  int depth;
+  int result;
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void modbus_stress_request(FAR uint8_t *req, uint16_t tid,
+                                  uint8_t func, uint16_t addr,
+                                  uint16_t value)
+{
+  req[0]  = tid >> 8;
+  req[1]  = tid & 0xff;
+  req[2]  = 0;                  /* Protocol identifier */
+  req[3]  = 0;
+  req[4]  = 0;                  /* Length of unit id and PDU */
+  req[5]  = 6;
+  req[6]  = 0xff;               /* Unit identifier */
+  req[7]  = func;
+  req[8]  = addr >> 8;
+  req[9]  = addr & 0xff;
+  req[10] = value >> 8;
+  req[11] = value & 0xff;
+}
+
+static int modbus_stress_recv(int sd, FAR uint8_t *buf, size_t len)
+{
+  ssize_t nrecv;
+
+  while (len > 0)
+    {
+      nrecv = recv(sd, buf, len, 0);
+      if (nrecv <= 0)
+        {
+          if (nrecv < 0 && errno == EINTR)
+            {
+              continue;
+            }
+
+          return ERROR;
+        }
+
+      buf += nrecv;
+      len -= nrecv;
+    }
+
+  return OK;
+}
+
+static FAR void *modbus_stress_client(FAR void *arg)
+{
+  FAR struct modbus_stress_s *client = arg;
+  struct sockaddr_in addr;
+  FAR uint8_t *reqs;
+  uint8_t rsp[STRESS_REQ_SIZE];
+  uint16_t regaddr;
+  uint16_t value;
+  uint16_t tid = 0;
+  size_t rsplen;
+  int batch;
+  int done;
+  int sd;
+  int i;
+
+  client->result = ERROR;
+
+  reqs = malloc(client->depth * STRESS_REQ_SIZE);
+  if (reqs == NULL)
+    {
+      return NULL;
+    }
+
+  sd = socket(AF_INET, SOCK_STREAM, 0);
+  if (sd < 0)
+    {
+      free(reqs);
+      return NULL;
+    }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(client->port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (connect(sd, (FAR struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+      fprintf(stderr, "modbus_stress: client %d: connect failed: %d\n",
+              client->id, errno);
+      goto errout;
+    }
+
+  /* The register callbacks see the PDU address plus one */
+
+  regaddr = CONFIG_EXAMPLES_MODBUS_REG_HOLDING_START - 1 + client->id;
+
+  for (done = 0; done < client->ntrans; done += batch)
+    {
+      batch = client->ntrans - done;
+      if (batch > client->depth)
+        {
+          batch = client->depth;
+        }
+
+      /* Queue the whole batch before reading any response */
+
+      for (i = 0; i < batch; i++)
+        {
+          value = (uint16_t)(client->id << 12 | (done + i));
+          if (i & 1)
+            {
+              modbus_stress_request(&reqs[i * STRESS_REQ_SIZE],
+                                    tid + i, STRESS_FUNC_READ, regaddr, 1);
+            }
+          else
+            {
+              modbus_stress_request(&reqs[i * STRESS_REQ_SIZE],
+                                    tid + i, STRESS_FUNC_WRITE, regaddr,
+                                    value);
+            }
+        }
+
+      if (send(sd, reqs, batch * STRESS_REQ_SIZE, 0) !=
+          batch * STRESS_REQ_SIZE)
+        {
+          fprintf(stderr, "modbus_stress: client %d: send failed: %d\n",
+                  client->id, errno);
+          goto errout;
+        }
+
+      for (i = 0; i < batch; i++, tid++)
+        {
+          /* A write is echoed, a read returns one register */
+
+          rsplen = (i & 1) ? STRESS_READ_RSPSIZE : STRESS_REQ_SIZE;
+          if (modbus_stress_recv(sd, rsp, rsplen) < 0)
+            {
+              fprintf(stderr, "modbus_stress: client %d: "
+                      "connection lost after %d transactions\n",
+                      client->id, done + i);
+              goto errout;
+            }
+
+          if ((rsp[0] << 8 | rsp[1]) != tid)
+            {
+              fprintf(stderr, "modbus_stress: client %d: "
+                      "transaction id %u, expected %u\n",
+                      client->id, rsp[0] << 8 | rsp[1], tid);
+              goto errout;
+            }
+
+          if (i & 1)
+            {
+              /* Must read back the value written just before */
+
+              value = (uint16_t)(client->id << 12 | (done + i - 1));
+              if (rsp[7] != STRESS_FUNC_READ || rsp[8] != 2 ||
+                  (rsp[9] << 8 | rsp[10]) != value)
+                {
+                  fprintf(stderr, "modbus_stress: client %d: "
+                          "bad read response %02x %02x %02x%02x\n",
+                          client->id, rsp[7], rsp[8], rsp[9], rsp[10]);
+                  goto errout;
+                }
+            }
+          else if (memcmp(rsp, &reqs[i * STRESS_REQ_SIZE],
+                          STRESS_REQ_SIZE) != 0)
+            {
+              fprintf(stderr, "modbus_stress: client %d: "
+                      "bad write response %02x\n", client->id, rsp[7]);
+              goto errout;
+            }
+        }
+    }
+
+  client->result = OK;
+
+errout:
+  close(sd);
+  free(reqs);
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: modbus_stress
+ ****************************************************************************/
+
+int modbus_stress(uint16_t port, int nclients, int ntrans, int depth)
+{
+  FAR struct modbus_stress_s *clients;
+  struct timespec start;
+  struct timespec end;
+  uint32_t elapsed;
+  int started;
+  int ret = OK;
+  int i;
+
+  clients = calloc(nclients, sizeof(struct modbus_stress_s));
+  if (clients == NULL)
+    {
+      return ERROR;
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (started = 0; started < nclients; started++)
+    {
+      clients[started].port = port;
+      clients[started].id = started;
+      clients[started].ntrans = ntrans;
+      clients[started].depth = depth > 0 ? depth : 1;
+
+      if (pthread_create(&clients[started].thread, NULL,
+                         modbus_stress_client, &clients[started]) != 0)
+        {
+          fprintf(stderr, "modbus_stress: pthread_create failed\n");
+          ret = ERROR;
+          break;
+        }
+    }
+
+  for (i = 0; i < started; i++)
+    {
+      pthread_join(clients[i].thread, NULL);
+      if (clients[i].result != OK)
+        {
+          ret = ERROR;
+        }
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  elapsed = (end.tv_sec - start.tv_sec) * 1000 +
+            (end.tv_nsec - start.tv_nsec) / 1000000;
+
+  printf("modbus_stress: %d clients x %d transactions (depth %d) "
+         "in %" PRIu32 " ms: %s\n", nclients, ntrans, depth, elapsed,
+         ret == OK ? "PASSED" : "FAILED");
+  if (ret == OK && elapsed > 0)
+    {
+      printf("modbus_stress: %" PRIu32 " transactions/s\n",
+             (uint32_t)((uint64_t)nclients * ntrans * 1000 / elapsed));
+    }
+
+  free(clients);
+  return ret;
+}
@@ -46,22 +46,15 @@
  * Other configuration options:
  *
  *  CONFIG_EXAMPLES_TIFF_OUTFILE - Name of the resulting TIFF file
- *  CONFIG_EXAMPLES_TIFF_TMPFILE1/2 - Names of two temporaries files that
- *    will be used in the file creation.
+ *
+ * The strips are compressed with the method given as argument:  none
+ * (default), packbits or lzw.
  */
 
 #ifndef CONFIG_EXAMPLES_TIFF_OUTFILE
 #  define CONFIG_EXAMPLES_TIFF_OUTFILE "/tmp/result.tif"
 #endif
 
-#ifndef CONFIG_EXAMPLES_TIFF_TMPFILE1
-#  define CONFIG_EXAMPLES_TIFF_TMPFILE1 "/tmp/tmpfile1.dat"
-#endif
-
-#ifndef CONFIG_EXAMPLES_TIFF_TMPFILE2
-#  define CONFIG_EXAMPLES_TIFF_TMPFILE2 "/tmp/tmpfile2.dat"
-#endif
-
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -103,15 +96,31 @@ int main(int argc, FAR char *argv[])
 
   memset(&info, 0, sizeof(struct tiff_info_s));
   info.outfile   = CONFIG_EXAMPLES_TIFF_OUTFILE;
-  info.tmpfile1  = CONFIG_EXAMPLES_TIFF_TMPFILE1;
-  info.tmpfile2  = CONFIG_EXAMPLES_TIFF_TMPFILE2;
   info.colorfmt  = FB_FMT_RGB24;
+  info.compress  = TAG_COMP_NONE;
   info.rps       = 1;
   info.imgwidth  = 256;
   info.imgheight = 256;
   info.iobuffer  = (uint8_t *)malloc(300);
   info.iosize    = 300;
 
+  if (argc > 1)
+    {
+      if (strcmp(argv[1], "packbits") == 0)
+        {
+          info.compress = TAG_COMP_PACKBITS;
+        }
+      else if (strcmp(argv[1], "lzw") == 0)
+        {
+          info.compress = TAG_COMP_LZW;
+        }
+      else if (strcmp(argv[1], "none") != 0)
+        {
+          printf("Usage: %s [none|packbits|lzw]\n", argv[0]);
+          exit(1);
+        }
+    }
+
   /* Initialize the TIFF library */
 
   ret = tiff_initialize(&info);
@@ -214,7 +214,8 @@ int ft80x_ramdl_append(int fd, FAR const void *data, size_t len);
  * Name: ft80x_ramcmd_append
  *
  * Description:
- *   Append new display list data to RAM CMD
+ *   Append new display list data to RAM CMD.  This does not wait for the
+ *   co-processor to execute the data, only for FIFO space if it is full.
  *
  * Input Parameters:
  *   fd   - The file descriptor of the FT80x device.  Opened by the caller
@@ -243,13 +244,12 @@ int ft80x_ramcmd_append(int fd, FAR const void *data, size_t len);
  *   avail  - Pointer to location to return the FIFO free space
  *
  * Returned Value:
- *   The (positive) number of free bytes in RAM CMD on success.  A negated
- *   errno value is returned on any failure.
+ *   Zero (OK) on success.  A negated errno value on failure.
  *
  ****************************************************************************/
 
-uint16_t ft80x_ramcmd_freespace(int fd, FAR uint16_t *offset,
-                                FAR uint16_t *avail);
+int ft80x_ramcmd_freespace(int fd, FAR uint16_t *offset,
+                           FAR uint16_t *avail);
 
 /****************************************************************************
  * Name: ft80x_ramcmd_waitfifoempty
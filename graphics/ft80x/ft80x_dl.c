@@ -30,6 +30,7 @@
 #include <stdint.h>
 #include <unistd.h>
 #include <string.h>
+#include <time.h>
 #include <assert.h>
 #include <errno.h>
 
@@ -111,6 +112,25 @@ static void ft80x_dl_dump(FAR struct ft80x_dlbuffer_s *buffer,
 #  define ft80x_dl_dump(b,d,l)
 #endif
 
+/****************************************************************************
+ * Name: ft80x_dl_elapsed
+ *
+ * Description:
+ *   Return the time elapsed since 'start' in microseconds.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+static uint32_t ft80x_dl_elapsed(FAR const struct timespec *start)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t)((now.tv_sec - start->tv_sec) * 1000000 +
+                    (now.tv_nsec - start->tv_nsec) / 1000);
+}
+#endif
+
 /****************************************************************************
  * Name: ft80x_dl_append
  *
@@ -132,9 +152,44 @@ static void ft80x_dl_dump(FAR struct ft80x_dlbuffer_s *buffer,
 static int ft80x_dl_append(int fd, FAR struct ft80x_dlbuffer_s *buffer,
                            FAR const void *data, size_t len)
 {
+  FAR struct ft80x_dlseg_s *dlseg = buffer->dlseg;
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+  struct timespec start;
+#endif
   int ret;
 
+  if (len == 0)
+    {
+      return OK;
+    }
+
   ft80x_dl_dump(buffer, data, len);
+
+  if (dlseg != NULL)
+    {
+      /* Record data into the segment in RAM G */
+
+      if (dlseg->size + len > dlseg->maxsize)
+        {
+          ft80x_err("ERROR: Segment full: %lu + %lu > %lu\n",
+                    (unsigned long)dlseg->size, (unsigned long)len,
+                    (unsigned long)dlseg->maxsize);
+          return -ENOSPC;
+        }
+
+      ret = ft80x_ramg_write(fd, dlseg->offset + dlseg->size, data, len);
+      if (ret >= 0)
+        {
+          dlseg->size += len;
+        }
+
+      return ret;
+    }
+
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+  clock_gettime(CLOCK_MONOTONIC, &start);
+#endif
+
   if (buffer->coproc)
     {
       /* Append data to RAM CMD */
@@ -148,6 +203,10 @@ static int ft80x_dl_append(int fd, FAR struct ft80x_dlbuffer_s *buffer,
       ret = ft80x_ramdl_append(fd, data, len);
     }
 
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+  buffer->xfer += ft80x_dl_elapsed(&start);
+#endif
+
   return ret;
 }
 
@@ -195,6 +254,12 @@ int ft80x_dl_start(int fd, FAR struct ft80x_dlbuffer_s *buffer, bool coproc)
   buffer->coproc   = coproc;
   buffer->dlsize   = 0;
   buffer->dloffset = 0;
+  buffer->dlseg    = NULL;
+
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+  clock_gettime(CLOCK_MONOTONIC, &buffer->start);
+  buffer->xfer     = 0;
+#endif
 
   if (!coproc)
     {
@@ -240,7 +305,8 @@ int ft80x_dl_start(int fd, FAR struct ft80x_dlbuffer_s *buffer, bool coproc)
  *      buffer offset to zero.
  *   4) Swap to the newly created display list (DL memory case only).
  *   5) For the case of the co-processor RAM CMD, it will also wait for the
- *      FIFO to be emptied.
+ *      FIFO to be emptied (unless CONFIG_GRAPHICS_FT80X_PIPELINE is
+ *      selected).
  *
  * Input Parameters:
  *   fd     - The file descriptor of the FT80x device.  Opened by the caller
@@ -260,11 +326,14 @@ int ft80x_dl_end(int fd, FAR struct ft80x_dlbuffer_s *buffer)
     struct ft80x_cmd32_s swap;
   } s;
 
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+  FAR struct ft80x_framestats_s *stats;
+#endif
   size_t size;
   int ret;
 
   ft80x_info("fd=%d buffer=%p\n", fd, buffer);
-  DEBUGASSERT(fd >= 0 && buffer != NULL);
+  DEBUGASSERT(fd >= 0 && buffer != NULL && buffer->dlseg == NULL);
 
   /* 1) Add the DISPLAY command to the local display list buffer to finish
    *    the last display
@@ -313,9 +382,11 @@ int ft80x_dl_end(int fd, FAR struct ft80x_dlbuffer_s *buffer)
     }
 
   /* 5) For the case of the co-processor RAM CMD, it will also wait for the
-   *    FIFO to be emptied.
+   *    FIFO to be emptied.  When pipelining, the co-processor executes this
+   *    display list while the next one is being formed.
    */
 
+#ifndef CONFIG_GRAPHICS_FT80X_PIPELINE
   if (buffer->coproc)
     {
       ret = ft80x_ramcmd_waitfifoempty(fd);
@@ -325,6 +396,29 @@ int ft80x_dl_end(int fd, FAR struct ft80x_dlbuffer_s *buffer)
           return ret;
         }
     }
+#endif
+
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+  /* Account for the time of this display list */
+
+  stats         = &buffer->stats;
+  stats->last   = ft80x_dl_elapsed(&buffer->start);
+  stats->xfer   = buffer->xfer;
+  stats->dlsize = buffer->dlsize;
+  stats->total += stats->last;
+
+  if (stats->nframes == 0 || stats->last < stats->min)
+    {
+      stats->min = stats->last;
+    }
+
+  if (stats->last > stats->max)
+    {
+      stats->max = stats->last;
+    }
+
+  stats->nframes++;
+#endif
 
   return ret;
 }
@@ -719,3 +813,187 @@ int ft80x_dl_create(int fd, FAR struct ft80x_dlbuffer_s *buffer,
 
   return OK;
 }
+
+/****************************************************************************
+ * Name: ft80x_dlseg_start
+ *
+ * Description:
+ *   Start recording a display list segment into RAM G.  Display list
+ *   commands added to the buffer with ft80x_dl_data() and
+ *   ft80x_dl_string() are then written to RAM G instead of to the display
+ *   list, until ft80x_dlseg_end() is called.
+ *
+ * Input Parameters:
+ *   fd      - The file descriptor of the FT80x device.  Opened by the
+ *             caller with write access.
+ *   buffer  - An instance of struct ft80x_dlbuffer_s allocated by the
+ *             caller.
+ *   dlseg   - The segment to be recorded.
+ *   offset  - Offset in RAM G where the segment is stored.  Must be a
+ *             multiple of 4.
+ *   maxsize - The size of the RAM G space reserved for the segment.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int ft80x_dlseg_start(int fd, FAR struct ft80x_dlbuffer_s *buffer,
+                      FAR struct ft80x_dlseg_s *dlseg, uint32_t offset,
+                      uint32_t maxsize)
+{
+  ft80x_info("fd=%d buffer=%p offset=%lu maxsize=%lu\n",
+             fd, buffer, (unsigned long)offset, (unsigned long)maxsize);
+  DEBUGASSERT(fd >= 0 && buffer != NULL && dlseg != NULL);
+
+  if ((offset & 3) != 0 || maxsize == 0 ||
+      offset >= FT80X_RAM_G_SIZE || maxsize > FT80X_RAM_G_SIZE - offset)
+    {
+      ft80x_err("ERROR: Bad segment offset/size: %lu/%lu\n",
+                (unsigned long)offset, (unsigned long)maxsize);
+      return -EINVAL;
+    }
+
+  dlseg->offset    = offset;
+  dlseg->maxsize   = maxsize;
+  dlseg->size      = 0;
+
+  /* The display list commands are buffered as usual and written to the
+   * segment when the buffer is flushed.
+   */
+
+  buffer->coproc   = false;
+  buffer->dlsize   = 0;
+  buffer->dloffset = 0;
+  buffer->dlseg    = dlseg;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ft80x_dlseg_end
+ *
+ * Description:
+ *   Finish recording the display list segment started with
+ *   ft80x_dlseg_start().
+ *
+ * Input Parameters:
+ *   fd     - The file descriptor of the FT80x device.  Opened by the caller
+ *            with write access.
+ *   buffer - The buffer passed to ft80x_dlseg_start().
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure; -ENOSPC if
+ *   the segment did not fit into its RAM G space.
+ *
+ ****************************************************************************/
+
+int ft80x_dlseg_end(int fd, FAR struct ft80x_dlbuffer_s *buffer)
+{
+  int ret;
+
+  ft80x_info("fd=%d buffer=%p\n", fd, buffer);
+  DEBUGASSERT(fd >= 0 && buffer != NULL && buffer->dlseg != NULL);
+
+  ret = ft80x_dl_flush(fd, buffer, false);
+  if (ret < 0)
+    {
+      ft80x_err("ERROR: ft80x_dl_flush failed: %d\n", ret);
+    }
+
+  buffer->dlseg = NULL;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: ft80x_dlseg_append
+ *
+ * Description:
+ *   Add a recorded display list segment to the display list being formed
+ *   with a CMD_APPEND command.
+ *
+ * Input Parameters:
+ *   fd     - The file descriptor of the FT80x device.  Opened by the caller
+ *            with write access.
+ *   buffer - An instance of struct ft80x_dlbuffer_s allocated by the caller.
+ *   dlseg  - The segment recorded with ft80x_dlseg_start/end().
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int ft80x_dlseg_append(int fd, FAR struct ft80x_dlbuffer_s *buffer,
+                       FAR const struct ft80x_dlseg_s *dlseg)
+{
+  struct ft80x_cmd_append_s append;
+
+  ft80x_info("fd=%d buffer=%p offset=%lu size=%lu\n", fd, buffer,
+             (unsigned long)dlseg->offset, (unsigned long)dlseg->size);
+  DEBUGASSERT(fd >= 0 && buffer != NULL && dlseg != NULL &&
+              buffer->dlseg == NULL);
+
+  /* CMD_APPEND is a co-processor command */
+
+  if (!buffer->coproc)
+    {
+      ft80x_err("ERROR: Not a co-processor display list\n");
+      return -EINVAL;
+    }
+
+  if (dlseg->size == 0)
+    {
+      return OK;
+    }
+
+  append.cmd = FT80X_CMD_APPEND;
+  append.ptr = FT80X_RAM_G + dlseg->offset;
+  append.num = dlseg->size;
+
+  return ft80x_dl_data(fd, buffer, &append,
+                       sizeof(struct ft80x_cmd_append_s));
+}
+
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+/****************************************************************************
+ * Name: ft80x_dl_getstats
+ *
+ * Description:
+ *   Return the timing of the display lists completed with the buffer
+ *   since the last ft80x_dl_resetstats().
+ *
+ * Input Parameters:
+ *   buffer - An instance of struct ft80x_dlbuffer_s allocated by the caller.
+ *   stats  - The location to return the statistics.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void ft80x_dl_getstats(FAR const struct ft80x_dlbuffer_s *buffer,
+                       FAR struct ft80x_framestats_s *stats)
+{
+  DEBUGASSERT(buffer != NULL && stats != NULL);
+  *stats = buffer->stats;
+}
+
+/****************************************************************************
+ * Name: ft80x_dl_resetstats
+ *
+ * Description:
+ *   Reset the display list timing.
+ *
+ * Input Parameters:
+ *   buffer - An instance of struct ft80x_dlbuffer_s allocated by the caller.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void ft80x_dl_resetstats(FAR struct ft80x_dlbuffer_s *buffer)
+{
+  DEBUGASSERT(buffer != NULL);
+  memset(&buffer->stats, 0, sizeof(struct ft80x_framestats_s));
+}
+#endif
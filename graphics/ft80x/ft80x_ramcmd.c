@@ -39,6 +39,76 @@
 #include "graphics/ft80x.h"
 #include "ft80x.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* When the FIFO is full, writing resumes once this much of it is free */
+
+#define RAMCMD_RESUME      (FT80X_CMDFIFO_SIZE / 2)
+
+/* Polling of the FIFO space (units = microseconds) */
+
+#define RAMCMD_POLLDELAY   (1000)
+#define RAMCMD_POLLTIMEOUT (1000 * 1000)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ft80x_ramcmd_waitspace
+ *
+ * Description:
+ *   Wait until there are at least 'need' free bytes in RAM CMD.  Unlike
+ *   ft80x_ramcmd_waitfifoempty(), this does not wait for the co-processor
+ *   to execute all of the commands in the FIFO, so that it is never idle
+ *   while the next commands are written.
+ *
+ * Input Parameters:
+ *   fd     - The file descriptor of the FT80x device.  Opened by the caller
+ *            with write access.
+ *   need   - The number of free bytes to wait for.
+ *   offset - Pointer to location to return the write offset.
+ *   avail  - Pointer to location to return the FIFO free space.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int ft80x_ramcmd_waitspace(int fd, uint16_t need,
+                                  FAR uint16_t *offset,
+                                  FAR uint16_t *avail)
+{
+  int elapsed;
+  int ret;
+
+  for (elapsed = 0; ; elapsed += RAMCMD_POLLDELAY)
+    {
+      ret = ft80x_ramcmd_freespace(fd, offset, avail);
+      if (ret < 0)
+        {
+          ft80x_err("ERROR: ft80x_ramcmd_freespace() failed: %d\n", ret);
+          return ret;
+        }
+
+      if (*avail >= need)
+        {
+          return OK;
+        }
+
+      if (elapsed >= RAMCMD_POLLTIMEOUT)
+        {
+          ft80x_err("ERROR: Timed out!  %u bytes free, %u needed\n",
+                    *avail, need);
+          return -ETIMEDOUT;
+        }
+
+      usleep(RAMCMD_POLLDELAY);
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -49,6 +119,12 @@
  * Description:
  *   Append new display list data to RAM CMD
  *
+ *   The data is written as far as it fits into the FIFO and REG_CMD_WRITE
+ *   is updated, so that the co-processor starts executing it at once.  If
+ *   the FIFO becomes full, the rest is written as soon as half of the FIFO
+ *   is free again:  The co-processor executes one half of the FIFO while
+ *   the other half is being written.
+ *
  * Input Parameters:
  *   fd     - The file descriptor of the FT80x device.  Opened by the caller
  *            with write access.
@@ -64,7 +140,7 @@ int ft80x_ramcmd_append(int fd, FAR const void *data, size_t len)
 {
   struct ft80x_relmem_s wrdesc;
   FAR const uint8_t *src;
-  ssize_t remaining;
+  size_t remaining;
   size_t wrsize;
   uint16_t offset;
   uint16_t maxsize;
@@ -73,6 +149,15 @@ int ft80x_ramcmd_append(int fd, FAR const void *data, size_t len)
   DEBUGASSERT(data != NULL && ((uintptr_t)data & 3) == 0 &&
               len > 0 && (len & 3) == 0);
 
+  /* Get the amount of free space in the FIFO. */
+
+  ret = ft80x_ramcmd_freespace(fd, &offset, &maxsize);
+  if (ret < 0)
+    {
+      ft80x_err("ERROR: ft80x_ramcmd_freespace() failed: %d\n", ret);
+      return ret;
+    }
+
   /* Loop until all of the display list commands have been transferred to
    * FIFO.
    */
@@ -80,105 +165,68 @@ int ft80x_ramcmd_append(int fd, FAR const void *data, size_t len)
   src       = data;
   remaining = len;
 
-  do
+  for (; ; )
     {
-      /* Write the number of bytes remaining to be transferred */
+      /* Limit the write size to the size of the available FIFO memory */
 
       wrsize = remaining;
-
-      /* Get the amount of free space in the FIFO. */
-
-      maxsize = 0;
-      ret     = ft80x_ramcmd_freespace(fd, &offset, &maxsize);
-      if (ret < 0)
+      if (wrsize > (size_t)maxsize)
         {
-          ft80x_err("ERROR: ft80x_ramcmd_freespace() failed: %d\n", ret);
-          return ret;
+          wrsize = (size_t)maxsize;
         }
 
-      /* If the FIFO full?
-       *
-       * REVISIT:  Will the FIFO be consumed as we generate the display
-       * list?  Is it fatal if it becomes full?  Or could we wait for space
-       * to free up.
-       */
-
-      if (maxsize == 0)
+      if (wrsize > 0)
         {
-#if 1
-          /* Yes.. wait for the FIFO to empty, then try again.
-           *
-           * REVISIT:  Would it not be sufficient to wait only until the
-           * FIFO is not full?
-           */
-
-          ft80x_warn("WARNING: FIFO is full: %d\n", ret);
-          ret = ft80x_ramcmd_waitfifoempty(fd);
+          /* Perform the transfer */
+
+          wrdesc.offset = offset;
+          wrdesc.nbytes = wrsize;
+          wrdesc.value  = (FAR void *)src;  /* Discards 'const' qualifier */
+
+          ret = ioctl(fd, FT80X_IOC_PUTRAMCMD,
+                      (unsigned long)((uintptr_t)&wrdesc));
           if (ret < 0)
             {
-              ft80x_err("ERROR: ft80x_ramcmd_waitfifoempty() failed: %d\n",
-                        ret);
-              return ret;
+              int errcode = errno;
+              ft80x_err("ERROR: ioctl() FT80X_IOC_PUTRAMCMD failed: %d\n",
+                        errcode);
+              return -errcode;
             }
 
-          continue;
-#else
-          ft80x_err("ERROR: FIFO is full: %d\n", ret);
-          return -ENOSPC;
-#endif
-        }
+          /* Update the command FIFO */
 
-      /* Limit the write size to the size of the available FIFO memory */
+          ret = ft80x_putreg16(fd, FT80X_REG_CMD_WRITE, offset + wrsize);
+          if (ret < 0)
+            {
+              ft80x_err("ERROR: ft80x_putreg16() failed: %d\n", ret);
+              return ret;
+            }
 
-      if (wrsize > (size_t)maxsize)
-        {
-          wrsize = (size_t)maxsize;
+          remaining -= wrsize;
+          src       += wrsize;
         }
 
-      /* Perform the transfer */
-
-      wrdesc.offset = offset;
-      wrdesc.nbytes = wrsize;
-      wrdesc.value  = (FAR void *)src;  /* Discards 'const' qualifier */
-
-      ret = ioctl(fd, FT80X_IOC_PUTRAMCMD,
-                  (unsigned long)((uintptr_t)&wrdesc));
-      if (ret < 0)
+      if (remaining == 0)
         {
-          int errcode = errno;
-          ft80x_err("ERROR: ioctl() FT80X_IOC_PUTRAMCMD failed: %d\n",
-                    errcode);
-          return -errcode;
+          break;
         }
 
-      /* Update the command FIFO */
+      /* The FIFO is full.  Wait until half of it (or as much as is still
+       * needed) has been consumed by the co-processor.
+       */
+
+      ft80x_info("FIFO is full, %lu bytes remaining\n",
+                 (unsigned long)remaining);
 
-      ret = ft80x_putreg16(fd, FT80X_REG_CMD_WRITE, offset + wrsize);
+      ret = ft80x_ramcmd_waitspace(fd, remaining < RAMCMD_RESUME ?
+                                   remaining : RAMCMD_RESUME,
+                                   &offset, &maxsize);
       if (ret < 0)
         {
-          ft80x_err("ERROR: ft80x_putreg16() failed: %d\n", ret);
+          ft80x_err("ERROR: ft80x_ramcmd_waitspace() failed: %d\n", ret);
           return ret;
         }
-
-      /* Wait for the FIFO to empty */
-
-      if (remaining > wrsize)
-        {
-          ret = ft80x_ramcmd_waitfifoempty(fd);
-          if (ret < 0)
-            {
-              ft80x_err("ERROR: ft80x_ramcmd_waitfifoempty() failed: %d\n",
-                        ret);
-              return ret;
-            }
-        }
-
-      /* Set up for the next time through the loop. */
-
-      remaining -= wrsize;
-      src       += wrsize;
     }
-  while (remaining > 0);
 
   return OK;
 }
@@ -197,13 +245,12 @@ int ft80x_ramcmd_append(int fd, FAR const void *data, size_t len)
  *   avail  - Pointer to location to return the FIFO free space
  *
  * Returned Value:
- *   The (positive) number of free bytes in RAM CMD on success.  A negated
- *   errno value is returned on any failure.
+ *   Zero (OK) on success.  A negated errno value on failure.
  *
  ****************************************************************************/
 
-uint16_t ft80x_ramcmd_freespace(int fd, FAR uint16_t *offset,
-                                FAR uint16_t *avail)
+int ft80x_ramcmd_freespace(int fd, FAR uint16_t *offset,
+                           FAR uint16_t *avail)
 {
   uint32_t regs[2];
   int ret;
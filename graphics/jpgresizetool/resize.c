@@ -24,98 +24,415 @@
  * Included Files
  ****************************************************************************/
 
+#include <nuttx/config.h>
+
+#include <sys/stat.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <limits.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <unistd.h>
 #include <jpeglib.h>
 
 /****************************************************************************
  * Definitions
  ****************************************************************************/
 
-/* Every N line, report resizing progress */
-#define JPEGRESIZE_PROGRESS_INTERVAL  40
+#ifndef CONFIG_GRAPHICS_JPGRESIZETOOL_THREADS
+#  define CONFIG_GRAPHICS_JPGRESIZETOOL_THREADS 2
+#endif
+
+#ifndef CONFIG_GRAPHICS_JPGRESIZETOOL_STACKSIZE
+#  define CONFIG_GRAPHICS_JPGRESIZETOOL_STACKSIZE 4096
+#endif
+
+#ifndef CONFIG_GRAPHICS_JPGRESIZETOOL_LINES
+#  define CONFIG_GRAPHICS_JPGRESIZETOOL_LINES 16
+#endif
+
+/* Report resizing progress every N percent */
+
+#define JPEGRESIZE_PROGRESS_STEP  10
+
+/* libjpeg scales by scale_num / 8 in the DCT domain, scale_num 1 to 16 */
+
+#define JPEGRESIZE_DCT_DENOM      8
+#define JPEGRESIZE_DCT_MAXNUM     16
+
+/* Resampler weights are 16.16 fixed point */
+
+#define JPEGRESIZE_FRAC_BITS      16
+#define JPEGRESIZE_FRAC_ONE       (1 << JPEGRESIZE_FRAC_BITS)
+#define JPEGRESIZE_FRAC_MASK      (JPEGRESIZE_FRAC_ONE - 1)
 
 /****************************************************************************
- * Public Functions
+ * Private Types
  ****************************************************************************/
 
-/* Usage: jpgresize input.jpg output.jpg scale_denom quality%
- * scale_denom: 1, 2, 4, 8. Shrinks image by scale_denom times.
- * quality: 1% to 100%. 20% heavy compression, 80% nearly original.
- * thumbnail example:
- * jpgresize /sd/IMAGES/000000a1.jpg /sd/TEMP/THUMBS/000000a1.jpg 8 20
- */
+/* What to do with each image */
 
-int main(int argc, char *argv[])
+struct jpgresize_opts_s
 {
-  struct jpeg_compress_struct cinfo_out;
-  struct jpeg_decompress_struct cinfo;
-  struct jpeg_error_mgr jerr_out;
-  struct jpeg_error_mgr jerr;
-  const char *output_filename;
-  const char *input_filename;
-  uint8_t togglechar;
-  JSAMPARRAY buffer;
-  FILE *outfile;
-  FILE *infile;
-  int scale_denom;
-  int pixel_size;
-  int quality;
-  int height;
-  int width;
+  int scale_denom;          /* Shrink by this factor, or 0 */
+  JDIMENSION width;         /* Else the output width, 0 keeps aspect */
+  JDIMENSION height;        /* And the output height, 0 keeps aspect */
+  int quality;              /* Compression quality in percent */
+  bool progress;            /* Print a progress indication */
+};
 
-  /* Take arguments */
+/* Bilinear resampler for the part of the scaling that the DCT did not do */
+
+struct jpgresize_sampler_s
+{
+  JDIMENSION srcwidth;      /* Width of the decoded image */
+  JDIMENSION srcheight;     /* Height of the decoded image */
+  JDIMENSION dstwidth;      /* Width of the output image */
+  JDIMENSION dstheight;     /* Height of the output image */
+  int components;           /* Samples per pixel */
+  FAR JDIMENSION *xoffset;  /* Left source sample of each output pixel */
+  FAR uint16_t *xfrac;      /* Weight of the right source pixel */
+  JSAMPARRAY rows;          /* Two decoded rows, scaled horizontally */
+  JDIMENSION dsty;          /* Next output row */
+};
+
+/* Work shared by the threads of the batch mode */
+
+struct jpgresize_batch_s
+{
+  FAR const struct jpgresize_opts_s *opts;
+  FAR const char *indir;
+  FAR const char *outdir;
+  FAR char **names;         /* Images found in indir */
+  int count;                /* Number of images */
+  int next;                 /* Next image to take */
+  int failed;               /* Number of images that failed */
+  pthread_mutex_t lock;     /* Protects next and failed */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: jpgresize_error_exit
+ *
+ * Description:
+ *   Return to the image that failed instead of exiting the program, which
+ *   would end all other images of a batch as well.  client_data holds the
+ *   jmp_buf of the image.
+ *
+ ****************************************************************************/
+
+static void jpgresize_error_exit(j_common_ptr cinfo)
+{
+  (*cinfo->err->output_message)(cinfo);
+  longjmp(*(FAR jmp_buf *)cinfo->client_data, 1);
+}
+
+/****************************************************************************
+ * Name: jpgresize_dctscale
+ *
+ * Description:
+ *   Select the smallest DCT scaling whose output covers the requested
+ *   size, or the largest one if none does.  The resampler then only has
+ *   to shrink by less than one scaling step.
+ *
+ ****************************************************************************/
+
+static void jpgresize_dctscale(j_decompress_ptr cinfo,
+                               JDIMENSION width, JDIMENSION height)
+{
+  int num;
+
+  cinfo->scale_denom = JPEGRESIZE_DCT_DENOM;
 
-  if (argc != 5)
+  for (num = 1; num <= JPEGRESIZE_DCT_MAXNUM; num++)
     {
-      fprintf(stderr,
-      "Usage: %s input.jpg output.jpg scale_denom(1, 2, 4, 8) quality%%\n",
-              argv[0]);
-      return -1;
+      cinfo->scale_num = num;
+      jpeg_calc_output_dimensions(cinfo);
+
+      if (cinfo->output_width >= width && cinfo->output_height >= height)
+        {
+          return;
+        }
     }
 
-  scale_denom = atoi(argv[3]);
-  if (scale_denom != 1 && scale_denom != 2 && scale_denom != 4 &&
-      scale_denom != 8 && scale_denom != 16)
+  cinfo->scale_num = JPEGRESIZE_DCT_MAXNUM;
+}
+
+/****************************************************************************
+ * Name: jpgresize_position
+ *
+ * Description:
+ *   Map the center of output pixel dst to a 16.16 source position for a
+ *   scaling from srcsize to dstsize.
+ *
+ ****************************************************************************/
+
+static uint32_t jpgresize_position(JDIMENSION dst, JDIMENSION srcsize,
+                                   JDIMENSION dstsize)
+{
+  int64_t pos;
+
+  pos = ((int64_t)(2 * dst + 1) * srcsize - dstsize) *
+        JPEGRESIZE_FRAC_ONE / (2 * (int64_t)dstsize);
+  if (pos < 0)
     {
-      fprintf(stderr, "scale_denom must be 1, 2, 4 or 8\n");
-      return -1;
+      pos = 0;
+    }
+
+  if (pos > (int64_t)(srcsize - 1) << JPEGRESIZE_FRAC_BITS)
+    {
+      pos = (int64_t)(srcsize - 1) << JPEGRESIZE_FRAC_BITS;
+    }
+
+  return (uint32_t)pos;
+}
+
+/****************************************************************************
+ * Name: jpgresize_sampler_init
+ ****************************************************************************/
+
+static void jpgresize_sampler_init(j_decompress_ptr cinfo,
+                                   FAR struct jpgresize_sampler_s *smp,
+                                   JDIMENSION width, JDIMENSION height)
+{
+  JDIMENSION x;
+  uint32_t pos;
+
+  smp->srcwidth   = cinfo->output_width;
+  smp->srcheight  = cinfo->output_height;
+  smp->dstwidth   = width;
+  smp->dstheight  = height;
+  smp->components = cinfo->output_components;
+  smp->dsty       = 0;
+
+  smp->xoffset = (*cinfo->mem->alloc_small)
+    ((j_common_ptr)cinfo, JPOOL_IMAGE, width * sizeof(JDIMENSION));
+  smp->xfrac   = (*cinfo->mem->alloc_small)
+    ((j_common_ptr)cinfo, JPOOL_IMAGE, width * sizeof(uint16_t));
+  smp->rows    = (*cinfo->mem->alloc_sarray)
+    ((j_common_ptr)cinfo, JPOOL_IMAGE, width * smp->components, 2);
+
+  for (x = 0; x < width; x++)
+    {
+      pos = jpgresize_position(x, smp->srcwidth, width);
+      smp->xoffset[x] = (pos >> JPEGRESIZE_FRAC_BITS) * smp->components;
+      smp->xfrac[x]   = pos & JPEGRESIZE_FRAC_MASK;
     }
+}
+
+/****************************************************************************
+ * Name: jpgresize_hscale
+ *
+ * Description:
+ *   Scale one decoded row to the output width.
+ *
+ ****************************************************************************/
+
+static void jpgresize_hscale(FAR struct jpgresize_sampler_s *smp,
+                             JSAMPROW src, JSAMPROW dst)
+{
+  JDIMENSION last = (smp->srcwidth - 1) * smp->components;
+  JDIMENSION x;
+  int c;
+
+  for (x = 0; x < smp->dstwidth; x++)
+    {
+      JDIMENSION left  = smp->xoffset[x];
+      JDIMENSION right = left < last ? left + smp->components : left;
+      uint32_t frac    = smp->xfrac[x];
+
+      for (c = 0; c < smp->components; c++)
+        {
+          *dst++ = (JSAMPLE)(((JPEGRESIZE_FRAC_ONE - frac) * src[left + c] +
+                              frac * src[right + c] +
+                              JPEGRESIZE_FRAC_ONE / 2) >>
+                             JPEGRESIZE_FRAC_BITS);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: jpgresize_resample
+ *
+ * Description:
+ *   Consume the decoded row srcy and produce every output row that needs
+ *   no later row.  Returns the number of rows put into dst.
+ *
+ ****************************************************************************/
+
+static int jpgresize_resample(FAR struct jpgresize_sampler_s *smp,
+                              JDIMENSION srcy, JSAMPROW src,
+                              JSAMPARRAY dst)
+{
+  JDIMENSION nsamples = smp->dstwidth * smp->components;
+  JSAMPROW top;
+  JSAMPROW bottom;
+  JDIMENSION y0;
+  JDIMENSION y1;
+  JDIMENSION i;
+  uint32_t frac;
+  uint32_t pos;
+  int nrows = 0;
+
+  jpgresize_hscale(smp, src, smp->rows[srcy & 1]);
+
+  while (smp->dsty < smp->dstheight)
+    {
+      pos  = jpgresize_position(smp->dsty, smp->srcheight, smp->dstheight);
+      y0   = pos >> JPEGRESIZE_FRAC_BITS;
+      y1   = y0 < smp->srcheight - 1 ? y0 + 1 : y0;
+      frac = pos & JPEGRESIZE_FRAC_MASK;
+
+      if (y1 > srcy)
+        {
+          break;
+        }
+
+      /* Both source rows are buffered; y0 is srcy or srcy - 1 */
+
+      top    = smp->rows[y0 & 1];
+      bottom = smp->rows[y1 & 1];
+
+      for (i = 0; i < nsamples; i++)
+        {
+          dst[nrows][i] = (JSAMPLE)(((JPEGRESIZE_FRAC_ONE - frac) * top[i] +
+                                     frac * bottom[i] +
+                                     JPEGRESIZE_FRAC_ONE / 2) >>
+                                    JPEGRESIZE_FRAC_BITS);
+        }
+
+      smp->dsty++;
+      nrows++;
+    }
+
+  return nrows;
+}
 
-  input_filename  = argv[1];
-  output_filename = argv[2];
-  quality = atoi(argv[4]);
+/****************************************************************************
+ * Name: jpgresize_file
+ *
+ * Description:
+ *   Resize one JPEG file.  Returns 0 on success, -1 on failure.
+ *
+ ****************************************************************************/
+
+static int jpgresize_file(FAR const struct jpgresize_opts_s *opts,
+                          FAR const char *input_filename,
+                          FAR const char *output_filename)
+{
+  struct jpeg_compress_struct cinfo_out;
+  struct jpeg_decompress_struct cinfo;
+  struct jpeg_error_mgr jerr_out;
+  struct jpeg_error_mgr jerr;
+  struct jpgresize_sampler_s smp;
+  JSAMPARRAY outbuf;
+  JSAMPARRAY buffer;
+  jmp_buf jmpbuf;
+  JDIMENSION height;
+  JDIMENSION width;
+  JDIMENSION lines;
+  JDIMENSION nread;
+  JDIMENSION i;
+  FILE *volatile outfile = NULL;
+  FILE *infile;
+  bool resample;
+  JDIMENSION percent;
+  JDIMENSION shown;
+  int nout;
 
   /* Opening input */
 
   infile = fopen(input_filename, "rb");
   if (!infile)
     {
-      perror("fopen input");
+      perror(input_filename);
       return -1;
     }
 
-  /* Configuring decompressor */
+  /* Configuring decompressor.  Both libjpeg objects exist from here on, so
+   * that a failure in either can destroy both.
+   */
 
   cinfo.err = jpeg_std_error(&jerr);
+  jerr.error_exit = jpgresize_error_exit;
+  cinfo_out.err = jpeg_std_error(&jerr_out);
+  jerr_out.error_exit = jpgresize_error_exit;
+
   jpeg_create_decompress(&cinfo);
+  jpeg_create_compress(&cinfo_out);
+  cinfo.client_data = &jmpbuf;
+  cinfo_out.client_data = &jmpbuf;
+
+  if (setjmp(jmpbuf))
+    {
+      fprintf(stderr, "%s: resize failed\n", input_filename);
+      jpeg_destroy_compress(&cinfo_out);
+      jpeg_destroy_decompress(&cinfo);
+      if (outfile)
+        {
+          fclose(outfile);
+          unlink(output_filename);
+        }
+
+      fclose(infile);
+      return -1;
+    }
+
   jpeg_stdio_src(&cinfo, infile);
   jpeg_read_header(&cinfo, TRUE);
 
-  cinfo.scale_num = 1;
-  cinfo.scale_denom = scale_denom;
+  /* Work out the output size.  A scale_denom is a plain DCT scaling, an
+   * output size is reached with the nearest DCT scaling above it and
+   * the resampler for the rest.
+   */
+
+  if (opts->scale_denom > 0)
+    {
+      width  = (cinfo.image_width + opts->scale_denom - 1) /
+               opts->scale_denom;
+      height = (cinfo.image_height + opts->scale_denom - 1) /
+               opts->scale_denom;
+    }
+  else
+    {
+      width  = opts->width;
+      height = opts->height;
+
+      if (width == 0)
+        {
+          width = ((uint64_t)cinfo.image_width * height +
+                   cinfo.image_height / 2) / cinfo.image_height;
+        }
+      else if (height == 0)
+        {
+          height = ((uint64_t)cinfo.image_height * width +
+                    cinfo.image_width / 2) / cinfo.image_width;
+        }
+
+      width  = width > 0 ? width : 1;
+      height = height > 0 ? height : 1;
+    }
+
+  jpgresize_dctscale(&cinfo, width, height);
   jpeg_start_decompress(&cinfo);
 
-  width = cinfo.output_width;
-  height = cinfo.output_height;
-  pixel_size = cinfo.output_components;
+  resample = cinfo.output_width != width || cinfo.output_height != height;
 
   /* Opening output */
 
   outfile = fopen(output_filename, "wb");
   if (!outfile)
     {
-      perror("fopen output");
+      perror(output_filename);
+      jpeg_destroy_compress(&cinfo_out);
       jpeg_destroy_decompress(&cinfo);
       fclose(infile);
       return -1;
@@ -123,70 +440,77 @@ int main(int argc, char *argv[])
 
   /* Configuring compressor */
 
-  cinfo_out.err = jpeg_std_error(&jerr_out);
-  jpeg_create_compress(&cinfo_out);
   jpeg_stdio_dest(&cinfo_out, outfile);
 
   cinfo_out.image_width = width;
   cinfo_out.image_height = height;
-  cinfo_out.input_components = pixel_size;
+  cinfo_out.input_components = cinfo.output_components;
   cinfo_out.in_color_space = cinfo.out_color_space;
   jpeg_set_defaults(&cinfo_out);
-  jpeg_set_quality(&cinfo_out, quality, TRUE);
+  jpeg_set_quality(&cinfo_out, opts->quality, TRUE);
   jpeg_start_compress(&cinfo_out, TRUE);
 
-  /* Allocating memory by using JPEG their own allocator. Do not use malloc */
+  /* Allocating memory by using JPEG their own allocator. Do not use malloc.
+   * Scanlines are passed through libjpeg in batches.  When enlarging, one
+   * decoded row completes up to one output row more than the ratio of the
+   * heights.
+   */
 
-  printf("Allocating... \r");
+  lines = CONFIG_GRAPHICS_JPGRESIZETOOL_LINES;
   buffer = (*cinfo.mem->alloc_sarray)
-      ((j_common_ptr)&cinfo, JPOOL_IMAGE, width * pixel_size, 1);
+      ((j_common_ptr)&cinfo, JPOOL_IMAGE,
+       cinfo.output_width * cinfo.output_components, lines);
+
+  outbuf = buffer;
+  if (resample)
+    {
+      jpgresize_sampler_init(&cinfo, &smp, width, height);
+      outbuf = (*cinfo.mem->alloc_sarray)
+        ((j_common_ptr)&cinfo, JPOOL_IMAGE,
+         width * cinfo.output_components,
+         lines * (height / cinfo.output_height + 2));
+    }
 
   /* Start the job */
 
-  printf("Resizing...   \n");
-  togglechar = 0;
+  shown = 0;
   while (cinfo.output_scanline < cinfo.output_height)
     {
-      /* Pretty loading bar... */
-
-      if (cinfo.output_scanline % JPEGRESIZE_PROGRESS_INTERVAL == 1)
-        {
-          printf("\r[%u%%]",
-                 (unsigned)(((float)cinfo.output_scanline
-                 / cinfo.output_height)
-                 * 100));
-          togglechar = !togglechar;
-        }
+      nread = jpeg_read_scanlines(&cinfo, buffer, lines);
 
-      if (togglechar)
+      if (resample)
         {
-          printf("-");
+          nout = 0;
+          for (i = 0; i < nread; i++)
+            {
+              nout += jpgresize_resample(&smp,
+                                         cinfo.output_scanline - nread + i,
+                                         buffer[i], outbuf + nout);
+            }
         }
       else
         {
-          printf("#");
+          nout = nread;
         }
 
-      fflush(stdout);
-
-      /* Actual work */
-
-      jpeg_read_scanlines(&cinfo, buffer, 1);
-      jpeg_write_scanlines(&cinfo_out, buffer, 1);
-    }
+      if (nout > 0)
+        {
+          jpeg_write_scanlines(&cinfo_out, outbuf, nout);
+        }
 
-  /* Erase progress bar */
+      /* Loading indication */
 
-  printf("\r      ");
-  for (size_t i = 0; i < JPEGRESIZE_PROGRESS_INTERVAL; i++)
-    {
-      printf(" ");
+      percent = cinfo.output_scanline * 100 / cinfo.output_height;
+      if (opts->progress && percent >= shown + JPEGRESIZE_PROGRESS_STEP)
+        {
+          printf("\r[%u%%]", (unsigned)percent);
+          fflush(stdout);
+          shown = percent;
+        }
     }
 
   /* All done */
 
-  printf("\rDone\n");
-
   jpeg_finish_compress(&cinfo_out);
   jpeg_destroy_compress(&cinfo_out);
   fclose(outfile);
@@ -195,6 +519,283 @@ int main(int argc, char *argv[])
   jpeg_destroy_decompress(&cinfo);
   fclose(infile);
 
-  printf("Resized JPEG written to %s\n", output_filename);
+  if (opts->progress)
+    {
+      printf("\rDone  \n");
+    }
+
+  printf("%s: %ux%u written to %s\n", input_filename,
+         (unsigned)width, (unsigned)height, output_filename);
   return 0;
 }
+
+/****************************************************************************
+ * Name: jpgresize_isjpeg
+ ****************************************************************************/
+
+static bool jpgresize_isjpeg(FAR const char *name)
+{
+  FAR const char *ext = strrchr(name, '.');
+
+  return ext != NULL &&
+         (strcasecmp(ext, ".jpg") == 0 || strcasecmp(ext, ".jpeg") == 0);
+}
+
+/****************************************************************************
+ * Name: jpgresize_worker
+ *
+ * Description:
+ *   Take images of the batch until none is left.
+ *
+ ****************************************************************************/
+
+static FAR void *jpgresize_worker(FAR void *arg)
+{
+  FAR struct jpgresize_batch_s *batch = arg;
+  char input[PATH_MAX];
+  char output[PATH_MAX];
+  int index;
+
+  for (; ; )
+    {
+      pthread_mutex_lock(&batch->lock);
+      index = batch->next < batch->count ? batch->next++ : -1;
+      pthread_mutex_unlock(&batch->lock);
+
+      if (index < 0)
+        {
+          break;
+        }
+
+      snprintf(input, sizeof(input), "%s/%s",
+               batch->indir, batch->names[index]);
+      snprintf(output, sizeof(output), "%s/%s",
+               batch->outdir, batch->names[index]);
+
+      if (jpgresize_file(batch->opts, input, output) < 0)
+        {
+          pthread_mutex_lock(&batch->lock);
+          batch->failed++;
+          pthread_mutex_unlock(&batch->lock);
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: jpgresize_dir
+ *
+ * Description:
+ *   Resize every JPEG file in indir into a file of the same name in outdir
+ *   using nthreads threads.  Returns 0 if all images were resized.
+ *
+ ****************************************************************************/
+
+static int jpgresize_dir(FAR const struct jpgresize_opts_s *opts,
+                         FAR const char *indir, FAR const char *outdir,
+                         int nthreads)
+{
+  struct jpgresize_batch_s batch;
+  FAR struct dirent *entry;
+  FAR pthread_t *threads;
+  pthread_attr_t attr;
+  FAR char **names;
+  FAR DIR *dir;
+  int started;
+  int ret = -1;
+  int i;
+
+  memset(&batch, 0, sizeof(batch));
+  batch.opts   = opts;
+  batch.indir  = indir;
+  batch.outdir = outdir;
+
+  /* Collect the images first so that the workers need not share the
+   * directory stream.
+   */
+
+  dir = opendir(indir);
+  if (dir == NULL)
+    {
+      perror(indir);
+      return -1;
+    }
+
+  while ((entry = readdir(dir)) != NULL)
+    {
+      if (!jpgresize_isjpeg(entry->d_name))
+        {
+          continue;
+        }
+
+      names = realloc(batch.names, (batch.count + 1) * sizeof(FAR char *));
+      if (names == NULL)
+        {
+          fprintf(stderr, "Out of memory\n");
+          goto errout_with_names;
+        }
+
+      batch.names = names;
+      batch.names[batch.count] = strdup(entry->d_name);
+      if (batch.names[batch.count] == NULL)
+        {
+          fprintf(stderr, "Out of memory\n");
+          goto errout_with_names;
+        }
+
+      batch.count++;
+    }
+
+  if (nthreads > batch.count)
+    {
+      nthreads = batch.count > 0 ? batch.count : 1;
+    }
+
+  threads = malloc(nthreads * sizeof(pthread_t));
+  if (threads == NULL)
+    {
+      fprintf(stderr, "Out of memory\n");
+      goto errout_with_names;
+    }
+
+  /* Start the workers.  The calling thread does its share as well */
+
+  pthread_mutex_init(&batch.lock, NULL);
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, CONFIG_GRAPHICS_JPGRESIZETOOL_STACKSIZE);
+
+  for (started = 0; started < nthreads - 1; started++)
+    {
+      if (pthread_create(&threads[started], &attr, jpgresize_worker,
+                         &batch) != 0)
+        {
+          break;
+        }
+    }
+
+  jpgresize_worker(&batch);
+
+  for (i = 0; i < started; i++)
+    {
+      pthread_join(threads[i], NULL);
+    }
+
+  pthread_attr_destroy(&attr);
+  pthread_mutex_destroy(&batch.lock);
+  free(threads);
+
+  printf("%d of %d images resized\n",
+         batch.count - batch.failed, batch.count);
+  ret = batch.failed > 0 ? -1 : 0;
+
+errout_with_names:
+  for (i = 0; i < batch.count; i++)
+    {
+      free(batch.names[i]);
+    }
+
+  free(batch.names);
+  closedir(dir);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: jpgresize_usage
+ ****************************************************************************/
+
+static void jpgresize_usage(FAR const char *progname)
+{
+  fprintf(stderr,
+          "Usage: %s [-j threads] input output scale quality%%\n"
+          "  input, output: JPEG files, or directories to resize all\n"
+          "                 JPEG files of input into output\n"
+          "  scale:   scale_denom (1, 2, 4, 8) to shrink by that factor,\n"
+          "           or WIDTHxHEIGHT, where 0 keeps the aspect ratio\n"
+          "  quality: 1%% to 100%%\n"
+          "  -j:      threads of the directory mode (default %d)\n",
+          progname, CONFIG_GRAPHICS_JPGRESIZETOOL_THREADS);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* Usage: jpgresize [-j threads] input.jpg output.jpg scale quality%
+ * scale: scale_denom 1, 2, 4, 8. Shrinks image by scale_denom times.
+ *        Or WIDTHxHEIGHT, e.g. 160x0 for a 160 pixel wide image.
+ * quality: 1% to 100%. 20% heavy compression, 80% nearly original.
+ * With directories as input and output all JPEG files are resized.
+ * thumbnail example:
+ * jpgresize /sd/IMAGES/000000a1.jpg /sd/TEMP/THUMBS/000000a1.jpg 8 20
+ * jpgresize -j 2 /sd/IMAGES /sd/TEMP/THUMBS 160x0 20
+ */
+
+int main(int argc, char *argv[])
+{
+  struct jpgresize_opts_s opts;
+  struct stat st;
+  FAR char *end;
+  int nthreads = CONFIG_GRAPHICS_JPGRESIZETOOL_THREADS;
+  int option;
+
+  /* Take arguments */
+
+  while ((option = getopt(argc, argv, "j:")) != ERROR)
+    {
+      switch (option)
+        {
+          case 'j':
+            nthreads = atoi(optarg);
+            if (nthreads < 1)
+              {
+                fprintf(stderr, "threads must be at least 1\n");
+                return -1;
+              }
+            break;
+
+          default:
+            jpgresize_usage(argv[0]);
+            return -1;
+        }
+    }
+
+  if (argc - optind != 4)
+    {
+      jpgresize_usage(argv[0]);
+      return -1;
+    }
+
+  memset(&opts, 0, sizeof(opts));
+
+  if (strchr(argv[optind + 2], 'x') != NULL)
+    {
+      opts.width  = strtoul(argv[optind + 2], &end, 10);
+      opts.height = strtoul(end + 1, &end, 10);
+      if (*end != '\0' || (opts.width == 0 && opts.height == 0))
+        {
+          fprintf(stderr, "size must be WIDTHxHEIGHT\n");
+          return -1;
+        }
+    }
+  else
+    {
+      opts.scale_denom = atoi(argv[optind + 2]);
+      if (opts.scale_denom != 1 && opts.scale_denom != 2 &&
+          opts.scale_denom != 4 && opts.scale_denom != 8)
+        {
+          fprintf(stderr, "scale_denom must be 1, 2, 4 or 8\n");
+          return -1;
+        }
+    }
+
+  opts.quality = atoi(argv[optind + 3]);
+
+  if (stat(argv[optind], &st) == 0 && S_ISDIR(st.st_mode))
+    {
+      return jpgresize_dir(&opts, argv[optind], argv[optind + 1], nthreads);
+    }
+
+  opts.progress = true;
+  return jpgresize_file(&opts, argv[optind], argv[optind + 1]);
+}
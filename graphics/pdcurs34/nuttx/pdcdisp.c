@@ -25,8 +25,10 @@
  ****************************************************************************/
 
 #include <sys/ioctl.h>
+#include <sys/param.h>
 #include <assert.h>
 #include <errno.h>
+#include <string.h>
 #include <unistd.h>
 
 #ifdef CONFIG_SYSTEM_TERMCURSES
@@ -211,13 +213,15 @@ static inline pdc_color_t PDC_color(FAR struct pdc_fbstate_s *fbstate,
  * Description:
  *   Set memory to the device background RGB color.  For the case of BPP < 8,
  *   this is byte-aligned font buffer.  For other cases, this clears a patch
- *   of memory in the framebuffer.
+ *   of memory in the framebuffer or in the glyph cache.  stride is the
+ *   length of one line of that memory in bytes.
  *
  ****************************************************************************/
 
 #if PDCURSES_BPP < 8
 static inline void PDC_set_bg(FAR struct pdc_fbstate_s *fbstate,
-                              FAR uint8_t *fbuffer, short bg)
+                              FAR uint8_t *fbuffer, unsigned int stride,
+                              short bg)
 {
   uint8_t color8;
   int row;
@@ -229,7 +233,7 @@ static inline void PDC_set_bg(FAR struct pdc_fbstate_s *fbstate,
 
   /* Now copy the color into the entire glyph region */
 
-  for (row = 0; row < fbstate->fheight; row++, fbuffer += fbstate->fstride)
+  for (row = 0; row < fbstate->fheight; row++, fbuffer += stride)
     {
       FAR uint8_t *fbdest = fbuffer;
 
@@ -246,7 +250,8 @@ static inline void PDC_set_bg(FAR struct pdc_fbstate_s *fbstate,
 }
 #else
 static inline void PDC_set_bg(FAR struct pdc_fbstate_s *fbstate,
-                              FAR uint8_t *fbstart, short bg)
+                              FAR uint8_t *fbstart, unsigned int stride,
+                              short bg)
 {
   pdc_color_t bgcolor = PDC_color(fbstate, bg);
   int row;
@@ -254,7 +259,7 @@ static inline void PDC_set_bg(FAR struct pdc_fbstate_s *fbstate,
 
   /* Set the glyph to the background color. */
 
-  for (row = 0; row < fbstate->fheight; row++, fbstart += fbstate->stride)
+  for (row = 0; row < fbstate->fheight; row++, fbstart += stride)
     {
       FAR pdc_color_t *fbdest;
 
@@ -273,28 +278,20 @@ static inline void PDC_set_bg(FAR struct pdc_fbstate_s *fbstate,
  *
  * Description:
  *   Render the font into the glyph memory using the foreground RGB color.
+ *   Whether that is the framebuffer, the font buffer or the glyph cache,
+ *   the only difference is the stride value.
  *
  ****************************************************************************/
 
 static inline void PDC_render_glyph(FAR struct pdc_fbstate_s *fbstate,
                                     FAR const struct nx_fontbitmap_s *fbm,
-                                    FAR uint8_t *fbstart, short fg)
+                                    FAR uint8_t *fbstart,
+                                    unsigned int stride, short fg)
 {
   pdc_color_t fgcolor = PDC_color(fbstate, fg);
-  unsigned int stride;
   int ret;
 
-  /* Are we rendering into the framebuffer or the font buffer.  The only
-   * difference here is the stride value.
-   */
-
-#if PDCURSES_BPP < 8
-  stride = fbstate->fstride;  /* Width of the font buffer in bytes */
-#else
-  stride = fbstate->stride;   /* Width of the framebuffer in bytes */
-#endif
-
-  /* Then render the glyph into the allocated memory
+  /* Render the glyph into the allocated memory
    *
    * REVISIT:  The case where visibility==1 is not yet handled.  In that
    * case, only the lower quarter of the glyph should be reversed.
@@ -489,11 +486,119 @@ static inline void  PDC_copy_glyph(FAR struct pdc_fbstate_s *fbstate,
 }
 #endif
 
+/****************************************************************************
+ * Name: PDC_draw_glyph
+ *
+ * Description:
+ *   Set the glyph memory to the background color and render the character
+ *   into it using the foreground color.
+ *
+ ****************************************************************************/
+
+static void PDC_draw_glyph(FAR struct pdc_fbstate_s *fbstate,
+                           FAR uint8_t *dest, unsigned int stride,
+                           chtype ch, short fg, short bg)
+{
+  FAR const struct nx_fontbitmap_s *fbm;
+#ifdef HAVE_BOLD_FONT
+  bool bold = ((ch & A_BOLD) != 0);
+#endif
+
+  /* Initialize the glyph to the (possibly reversed) background color */
+
+  PDC_set_bg(fbstate, dest, stride, bg);
+
+  /* Does the code map to a font? */
+
+#ifdef HAVE_BOLD_FONT
+  fbm = nxf_getbitmap(bold ? fbstate->hfont : fbstate->hbold,
+                      ch & A_CHARTEXT);
+#else
+  fbm = nxf_getbitmap(fbstate->hfont, ch & A_CHARTEXT);
+#endif
+
+  if (fbm != NULL)
+    {
+      /* Yes.. render the glyph */
+
+      PDC_render_glyph(fbstate, fbm, dest, stride, fg);
+    }
+}
+
+/****************************************************************************
+ * Name: PDC_cache_glyph
+ *
+ * Description:
+ *   Put the glyph of a character into dest, which is the font buffer for
+ *   BPP < 8 and the framebuffer otherwise.  The glyph is copied from the
+ *   glyph cache when it was rendered with the same colors before.
+ *   Otherwise it is rendered into the cache, replacing the entry it maps
+ *   to, and copied from there.
+ *
+ ****************************************************************************/
+
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+static void PDC_cache_glyph(FAR struct pdc_fbstate_s *fbstate,
+                            FAR uint8_t *dest, chtype ch, short fg,
+                            short bg)
+{
+  FAR uint8_t *glyph;
+  unsigned int index;
+  uint32_t key;
+#if PDCURSES_BPP >= 8
+  unsigned int width;
+  int row;
+#endif
+
+  /* Bold is the only attribute that changes the rendered glyph */
+
+  key = (uint32_t)(ch & A_CHARTEXT) |
+        (uint32_t)(fg & 15) << 16 |
+        (uint32_t)(bg & 15) << 20;
+#ifdef HAVE_BOLD_FONT
+  if ((ch & A_BOLD) != 0)
+    {
+      key |= (uint32_t)1 << 24;
+    }
+#endif
+
+  index = ((key * 2654435761u) >> 16) % CONFIG_PDCURSES_GLYPH_CACHE;
+  glyph = fbstate->glyphs + index * fbstate->gsize;
+
+#if PDCURSES_BPP < 8
+  if (fbstate->gkey[index] != key)
+    {
+      PDC_draw_glyph(fbstate, glyph, fbstate->fstride, ch, fg, bg);
+      fbstate->gkey[index] = key;
+    }
+
+  memcpy(dest, glyph, fbstate->gsize);
+#else
+  width = fbstate->fwidth * sizeof(pdc_color_t);
+
+  if (fbstate->gkey[index] != key)
+    {
+      PDC_draw_glyph(fbstate, glyph, width, ch, fg, bg);
+      fbstate->gkey[index] = key;
+    }
+
+  for (row = 0; row < fbstate->fheight; row++)
+    {
+      memcpy(dest, glyph, width);
+      dest  += fbstate->stride;
+      glyph += width;
+    }
+#endif
+}
+#endif
+
 /****************************************************************************
  * Name: PDC_update
  *
  * Description:
- *   Update the LCD display is necessary.
+ *   Add a run of characters to the area of the display that needs to be
+ *   updated.  The update itself is deferred to PDC_flush() so that all of
+ *   the changes of one refresh cost one FBIO_UPDATE.
  *
  ****************************************************************************/
 
@@ -501,22 +606,62 @@ static inline void  PDC_copy_glyph(FAR struct pdc_fbstate_s *fbstate,
 static void PDC_update(FAR struct pdc_fbstate_s *fbstate, int row, int col,
                        int nchars)
 {
-  struct fb_area_s area;
-  int ret;
+  FAR struct fb_area_s *area = &fbstate->damage;
+  fb_coord_t xend;
+  fb_coord_t yend;
+  fb_coord_t x;
+  fb_coord_t y;
 
   if (nchars > 0)
     {
       /* Setup the bounding rectangle */
 
-      area.x = PDC_pixel_x(fbstate, col);
-      area.y = PDC_pixel_y(fbstate, row);
-      area.w = nchars * fbstate->fwidth;
-      area.h = fbstate->fheight;
+      x    = PDC_pixel_x(fbstate, col);
+      y    = PDC_pixel_y(fbstate, row);
+      xend = x + nchars * fbstate->fwidth;
+      yend = y + fbstate->fheight;
+
+      /* Then merge it with the pending changes */
 
-      /* Then perform the update via IOCTL */
+      if (fbstate->dirty)
+        {
+          xend = MAX(xend, area->x + area->w);
+          yend = MAX(yend, area->y + area->h);
+          x    = MIN(x, area->x);
+          y    = MIN(y, area->y);
+        }
+
+      area->x        = x;
+      area->y        = y;
+      area->w        = xend - x;
+      area->h        = yend - y;
+      fbstate->dirty = true;
+    }
+}
+#else
+#  define PDC_update(f,r,c,n)
+#endif
+
+/****************************************************************************
+ * Name: PDC_flush
+ *
+ * Description:
+ *   Update the LCD display with all changes since the last update, if
+ *   necessary.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FB_UPDATE
+static void PDC_flush(FAR struct pdc_fbstate_s *fbstate)
+{
+  int ret;
+
+  if (fbstate->dirty)
+    {
+      fbstate->dirty = false;
 
       ret = ioctl(fbstate->fbfd, FBIO_UPDATE,
-                  (unsigned long)((uintptr_t)&area));
+                  (unsigned long)((uintptr_t)&fbstate->damage));
       if (ret < 0)
         {
           PDC_LOG(("ERROR:  ioctl(FBIO_UPDATE) failed: %d\n", errno));
@@ -524,7 +669,7 @@ static void PDC_update(FAR struct pdc_fbstate_s *fbstate, int row, int col,
     }
 }
 #else
-#  define PDC_update(f,r,c,n)
+#  define PDC_flush(f)
 #endif
 
 /****************************************************************************
@@ -539,13 +684,9 @@ static void PDC_update(FAR struct pdc_fbstate_s *fbstate, int row, int col,
 static void PDC_putc(FAR struct pdc_fbstate_s *fbstate, int row, int col,
                      chtype ch)
 {
-  FAR const struct nx_fontbitmap_s *fbm;
   FAR uint8_t *dest;
   short fg;
   short bg;
-#ifdef HAVE_BOLD_FONT
-  bool bold = ((ch & A_BOLD) != 0);
-#endif
 #ifdef CONFIG_PDCURSES_MULTITHREAD
   FAR struct pdc_context_s *ctx = PDC_ctx();
 #endif
@@ -601,26 +742,16 @@ static void PDC_putc(FAR struct pdc_fbstate_s *fbstate, int row, int col,
                         PDC_fbmem_x(fbstate, col);
 #endif
 
-  /* Initialize the glyph to the (possibly reversed) background color */
-
-  PDC_set_bg(fbstate, dest, bg);
+  /* Render the glyph in the (possibly reversed) colors */
 
-  /* Does the code map to a font? */
-
-#ifdef HAVE_BOLD_FONT
-  fbm = nxf_getbitmap(bold ? fbstate->hfont : fbstate->hbold,
-                      ch & A_CHARTEXT);
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+  PDC_cache_glyph(fbstate, dest, ch, fg, bg);
+#elif PDCURSES_BPP < 8
+  PDC_draw_glyph(fbstate, dest, fbstate->fstride, ch, fg, bg);
 #else
-  fbm = nxf_getbitmap(fbstate->hfont, ch & A_CHARTEXT);
+  PDC_draw_glyph(fbstate, dest, fbstate->stride, ch, fg, bg);
 #endif
 
-  if (fbm != NULL)
-    {
-      /* Yes.. render the glyph */
-
-      PDC_render_glyph(fbstate, fbm, dest, fg);
-    }
-
   /* Apply more attributes */
 
   if ((ch & (A_UNDERLINE | A_LEFTLINE | A_RIGHTLINE)) != 0)
@@ -930,6 +1061,8 @@ void PDC_gotoyx(int row, int col)
       PDC_putc(fbstate, row, col, ch);
       PDC_update(fbstate, row, col, 1);
     }
+
+  PDC_flush(fbstate);
 }
 
 /****************************************************************************
@@ -990,6 +1123,37 @@ void PDC_transform_line(int lineno, int x, int len, const chtype *srcp)
   PDC_update(fbstate, lineno, x, nextx - x);
 }
 
+/****************************************************************************
+ * Name: PDC_doupdate
+ *
+ * Description:
+ *   Called at the end of doupdate().  The display is updated once with the
+ *   merged area of all lines transformed by this refresh.
+ *
+ ****************************************************************************/
+
+void PDC_doupdate(void)
+{
+#ifdef CONFIG_FB_UPDATE
+#ifdef CONFIG_PDCURSES_MULTITHREAD
+  FAR struct pdc_context_s *ctx = PDC_ctx();
+#endif
+  FAR struct pdc_fbscreen_s *fbscreen = (FAR struct pdc_fbscreen_s *)SP;
+
+  PDC_LOG(("PDC_doupdate() - called\n"));
+
+#ifdef CONFIG_SYSTEM_TERMCURSES
+  if (!graphic_screen)
+    {
+      return;
+    }
+#endif
+
+  DEBUGASSERT(fbscreen != NULL);
+  PDC_flush(&fbscreen->fbstate);
+#endif
+}
+
 /****************************************************************************
  * Name: PDC_clear_screen
  *
@@ -1007,11 +1171,6 @@ void PDC_clear_screen(FAR struct pdc_fbstate_s *fbstate)
   int row;
   int col;
 
-#ifdef CONFIG_FB_UPDATE
-  struct fb_area_s area;
-  int ret;
-#endif
-
   /* Get the background color and display width */
 
   bgcolor = PDCURSES_INIT_COLOR;      /* Background color for one pixel */
@@ -1054,21 +1213,35 @@ void PDC_clear_screen(FAR struct pdc_fbstate_s *fbstate)
     }
 
 #ifdef CONFIG_FB_UPDATE
-  /* Update the entire display */
+  /* Update the entire display, which includes any pending changes */
 
-  /* Setup the bounding rectangle */
+  fbstate->damage.x = 0;
+  fbstate->damage.y = 0;
+  fbstate->damage.w = fbstate->xres;
+  fbstate->damage.h = fbstate->yres;
+  fbstate->dirty    = true;
 
-  area.x = 0;
-  area.y = 0;
-  area.w = fbstate->xres;
-  area.h = fbstate->yres;
+  PDC_flush(fbstate);
+#endif
+}
 
-  /* Then perform the update via IOCTL */
+/****************************************************************************
+ * Name: PDC_glyph_flush
+ *
+ * Description:
+ *   Discard all cached glyphs.  Called when a color they were rendered
+ *   with changes.
+ *
+ ****************************************************************************/
 
-  ret = ioctl(fbstate->fbfd, FBIO_UPDATE, (unsigned long)((uintptr_t)&area));
-  if (ret < 0)
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+void PDC_glyph_flush(FAR struct pdc_fbstate_s *fbstate)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_PDCURSES_GLYPH_CACHE; i++)
     {
-      PDC_LOG(("ERROR:  ioctl(FBIO_UPDATE) failed: %d\n", errno));
+      fbstate->gkey[i] = PDCURSES_GLYPH_NONE;
     }
-#endif
 }
+#endif
@@ -181,6 +181,14 @@
 #define PDCURSES_ALIGN_UP(n)   (((n) + PDCURSES_BPP_MASK) >> 3)
 #define PDCURSES_ALIGN_DOWN(n) (((n) & ~PDCURSES_BPP_MASK) >> 3)
 
+/* Glyph cache.  A key never generated by PDC_putc() marks an unused entry */
+
+#ifndef CONFIG_PDCURSES_GLYPH_CACHE
+#  define CONFIG_PDCURSES_GLYPH_CACHE 0
+#endif
+
+#define PDCURSES_GLYPH_NONE    UINT32_MAX
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -267,6 +275,23 @@ struct pdc_fbstate_s
 #else
   struct pdc_rgbcolor_s rgbcolor[16];
 #endif
+
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+  /* Rendered glyphs, in font buffer format for BPP < 8, else as rows of
+   * framebuffer pixels.
+   */
+
+  FAR uint32_t *gkey;      /* Character and colors of each cached glyph */
+  FAR uint8_t *glyphs;     /* Glyph bitmaps, gsize bytes each */
+  uint16_t gsize;          /* Size of one glyph bitmap (bytes) */
+#endif
+
+#ifdef CONFIG_FB_UPDATE
+  /* Framebuffer area changed since the last FBIO_UPDATE */
+
+  struct fb_area_s damage; /* Bounding rectangle of the changes */
+  bool dirty;              /* True: damage is valid */
+#endif
 };
 
 /* This structure contains the framebuffer device structure and is a cast
@@ -351,6 +376,19 @@ EXTERN struct pdc_fbstate_s g_pdc_fbstate;
 
 void PDC_clear_screen(FAR struct pdc_fbstate_s *fbstate);
 
+/****************************************************************************
+ * Name: PDC_glyph_flush
+ *
+ * Description:
+ *   Discard all cached glyphs.  Called when a color they were rendered
+ *   with changes.
+ *
+ ****************************************************************************/
+
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+void PDC_glyph_flush(FAR struct pdc_fbstate_s *fbstate);
+#endif
+
 /****************************************************************************
  * Name: PDC_input_open
  *
@@ -389,6 +389,13 @@ void PDC_scr_free(void)
   close(fbstate->fbfd);
 #ifdef CONFIG_PDCURSES_HAVE_INPUT
   PDC_input_close(fbstate);
+#endif
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+  free(fbstate->glyphs);
+  free(fbstate->gkey);
+#endif
+#if PDCURSES_BPP < 8
+  free(fbstate->fbuffer);
 #endif
   free(fbscreen);
   SP = NULL;
@@ -642,6 +649,32 @@ int PDC_scr_open(int argc, char **argv)
     }
 #endif
 
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+  /* Allocate the glyph cache.  Each entry holds one glyph as PDC_putc()
+   * renders it:  In the font buffer format for BPP < 8, otherwise as rows
+   * of framebuffer pixels.
+   */
+
+#if PDCURSES_BPP < 8
+  fbstate->gsize  = fbstate->fstride * fbstate->fheight;
+#else
+  fbstate->gsize  = fbstate->fwidth * fbstate->fheight *
+                    sizeof(pdc_color_t);
+#endif
+  fbstate->gkey   = (FAR uint32_t *)
+    malloc(CONFIG_PDCURSES_GLYPH_CACHE * sizeof(uint32_t));
+  fbstate->glyphs = (FAR uint8_t *)
+    malloc(CONFIG_PDCURSES_GLYPH_CACHE * fbstate->gsize);
+
+  if (fbstate->gkey == NULL || fbstate->glyphs == NULL)
+    {
+      PDC_LOG(("ERROR: Failed to allocate glyph cache: %d\n", errno));
+      goto errout_with_glyphs;
+    }
+
+  PDC_glyph_flush(fbstate);
+#endif
+
   /* Calculate the drawable region */
 
   SP->lines        = fbstate->yres / fbstate->fheight;
@@ -660,14 +693,18 @@ int PDC_scr_open(int argc, char **argv)
   ret = PDC_input_open(fbstate);
   if (ret == ERR)
     {
-      goto errout_with_fbuffer;
+      goto errout_with_glyphs;
     }
 #endif
 
   return OK;
 
-#ifdef CONFIG_PDCURSES_HAVE_INPUT
-errout_with_fbuffer:
+#if defined(CONFIG_PDCURSES_HAVE_INPUT) || CONFIG_PDCURSES_GLYPH_CACHE > 0
+errout_with_glyphs:
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+  free(fbstate->glyphs);
+  free(fbstate->gkey);
+#endif
 #if PDCURSES_BPP < 8
   free(fbstate->fbuffer);
 #endif
@@ -954,5 +991,11 @@ int PDC_init_color(short color, short red, short green, short blue)
   fbstate->rgbcolor[color].blue  = DIVROUND(blue * 255, 1000);
 #endif
 
+#if CONFIG_PDCURSES_GLYPH_CACHE > 0
+  /* Glyphs rendered in the old color are no longer valid */
+
+  PDC_glyph_flush(fbstate);
+#endif
+
   return OK;
 }
@@ -272,6 +272,8 @@ int doupdate(void)
       PDC_gotoyx(curscr->_cury, curscr->_curx);
     }
 
+  PDC_doupdate();
+
   SP->cursrow = curscr->_cury;
   SP->curscol = curscr->_curx;
 
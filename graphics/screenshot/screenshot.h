@@ -0,0 +1,118 @@
+/****************************************************************************
+ * apps/graphics/screenshot/screenshot.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_GRAPHICS_SCREENSHOT_SCREENSHOT_H
+#define __APPS_GRAPHICS_SCREENSHOT_SCREENSHOT_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+
+#ifdef CONFIG_SCREENSHOT_STREAM
+#  include <nuttx/nx/nx.h>
+#endif
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/* Screen recording file format.  All values are little endian.
+ *
+ * The file starts with a header:
+ *
+ *   uint8_t  magic[4]   "NXSR"
+ *   uint8_t  version    SCREENSHOT_STREAM_VERSION
+ *   uint8_t  pixfmt     SCREENSHOT_PIXFMT_*
+ *   uint8_t  tilesize   Tile width and height (pixels)
+ *   uint8_t  reserved
+ *   uint16_t width      Screen width (pixels)
+ *   uint16_t height     Screen height (rows)
+ *
+ * A sequence of frames follows, each one:
+ *
+ *   uint32_t time       Milliseconds since the start of the recording
+ *   Tiles that changed since the previous frame, each one:
+ *     uint16_t index    Tile number, row by row from the top left tile
+ *     uint16_t length   Length of the data (bytes)
+ *     uint8_t  data[]   The tile, compressed
+ *   uint16_t SCREENSHOT_STREAM_ENDFRAME
+ *
+ * Tiles at the right and bottom edges are cut to the screen size.  The
+ * tile data is the XOR of the new pixels with the previous ones, which
+ * are all zero before the first frame, compressed with a PackBits
+ * variant that counts pixels instead of bytes:
+ *
+ *   0-127:    The next n + 1 pixels follow literally
+ *   128-255:  The next pixel is repeated n - 126 times (2-129)
+ *
+ * Frames without any changed tile are not recorded.
+ */
+
+#define SCREENSHOT_STREAM_MAGIC     "NXSR"
+#define SCREENSHOT_STREAM_VERSION   1
+#define SCREENSHOT_STREAM_HDRSIZE   12
+#define SCREENSHOT_STREAM_ENDFRAME  0xffff
+
+/* Pixel formats of the recording */
+
+#define SCREENSHOT_PIXFMT_Y8        0  /* 8-bit greyscale */
+#define SCREENSHOT_PIXFMT_RGB565    1  /* 16-bit RGB 5:6:5 */
+#define SCREENSHOT_PIXFMT_RGB24     2  /* 24-bit B, G, R bytes */
+#define SCREENSHOT_PIXFMT_RGB32     3  /* 32-bit B, G, R, X bytes */
+
+/* PackBits control bytes */
+
+#define SCREENSHOT_LITERAL_MAX      128  /* Pixels of one literal run */
+#define SCREENSHOT_REPEAT_MIN       2    /* Pixels of one repeat run */
+#define SCREENSHOT_REPEAT_MAX       129
+#define SCREENSHOT_REPEAT_BIAS      126  /* Control byte = count + bias */
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_SCREENSHOT_STREAM
+
+/****************************************************************************
+ * Name: screenshot_stream
+ *
+ * Description:
+ *   Record the screen read through window into a screen recording file.
+ *   fps frames are taken per second, each one spending about budget
+ *   milliseconds at most; the bands of tiles not compared within that
+ *   time are compared in the next frame.  Recording ends after nframes
+ *   frames, or on SIGINT if nframes is zero.
+ *
+ *   Returns OK on success, -E2BIG if the screen has more tiles than the
+ *   file format can number, or ERROR on other failures.
+ *
+ ****************************************************************************/
+
+int screenshot_stream(NXWINDOW window, FAR const struct nxgl_size_s *size,
+                      FAR const char *filename, int fps, int nframes,
+                      int budget);
+
+#endif
+
+#endif /* __APPS_GRAPHICS_SCREENSHOT_SCREENSHOT_H */
@@ -33,12 +33,15 @@
 #include <stdbool.h>
 #include <string.h>
 #include <semaphore.h>
+#include <unistd.h>
 #include <errno.h>
 
 #include "graphics/tiff.h"
 
 #include <nuttx/nx/nx.h>
 
+#include "screenshot.h"
+
 /****************************************************************************
  * Pre-Processor Definitions
  ****************************************************************************/
@@ -55,6 +58,28 @@
 #  define CONFIG_SCREENSHOT_FORMAT FB_FMT_RGB16_565
 #endif
 
+#ifndef CONFIG_SCREENSHOT_STREAM_FPS
+#  define CONFIG_SCREENSHOT_STREAM_FPS 4
+#endif
+
+#ifndef CONFIG_SCREENSHOT_STREAM_BUDGET
+#  define CONFIG_SCREENSHOT_STREAM_BUDGET 50
+#endif
+
+/* Screenshots are compressed as well as the TIFF library supports */
+
+#if defined(CONFIG_TIFF_LZW)
+#  define SCREENSHOT_COMPRESS TAG_COMP_LZW
+#elif defined(CONFIG_TIFF_PACKBITS)
+#  define SCREENSHOT_COMPRESS TAG_COMP_PACKBITS
+#else
+#  define SCREENSHOT_COMPRESS TAG_COMP_NONE
+#endif
+
+/* Size of the buffer for writes to the TIFF file */
+
+#define SCREENSHOT_IOSIZE 1024
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -71,122 +96,151 @@
  * Private Functions
  ****************************************************************************/
 
-static void replace_extension(FAR const char *filename,
-                              FAR const char *newext,
-                              FAR char *dest, size_t size)
-{
-  FAR char *p = strrchr(filename, '.');
-  int len = strlen(filename);
-
-  if (p != NULL)
-    {
-      len = p - filename;
-    }
-
-  if (len > size)
-    {
-      len = size - strlen(newext);
-    }
-
-  strlcpy(dest, filename, size);
-  strlcpy(dest + len, newext, size - len);
-}
-
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
-
 /****************************************************************************
- * Name: save_screenshot
+ * Name: screenshot_connect
  *
  * Description:
- *   Takes a screenshot and saves it to a tif file.
+ *   Connect to the NX server and open the invisible window used to read
+ *   the screen.
  *
  ****************************************************************************/
 
-int save_screenshot(FAR const char *filename)
+static int screenshot_connect(FAR NXHANDLE *server, FAR NXWINDOW *window,
+                              FAR const struct nxgl_size_s *size)
 {
-  struct tiff_info_s info;
   struct nx_callback_s cb =
   {
   };
 
-  struct nxgl_size_s size =
-  {
-    CONFIG_SCREENSHOT_WIDTH, CONFIG_SCREENSHOT_HEIGHT
-  };
-
 #ifdef CONFIG_VNCSERVER
   struct boardioc_vncstart_s vnc;
-#endif
-  FAR uint8_t *strip;
-  NXHANDLE server;
-  NXWINDOW window;
-  char tempf1[64];
-  char tempf2[64];
-  int row;
   int ret;
-
-  replace_extension(filename, ".tm1", tempf1, sizeof(tempf1));
-  replace_extension(filename, ".tm2", tempf2, sizeof(tempf2));
+#endif
 
   /* Connect to NX server */
 
-  server = nx_connect();
-  if (!server)
+  *server = nx_connect();
+  if (!*server)
     {
       perror("nx_connect");
-      return 1;
+      return ERROR;
     }
 
 #ifdef CONFIG_VNCSERVER
   /* Setup the VNC server to support keyboard/mouse inputs */
 
   vnc.display = 0;
-  vnc.handle  = server;
+  vnc.handle  = *server;
 
   ret = boardctl(BOARDIOC_VNC_START, (uintptr_t)&vnc);
   if (ret < 0)
     {
       printf("boardctl(BOARDIOC_VNC_START) failed: %d\n", ret);
-      nx_disconnect(server);
-      return 1;
+      nx_disconnect(*server);
+      return ERROR;
     }
 #endif
 
   /* Wait for "connected" event */
 
-  if (nx_eventhandler(server) < 0)
+  if (nx_eventhandler(*server) < 0)
     {
       perror("nx_eventhandler");
-      nx_disconnect(server);
-      return 1;
+      nx_disconnect(*server);
+      return ERROR;
     }
 
   /* Open invisible dummy window for communication */
 
-  window = nx_openwindow(server, 0, &cb, NULL);
-  if (!window)
+  *window = nx_openwindow(*server, 0, &cb, NULL);
+  if (!*window)
     {
       perror("nx_openwindow");
-      nx_disconnect(server);
+      nx_disconnect(*server);
+      return ERROR;
+    }
+
+  nx_setsize(*window, size);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: record_screen
+ *
+ * Description:
+ *   Records the screen to a screen recording file.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCREENSHOT_STREAM
+static int record_screen(FAR const char *filename, int fps, int nframes,
+                         int budget)
+{
+  struct nxgl_size_s size =
+  {
+    CONFIG_SCREENSHOT_WIDTH, CONFIG_SCREENSHOT_HEIGHT
+  };
+
+  NXHANDLE server;
+  NXWINDOW window;
+  int ret;
+
+  if (screenshot_connect(&server, &window, &size) < 0)
+    {
       return 1;
     }
 
-  nx_setsize(window, &size);
+  ret = screenshot_stream(window, &size, filename, fps, nframes, budget);
+
+  nx_closewindow(window);
+  nx_disconnect(server);
+
+  return ret < 0 ? 1 : 0;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: save_screenshot
+ *
+ * Description:
+ *   Takes a screenshot and saves it to a tif file.
+ *
+ ****************************************************************************/
+
+int save_screenshot(FAR const char *filename)
+{
+  struct tiff_info_s info;
+  struct nxgl_size_s size =
+  {
+    CONFIG_SCREENSHOT_WIDTH, CONFIG_SCREENSHOT_HEIGHT
+  };
+
+  FAR uint8_t *strip;
+  NXHANDLE server;
+  NXWINDOW window;
+  int row;
+  int ret;
+
+  if (screenshot_connect(&server, &window, &size) < 0)
+    {
+      return 1;
+    }
 
   /* Configure the TIFF structure */
 
   memset(&info, 0, sizeof(struct tiff_info_s));
   info.outfile   = filename;
-  info.tmpfile1  = tempf1;
-  info.tmpfile2  = tempf2;
   info.colorfmt  = CONFIG_SCREENSHOT_FORMAT;
+  info.compress  = SCREENSHOT_COMPRESS;
   info.rps       = 1;
   info.imgwidth  = size.w;
   info.imgheight = size.h;
-  info.iobuffer  = (uint8_t *)malloc(300);
-  info.iosize    = 300;
+  info.iobuffer  = (uint8_t *)malloc(SCREENSHOT_IOSIZE);
+  info.iosize    = SCREENSHOT_IOSIZE;
 
   /* Initialize the TIFF library */
 
@@ -227,10 +281,13 @@ int save_screenshot(FAR const char *filename)
 
   /* Then finalize the TIFF file */
 
-  ret = tiff_finalize(&info);
-  if (ret < 0)
+  if (ret == OK)
     {
-      printf("tiff_finalize() failed: %d\n", ret);
+      ret = tiff_finalize(&info);
+      if (ret < 0)
+        {
+          printf("tiff_finalize() failed: %d\n", ret);
+        }
     }
 
   free(info.iobuffer);
@@ -250,6 +307,62 @@ int save_screenshot(FAR const char *filename)
 
 int main(int argc, FAR char *argv[])
 {
+#ifdef CONFIG_SCREENSHOT_STREAM
+  FAR const char *recording = NULL;
+  int budget = CONFIG_SCREENSHOT_STREAM_BUDGET;
+  int fps = CONFIG_SCREENSHOT_STREAM_FPS;
+  int nframes = 0;
+  int option;
+
+  while ((option = getopt(argc, argv, "r:f:n:b:")) != ERROR)
+    {
+      switch (option)
+        {
+          case 'r':
+            recording = optarg;
+            break;
+
+          case 'f':
+            fps = atoi(optarg);
+            break;
+
+          case 'n':
+            nframes = atoi(optarg);
+            break;
+
+          case 'b':
+            budget = atoi(optarg);
+            break;
+
+          default:
+            goto usage;
+        }
+    }
+
+  if (recording != NULL)
+    {
+      if (optind != argc || fps < 1 || fps > 1000 || nframes < 0 ||
+          budget < 1)
+        {
+          goto usage;
+        }
+
+      return record_screen(recording, fps, nframes, budget);
+    }
+
+  if (optind != argc - 1)
+    {
+      goto usage;
+    }
+
+  return save_screenshot(argv[optind]);
+
+usage:
+  fprintf(stderr, "Usage: screenshot file.tif\n"
+                  "       screenshot -r file.nxs [-f fps] [-n frames] "
+                  "[-b budget_ms]\n");
+  return 1;
+#else
   if (argc != 2)
     {
       fprintf(stderr, "Usage: screenshot file.tif\n");
@@ -257,4 +370,5 @@ int main(int argc, FAR char *argv[])
     }
 
   return save_screenshot(argv[1]);
+#endif
 }
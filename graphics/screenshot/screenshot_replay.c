@@ -0,0 +1,372 @@
+/****************************************************************************
+ * apps/graphics/screenshot/screenshot_replay.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Host tool that replays a recording of "screenshot -r" into a sequence of
+ * PPM images:
+ *
+ *   replay file.nxs prefix [fps]
+ *
+ * writes prefix00000.ppm, prefix00001.ppm, ...  Without fps there is one
+ * image per recorded frame; with fps the images are taken at that constant
+ * rate from the frame times, for example for
+ *
+ *   ffmpeg -framerate 10 -i prefix%05d.ppm screen.mp4
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "screenshot.h"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct replay_s
+{
+  FILE *file;
+  int pixsize;              /* Bytes per pixel */
+  int pixfmt;               /* SCREENSHOT_PIXFMT_* */
+  int tilesize;             /* Tile width and height */
+  int width;                /* Screen width */
+  int height;               /* Screen height */
+  int tcols;                /* Tiles per row of tiles */
+  int ntiles;               /* Number of tiles */
+  uint8_t *screen;          /* The screen as replayed so far */
+  uint8_t *tile;            /* One decompressed tile */
+  uint8_t *rgb;             /* One PPM row */
+  uint8_t *data;            /* Compressed tile data */
+  const char *prefix;       /* Output file name prefix */
+  int nimages;              /* Images written */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int read16(FILE *file, unsigned int *value)
+{
+  uint8_t buf[2];
+
+  if (fread(buf, 1, 2, file) != 2)
+    {
+      return -1;
+    }
+
+  *value = buf[0] | buf[1] << 8;
+  return 0;
+}
+
+/* Decompress one tile and apply it to the screen */
+
+static int replay_tile(struct replay_s *rp, unsigned int index,
+                       unsigned int len)
+{
+  int npixels;
+  int rowsize;
+  int rows;
+  int x0;
+  int y0;
+  int row;
+  int i;
+  uint8_t *dest = rp->tile;
+  uint8_t *src = rp->data;
+  uint8_t *end = rp->data + len;
+
+  if (index >= (unsigned int)rp->ntiles ||
+      fread(rp->data, 1, len, rp->file) != len)
+    {
+      return -1;
+    }
+
+  x0      = index % rp->tcols * rp->tilesize;
+  y0      = index / rp->tcols * rp->tilesize;
+  rows    = rp->height - y0 < rp->tilesize ? rp->height - y0 : rp->tilesize;
+  rowsize = (rp->width - x0 < rp->tilesize ? rp->width - x0 : rp->tilesize) *
+            rp->pixsize;
+  npixels = rows * rowsize / rp->pixsize;
+
+  while (src < end)
+    {
+      int ctrl = *src++;
+      int count;
+
+      if (ctrl <= SCREENSHOT_LITERAL_MAX - 1)
+        {
+          count = ctrl + 1;
+          if (end - src < count * rp->pixsize ||
+              dest + count * rp->pixsize > rp->tile + npixels * rp->pixsize)
+            {
+              return -1;
+            }
+
+          memcpy(dest, src, count * rp->pixsize);
+          src  += count * rp->pixsize;
+          dest += count * rp->pixsize;
+        }
+      else
+        {
+          count = ctrl - SCREENSHOT_REPEAT_BIAS;
+          if (end - src < rp->pixsize ||
+              dest + count * rp->pixsize > rp->tile + npixels * rp->pixsize)
+            {
+              return -1;
+            }
+
+          for (i = 0; i < count; i++)
+            {
+              memcpy(dest, src, rp->pixsize);
+              dest += rp->pixsize;
+            }
+
+          src += rp->pixsize;
+        }
+    }
+
+  if (dest != rp->tile + npixels * rp->pixsize)
+    {
+      return -1;
+    }
+
+  /* The tile holds the changes to the pixels */
+
+  for (row = 0, src = rp->tile; row < rows; row++)
+    {
+      dest = rp->screen + ((y0 + row) * rp->width + x0) * rp->pixsize;
+      for (i = 0; i < rowsize; i++)
+        {
+          *dest++ ^= *src++;
+        }
+    }
+
+  return 0;
+}
+
+/* Write the screen as the next PPM image */
+
+static int replay_image(struct replay_s *rp)
+{
+  char name[256];
+  const uint8_t *src = rp->screen;
+  uint8_t *dest;
+  FILE *out;
+  int x;
+  int y;
+
+  snprintf(name, sizeof(name), "%s%05d.ppm", rp->prefix, rp->nimages);
+  out = fopen(name, "wb");
+  if (out == NULL)
+    {
+      perror(name);
+      return -1;
+    }
+
+  fprintf(out, "P6\n%d %d\n255\n", rp->width, rp->height);
+
+  for (y = 0; y < rp->height; y++)
+    {
+      for (x = 0, dest = rp->rgb; x < rp->width; x++, src += rp->pixsize)
+        {
+          unsigned int rgb565;
+
+          switch (rp->pixfmt)
+            {
+              case SCREENSHOT_PIXFMT_Y8:
+                *dest++ = src[0];
+                *dest++ = src[0];
+                *dest++ = src[0];
+                break;
+
+              case SCREENSHOT_PIXFMT_RGB565:
+                rgb565  = src[0] | src[1] << 8;
+                *dest++ = (rgb565 >> 11) * 255 / 31;
+                *dest++ = ((rgb565 >> 5) & 0x3f) * 255 / 63;
+                *dest++ = (rgb565 & 0x1f) * 255 / 31;
+                break;
+
+              default:
+                *dest++ = src[2];
+                *dest++ = src[1];
+                *dest++ = src[0];
+                break;
+            }
+        }
+
+      fwrite(rp->rgb, 3, rp->width, out);
+    }
+
+  rp->nimages++;
+  return fclose(out) == 0 ? 0 : -1;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+  struct replay_s rp;
+  uint8_t hdr[SCREENSHOT_STREAM_HDRSIZE];
+  unsigned int index;
+  unsigned int len;
+  unsigned int lo;
+  unsigned int hi;
+  unsigned long long usec;
+  unsigned long long next = 0;
+  int nframes = 0;
+  int fps = 0;
+  int ret = 1;
+
+  if (argc != 3 && argc != 4)
+    {
+      fprintf(stderr, "Usage: %s file.nxs prefix [fps]\n", argv[0]);
+      return 1;
+    }
+
+  memset(&rp, 0, sizeof(rp));
+  rp.prefix = argv[2];
+  if (argc == 4)
+    {
+      fps = atoi(argv[3]);
+      if (fps < 1 || fps > 1000)
+        {
+          fprintf(stderr, "fps must be 1 to 1000\n");
+          return 1;
+        }
+    }
+
+  rp.file = fopen(argv[1], "rb");
+  if (rp.file == NULL)
+    {
+      perror(argv[1]);
+      return 1;
+    }
+
+  if (fread(hdr, 1, sizeof(hdr), rp.file) != sizeof(hdr) ||
+      memcmp(hdr, SCREENSHOT_STREAM_MAGIC, 4) != 0 ||
+      hdr[4] != SCREENSHOT_STREAM_VERSION ||
+      hdr[5] > SCREENSHOT_PIXFMT_RGB32 || hdr[6] == 0)
+    {
+      fprintf(stderr, "%s: not a screen recording\n", argv[1]);
+      goto out;
+    }
+
+  rp.pixfmt   = hdr[5];
+  rp.pixsize  = rp.pixfmt + 1;   /* Y8, RGB565, RGB24, RGB32 */
+  rp.tilesize = hdr[6];
+  rp.width    = hdr[8] | hdr[9] << 8;
+  rp.height   = hdr[10] | hdr[11] << 8;
+  rp.tcols    = (rp.width + rp.tilesize - 1) / rp.tilesize;
+  rp.ntiles   = rp.tcols * ((rp.height + rp.tilesize - 1) / rp.tilesize);
+
+  rp.screen = calloc((size_t)rp.width * rp.height, rp.pixsize);
+  rp.tile   = malloc((size_t)rp.tilesize * rp.tilesize * rp.pixsize);
+  rp.rgb    = malloc((size_t)rp.width * 3 + 1);
+  rp.data   = malloc(0x10000);
+  if (!rp.screen || !rp.tile || !rp.rgb || !rp.data)
+    {
+      fprintf(stderr, "Out of memory\n");
+      goto out;
+    }
+
+  /* The frame time is read before the screen is updated with the frame,
+   * so that constant rate images before it show the previous frame.  The
+   * image times are kept in microseconds so that rates which do not
+   * divide a second do not drift.
+   */
+
+  while (read16(rp.file, &lo) == 0)
+    {
+      if (read16(rp.file, &hi) < 0)
+        {
+          goto truncated;
+        }
+
+      usec = (lo | (unsigned long long)hi << 16) * 1000;
+
+      if (fps > 0)
+        {
+          for (; nframes > 0 && next < usec; next += 1000000 / fps)
+            {
+              if (replay_image(&rp) < 0)
+                {
+                  goto out;
+                }
+            }
+        }
+
+      for (; ; )
+        {
+          if (read16(rp.file, &index) < 0)
+            {
+              goto truncated;
+            }
+
+          if (index == SCREENSHOT_STREAM_ENDFRAME)
+            {
+              break;
+            }
+
+          if (read16(rp.file, &len) < 0 || replay_tile(&rp, index, len) < 0)
+            {
+              fprintf(stderr, "Frame %d: bad tile %u\n", nframes, index);
+              goto out;
+            }
+        }
+
+      nframes++;
+      if (fps == 0 && replay_image(&rp) < 0)
+        {
+          goto out;
+        }
+    }
+
+  if (fps > 0 && nframes > 0 && replay_image(&rp) < 0)
+    {
+      goto out;
+    }
+
+  printf("%d frames, %d images\n", nframes, rp.nimages);
+  ret = 0;
+  goto out;
+
+truncated:
+  fprintf(stderr, "Recording ends within frame %d\n", nframes);
+  if (nframes > 0)
+    {
+      replay_image(&rp);
+    }
+
+out:
+  free(rp.data);
+  free(rp.rgb);
+  free(rp.tile);
+  free(rp.screen);
+  fclose(rp.file);
+  return ret;
+}
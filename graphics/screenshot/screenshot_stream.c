@@ -0,0 +1,477 @@
+/****************************************************************************
+ * apps/graphics/screenshot/screenshot_stream.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <nuttx/nx/nx.h>
+#include <nuttx/video/fb.h>
+
+#include "screenshot.h"
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_SCREENSHOT_STREAM_TILESIZE
+#  define CONFIG_SCREENSHOT_STREAM_TILESIZE 16
+#endif
+
+/* Size of one pixel as returned by nx_getrectangle() */
+
+#if CONFIG_SCREENSHOT_FORMAT == FB_FMT_Y8
+#  define SCREENSHOT_PIXSIZE  1
+#  define SCREENSHOT_PIXFMT   SCREENSHOT_PIXFMT_Y8
+#elif CONFIG_SCREENSHOT_FORMAT == FB_FMT_RGB16_565
+#  define SCREENSHOT_PIXSIZE  2
+#  define SCREENSHOT_PIXFMT   SCREENSHOT_PIXFMT_RGB565
+#elif CONFIG_SCREENSHOT_FORMAT == FB_FMT_RGB24
+#  define SCREENSHOT_PIXSIZE  3
+#  define SCREENSHOT_PIXFMT   SCREENSHOT_PIXFMT_RGB24
+#elif CONFIG_SCREENSHOT_FORMAT == FB_FMT_RGB32
+#  define SCREENSHOT_PIXSIZE  4
+#  define SCREENSHOT_PIXFMT   SCREENSHOT_PIXFMT_RGB32
+#else
+#  error Streaming capture needs a Y8, RGB16_565, RGB24 or RGB32 format
+#endif
+
+#define SCREENSHOT_TILESIZE   CONFIG_SCREENSHOT_STREAM_TILESIZE
+#define SCREENSHOT_TILEBYTES  (SCREENSHOT_TILESIZE * SCREENSHOT_TILESIZE * \
+                               SCREENSHOT_PIXSIZE)
+
+/* Worst case size of a compressed tile, with a control byte for every
+ * pixel
+ */
+
+#define SCREENSHOT_PACKBYTES  (SCREENSHOT_TILEBYTES + \
+                               SCREENSHOT_TILESIZE * SCREENSHOT_TILESIZE)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct screenshot_stream_s
+{
+  NXWINDOW window;          /* Window used to read the screen */
+  FAR FILE *file;           /* The recording */
+  nxgl_coord_t width;       /* Screen width (pixels) */
+  nxgl_coord_t height;      /* Screen height (rows) */
+  int tcols;                /* Tiles per band */
+  int nbands;               /* Bands of tiles */
+  int nextband;             /* Band to compare first in the next frame */
+  size_t stride;            /* Length of one screen row (bytes) */
+  FAR uint8_t *prev;        /* Screen content as recorded so far */
+  FAR uint8_t *band;        /* Screen content of one band */
+  uint8_t delta[SCREENSHOT_TILEBYTES];
+  uint8_t packed[SCREENSHOT_PACKBYTES];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static volatile bool g_screenshot_stop;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void screenshot_sigint(int signo)
+{
+  g_screenshot_stop = true;
+}
+
+static uint32_t screenshot_msec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void screenshot_putle16(FAR uint8_t *dest, uint16_t value)
+{
+  dest[0] = value & 0xff;
+  dest[1] = value >> 8;
+}
+
+static int screenshot_write16(FAR struct screenshot_stream_s *st,
+                              uint16_t value)
+{
+  uint8_t buf[2];
+
+  screenshot_putle16(buf, value);
+  return fwrite(buf, 1, 2, st->file) == 2 ? OK : ERROR;
+}
+
+static bool screenshot_samepix(FAR const uint8_t *src, size_t i, size_t j)
+{
+  return memcmp(src + i * SCREENSHOT_PIXSIZE, src + j * SCREENSHOT_PIXSIZE,
+                SCREENSHOT_PIXSIZE) == 0;
+}
+
+/****************************************************************************
+ * Name: screenshot_pack
+ *
+ * Description:
+ *   Compress npixels pixels of src into dest.  Returns the length of the
+ *   compressed data.
+ *
+ ****************************************************************************/
+
+static size_t screenshot_pack(FAR const uint8_t *src, size_t npixels,
+                              FAR uint8_t *dest)
+{
+  FAR uint8_t *start = dest;
+  size_t count;
+  size_t i = 0;
+
+  while (i < npixels)
+    {
+      /* Count the pixels equal to pixel i */
+
+      count = 1;
+      while (i + count < npixels && count < SCREENSHOT_REPEAT_MAX &&
+             screenshot_samepix(src, i, i + count))
+        {
+          count++;
+        }
+
+      if (count >= SCREENSHOT_REPEAT_MIN)
+        {
+          *dest++ = count + SCREENSHOT_REPEAT_BIAS;
+          memcpy(dest, src + i * SCREENSHOT_PIXSIZE, SCREENSHOT_PIXSIZE);
+          dest += SCREENSHOT_PIXSIZE;
+          i    += count;
+          continue;
+        }
+
+      /* Literal pixels, up to the start of the next repeat run */
+
+      count = 1;
+      while (i + count < npixels && count < SCREENSHOT_LITERAL_MAX &&
+             (i + count + 1 >= npixels ||
+              !screenshot_samepix(src, i + count, i + count + 1)))
+        {
+          count++;
+        }
+
+      *dest++ = count - 1;
+      memcpy(dest, src + i * SCREENSHOT_PIXSIZE,
+             count * SCREENSHOT_PIXSIZE);
+      dest += count * SCREENSHOT_PIXSIZE;
+      i    += count;
+    }
+
+  return dest - start;
+}
+
+/****************************************************************************
+ * Name: screenshot_tile
+ *
+ * Description:
+ *   Compare one tile of the current band with the recorded screen.  If it
+ *   changed, write it to the recording, preceded by the frame time if it is
+ *   the first tile of the frame.  Returns 1 if the tile was written, 0 if
+ *   it did not change and ERROR on a write error.
+ *
+ ****************************************************************************/
+
+static int screenshot_tile(FAR struct screenshot_stream_s *st, int band,
+                           int tcol, bool first, uint32_t msec)
+{
+  nxgl_coord_t y0 = band * SCREENSHOT_TILESIZE;
+  nxgl_coord_t x0 = tcol * SCREENSHOT_TILESIZE;
+  size_t offset = x0 * SCREENSHOT_PIXSIZE;
+  size_t rowsize;
+  size_t len;
+  FAR uint8_t *delta;
+  FAR uint8_t *prev;
+  FAR uint8_t *src;
+  uint8_t buf[4];
+  size_t i;
+  int rows;
+  int row;
+
+  rows    = MIN(SCREENSHOT_TILESIZE, st->height - y0);
+  rowsize = MIN(SCREENSHOT_TILESIZE, st->width - x0) * SCREENSHOT_PIXSIZE;
+
+  for (row = 0; row < rows; row++)
+    {
+      if (memcmp(st->band + row * st->stride + offset,
+                 st->prev + (y0 + row) * st->stride + offset,
+                 rowsize) != 0)
+        {
+          break;
+        }
+    }
+
+  if (row >= rows)
+    {
+      return 0;
+    }
+
+  /* Record the change and the new content */
+
+  for (row = 0, delta = st->delta; row < rows; row++)
+    {
+      src  = st->band + row * st->stride + offset;
+      prev = st->prev + (y0 + row) * st->stride + offset;
+
+      for (i = 0; i < rowsize; i++)
+        {
+          *delta++ = src[i] ^ prev[i];
+        }
+
+      memcpy(prev, src, rowsize);
+    }
+
+  len = screenshot_pack(st->delta, (delta - st->delta) / SCREENSHOT_PIXSIZE,
+                        st->packed);
+
+  if (first)
+    {
+      screenshot_putle16(buf, msec & 0xffff);
+      screenshot_putle16(buf + 2, msec >> 16);
+      if (fwrite(buf, 1, 4, st->file) != 4)
+        {
+          return ERROR;
+        }
+    }
+
+  screenshot_putle16(buf, band * st->tcols + tcol);
+  screenshot_putle16(buf + 2, len);
+  if (fwrite(buf, 1, 4, st->file) != 4 ||
+      fwrite(st->packed, 1, len, st->file) != len)
+    {
+      return ERROR;
+    }
+
+  return 1;
+}
+
+/****************************************************************************
+ * Name: screenshot_frame
+ *
+ * Description:
+ *   Record one frame.  Bands are compared starting where the previous
+ *   frame stopped, until all were compared or budget milliseconds passed.
+ *
+ ****************************************************************************/
+
+static int screenshot_frame(FAR struct screenshot_stream_s *st,
+                            uint32_t start, int budget)
+{
+  uint32_t begin = screenshot_msec();
+  bool first = true;
+  int scanned;
+  int band;
+  int tcol;
+  int ret;
+
+  for (scanned = 0; scanned < st->nbands; scanned++)
+    {
+      struct nxgl_rect_s rect;
+
+      if (scanned > 0 && screenshot_msec() - begin >= (uint32_t)budget)
+        {
+          break;
+        }
+
+      band          = st->nextband;
+      st->nextband  = (band + 1) % st->nbands;
+
+      rect.pt1.x = 0;
+      rect.pt1.y = band * SCREENSHOT_TILESIZE;
+      rect.pt2.x = st->width - 1;
+      rect.pt2.y = MIN(rect.pt1.y + SCREENSHOT_TILESIZE, st->height) - 1;
+
+      ret = nx_getrectangle(st->window, &rect, 0, st->band, st->stride);
+      if (ret < 0)
+        {
+          perror("nx_getrectangle");
+          return ERROR;
+        }
+
+      for (tcol = 0; tcol < st->tcols; tcol++)
+        {
+          ret = screenshot_tile(st, band, tcol, first, begin - start);
+          if (ret < 0)
+            {
+              return ERROR;
+            }
+
+          first = first && ret == 0;
+        }
+    }
+
+  if (!first)
+    {
+      if (screenshot_write16(st, SCREENSHOT_STREAM_ENDFRAME) < 0 ||
+          fflush(st->file) != 0)
+        {
+          return ERROR;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: screenshot_stream
+ *
+ * Description:
+ *   Record the screen read through window into a screen recording file.
+ *
+ ****************************************************************************/
+
+int screenshot_stream(NXWINDOW window, FAR const struct nxgl_size_s *size,
+                      FAR const char *filename, int fps, int nframes,
+                      int budget)
+{
+  FAR struct screenshot_stream_s *st;
+  uint8_t hdr[SCREENSHOT_STREAM_HDRSIZE];
+  uint32_t interval = 1000 / fps;
+  uint32_t start;
+  uint32_t now;
+  uint32_t due;
+  int frame;
+  int ret = ERROR;
+  int ntiles;
+
+  /* Tile indices are 16 bits and the largest one marks the frame end */
+
+  ntiles = ((size->w + SCREENSHOT_TILESIZE - 1) / SCREENSHOT_TILESIZE) *
+           ((size->h + SCREENSHOT_TILESIZE - 1) / SCREENSHOT_TILESIZE);
+  if (ntiles > SCREENSHOT_STREAM_ENDFRAME)
+    {
+      fprintf(stderr, "Screen too large: %d tiles\n", ntiles);
+      return -E2BIG;
+    }
+
+  st = zalloc(sizeof(struct screenshot_stream_s));
+  if (st == NULL)
+    {
+      return ERROR;
+    }
+
+  st->window = window;
+  st->width  = size->w;
+  st->height = size->h;
+  st->tcols  = (size->w + SCREENSHOT_TILESIZE - 1) / SCREENSHOT_TILESIZE;
+  st->nbands = (size->h + SCREENSHOT_TILESIZE - 1) / SCREENSHOT_TILESIZE;
+  st->stride = size->w * SCREENSHOT_PIXSIZE;
+
+  /* The recorded screen starts out as all zero, like the replay's */
+
+  st->prev = zalloc(st->stride * size->h);
+  st->band = malloc(st->stride * SCREENSHOT_TILESIZE);
+  if (st->prev == NULL || st->band == NULL)
+    {
+      fprintf(stderr, "Out of memory\n");
+      goto errout;
+    }
+
+  st->file = fopen(filename, "wb");
+  if (st->file == NULL)
+    {
+      perror(filename);
+      goto errout;
+    }
+
+  memcpy(hdr, SCREENSHOT_STREAM_MAGIC, 4);
+  hdr[4] = SCREENSHOT_STREAM_VERSION;
+  hdr[5] = SCREENSHOT_PIXFMT;
+  hdr[6] = SCREENSHOT_TILESIZE;
+  hdr[7] = 0;
+  screenshot_putle16(hdr + 8, size->w);
+  screenshot_putle16(hdr + 10, size->h);
+
+  if (fwrite(hdr, 1, sizeof(hdr), st->file) != sizeof(hdr))
+    {
+      perror(filename);
+      goto errout_with_file;
+    }
+
+  g_screenshot_stop = false;
+  signal(SIGINT, screenshot_sigint);
+
+  start = screenshot_msec();
+  due   = start;
+
+  for (frame = 0; (nframes == 0 || frame < nframes) && !g_screenshot_stop;
+       frame++)
+    {
+      if (screenshot_frame(st, start, budget) < 0)
+        {
+          fprintf(stderr, "Recording failed at frame %d\n", frame);
+          goto errout_with_signal;
+        }
+
+      /* Wait for the next frame.  Frames that are already overdue are
+       * dropped instead of being taken back to back.
+       */
+
+      due += interval;
+      now  = screenshot_msec();
+      if ((int32_t)(due - now) > 0)
+        {
+          usleep((due - now) * 1000);
+        }
+      else
+        {
+          due = now;
+        }
+    }
+
+  printf("%d frames recorded to %s\n", frame, filename);
+  ret = OK;
+
+errout_with_signal:
+  signal(SIGINT, SIG_DFL);
+
+errout_with_file:
+  fclose(st->file);
+
+errout:
+  free(st->band);
+  free(st->prev);
+  free(st);
+  return ret;
+}
@@ -38,6 +38,10 @@
  * Pre-Processor Definitions
  ****************************************************************************/
 
+/* RGB565 pixels are converted in groups of this size */
+
+#define TIFF_CONVPIXELS 32
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -55,86 +59,55 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Name: tiff_addstrip
+ * Name: tiff_convrow
  *
  * Description:
- *   Convert an RGB565 strip to an RGB888 strip and write it to tmpfile2.
- *
- *   Add an image data strip.  The size of the strip in pixels must be equal
- *   to the RowsPerStrip x ImageWidth values that were provided to
- *   tiff_initialize().
+ *   Convert an RGB565 row to an RGB888 row and compress it.
  *
  * Input Parameters:
- *   info    - A pointer to the caller allocated parameter passing/TIFF state instance.
- *   buffer  - A buffer containing a single row of data.
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
+ *   row  - A buffer containing a single row of data.
  *
  * Returned Value:
  *   Zero (OK) on success.  A negated errno value on failure.
  *
  ****************************************************************************/
-int tiff_convstrip(FAR struct tiff_info_s *info, FAR const uint8_t *strip)
+
+static int tiff_convrow(FAR struct tiff_info_s *info, FAR const uint8_t *row)
 {
-#ifdef CONFIG_DEBUG_GRAPHICS
-  size_t ntotal;
-#endif
-  size_t nbytes;
-  FAR uint16_t *src;
+  uint8_t rgb888[3 * TIFF_CONVPIXELS];
+  FAR const uint16_t *src;
   FAR uint8_t *dest;
   uint16_t rgb565;
+  int npixels;
   int ret;
   int i;
 
-  DEBUGASSERT(info->iobuffer != NULL);
-
-  /* Convert each RGB565 pixel to RGB888 */
-
-  src    = (FAR uint16_t *)strip;
-  dest   = info->iobuffer;
-  nbytes = 0;
-#ifdef CONFIG_DEBUG_GRAPHICS
-  ntotal = 0;
-#endif
+  src = (FAR const uint16_t *)row;
 
-  for (i = 0; i < info->pps; i++)
+  for (npixels = info->imgwidth; npixels > 0; npixels -= TIFF_CONVPIXELS)
     {
-      /* Convert RGB565 to RGB888 */
+      int n = npixels < TIFF_CONVPIXELS ? npixels : TIFF_CONVPIXELS;
 
-      rgb565  = *src++;
-      *dest++ = (rgb565 >> (11-3)) & 0xf8; /* Move bits 11-15 to 3-7 */
-      *dest++ = (rgb565 >> ( 5-2)) & 0xfc; /* Move bits  5-10 to 2-7 */
-      *dest++ = (rgb565 << (   3)) & 0xf8; /* Move bits  0- 4 to 3-7 */
+      /* Convert a group of RGB565 pixels to RGB888 */
 
-      /* Update the byte count */
-
-      nbytes += 3;
-#ifdef CONFIG_DEBUG_GRAPHICS
-      ntotal += 3;
-#endif
-
-      /* Flush the conversion buffer to tmpfile2 when it becomes full */
-
-      if (nbytes > (info->iosize-3))
+      for (i = 0, dest = rgb888; i < n; i++)
         {
-          ret = tiff_write(info->tmp2fd, info->iobuffer, nbytes);
-          if (ret < 0)
-            {
-              return ret;
-            }
-
-          /* Reset to refill the conversion buffer */
+          rgb565  = *src++;
+          *dest++ = (rgb565 >> (11-3)) & 0xf8; /* Move bits 11-15 to 3-7 */
+          *dest++ = (rgb565 >> ( 5-2)) & 0xfc; /* Move bits  5-10 to 2-7 */
+          *dest++ = (rgb565 << (   3)) & 0xf8; /* Move bits  0- 4 to 3-7 */
+        }
 
-          dest   = info->iobuffer;
-          nbytes = 0;
+      ret = tiff_compress(info, rgb888, 3 * n);
+      if (ret < 0)
+        {
+          return ret;
         }
     }
 
-  /* Flush any buffer data to tmpfile2 */
-
-  ret = tiff_write(info->tmp2fd, info->iobuffer, nbytes);
-#ifdef CONFIG_DEBUG_GRAPHICS
-  DEBUGASSERT(ntotal == info->bps);
-#endif
-  return ret;
+  return OK;
 }
 
 /****************************************************************************
@@ -145,13 +118,18 @@ int tiff_convstrip(FAR struct tiff_info_s *info, FAR const uint8_t *strip)
  * Name: tiff_addstrip
  *
  * Description:
- *   Add an image data strip.  The size of the strip in pixels must be equal
- *   to the RowsPerStrip x ImageWidth values that were provided to
- *   tiff_initialize().
+ *   Add an image data strip.  The strip holds rps rows of ImageWidth
+ *   pixels as provided to tiff_initialize(), each row starting on a byte
+ *   boundary.  Only the rows up to ImageLength are used from the last
+ *   strip.
+ *
+ *   The rows are compressed into the TIFF strip being built, which is
+ *   completed once it holds RowsPerStrip rows.
  *
  * Input Parameters:
- *   info    - A pointer to the caller allocated parameter passing/TIFF state instance.
- *   buffer  - A buffer containing a single row of data.
+ *   info    - A pointer to the caller allocated parameter passing/TIFF state
+ *             instance.
+ *   strip   - A buffer containing rps rows of data.
  *
  * Returned Value:
  *   Zero (OK) on success.  A negated errno value on failure.
@@ -160,63 +138,76 @@ int tiff_convstrip(FAR struct tiff_info_s *info, FAR const uint8_t *strip)
 
 int tiff_addstrip(FAR struct tiff_info_s *info, FAR const uint8_t *strip)
 {
-  ssize_t newsize;
+  size_t srcsize;
+  int nrows;
   int ret;
+  int i;
 
-  /* Add the new strip based on the color format.  For FB_FMT_RGB16_565,
-   * will have to perform a conversion to RGB888.
-   */
+  DEBUGASSERT(info && info->outfd >= 0 && strip != NULL);
 
-  if (info->colorfmt == FB_FMT_RGB16_565)
+  if (info->nrows >= info->imgheight)
     {
-      ret = tiff_convstrip(info, strip);
+      ret = -E2BIG;
+      goto errout;
     }
 
-  /* For other formats, it is a simple write using the number of bytes per strip */
-
-  else
+  nrows = info->imgheight - info->nrows;
+  if (nrows > info->rps)
     {
-      ret = tiff_write(info->tmp2fd, strip, info->bps);
+      nrows = info->rps;
     }
 
-  if (ret < 0)
-    {
-      goto errout;
-    }
+  /* Add each row based on the color format.  For FB_FMT_RGB16_565,
+   * will have to perform a conversion to RGB888.
+   */
 
-  /* Write the byte count to the outfile and the offset to tmpfile1 */
+  srcsize = info->colorfmt == FB_FMT_RGB16_565 ?
+            2 * info->imgwidth : info->rowsize;
 
-  ret = tiff_putint32(info->outfd, info->bps);
-  if (ret < 0)
+  for (i = 0; i < nrows; i++, strip += srcsize)
     {
-      goto errout;
-    }
-  info->outsize += 4;
+      if (info->nrows % info->stripheight == 0)
+        {
+          ret = tiff_startstrip(info);
+          if (ret < 0)
+            {
+              goto errout;
+            }
+        }
 
-  ret = tiff_putint32(info->tmp1fd, info->tmp2size);
-  if (ret < 0)
-    {
-      goto errout;
-    }
-  info->tmp1size += 4;
+      if (info->colorfmt == FB_FMT_RGB16_565)
+        {
+          ret = tiff_convrow(info, strip);
+        }
+      else
+        {
+          ret = tiff_compress(info, strip, info->rowsize);
+        }
 
-  /* Increment the size of tmp2file. */
+      if (ret == OK)
+        {
+          ret = tiff_endrow(info);
+        }
 
-  info->tmp2size += info->bps;
+      if (ret < 0)
+        {
+          goto errout;
+        }
 
-  /* Pad tmpfile2 as necessary achieve word alignment */
+      /* Complete the TIFF strip after its last row */
 
-  newsize = tiff_wordalign(info->tmp2fd, info->tmp2size);
-  if (newsize < 0)
-    {
-      ret = (int)newsize;
-      goto errout;
+      info->nrows++;
+      if (info->nrows % info->stripheight == 0 ||
+          info->nrows == info->imgheight)
+        {
+          ret = tiff_endstrip(info);
+          if (ret < 0)
+            {
+              goto errout;
+            }
+        }
     }
-  info->tmp2size = (size_t)newsize;
-
-  /* Increment the number of strips in the TIFF file */
 
-  info->nstrips++;
   return OK;
 
 errout:
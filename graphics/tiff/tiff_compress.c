@@ -0,0 +1,499 @@
+/****************************************************************************
+ * apps/graphics/tiff/tiff_compress.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include "graphics/tiff.h"
+
+#include "tiff_internal.h"
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/* PackBits (TIFF 6.0, section 9).  Each row is packed separately into
+ * literal runs of 1-128 bytes and repeat runs of 2-128 bytes.  A literal
+ * run is built up in place in the I/O buffer, so there must be room for
+ * the longest one when it starts.
+ */
+
+#define TIFF_PACKBITS_MAXRUN   128
+#define TIFF_PACKBITS_MINRUN   3  /* Shorter runs inside literal runs */
+
+/* LZW (TIFF 6.0, section 13) */
+
+#define TIFF_LZW_CLEAR         256  /* ClearCode */
+#define TIFF_LZW_EOI           257  /* EndOfInformation */
+#define TIFF_LZW_FIRST         258  /* First code of a string */
+#define TIFF_LZW_MINBITS       9    /* Code width after ClearCode */
+#define TIFF_LZW_MAXCODE       4094 /* Table is cleared at this code */
+
+/* The string table (TIFF_LZW_HASHSIZE entries) uses double hashing.
+ * Each entry holds the code of the string prefix and the byte added to it
+ * as key (20 bits) and the code of the string (12 bits).
+ */
+
+#define TIFF_LZW_EMPTY         0xffffffff
+#define TIFF_LZW_KEY(p,c)      (((uint32_t)(p) << 8) | (c))
+#define TIFF_LZW_ENTRY(k,code) (((k) << 12) | (code))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tiff_putbyte
+ *
+ * Description:
+ *   Add one byte to the outfile through the I/O buffer.
+ *
+ ****************************************************************************/
+
+static inline int tiff_putbyte(FAR struct tiff_info_s *info, uint8_t value)
+{
+  int ret;
+
+  if (info->iolen >= info->iosize)
+    {
+      ret = tiff_flush(info);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  info->iobuffer[info->iolen++] = value;
+  info->outsize++;
+  return OK;
+}
+
+#ifdef CONFIG_TIFF_PACKBITS
+/****************************************************************************
+ * Name: tiff_packliteral
+ *
+ * Description:
+ *   Add one byte to the current PackBits literal run, starting a new run
+ *   if there is none.
+ *
+ ****************************************************************************/
+
+static int tiff_packliteral(FAR struct tiff_info_s *info, uint8_t value)
+{
+  int ret;
+
+  if (info->litpos < 0)
+    {
+      if (info->iosize - info->iolen < TIFF_PACKBITS_MAXRUN + 1)
+        {
+          ret = tiff_flush(info);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+
+      /* The control byte is the length of the run minus one */
+
+      info->litpos = info->iolen;
+      info->iobuffer[info->iolen++] = 0;
+      info->outsize++;
+    }
+  else
+    {
+      info->iobuffer[info->litpos]++;
+    }
+
+  info->iobuffer[info->iolen++] = value;
+  info->outsize++;
+
+  if (info->iobuffer[info->litpos] == TIFF_PACKBITS_MAXRUN - 1)
+    {
+      info->litpos = -1;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tiff_packrun
+ *
+ * Description:
+ *   Add the pending repeated bytes to the outfile, as a repeat run or as
+ *   part of a literal run.
+ *
+ ****************************************************************************/
+
+static int tiff_packrun(FAR struct tiff_info_s *info)
+{
+  uint8_t packet[2];
+  int ret = OK;
+
+  /* Short runs cost as much as the literal run they would split */
+
+  if (info->runcount >= TIFF_PACKBITS_MINRUN ||
+      (info->runcount > 1 && info->litpos < 0))
+    {
+      packet[0]      = (uint8_t)(1 - info->runcount);
+      packet[1]      = info->runbyte;
+      info->litpos   = -1;
+      info->runcount = 0;
+      return tiff_putbuffer(info, packet, 2);
+    }
+
+  for (; info->runcount > 0 && ret == OK; info->runcount--)
+    {
+      ret = tiff_packliteral(info, info->runbyte);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: tiff_packbits
+ *
+ * Description:
+ *   Compress image data with PackBits.
+ *
+ ****************************************************************************/
+
+static int tiff_packbits(FAR struct tiff_info_s *info,
+                         FAR const uint8_t *buffer, size_t count)
+{
+  int ret;
+
+  for (; count > 0; count--, buffer++)
+    {
+      if (info->runcount > 0 && *buffer == info->runbyte &&
+          info->runcount < TIFF_PACKBITS_MAXRUN)
+        {
+          info->runcount++;
+          continue;
+        }
+
+      if (info->runcount > 0)
+        {
+          ret = tiff_packrun(info);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+
+      info->runbyte  = *buffer;
+      info->runcount = 1;
+    }
+
+  return OK;
+}
+#endif
+
+#ifdef CONFIG_TIFF_LZW
+/****************************************************************************
+ * Name: tiff_lzwput
+ *
+ * Description:
+ *   Add one code to the outfile, most significant bit first.
+ *
+ ****************************************************************************/
+
+static int tiff_lzwput(FAR struct tiff_info_s *info, unsigned int code)
+{
+  int ret;
+
+  info->bitbuffer = (info->bitbuffer << info->nbits) | code;
+  info->bitcount += info->nbits;
+
+  while (info->bitcount >= 8)
+    {
+      info->bitcount -= 8;
+      ret = tiff_putbyte(info, (uint8_t)(info->bitbuffer >> info->bitcount));
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tiff_lzwclear
+ *
+ * Description:
+ *   Empty the string table.
+ *
+ ****************************************************************************/
+
+static void tiff_lzwclear(FAR struct tiff_info_s *info)
+{
+  memset(info->lzwtable, 0xff, TIFF_LZW_HASHSIZE * sizeof(uint32_t));
+  info->nextcode = TIFF_LZW_FIRST;
+  info->nbits    = TIFF_LZW_MINBITS;
+}
+
+/****************************************************************************
+ * Name: tiff_lzwnext
+ *
+ * Description:
+ *   Account for a new string table entry.  The code width grows as soon
+ *   as the next code needs it; a full table is cleared.
+ *
+ ****************************************************************************/
+
+static int tiff_lzwnext(FAR struct tiff_info_s *info)
+{
+  int ret;
+
+  info->nextcode++;
+  if (info->nextcode == TIFF_LZW_MAXCODE)
+    {
+      ret = tiff_lzwput(info, TIFF_LZW_CLEAR);
+      tiff_lzwclear(info);
+      return ret;
+    }
+
+  if (info->nextcode >= (1 << info->nbits))
+    {
+      info->nbits++;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tiff_lzw
+ *
+ * Description:
+ *   Compress image data with LZW.
+ *
+ ****************************************************************************/
+
+static int tiff_lzw(FAR struct tiff_info_s *info,
+                    FAR const uint8_t *buffer, size_t count)
+{
+  FAR uint32_t *table = info->lzwtable;
+  uint32_t entry;
+  uint32_t key;
+  unsigned int hash;
+  unsigned int disp;
+  int ret;
+
+  for (; count > 0; count--, buffer++)
+    {
+      if (info->prefix < 0)
+        {
+          info->prefix = *buffer;
+          continue;
+        }
+
+      /* Look up the current string plus this byte */
+
+      key  = TIFF_LZW_KEY(info->prefix, *buffer);
+      hash = key % TIFF_LZW_HASHSIZE;
+      disp = hash == 0 ? 1 : TIFF_LZW_HASHSIZE - hash;
+
+      while ((entry = table[hash]) != TIFF_LZW_EMPTY &&
+             (entry >> 12) != key)
+        {
+          hash = hash >= disp ? hash - disp : hash + TIFF_LZW_HASHSIZE - disp;
+        }
+
+      if (entry != TIFF_LZW_EMPTY)
+        {
+          info->prefix = entry & 0xfff;
+          continue;
+        }
+
+      /* Not in the table:  Emit the current string and add the new one */
+
+      ret = tiff_lzwput(info, info->prefix);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      table[hash]  = TIFF_LZW_ENTRY(key, info->nextcode);
+      info->prefix = *buffer;
+
+      ret = tiff_lzwnext(info);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tiff_startstrip
+ *
+ * Description:
+ *   Prepare the compression for a new strip.
+ *
+ ****************************************************************************/
+
+int tiff_startstrip(FAR struct tiff_info_s *info)
+{
+  info->stripstart = info->outsize;
+  info->litpos     = -1;
+  info->runcount   = 0;
+
+#ifdef CONFIG_TIFF_LZW
+  /* Each LZW strip starts with ClearCode */
+
+  if (info->compress == TAG_COMP_LZW)
+    {
+      tiff_lzwclear(info);
+      info->bitcount = 0;
+      info->prefix   = -1;
+      return tiff_lzwput(info, TIFF_LZW_CLEAR);
+    }
+#endif
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tiff_compress
+ *
+ * Description:
+ *   Compress image data of the current row and add it to the outfile.
+ *
+ ****************************************************************************/
+
+int tiff_compress(FAR struct tiff_info_s *info, FAR const uint8_t *buffer,
+                  size_t count)
+{
+  switch (info->compress)
+    {
+#ifdef CONFIG_TIFF_PACKBITS
+      case TAG_COMP_PACKBITS:
+        return tiff_packbits(info, buffer, count);
+#endif
+
+#ifdef CONFIG_TIFF_LZW
+      case TAG_COMP_LZW:
+        return tiff_lzw(info, buffer, count);
+#endif
+
+      default:
+        return tiff_putbuffer(info, buffer, count);
+    }
+}
+
+/****************************************************************************
+ * Name: tiff_endrow
+ *
+ * Description:
+ *   Complete the compression of a row.
+ *
+ ****************************************************************************/
+
+int tiff_endrow(FAR struct tiff_info_s *info)
+{
+  int ret = OK;
+
+#ifdef CONFIG_TIFF_PACKBITS
+  /* PackBits runs do not cross rows */
+
+  if (info->compress == TAG_COMP_PACKBITS)
+    {
+      if (info->runcount > 0)
+        {
+          ret = tiff_packrun(info);
+        }
+
+      info->litpos = -1;
+    }
+#endif
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: tiff_endstrip
+ *
+ * Description:
+ *   Complete the compression of a strip and record its byte count.
+ *
+ ****************************************************************************/
+
+int tiff_endstrip(FAR struct tiff_info_s *info)
+{
+  int ret = OK;
+
+  DEBUGASSERT(info->nstrips < info->maxstrips);
+
+#ifdef CONFIG_TIFF_LZW
+  /* Emit the last string and EndOfInformation, then the remaining bits
+   * padded to a byte.  The decoder adds a table entry for the last string
+   * as well, which may widen the codes.
+   */
+
+  if (info->compress == TAG_COMP_LZW)
+    {
+      if (info->prefix >= 0)
+        {
+          ret = tiff_lzwput(info, info->prefix);
+          if (ret == OK)
+            {
+              ret = tiff_lzwnext(info);
+            }
+        }
+
+      if (ret == OK)
+        {
+          ret = tiff_lzwput(info, TIFF_LZW_EOI);
+        }
+
+      if (ret == OK && info->bitcount > 0)
+        {
+          ret = tiff_putbyte(info, (uint8_t)(info->bitbuffer <<
+                                             (8 - info->bitcount)));
+          info->bitcount = 0;
+        }
+
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+#endif
+
+  info->stripcounts[info->nstrips++] = info->outsize - info->stripstart;
+  return ret;
+}
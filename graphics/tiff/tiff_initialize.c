@@ -26,6 +26,7 @@
 
 #include <nuttx/config.h>
 
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -52,7 +53,7 @@
  *           12    NewSubfileType
  *           24    ImageWidth                  Number of columns is a user parameter
  *           36    ImageLength                 Number of rows is a user parameter
- *           48    Compression                 Hard-coded no compression (for now)
+ *           48    Compression                 Value is a user parameter
  *           60    PhotometricInterpretation   Value is a user parameter
  *           72    StripOffsets                Offset and count determined as strips added
  *           84    RowsPerStrip                Value is a user parameter
@@ -72,7 +73,6 @@
  *          214    [2 bytes padding]
  *          216    StripByteCounts             Beginning of strip byte counts
  *          xxx    StripOffsets                Beginning of strip offsets
- *          xxx    [Probably padding]
  *          xxx    Data for strips             Beginning of strip data
  */
 
@@ -105,7 +105,7 @@
  *           24    ImageWidth                  Number of columns is a user parameter
  *           36    ImageLength                 Number of rows is a user parameter
  *           48    BitsPerSample
- *           60    Compression                 Hard-coded no compression (for now)
+ *           60    Compression                 Value is a user parameter
  *           72    PhotometricInterpretation   Value is a user parameter
  *           84    StripOffsets                Offset and count determined as strips added
  *           96    RowsPerStrip                Value is a user parameter
@@ -125,7 +125,6 @@
  *          226    [2 bytes padding]
  *          228    StripByteCounts             Beginning of strip byte counts
  *          xxx    StripOffsets                Beginning of strip offsets
- *          xxx    [Probably padding]
  *          xxx    Data for strips             Beginning of strip data
  */
 
@@ -151,7 +150,7 @@
  *           24    ImageWidth                  Number of columns is a user parameter
  *           36    ImageLength                 Number of rows is a user parameter
  *           48    BitsPerSample               8, 8, 8
- *           60    Compression                 Hard-coded no compression (for now)
+ *           60    Compression                 Value is a user parameter
  *           72    PhotometricInterpretation   Value is a user parameter
  *           84    StripOffsets                Offset and count determined as strips added
  *           96    SamplesPerPixel             Hard-coded to 3
@@ -174,7 +173,6 @@
  *          246    [2 bytes padding]
  *          248    StripByteCounts             Beginning of strip byte counts
  *          xxx    StripOffsets                Beginning of strip offsets
- *          xxx    [Probably padding]
  *          xxx    Data for strips             Beginning of strip data
  */
 
@@ -302,7 +300,7 @@ static inline int tiff_putheader(FAR struct tiff_info_s *info)
 
   /* Write the header to the output file */
 
-  ret = tiff_write(info->outfd, &hdr, SIZEOF_TIFF_HEADER);
+  ret = tiff_putbuffer(info, &hdr, SIZEOF_TIFF_HEADER);
   if (ret != OK)
     {
       return ret;
@@ -310,7 +308,7 @@ static inline int tiff_putheader(FAR struct tiff_info_s *info)
 
   /* Two pad bytes following the header */
 
-  ret = tiff_putint16(info->outfd, 0);
+  ret = tiff_putint16(info, 0);
   return ret;
 }
 
@@ -341,7 +339,7 @@ static int tiff_putifdentry(FAR struct tiff_info_s *info, uint16_t tag,
   tiff_put16(ifd.type, type);
   tiff_put32(ifd.count, count);
   tiff_put32(ifd.offset, offset);
-  return tiff_write(info->outfd, &ifd, SIZEOF_IFD_ENTRY);
+  return tiff_putbuffer(info, &ifd, SIZEOF_IFD_ENTRY);
 }
 
 /****************************************************************************
@@ -441,71 +439,52 @@ int tiff_initialize(FAR struct tiff_info_s *info)
   off_t offset = 0;
 #endif
   char timbuf[TIFF_DATETIME_STRLEN + 8];
+  size_t nrows;
   int ret = -EINVAL;
 
-  DEBUGASSERT(info && info->outfile && info->tmpfile1 && info->tmpfile2);
+  DEBUGASSERT(info && info->outfile && info->iobuffer);
 
-  /* Open all output files */
-
-  info->outfd = open(info->outfile, O_RDWR|O_CREAT|O_TRUNC, 0666);
-  if (info->outfd < 0)
-    {
-      gerr("ERROR: Failed to open %s for reading/writing: %d\n",
-           info->outfile, errno);
-      goto errout;
-    }
-
-  info->tmp1fd = open(info->tmpfile1, O_RDWR|O_CREAT|O_TRUNC, 0666);
-  if (info->tmp1fd < 0)
-    {
-      gerr("ERROR: Failed to open %s for reading/writing: %d\n",
-           info->tmpfile1, errno);
-      goto errout;
-    }
-
-  info->tmp2fd = open(info->tmpfile2, O_RDWR|O_CREAT|O_TRUNC, 0666);
-  if (info->tmp2fd < 0)
+  if (info->rps < 1 || info->imgwidth < 1 || info->imgheight < 1 ||
+      info->iosize < TIFF_IOBUFFER_MIN)
     {
-      gerr("ERROR: Failed to open %s for reading/writing: %d\n",
-           info->tmpfile2, errno);
-      goto errout;
+      gerr("ERROR: Bad image or buffer size\n");
+      return -EINVAL;
     }
 
   /* Make some decisions using the color format.  Only the following are
    * supported:
    */
 
-  info->pps = info->imgwidth * info->rps;           /* Pixels per strip */
   switch (info->colorfmt)
     {
       case FB_FMT_Y1:                               /* BPP=1, monochrome, 0=black */
         info->filefmt  = &g_bilevinfo;              /* Bi-level file image file info */
         info->imgflags = IMGFLAGS_FMT_Y1;           /* Bit encoded image characteristics */
-        info->bps      = (info->pps + 7) >> 3;      /* Bytes per strip */
+        info->rowsize  = (info->imgwidth + 7) >> 3; /* Bytes per row */
         break;
 
       case FB_FMT_Y4:                               /* BPP=4, 4-bit greyscale, 0=black */
         info->filefmt  = &g_greyinfo;               /* Greyscale file image file info */
         info->imgflags = IMGFLAGS_FMT_Y4;           /* Bit encoded image characteristics */
-        info->bps      = (info->pps + 1) >> 1;      /* Bytes per strip */
+        info->rowsize  = (info->imgwidth + 1) >> 1; /* Bytes per row */
         break;
 
       case FB_FMT_Y8:                               /* BPP=8, 8-bit greyscale, 0=black */
         info->filefmt  = &g_greyinfo;               /* Greyscale file image file info */
         info->imgflags = IMGFLAGS_FMT_Y8;           /* Bit encoded image characteristics */
-        info->bps      = info->pps;                 /* Bytes per strip */
+        info->rowsize  = info->imgwidth;            /* Bytes per row */
         break;
 
       case FB_FMT_RGB16_565:                        /* BPP=16 R=6, G=6, B=5 */
         info->filefmt  = &g_rgbinfo;                /* RGB file image file info */
         info->imgflags = IMGFLAGS_FMT_RGB16_565;    /* Bit encoded image characteristics */
-        info->bps      = 3 * info->pps;             /* Bytes per strip */
+        info->rowsize  = 3 * info->imgwidth;        /* Bytes per row */
         break;
 
       case FB_FMT_RGB24:                            /* BPP=24 R=8, G=8, B=8 */
         info->filefmt  = &g_rgbinfo;                /* RGB file image file info */
         info->imgflags = IMGFLAGS_FMT_RGB24;        /* Bit encoded image characteristics */
-        info->bps      = 3 *info->pps;              /* Bytes per strip */
+        info->rowsize  = 3 * info->imgwidth;        /* Bytes per row */
         break;
 
       default:
@@ -513,6 +492,91 @@ int tiff_initialize(FAR struct tiff_info_s *info)
         return -EINVAL;
     }
 
+  /* Check the compression */
+
+  switch (info->compress)
+    {
+      case 0:
+        info->compress = TAG_COMP_NONE;
+        break;
+
+      case TAG_COMP_NONE:
+#ifdef CONFIG_TIFF_PACKBITS
+      case TAG_COMP_PACKBITS:
+#endif
+#ifdef CONFIG_TIFF_LZW
+      case TAG_COMP_LZW:
+#endif
+        break;
+
+      default:
+        gerr("ERROR: Unsupported compression: %d\n", info->compress);
+        return -ENOSYS;
+    }
+
+  /* Rows are collected into strips of about CONFIG_TIFF_STRIPSIZE bytes
+   * before compression.  The number of strips is known, so room for their
+   * StripByteCounts and StripOffsets is reserved after the values and the
+   * strip data follows.  A single strip has them in the IFD entries.
+   */
+
+  nrows = CONFIG_TIFF_STRIPSIZE / info->rowsize;
+  if (nrows < 1)
+    {
+      nrows = 1;
+    }
+  else if (nrows > info->imgheight)
+    {
+      nrows = info->imgheight;
+    }
+
+  info->stripheight = nrows;
+
+  info->maxstrips  = (info->imgheight + info->stripheight - 1) /
+                     info->stripheight;
+  info->dataoffset = info->filefmt->sbcoffset;
+  if (info->maxstrips > 1)
+    {
+      info->dataoffset += 8 * info->maxstrips;
+    }
+
+  info->nstrips     = 0;
+  info->nrows       = 0;
+  info->outsize     = 0;
+  info->iolen       = 0;
+  info->stripcounts = NULL;
+  info->lzwtable    = NULL;
+
+  /* Open the output file */
+
+  info->outfd = open(info->outfile, O_WRONLY|O_CREAT|O_TRUNC, 0666);
+  if (info->outfd < 0)
+    {
+      ret = -errno;
+      gerr("ERROR: Failed to open %s for writing: %d\n",
+           info->outfile, ret);
+      return ret;
+    }
+
+  info->stripcounts = malloc(info->maxstrips * sizeof(uint32_t));
+  if (info->stripcounts == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+#ifdef CONFIG_TIFF_LZW
+  if (info->compress == TAG_COMP_LZW)
+    {
+      info->lzwtable = malloc(TIFF_LZW_HASHSIZE * sizeof(uint32_t));
+      if (info->lzwtable == NULL)
+        {
+          ret = -ENOMEM;
+          goto errout;
+        }
+    }
+#endif
+
   /* Write the TIFF header data to the outfile:
    *
    * Header:    0    Byte Order                  "II" or "MM"
@@ -533,7 +597,7 @@ int tiff_initialize(FAR struct tiff_info_s *info)
    * All formats: Offset 10 Number of Directory Entries 12
    */
 
-  ret = tiff_putint16(info->outfd, info->filefmt->nifdentries);
+  ret = tiff_putint16(info, info->filefmt->nifdentries);
   if (ret < 0)
     {
       goto errout;
@@ -608,12 +672,13 @@ int tiff_initialize(FAR struct tiff_info_s *info)
 
   /* Write Compression:
    *
-   * Bi-level Images: Offset 48 Hard-coded no compression (for now)
-   * Greyscale:       Offset 60  "  " "   " "" "          " " " " "
-   * RGB:             Offset 60 "  " "   " "" "          " " " " "
+   * Bi-level Images: Offset 48 Value is a user parameter
+   * Greyscale:       Offset 60 Value is a user parameter
+   * RGB:             Offset 60 Value is a user parameter
    */
 
-  ret = tiff_putifdentry16(info, IFD_TAG_COMPRESSION, IFD_FIELD_SHORT, 1, TAG_COMP_NONE);
+  ret = tiff_putifdentry16(info, IFD_TAG_COMPRESSION, IFD_FIELD_SHORT, 1,
+                           info->compress);
   if (ret < 0)
     {
       goto errout;
@@ -645,13 +710,19 @@ int tiff_initialize(FAR struct tiff_info_s *info)
 
   /* Write StripOffsets:
    *
-   * Bi-level Images: Offset 72 Value determined by switch statement above
-   * Greyscale:       Offset 84 Value determined by switch statement above
-   * RGB:             Offset 84 Value determined by switch statement above
+   * Bi-level Images: Offset 72 Count is the number of strips
+   * Greyscale:       Offset 84 Count is the number of strips
+   * RGB:             Offset 84 Count is the number of strips
+   *
+   * The values follow the StripByteCounts values, or the value is the
+   * offset of the only strip.
    */
 
   tiff_checkoffs(offset, info->filefmt->soifdoffset);
-  ret = tiff_putifdentry(info, IFD_TAG_STRIPOFFSETS, IFD_FIELD_LONG, 0, 0);
+  ret = tiff_putifdentry(info, IFD_TAG_STRIPOFFSETS, IFD_FIELD_LONG,
+                         info->maxstrips, info->maxstrips > 1 ?
+                         info->filefmt->sbcoffset + 4 * info->maxstrips :
+                         info->dataoffset);
   if (ret < 0)
     {
       goto errout;
@@ -677,12 +748,13 @@ int tiff_initialize(FAR struct tiff_info_s *info)
 
   /* Write RowsPerStrip:
    *
-   * Bi-level Images: Offset  84 Value is a user parameter
-   * Greyscale:       Offset  96 Value is a user parameter
-   * RGB:             Offset 108 Value is a user parameter
+   * Bi-level Images: Offset  84 Value determined from CONFIG_TIFF_STRIPSIZE
+   * Greyscale:       Offset  96 Value determined from CONFIG_TIFF_STRIPSIZE
+   * RGB:             Offset 108 Value determined from CONFIG_TIFF_STRIPSIZE
    */
 
-  ret = tiff_putifdentry16(info, IFD_TAG_ROWSPERSTRIP, IFD_FIELD_SHORT, 1, info->rps);
+  ret = tiff_putifdentry16(info, IFD_TAG_ROWSPERSTRIP, IFD_FIELD_SHORT, 1,
+                           info->stripheight);
   if (ret < 0)
     {
       goto errout;
@@ -691,13 +763,17 @@ int tiff_initialize(FAR struct tiff_info_s *info)
 
   /* Write StripByteCounts:
    *
-   * Bi-level Images: Offset  96 Count determined as strips added, Value offset = 216
-   * Greyscale:       Offset 108 Count determined as strips added, Value offset = 228
-   * RGB:             Offset 120 Count determined as strips added, Value offset = 248
+   * Bi-level Images: Offset  96 Strip count, Value offset = 216
+   * Greyscale:       Offset 108 Strip count, Value offset = 228
+   * RGB:             Offset 120 Strip count, Value offset = 248
+   *
+   * The value of a single strip is filled in by tiff_finalize().
    */
 
   tiff_checkoffs(offset, info->filefmt->sbcifdoffset);
-  ret = tiff_putifdentry(info, IFD_TAG_STRIPCOUNTS, IFD_FIELD_LONG, 0, info->filefmt->sbcoffset);
+  ret = tiff_putifdentry(info, IFD_TAG_STRIPCOUNTS, IFD_FIELD_LONG,
+                         info->maxstrips, info->maxstrips > 1 ?
+                         info->filefmt->sbcoffset : 0);
   if (ret < 0)
     {
       goto errout;
@@ -775,7 +851,7 @@ int tiff_initialize(FAR struct tiff_info_s *info)
    *                  Offset 194, [2 bytes padding]
    */
 
-  ret = tiff_putint32(info->outfd, 0);
+  ret = tiff_putint32(info, 0);
   if (ret < 0)
     {
       goto errout;
@@ -797,10 +873,10 @@ int tiff_initialize(FAR struct tiff_info_s *info)
    */
 
   tiff_checkoffs(offset, info->filefmt->xresoffset);
-  ret = tiff_putint32(info->outfd, 300);
+  ret = tiff_putint32(info, 300);
   if (ret == OK)
     {
-      ret = tiff_putint32(info->outfd, 1);
+      ret = tiff_putint32(info, 1);
     }
 
   if (ret < 0)
@@ -810,10 +886,10 @@ int tiff_initialize(FAR struct tiff_info_s *info)
   tiff_offset(offset, 8);
 
   tiff_checkoffs(offset, info->filefmt->yresoffset);
-  ret = tiff_putint32(info->outfd, 300);
+  ret = tiff_putint32(info, 300);
   if (ret == OK)
     {
-      ret = tiff_putint32(info->outfd, 1);
+      ret = tiff_putint32(info, 1);
     }
 
   if (ret < 0)
@@ -833,10 +909,10 @@ int tiff_initialize(FAR struct tiff_info_s *info)
   if (IMGFLAGS_ISRGB(info->imgflags))
     {
       tiff_checkoffs(offset, TIFF_RGB_BPSOFFSET);
-      tiff_putint16(info->outfd, 8);
-      tiff_putint16(info->outfd, 8);
-      tiff_putint16(info->outfd, 8);
-      tiff_putint16(info->outfd, 0);
+      tiff_putint16(info, 8);
+      tiff_putint16(info, 8);
+      tiff_putint16(info, 8);
+      tiff_putint16(info, 0);
       tiff_offset(offset, 8);
     }
 
@@ -849,7 +925,7 @@ int tiff_initialize(FAR struct tiff_info_s *info)
    */
 
   tiff_checkoffs(offset, info->filefmt->swoffset);
-  ret = tiff_putstring(info->outfd, TIFF_SOFTWARE_STRING, TIFF_SOFTWARE_STRLEN);
+  ret = tiff_putstring(info, TIFF_SOFTWARE_STRING, TIFF_SOFTWARE_STRLEN);
   if (ret < 0)
     {
       goto errout;
@@ -871,7 +947,7 @@ int tiff_initialize(FAR struct tiff_info_s *info)
       goto errout;
     }
 
-  ret = tiff_putstring(info->outfd, timbuf, TIFF_DATETIME_STRLEN);
+  ret = tiff_putstring(info, timbuf, TIFF_DATETIME_STRLEN);
   if (ret < 0)
     {
       goto errout;
@@ -880,17 +956,28 @@ int tiff_initialize(FAR struct tiff_info_s *info)
 
   /* Add two bytes of padding */
 
-  ret = tiff_putint16(info->outfd, 0);
+  ret = tiff_putint16(info, 0);
   if (ret < 0)
     {
       goto errout;
     }
   tiff_offset(offset, 2);
 
-  /* And that should do it! */
+  /* Reserve the StripByteCounts and StripOffsets values */
 
   tiff_checkoffs(offset, info->filefmt->sbcoffset);
-  info->outsize = info->filefmt->sbcoffset;
+  while (info->outsize < info->dataoffset)
+    {
+      ret = tiff_putint32(info, 0);
+      if (ret < 0)
+        {
+          goto errout;
+        }
+    }
+
+  /* And that should do it! */
+
+  DEBUGASSERT(info->outsize == info->dataoffset);
   return OK;
 
 errout:
@@ -64,6 +64,14 @@
 #define IMGFLAGS_ISRGB(f) \
   (((f) & IMGFLAGS_FMT_RGB24) != 0)
 
+/* Compression **************************************************************/
+
+/* Entries of the LZW string table, a prime number with room for all 4094
+ * codes at 80% occupancy at most.
+ */
+
+#define TIFF_LZW_HASHSIZE      5003
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -86,32 +94,49 @@ extern "C"
  ****************************************************************************/
 
 /****************************************************************************
- * Name: tiff_read
+ * Name: tiff_write
  *
  * Description:
- *   Read TIFF data from the specified file
+ *   Write TIFF data to the specified file
  *
  * Input Parameters:
- *   fd - Open file descriptor to read from
+ *   fd - Open file descriptor to write to
  *   buffer - Read-only buffer containing the data to be written
  *   count - The number of bytes to write
  *
  * Returned Value:
- *   On success, then number of bytes read; Zero is returned on EOF.
- *   Otherwise, a negated errno value on failure.
+ *   Zero (OK) on success.  A negated errno value on failure.
  *
  ****************************************************************************/
 
-ssize_t tiff_read(int fd, FAR void *buffer, size_t count);
+int tiff_write(int fd, FAR const void *buffer, size_t count);
 
 /****************************************************************************
- * Name: tiff_write
+ * Name: tiff_flush
  *
  * Description:
- *   Write TIFF data to the specified file
+ *   Write the data collected in the I/O buffer to the outfile.
  *
  * Input Parameters:
- *   fd - Open file descriptor to write to
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int tiff_flush(FAR struct tiff_info_s *info);
+
+/****************************************************************************
+ * Name: tiff_putbuffer
+ *
+ * Description:
+ *   Add data to the outfile through the I/O buffer.
+ *
+ * Input Parameters:
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
  *   buffer - Read-only buffer containing the data to be written
  *   count - The number of bytes to write
  *
@@ -120,7 +145,8 @@ ssize_t tiff_read(int fd, FAR void *buffer, size_t count);
  *
  ****************************************************************************/
 
-int tiff_write(int fd, FAR const void *buffer, size_t count);
+int tiff_putbuffer(FAR struct tiff_info_s *info, FAR const void *buffer,
+                   size_t count);
 
 /****************************************************************************
  * Name: tiff_putint16
@@ -129,7 +155,8 @@ int tiff_write(int fd, FAR const void *buffer, size_t count);
  *   Write two bytes to the outfile.
  *
  * Input Parameters:
- *   fd - File descriptor to be used.
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
  *   value - The 2-byte, uint16_t value to write
  *
  * Returned Value:
@@ -137,7 +164,7 @@ int tiff_write(int fd, FAR const void *buffer, size_t count);
  *
  ****************************************************************************/
 
-int tiff_putint16(int fd, uint16_t value);
+int tiff_putint16(FAR struct tiff_info_s *info, uint16_t value);
 
 /****************************************************************************
  * Name: tiff_putint32
@@ -146,7 +173,8 @@ int tiff_putint16(int fd, uint16_t value);
  *   Write four bytes to the outfile.
  *
  * Input Parameters:
- *   fd - File descriptor to be used.
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
  *   value - The 4-byte, uint32_t value to write
  *
  * Returned Value:
@@ -154,7 +182,7 @@ int tiff_putint16(int fd, uint16_t value);
  *
  ****************************************************************************/
 
-int tiff_putint32(int fd, uint32_t value);
+int tiff_putint32(FAR struct tiff_info_s *info, uint32_t value);
 
 /****************************************************************************
  * Name: tiff_putstring
@@ -163,7 +191,8 @@ int tiff_putint32(int fd, uint32_t value);
  *  Write a string of fixed length to the outfile.
  *
  * Input Parameters:
- *   fd - File descriptor to be used.
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
  *   string - A pointer to the memory containing the string
  *   len - The length of the string (including the NUL terminator)
  *
@@ -172,24 +201,80 @@ int tiff_putint32(int fd, uint32_t value);
  *
  ****************************************************************************/
 
-int tiff_putstring(int fd, FAR const char *string, int len);
+int tiff_putstring(FAR struct tiff_info_s *info, FAR const char *string,
+                   int len);
 
 /****************************************************************************
- * Name: tiff_wordalign
+ * Name: tiff_startstrip
  *
  * Description:
- *  Pad a file with zeros as necessary to achieve word alignament.
+ *   Prepare the compression for a new strip.
  *
  * Input Parameters:
- *   fd - File descriptor to be used.
- *   size - The current size of the file
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
  *
  * Returned Value:
- *   The new size of the file on success.  A negated errno value on failure.
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int tiff_startstrip(FAR struct tiff_info_s *info);
+
+/****************************************************************************
+ * Name: tiff_compress
+ *
+ * Description:
+ *   Compress image data of the current row and add it to the outfile.  A
+ *   row may be added by several calls.
+ *
+ * Input Parameters:
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
+ *   buffer - The image data in the file format
+ *   count - The number of bytes of image data
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int tiff_compress(FAR struct tiff_info_s *info, FAR const uint8_t *buffer,
+                  size_t count);
+
+/****************************************************************************
+ * Name: tiff_endrow
+ *
+ * Description:
+ *   Complete the compression of a row.
+ *
+ * Input Parameters:
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int tiff_endrow(FAR struct tiff_info_s *info);
+
+/****************************************************************************
+ * Name: tiff_endstrip
+ *
+ * Description:
+ *   Complete the compression of a strip and record its byte count.
+ *
+ * Input Parameters:
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
  *
  ****************************************************************************/
 
-ssize_t tiff_wordalign(int fd, size_t size);
+int tiff_endstrip(FAR struct tiff_info_s *info);
 
 #undef EXTERN
 #if defined(__cplusplus)
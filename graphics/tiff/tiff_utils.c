@@ -120,25 +120,23 @@ uint32_t tiff_get32(FAR uint8_t *src)
 }
 
 /****************************************************************************
- * Name: tiff_read
+ * Name: tiff_write
  *
  * Description:
- *   Read TIFF data from the specified file
+ *   Write TIFF data to the specified file
  *
  * Input Parameters:
- *   fd - Open file descriptor to read from
+ *   fd - Open file descriptor to write to
  *   buffer - Read-only buffer containing the data to be written
  *   count - The number of bytes to write
  *
  * Returned Value:
- *   On success, then number of bytes read; Zero is returned on EOF.
- *   Otherwise, a negated errno value on failure.
+ *   Zero (OK) on success.  A negated errno value on failure.
  *
  ****************************************************************************/
 
-ssize_t tiff_read(int fd, FAR void *buffer, size_t count)
+int tiff_write(int fd, FAR const void *buffer, size_t count)
 {
-  size_t  ntotal;
   ssize_t nbytes;
   int errval;
 
@@ -146,14 +144,11 @@ ssize_t tiff_read(int fd, FAR void *buffer, size_t count)
    * or (2) until an irrecoverble error occurs.
    */
 
-  for (ntotal = 0; ntotal < count; )
+  while (count > 0)
     {
-      /* Do the read.  The number of bytes left to read is the total
-       * requested size (count) minus the amount that we have already read
-       * (ntotal).
-       */
+      /* Do the write */
 
-      nbytes = read(fd, buffer, count-ntotal);
+      nbytes = write(fd, buffer, count);
 
       /* Check for an error */
 
@@ -172,36 +167,52 @@ ssize_t tiff_read(int fd, FAR void *buffer, size_t count)
             }
         }
 
-      /* Zero is a special case and means that the end of file was encountered. */
-
-      else if (nbytes == 0)
-        {
-          break;
-        }
-
-      /* What if read returns some number of bytes other than the requested number?
-       * This probably means that the end-of-file will be encountered the next time
-       * that we call read().
-       */
+      /* What if write returns some number of bytes other than the requested number? */
 
       else
         {
+          DEBUGASSERT(nbytes == count);
           buffer += nbytes;
-          ntotal += nbytes;
+          count  -= nbytes;
         }
     }
 
-  return ntotal;
+  return OK;
 }
 
 /****************************************************************************
- * Name: tiff_write
+ * Name: tiff_flush
  *
  * Description:
- *   Write TIFF data to the specified file
+ *   Write the data collected in the I/O buffer to the outfile.
  *
  * Input Parameters:
- *   fd - Open file descriptor to write to
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int tiff_flush(FAR struct tiff_info_s *info)
+{
+  int ret;
+
+  ret = tiff_write(info->outfd, info->iobuffer, info->iolen);
+  info->iolen = 0;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: tiff_putbuffer
+ *
+ * Description:
+ *   Add data to the outfile through the I/O buffer.
+ *
+ * Input Parameters:
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
  *   buffer - Read-only buffer containing the data to be written
  *   count - The number of bytes to write
  *
@@ -210,46 +221,38 @@ ssize_t tiff_read(int fd, FAR void *buffer, size_t count)
  *
  ****************************************************************************/
 
-int tiff_write(int fd, FAR const void *buffer, size_t count)
+int tiff_putbuffer(FAR struct tiff_info_s *info, FAR const void *buffer,
+                   size_t count)
 {
-  ssize_t nbytes;
-  int errval;
+  FAR const uint8_t *src = buffer;
+  size_t nbytes;
+  int ret;
 
-  /* This loop retries the write until either: (1) it completes successfully,
-   * or (2) until an irrecoverble error occurs.
-   */
+  info->outsize += count;
 
   while (count > 0)
     {
-      /* Do the write */
-
-      nbytes = write(fd, buffer, count);
+      /* Flush the I/O buffer when it becomes full */
 
-      /* Check for an error */
-
-      if (nbytes < 0)
+      if (info->iolen >= info->iosize)
         {
-          /* EINTR is not an error.. this just means that the write was
-           * interrupted by a signal.
-           */
-
-          errval = errno;
-          if (errval != EINTR)
+          ret = tiff_flush(info);
+          if (ret < 0)
             {
-              /* Other errors are bad news and we will break out with an error */
-
-              return -errval;
+              return ret;
             }
         }
 
-      /* What if write returns some number of bytes other than the requested number? */
-
-      else
+      nbytes = info->iosize - info->iolen;
+      if (nbytes > count)
         {
-          DEBUGASSERT(nbytes == count);
-          buffer += nbytes;
-          count  -= nbytes;
+          nbytes = count;
         }
+
+      memcpy(info->iobuffer + info->iolen, src, nbytes);
+      info->iolen += nbytes;
+      src         += nbytes;
+      count       -= nbytes;
     }
 
   return OK;
@@ -262,7 +265,8 @@ int tiff_write(int fd, FAR const void *buffer, size_t count)
  *   Write two bytes to the outfile.
  *
  * Input Parameters:
- *   fd - File descriptor to be used.
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
  *   value - The 2-byte, uint16_t value to write
  *
  * Returned Value:
@@ -270,14 +274,14 @@ int tiff_write(int fd, FAR const void *buffer, size_t count)
  *
  ****************************************************************************/
 
-int tiff_putint16(int fd, uint16_t value)
+int tiff_putint16(FAR struct tiff_info_s *info, uint16_t value)
 {
   uint8_t bytes[2];
 
   /* Write the two bytes to the output file */
 
   tiff_put16(bytes, value);
-  return tiff_write(fd, bytes, 2);
+  return tiff_putbuffer(info, bytes, 2);
 }
 
 /****************************************************************************
@@ -287,7 +291,8 @@ int tiff_putint16(int fd, uint16_t value)
  *   Write four bytes to the outfile.
  *
  * Input Parameters:
- *   fd - File descriptor to be used.
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
  *   value - The 4-byte, uint32_t value to write
  *
  * Returned Value:
@@ -295,14 +300,14 @@ int tiff_putint16(int fd, uint16_t value)
  *
  ****************************************************************************/
 
-int tiff_putint32(int fd, uint32_t value)
+int tiff_putint32(FAR struct tiff_info_s *info, uint32_t value)
 {
   uint8_t bytes[4];
 
   /* Write the four bytes to the output file */
 
   tiff_put32(bytes, value);
-  return tiff_write(fd, bytes, 4);
+  return tiff_putbuffer(info, bytes, 4);
 }
 
 /****************************************************************************
@@ -312,7 +317,8 @@ int tiff_putint32(int fd, uint32_t value)
  *  Write a string of fixed length to the outfile.
  *
  * Input Parameters:
- *   fd - File descriptor to be used.
+ *   info - A pointer to the caller allocated parameter passing/TIFF state
+ *          instance.
  *   string - A pointer to the memory containing the string
  *   len - The length of the string (including the NUL terminator)
  *
@@ -321,48 +327,13 @@ int tiff_putint32(int fd, uint32_t value)
  *
  ****************************************************************************/
 
-int tiff_putstring(int fd, FAR const char *string, int len)
+int tiff_putstring(FAR struct tiff_info_s *info, FAR const char *string,
+                   int len)
 {
 #ifdef CONFIG_DEBUG_GRAPHICS
   int actual = strlen(string);
 
-  DEBUGASSERT(len = actual+1);
+  DEBUGASSERT(len == actual + 1);
 #endif
-  return tiff_write(fd, string, len);
-}
-
-/****************************************************************************
- * Name: tiff_wordalign
- *
- * Description:
- *  Pad a file with zeros as necessary to achieve word alignament.
- *
- * Input Parameters:
- *   fd - File descriptor to be used.
- *   size - The current size of the file
- *
- * Returned Value:
- *   The new size of the file on success.  A negated errno value on failure.
- *
- ****************************************************************************/
-
-ssize_t tiff_wordalign(int fd, size_t size)
-{
-  unsigned int remainder;
-  int ret;
-
-  remainder = size & 3;
-  if (remainder > 0)
-    {
-      unsigned int nbytes = 4 - remainder;
-      uint32_t value      = 0;
-
-      ret = tiff_write(fd, &value, nbytes);
-      if (ret < 0)
-        {
-          return (ssize_t)ret;
-        }
-      size += nbytes;
-    }
-  return size;
+  return tiff_putbuffer(info, string, len);
 }
@@ -31,6 +31,7 @@
 
 #include <sys/types.h>
 #include <stdint.h>
+#include <time.h>
 
 #ifdef CONFIG_GRAPHICS_FT80X
 
@@ -47,6 +48,35 @@
  * Public Types
  ****************************************************************************/
 
+/* Describes a display list segment recorded in RAM G.  A segment holds
+ * display list commands (not co-processor commands) that are added to
+ * later display lists with CMD_APPEND instead of being sent every time.
+ */
+
+struct ft80x_dlseg_s
+{
+  uint32_t offset;   /* Offset of the segment in RAM G */
+  uint32_t maxsize;  /* Size of the RAM G space reserved for the segment */
+  uint32_t size;     /* Size of the recorded display list commands */
+};
+
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+/* Display list timing.  Times are in microseconds from ft80x_dl_start()
+ * until ft80x_dl_end() returns.
+ */
+
+struct ft80x_framestats_s
+{
+  uint32_t nframes;  /* Number of display lists completed */
+  uint32_t last;     /* Time of the last display list */
+  uint32_t xfer;     /* Part of that time spent writing to hardware */
+  uint32_t dlsize;   /* Size of the last display list (bytes) */
+  uint32_t min;      /* Shortest time */
+  uint32_t max;      /* Longest time */
+  uint64_t total;    /* Sum of all times */
+};
+#endif
+
 /* This structure defines the local display list buffer */
 
 struct ft80x_dlbuffer_s
@@ -54,6 +84,12 @@ struct ft80x_dlbuffer_s
   bool coproc;       /* True: Use co-processor FIFO; false: Use DL memory */
   uint16_t dlsize;   /* Total sizeof the display list written to hardware */
   uint16_t dloffset; /* The number display list bytes buffered locally */
+  FAR struct ft80x_dlseg_s *dlseg; /* Segment being recorded, or NULL */
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+  struct timespec start;           /* Time of ft80x_dl_start() */
+  uint32_t xfer;                   /* Time spent writing to hardware */
+  struct ft80x_framestats_s stats; /* Statistics of completed lists */
+#endif
   uint32_t dlbuffer[FT80X_DL_BUFWORDS];
 };
 
@@ -135,7 +171,8 @@ int ft80x_dl_start(int fd, FAR struct ft80x_dlbuffer_s *buffer, bool coproc);
  *      buffer offset to zero.
  *   4) Swap to the newly created display list (DL memory case only).
  *   5) For the case of the co-processor RAM CMD, it will also wait for the
- *      FIFO to be emptied.
+ *      FIFO to be emptied (unless CONFIG_GRAPHICS_FT80X_PIPELINE is
+ *      selected).
  *
  * Input Parameters:
  *   fd     - The file descriptor of the FT80x device.  Opened by the caller
@@ -253,6 +290,121 @@ int ft80x_dl_create(int fd, FAR struct ft80x_dlbuffer_s *buffer,
                     FAR const uint32_t *cmds, unsigned int nwords,
                     bool coproc);
 
+/****************************************************************************
+ * Name: ft80x_dlseg_start
+ *
+ * Description:
+ *   Start recording a display list segment into RAM G.  Display list
+ *   commands added to the buffer with ft80x_dl_data() and
+ *   ft80x_dl_string() are then written to RAM G instead of to the display
+ *   list, until ft80x_dlseg_end() is called.  Only display list commands
+ *   may be recorded, not co-processor commands.
+ *
+ *   The buffer must not hold a display list that is being formed; a
+ *   separate buffer may be used for recording.
+ *
+ * Input Parameters:
+ *   fd      - The file descriptor of the FT80x device.  Opened by the
+ *             caller with write access.
+ *   buffer  - An instance of struct ft80x_dlbuffer_s allocated by the
+ *             caller.
+ *   dlseg   - The segment to be recorded.
+ *   offset  - Offset in RAM G where the segment is stored.  Must be a
+ *             multiple of 4.
+ *   maxsize - The size of the RAM G space reserved for the segment.
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int ft80x_dlseg_start(int fd, FAR struct ft80x_dlbuffer_s *buffer,
+                      FAR struct ft80x_dlseg_s *dlseg, uint32_t offset,
+                      uint32_t maxsize);
+
+/****************************************************************************
+ * Name: ft80x_dlseg_end
+ *
+ * Description:
+ *   Finish recording the display list segment started with
+ *   ft80x_dlseg_start().  The segment may then be added to any number of
+ *   display lists with ft80x_dlseg_append() for as long as its RAM G space
+ *   is not used otherwise.
+ *
+ * Input Parameters:
+ *   fd     - The file descriptor of the FT80x device.  Opened by the caller
+ *            with write access.
+ *   buffer - The buffer passed to ft80x_dlseg_start().
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure; -ENOSPC if
+ *   the segment did not fit into its RAM G space.
+ *
+ ****************************************************************************/
+
+int ft80x_dlseg_end(int fd, FAR struct ft80x_dlbuffer_s *buffer);
+
+/****************************************************************************
+ * Name: ft80x_dlseg_append
+ *
+ * Description:
+ *   Add a recorded display list segment to the display list being formed
+ *   with a CMD_APPEND command.  The co-processor copies the segment from
+ *   RAM G, so that only the 12 byte command is sent over the bus.  This
+ *   requires a display list started with coproc == true.
+ *
+ * Input Parameters:
+ *   fd     - The file descriptor of the FT80x device.  Opened by the caller
+ *            with write access.
+ *   buffer - An instance of struct ft80x_dlbuffer_s allocated by the caller.
+ *   dlseg  - The segment recorded with ft80x_dlseg_start/end().
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  A negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int ft80x_dlseg_append(int fd, FAR struct ft80x_dlbuffer_s *buffer,
+                       FAR const struct ft80x_dlseg_s *dlseg);
+
+#ifdef CONFIG_GRAPHICS_FT80X_FRAMESTATS
+/****************************************************************************
+ * Name: ft80x_dl_getstats
+ *
+ * Description:
+ *   Return the timing of the display lists completed with the buffer
+ *   since the last ft80x_dl_resetstats().
+ *
+ * Input Parameters:
+ *   buffer - An instance of struct ft80x_dlbuffer_s allocated by the caller.
+ *   stats  - The location to return the statistics.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void ft80x_dl_getstats(FAR const struct ft80x_dlbuffer_s *buffer,
+                       FAR struct ft80x_framestats_s *stats);
+
+/****************************************************************************
+ * Name: ft80x_dl_resetstats
+ *
+ * Description:
+ *   Reset the display list timing.  This must be called once before the
+ *   first display list is started with a newly allocated buffer.
+ *
+ * Input Parameters:
+ *   buffer - An instance of struct ft80x_dlbuffer_s allocated by the caller.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void ft80x_dl_resetstats(FAR struct ft80x_dlbuffer_s *buffer);
+#endif
+
 /****************************************************************************
  * Name: ft80x_coproc_send
  *
@@ -41,6 +41,14 @@
 
 /* Configuration ************************************************************/
 
+#ifndef CONFIG_TIFF_STRIPSIZE
+#  define CONFIG_TIFF_STRIPSIZE 8192
+#endif
+
+/* The smallest I/O buffer that tiff_initialize() accepts */
+
+#define TIFF_IOBUFFER_MIN           256
+
 /* TIFF File Format Definitions *********************************************/
 
 /* Values for the IFD field type */
@@ -251,14 +259,6 @@ struct tiff_ifdentry_s
  * also structures used only internally by the TIFF file creation library).
  */
 
-/* This structure describes on strip in tmpfile2 */
-
-struct tiff_strip_s
-{
-  uint32_t offset; /* Offset to the strip data in tmpfile1 */
-  uint32_t count;  /* Count of pixels in the strip */
-};
-
 /* This structure is used only internally by the TIFF file creation library
  * to manage file offsets.
  */
@@ -285,11 +285,8 @@ struct tiff_info_s
   /* The first fields are used to pass information to the TIFF file creation
    * logic via tiff_initialize().
    *
-   * Filenames.  Three file names are required.  (1) path to the final
-   * output file and (2) two paths to temporary files.  One temporary file
-   * (tmpfile1) will be used to hold the strip image data and the other
-   * (tmpfile2) will be used to hold strip offset and count information.
-   *
+   * outfile   - Full path to the output file.  The file is written in a
+   *             single pass; no temporary files are needed.
    * colorfmt  - Specifies the form of the color data that will be provided
    *             in the strip data.  These are the FB_FMT_* definitions
    *             provided in include/nuttx/video/fb.h.  Only the following
@@ -301,23 +298,27 @@ struct tiff_info_s
    *             FB_FMT_RGB16_565        BPP=16 R=6, G=6, B=5
    *             FB_FMT_RGB24            BPP=24 R=8, G=8, B=8
    *
-   * rps       - TIFF RowsPerStrip
+   * compress  - TIFF Compression of the image data:  TAG_COMP_NONE (or
+   *             zero), TAG_COMP_PACKBITS (CONFIG_TIFF_PACKBITS) or
+   *             TAG_COMP_LZW (CONFIG_TIFF_LZW).
+   * rps       - Rows provided by each call to tiff_addstrip().  Rows are
+   *             collected into TIFF strips of about CONFIG_TIFF_STRIPSIZE
+   *             bytes, so this need not be the TIFF RowsPerStrip.
    * imgwidth  - TIFF ImageWidth, Number of columns in the image
    * imgheight - TIFF ImageLength, Number of rows in the image
    */
 
   FAR const char *outfile;  /* Full path to the final output file name */
-  FAR const char *tmpfile1; /* Full path to first temporary file */
-  FAR const char *tmpfile2; /* Full path to second temporary file */
 
   uint8_t      colorfmt;    /* See FB_FMT_* definitions in include/nuttx/video/fb.h */
-  nxgl_coord_t rps;         /* TIFF RowsPerStrip */
+  uint16_t     compress;    /* TAG_COMP_* compression of the strips */
+  nxgl_coord_t rps;         /* Rows per call to tiff_addstrip() */
   nxgl_coord_t imgwidth;    /* TIFF ImageWidth, Number of columns in the image */
   nxgl_coord_t imgheight;   /* TIFF ImageLength, Number of rows in the image */
 
-  /* The caller must provide an I/O buffer as well.  This I/O buffer will
-   * used for color conversions and as the intermediate buffer for copying
-   * files.  The larger the buffer, the better the performance.
+  /* The caller must provide an I/O buffer as well.  All output to the file
+   * is collected in this buffer, so the larger the buffer, the fewer and
+   * larger the writes.  It must hold at least TIFF_IOBUFFER_MIN bytes.
    */
 
   FAR uint8_t *iobuffer;    /* IO buffer allocated by the caller */
@@ -332,15 +333,29 @@ struct tiff_info_s
    */
 
   uint8_t      imgflags;    /* Bit-encoded image flags */
-  nxgl_coord_t nstrips;     /* Number of strips in tmpfile3 */
-  size_t       pps;         /* Pixels per strip */
-  size_t       bps;         /* Bytes per strip */
+  nxgl_coord_t nstrips;     /* Number of strips completed */
+  nxgl_coord_t maxstrips;   /* Number of strips in the image */
+  nxgl_coord_t stripheight; /* TIFF RowsPerStrip */
+  nxgl_coord_t nrows;       /* Number of rows added */
+  size_t       rowsize;     /* Bytes per row in the file */
   int          outfd;       /* outfile file descriptor */
-  int          tmp1fd;      /* tmpfile1 file descriptor */
-  int          tmp2fd;      /* tmpfile2 file descriptor */
-  off_t        outsize;     /* Current size of outfile */
-  off_t        tmp1size;    /* Current size of tmpfile1 */
-  off_t        tmp2size;    /* Current size of tmpfile2 */
+  off_t        outsize;     /* Size of outfile, including iobuffer */
+  off_t        dataoffset;  /* Offset to the first strip */
+  off_t        stripstart;  /* Offset to the strip being added */
+  unsigned int iolen;       /* Bytes in iobuffer */
+  FAR uint32_t *stripcounts; /* StripByteCounts, one per strip */
+
+  /* Compression state */
+
+  int          litpos;      /* PackBits: iobuffer index of literal run */
+  uint8_t      runbyte;     /* PackBits: Byte being repeated */
+  uint8_t      runcount;    /* PackBits: Times runbyte was seen */
+  uint8_t      nbits;       /* LZW: Current code width */
+  uint8_t      bitcount;    /* LZW: Bits in bitbuffer */
+  uint32_t     bitbuffer;   /* LZW: Bits not yet written */
+  int          prefix;      /* LZW: Code of the current string */
+  uint16_t     nextcode;    /* LZW: Next code to assign */
+  FAR uint32_t *lzwtable;   /* LZW: String table, hashed */
 
   /* Points to an internal constant structure of file offsets */
 
@@ -371,6 +386,10 @@ extern "C"
  *   3) Call tiff_addstrip() repeatedly to add strips to the graphic image
  *   4) Call tiff_finalize() to complete the file creation.
  *
+ *   The strip data follows the IFD directly.  The StripByteCounts and
+ *   StripOffsets values are reserved in front of it and filled in by
+ *   tiff_finalize(), so the file is written in one pass.
+ *
  * Input Parameters:
  *   info - A pointer to the caller allocated parameter passing/TIFF state
  *          instance.
@@ -386,14 +405,15 @@ int tiff_initialize(FAR struct tiff_info_s *info);
  * Name: tiff_addstrip
  *
  * Description:
- *   Add an image data strip.  The size of the strip in pixels
- *    must be equal to the RowsPerStrip x ImageWidth values
- *    that were provided to tiff_initialize().
+ *   Add an image data strip.  The strip holds rps rows of ImageWidth
+ *   pixels as provided to tiff_initialize(), each row starting on a byte
+ *   boundary.  Only the rows up to ImageLength are used from the last
+ *   strip.
  *
  * Input Parameters:
  *   info    - A pointer to the caller allocated parameter passing/TIFF state
  *             instance.
- *   buffer  - A buffer containing a single row of data.
+ *   strip   - A buffer containing rps rows of data.
  *
  * Returned Value:
  *   Zero (OK) on success.  A negated errno value on failure.
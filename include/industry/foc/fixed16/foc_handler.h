@@ -35,6 +35,14 @@
 #  include "industry/foc/fixed16/foc_cordic.h"
 #endif
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_INDUSTRY_FOC_BATCH_MAX
+#  define CONFIG_INDUSTRY_FOC_BATCH_MAX 4
+#endif
+
 /****************************************************************************
  * Public Type Definition
  ****************************************************************************/
@@ -229,6 +237,15 @@ int foc_handler_run_b16(FAR foc_handler_b16_t *h,
                         FAR struct foc_handler_input_b16_s *in,
                         FAR struct foc_handler_output_b16_s *out);
 
+/****************************************************************************
+ * Name: foc_handler_run_batch_b16
+ ****************************************************************************/
+
+int foc_handler_run_batch_b16(FAR foc_handler_b16_t **h,
+                              FAR struct foc_handler_input_b16_s *in,
+                              FAR struct foc_handler_output_b16_s *out,
+                              int n);
+
 /****************************************************************************
  * Name: foc_handler_cfg_b16
  ****************************************************************************/
@@ -35,6 +35,14 @@
 #  include "industry/foc/float/foc_cordic.h"
 #endif
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_INDUSTRY_FOC_BATCH_MAX
+#  define CONFIG_INDUSTRY_FOC_BATCH_MAX 4
+#endif
+
 /****************************************************************************
  * Public Type Definition
  ****************************************************************************/
@@ -230,6 +238,15 @@ int foc_handler_run_f32(FAR foc_handler_f32_t *h,
                         FAR struct foc_handler_input_f32_s *in,
                         FAR struct foc_handler_output_f32_s *out);
 
+/****************************************************************************
+ * Name: foc_handler_run_batch_f32
+ ****************************************************************************/
+
+int foc_handler_run_batch_f32(FAR foc_handler_f32_t **h,
+                              FAR struct foc_handler_input_f32_s *in,
+                              FAR struct foc_handler_output_f32_s *out,
+                              int n);
+
 /****************************************************************************
  * Name: foc_handler_cfg_f32
  ****************************************************************************/
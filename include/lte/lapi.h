@@ -28,16 +28,47 @@
  ****************************************************************************/
 
 #include <stdint.h>
+#include <nuttx/wireless/lte/lte_ioctl.h>
 #include "lte/lte_api.h"
 
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Number of commands with their own latency counters.  Commands beyond
+ * that share the entry with the command ID LAPI_CMDSTAT_OTHERS.
+ */
+
+#define LAPI_CMDSTAT_MAXCMDS 16
+#define LAPI_CMDSTAT_OTHERS  0xffffffff
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
+/* Latency counters of one command */
+
+struct lapi_cmdlatency_s
+{
+  uint32_t cmdid;             /* Command ID */
+  uint32_t count;             /* Number of responses */
+  uint32_t total_ms;          /* Sum of the latencies */
+  uint32_t max_ms;            /* Largest latency */
+};
+
+/* Modem command statistics of the daemon */
+
+struct lapi_cmdstat_s
+{
+  uint16_t inflight;          /* Commands waiting for their response */
+  uint16_t inflight_max;      /* Most commands in flight at once */
+  uint16_t containers;        /* Containers currently allocated */
+  uint16_t containers_max;    /* Most containers allocated at once */
+  uint32_t nocontainer;       /* Requests deferred for lack of container */
+  uint32_t ncmds;             /* Valid entries of cmds */
+  struct lapi_cmdlatency_s cmds[LAPI_CMDSTAT_MAXCMDS];
+};
+
 #ifdef __cplusplus
 #define EXTERN extern "C"
 extern "C"
@@ -75,6 +106,23 @@ int lapi_evtyield(int timeout_ms);
 int lapi_req(uint32_t cmdid, FAR void *inp, size_t insz, FAR void *outp,
              size_t outsz, FAR void *cb);
 
+/****************************************************************************
+ * Name: lapi_getcmdstat
+ *
+ * Description:
+ *   Get the number of modem commands in flight, the container usage and
+ *   the response latency of each command since the daemon started.
+ *
+ *   The daemon answers LTE_CMDID_GETCMDSTAT itself, without the modem.
+ *   The command ID belongs to nuttx/wireless/lte/lte_ioctl.h, so this is
+ *   only available with a kernel that defines it.
+ *
+ ****************************************************************************/
+
+#ifdef LTE_CMDID_GETCMDSTAT
+int lapi_getcmdstat(FAR struct lapi_cmdstat_s *stat);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
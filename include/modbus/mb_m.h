@@ -97,6 +97,22 @@ typedef enum
     MB_MRE_EXE_FUN                  /* execute function error. */
 } eMBMasterReqErrCode;
 
+/* Opaque Modbus Master instance.  Each instance owns one serial port and
+ * all protocol state for it.
+ */
+
+typedef struct xMBMasterInstance xMBMasterInstance;
+
+/* Register tables that can be read through the master poll list. */
+
+typedef enum
+{
+    MB_MQ_REG_HOLDING,              /* holding registers. */
+    MB_MQ_REG_INPUT,                /* input registers. */
+    MB_MQ_REG_COILS,                /* coils. */
+    MB_MQ_REG_DISCRETE              /* discrete inputs. */
+} eMBMasterQueueRegType;
+
 /* TimerMode is Master 3 kind of Timer modes. */
 
 typedef enum
@@ -444,6 +460,84 @@ eMBException eMBMasterFuncReadDiscreteInputs(uint8_t *pucFrame,
 eMBException eMBMasterFuncReadWriteMultipleHoldingRegister(uint8_t *pucFrame,
   uint16_t *usLen);
 
+#ifdef CONFIG_MB_MASTER_MULTI_INSTANCE
+
+/****************************************************************************
+ * Description:
+ *   Create and destroy Modbus Master instances.
+ *
+ *   All other Modbus Master functions operate on the instance selected by
+ *   the calling thread with vMBMasterInstanceSelect().  A thread which
+ *   never selected an instance uses a built-in default instance, so
+ *   applications driving a single port need no changes.  Both the thread
+ *   calling eMBMasterPoll() and the threads issuing requests for a port
+ *   must select that port's instance.
+ *
+ ****************************************************************************/
+
+xMBMasterInstance *pxMBMasterInstanceCreate(void);
+void vMBMasterInstanceDelete(xMBMasterInstance *pxInst);
+void vMBMasterInstanceSelect(xMBMasterInstance *pxInst);
+xMBMasterInstance *pxMBMasterInstanceGet(void);
+
+#endif
+
+#ifdef CONFIG_MB_MASTER_QUEUE
+
+/****************************************************************************
+ * Description:
+ *   Add a read request to the poll list of the selected instance.
+ *
+ *   Requests to the same slave and register table whose address ranges
+ *   overlap or lie within CONFIG_MB_MASTER_QUEUE_GAP of each other are
+ *   merged into a single Modbus request, as long as the result does not
+ *   exceed the maximum count allowed by the protocol.  The data is
+ *   delivered through the usual eMBMasterReg*CB() callbacks, with the
+ *   address range of the merged request.
+ *
+ * Returned Value:
+ *   MB_MRE_NO_ERR on success, MB_MRE_ILL_ARG for an invalid slave
+ *   address or range, or MB_MRE_MASTER_BUSY if the poll list is full.
+ *
+ ****************************************************************************/
+
+eMBMasterReqErrCode eMBMasterQueueRead(uint8_t ucSndAddr,
+                                       eMBMasterQueueRegType eType,
+                                       uint16_t usRegAddr,
+                                       uint16_t usNRegs);
+
+/****************************************************************************
+ * Description:
+ *   Remove all requests from the poll list of the selected instance.
+ *
+ ****************************************************************************/
+
+void vMBMasterQueueFlush(void);
+
+/****************************************************************************
+ * Description:
+ *   Execute the poll list of the selected instance once.
+ *
+ *   Requests are issued back to back, rotating between slaves so that
+ *   every slave is served once before any slave is served again.  When a
+ *   slave does not respond, its remaining requests are skipped and the
+ *   slave is left out of the next CONFIG_MB_MASTER_QUEUE_BACKOFF runs, so
+ *   a dead slave does not add a response timeout per request to every
+ *   poll cycle.
+ *
+ * Input Parameters:
+ *   lTimeOut Passed to the request functions, see
+ *     eMBMasterReqReadHoldingRegister().
+ *
+ * Returned Value:
+ *   MB_MRE_NO_ERR if all requests succeeded, otherwise the first error.
+ *
+ ****************************************************************************/
+
+eMBMasterReqErrCode eMBMasterQueueRun(uint32_t lTimeOut);
+
+#endif
+
 /* These functions are interface for Modbus Master */
 
 void vMBMasterGetPDUSndBuf(uint8_t **pucFrame);
@@ -109,10 +109,6 @@ extern bool(*pxMBFrameCBByteReceived)(void);
 extern bool(*pxMBFrameCBTransmitterEmpty)(void);
 extern bool(*pxMBPortCBTimerExpired)(void);
 
-extern bool(*pxMBMasterFrameCBByteReceived)(void);
-extern bool(*pxMBMasterFrameCBTransmitterEmpty)(void);
-extern bool(*pxMBMasterPortCBTimerExpired)(void);
-
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -173,6 +169,15 @@ void vMBMasterErrorCBExecuteFunction(uint8_t ucDestAddress, const uint8_t *pucPD
                                      uint16_t ucPDULength);
 void vMBMasterCBRequestSuccess(void);
 
+#ifdef CONFIG_MB_CRC16_ARCH
+/* CRC16 of a RTU frame computed by the port, e.g. with a CRC peripheral.
+ * Polynomial 0xa001 (reflected), initial value 0xffff, the low byte of the
+ * result is transmitted first.
+ */
+
+uint16_t usMBPortCRC16(const uint8_t *pucFrame, uint16_t usLen);
+#endif
+
 #ifdef CONFIG_MB_TCP_ENABLED
 /* TCP port function */
 
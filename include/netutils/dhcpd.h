@@ -49,6 +49,18 @@
  * Public Types
  ****************************************************************************/
 
+/* Address pool served on one interface, see dhcpd_set_pool().  All
+ * addresses are in host order; an option set to zero is not sent.
+ */
+
+struct dhcpd_pool_s
+{
+  in_addr_t startip;   /* First address handed out */
+  in_addr_t routerip;  /* Router option */
+  in_addr_t netmask;   /* Subnet mask option */
+  in_addr_t dnsip;     /* DNS server option */
+};
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -68,6 +80,8 @@ int dhcpd_set_startip(in_addr_t startip);
 int dhcpd_set_routerip(in_addr_t routerip);
 int dhcpd_set_netmask(in_addr_t netmask);
 int dhcpd_set_dnsip(in_addr_t dnsip);
+int dhcpd_set_pool(FAR const char *interface,
+                   FAR const struct dhcpd_pool_s *pool);
 
 #undef EXTERN
 #ifdef __cplusplus
@@ -31,6 +31,8 @@
 
 #include <sys/socket.h>
 
+#include <stdbool.h>
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -149,10 +151,12 @@ struct ntpc_status_s
   /* the latest samples */
 
   unsigned int nsamples;
+  unsigned int poll;         /* Current poll interval in seconds */
   struct
   {
     int64_t offset;
     int64_t delay;
+    bool selected;           /* Not rejected as falseticker */
     FAR const struct sockaddr *srv_addr;
     struct sockaddr_storage _srv_addr_store;
   }
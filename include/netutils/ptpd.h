@@ -33,6 +33,15 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Histograms of ptpd_status_s use logarithmic bins: bin 0 counts values
+ * below 2^PTPD_HISTOGRAM_SHIFT ns, bin n values from
+ * 2^(PTPD_HISTOGRAM_SHIFT + n - 1) ns up to twice that, and the last bin
+ * everything larger.
+ */
+
+#define PTPD_HISTOGRAM_BINS  16
+#define PTPD_HISTOGRAM_SHIFT 5
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -94,6 +103,23 @@ struct ptpd_status_s
 
   long path_delay_ns;
 
+  /* Statistics of the measured clock error since the clock source was
+   * selected.  Jitter is the change of the clock error between two
+   * measurements.
+   */
+
+  unsigned long samples;
+  int64_t offset_min_ns;
+  int64_t offset_max_ns;
+  long jitter_ns;            /* Smoothed jitter */
+  uint32_t offset_histogram[PTPD_HISTOGRAM_BINS];
+  uint32_t jitter_histogram[PTPD_HISTOGRAM_BINS];
+
+  /* Server statistics */
+
+  int unicast_clients;       /* Clients with a unicast grant */
+  unsigned long delayresp_count;
+
   /* Timestamps of latest received packets (CLOCK_MONOTONIC) */
 
   struct timespec last_received_multicast; /* Any multicast packet */
@@ -116,6 +116,25 @@
  */
 #define WEBCLIENT_FLAG_TUNNEL 2U
 
+/* WEBCLIENT_FLAG_KEEP_ALIVE: Reuse the connection
+ *
+ * With CONFIG_WEBCLIENT_KEEPALIVE, an HTTP/1.1 request with this flag
+ * does not ask the server to close the connection.  Once the response
+ * has been received in full, the connection is kept for the next request
+ * to the same host, port and TLS context, for up to
+ * CONFIG_WEBCLIENT_KEEPALIVE_IDLETIME seconds.
+ *
+ * If a reused connection turns out to be closed by the server before
+ * any response is received, the request is sent again on a new
+ * connection.  This requires a request body set with
+ * webclient_set_static_body(), or no body.
+ *
+ * The flag is ignored without CONFIG_WEBCLIENT_KEEPALIVE, for HTTP/1.0,
+ * with a proxy and with WEBCLIENT_FLAG_NON_BLOCKING.
+ */
+
+#define WEBCLIENT_FLAG_KEEP_ALIVE 4U
+
 /* The following WEBCLIENT_FLAG_xxx constants are for
  * webclient_poll_info::flags.
  */
@@ -230,6 +249,7 @@ typedef CODE int (*webclient_body_callback_t)(
     FAR void *ctx);
 
 struct webclient_tls_connection;
+struct webclient_tls_session;
 struct webclient_poll_info;
 struct webclient_conn_s;
 
@@ -269,6 +289,34 @@ struct webclient_tls_ops
                               FAR const char *hostname,
                               unsigned int timeout_second,
                               FAR struct webclient_tls_connection **connp);
+
+  /* TLS session resumption (CONFIG_WEBCLIENT_TLS_SESSIONS)
+   *
+   * connect_with_session: Same as connect, but resume the given session
+   *   if the server agrees.  session can be NULL.  The implementation
+   *   should not keep a reference to session after returning.
+   *
+   * get_session: Return a copy of the session of an established
+   *   connection in *sessionp, to be resumed by a later connection to
+   *   the same server.
+   *
+   * free_session: Release a session returned by get_session.
+   *
+   * These methods can be NULL.  All three are needed for resumption.
+   */
+
+  CODE int (*connect_with_session)(FAR void *ctx,
+                                   FAR const char *hostname,
+                                   FAR const char *port,
+                                   unsigned int timeout_second,
+                                   FAR struct webclient_tls_session *session,
+                                   FAR struct webclient_tls_connection
+                                   **connp);
+  CODE int (*get_session)(FAR void *ctx,
+                          FAR struct webclient_tls_connection *conn,
+                          FAR struct webclient_tls_session **sessionp);
+  CODE void (*free_session)(FAR void *ctx,
+                            FAR struct webclient_tls_session *session);
 };
 
 /* Note on webclient_client lifetime
@@ -571,6 +619,7 @@ ssize_t webclient_conn_recv(FAR struct webclient_conn_s *conn,
                             FAR void *buffer, size_t len);
 void webclient_conn_close(FAR struct webclient_conn_s *conn);
 void webclient_conn_free(FAR struct webclient_conn_s *conn);
+void webclient_flush_cache(void);
 
 #undef EXTERN
 #ifdef __cplusplus
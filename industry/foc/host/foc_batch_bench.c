@@ -0,0 +1,289 @@
+/****************************************************************************
+ * apps/industry/foc/host/foc_batch_bench.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Host benchmark of foc_handler_run_batch_f32().  Two identical sets of
+ * motors, each one a PMSM model closed over a PI current controller with
+ * SVM3 modulation, are stepped side by side: one set calls
+ * foc_handler_run_f32() per axis, the other steps all axes with one
+ * foc_handler_run_batch_f32() call.  The duty cycles of both sets must be
+ * identical at every step; the time spent in the handlers is reported per
+ * axis and step.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "industry/foc/foc_common.h"
+#include "industry/foc/float/foc_handler.h"
+#include "industry/foc/float/foc_model.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BENCH_AXES      CONFIG_INDUSTRY_FOC_BATCH_MAX
+#define BENCH_STEPS     1000000
+
+#define BENCH_PER       (1.0f / 10000.0f) /* 10 kHz control loop */
+#define BENCH_VBUS      (12.0f)
+#define BENCH_IQREF     (0.5f)
+#define BENCH_LOAD      (0.0f)
+#define BENCH_KP        (0.05f)
+#define BENCH_KI        (0.002f)
+
+#define BENCH_POLES     7
+#define BENCH_RES       (0.11f)
+#define BENCH_IND       (0.0002f)
+#define BENCH_INER      (0.1f)
+#define BENCH_FLUX      (0.001f)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bench_axis_s
+{
+  foc_handler_f32_t               handler;
+  foc_model_f32_t                 model;
+  struct foc_model_state_f32_s    state;
+  struct foc_handler_input_f32_s  in;
+  struct foc_handler_output_f32_s out;
+  struct foc_state_f32_s          foc;
+  dq_frame_f32_t                  dq_ref;
+  dq_frame_f32_t                  vdq_comp;
+  float                           current[CONFIG_MOTOR_FOC_PHASES];
+  float                           angle;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct bench_axis_s g_single[BENCH_AXES];
+static struct bench_axis_s g_batch[BENCH_AXES];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint64_t bench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int bench_axis_init(FAR struct bench_axis_s *axis, int i)
+{
+  struct foc_initdata_f32_s       ctrl_cfg;
+  struct foc_mod_cfg_f32_s        mod_cfg;
+  struct foc_model_pmsm_cfg_f32_s pmsm_cfg;
+  int                             ret;
+
+  memset(axis, 0, sizeof(*axis));
+
+  ret = foc_handler_init_f32(&axis->handler, &g_foc_control_pi_f32,
+                             &g_foc_mod_svm3_f32);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ctrl_cfg.id_kp = BENCH_KP;
+  ctrl_cfg.id_ki = BENCH_KI;
+  ctrl_cfg.iq_kp = BENCH_KP;
+  ctrl_cfg.iq_ki = BENCH_KI;
+  mod_cfg.pwm_duty_max = 0.95f;
+  foc_handler_cfg_f32(&axis->handler, &ctrl_cfg, &mod_cfg);
+
+  ret = foc_model_init_f32(&axis->model, &g_foc_model_pmsm_ops_f32);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  pmsm_cfg.poles      = BENCH_POLES;
+  pmsm_cfg.res        = BENCH_RES;
+  pmsm_cfg.ind        = BENCH_IND;
+  pmsm_cfg.iner       = BENCH_INER;
+  pmsm_cfg.flux_link  = BENCH_FLUX;
+  pmsm_cfg.ind_d      = BENCH_IND;
+  pmsm_cfg.ind_q      = BENCH_IND;
+  pmsm_cfg.per        = BENCH_PER;
+  pmsm_cfg.iphase_adc = 1.0f;
+  foc_model_cfg_f32(&axis->model, &pmsm_cfg);
+
+  /* Every axis gets a different torque request */
+
+  axis->dq_ref.d    = 0.0f;
+  axis->dq_ref.q    = BENCH_IQREF * (1 + i);
+  axis->in.current  = axis->current;
+  axis->in.dq_ref   = &axis->dq_ref;
+  axis->in.vdq_comp = &axis->vdq_comp;
+  axis->in.vbus     = BENCH_VBUS;
+  axis->in.mode     = FOC_HANDLER_MODE_CURRENT;
+
+  return OK;
+}
+
+/* Sample the model and prepare the handler input */
+
+static void bench_axis_sense(FAR struct bench_axis_s *axis)
+{
+  foc_model_state_f32(&axis->model, &axis->state);
+
+  memcpy(axis->current, axis->state.curr, sizeof(axis->current));
+
+  /* The model reports the electrical speed, integrate it for the angle */
+
+  axis->angle += axis->state.omega_e * BENCH_PER;
+  angle_norm_2pi(&axis->angle, 0.0f, 2.0f * M_PI);
+  axis->in.angle = axis->angle;
+}
+
+/* Apply the new phase voltages to the model */
+
+static void bench_axis_actuate(FAR struct bench_axis_s *axis)
+{
+  foc_handler_state_f32(&axis->handler, &axis->foc, NULL);
+  foc_model_run_f32(&axis->model, BENCH_LOAD, &axis->foc.vab);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  FAR foc_handler_f32_t *handlers[BENCH_AXES];
+  struct foc_handler_input_f32_s in[BENCH_AXES];
+  struct foc_handler_output_f32_s out[BENCH_AXES];
+  unsigned long steps = BENCH_STEPS;
+  unsigned long step;
+  uint64_t t_single = 0;
+  uint64_t t_batch = 0;
+  uint64_t start;
+  int axes = BENCH_AXES;
+  int i;
+
+  if (argc > 1)
+    {
+      steps = strtoul(argv[1], NULL, 0);
+    }
+
+  if (argc > 2)
+    {
+      axes = atoi(argv[2]);
+      if (axes < 1 || axes > BENCH_AXES)
+        {
+          fprintf(stderr, "ERROR: 1..%d axes supported\n", BENCH_AXES);
+          return EXIT_FAILURE;
+        }
+    }
+
+  for (i = 0; i < axes; i++)
+    {
+      if (bench_axis_init(&g_single[i], i) < 0 ||
+          bench_axis_init(&g_batch[i], i) < 0)
+        {
+          fprintf(stderr, "ERROR: axis %d initialization failed\n", i);
+          return EXIT_FAILURE;
+        }
+
+      handlers[i] = &g_batch[i].handler;
+    }
+
+  for (step = 0; step < steps; step++)
+    {
+      for (i = 0; i < axes; i++)
+        {
+          bench_axis_sense(&g_single[i]);
+          bench_axis_sense(&g_batch[i]);
+          in[i] = g_batch[i].in;
+        }
+
+      /* One call per axis */
+
+      start = bench_now();
+      for (i = 0; i < axes; i++)
+        {
+          foc_handler_run_f32(&g_single[i].handler, &g_single[i].in,
+                              &g_single[i].out);
+        }
+
+      t_single += bench_now() - start;
+
+      /* All axes in one call */
+
+      start = bench_now();
+      foc_handler_run_batch_f32(handlers, in, out, axes);
+      t_batch += bench_now() - start;
+
+      for (i = 0; i < axes; i++)
+        {
+          if (memcmp(g_single[i].out.duty, out[i].duty,
+                     sizeof(out[i].duty)) != 0)
+            {
+              fprintf(stderr, "FAIL: axis %d step %lu: duty differs\n",
+                      i, step);
+              return EXIT_FAILURE;
+            }
+
+          g_batch[i].out = out[i];
+          bench_axis_actuate(&g_single[i]);
+          bench_axis_actuate(&g_batch[i]);
+        }
+    }
+
+  printf("%lu steps x %d axes, batched output identical\n", steps, axes);
+  for (i = 0; i < axes; i++)
+    {
+      printf("  axis %d: iq %.3f A (ref %.3f), omega_m %.1f rad/s\n", i,
+             g_batch[i].foc.idq.q, g_batch[i].dq_ref.q,
+             g_batch[i].state.omega_m);
+    }
+
+  printf("foc_handler_run_f32:       %6.1f ns per axis and step\n",
+         (double)t_single / steps / axes);
+  printf("foc_handler_run_batch_f32: %6.1f ns per axis and step\n",
+         (double)t_batch / steps / axes);
+
+  for (i = 0; i < axes; i++)
+    {
+      foc_handler_deinit_f32(&g_single[i].handler);
+      foc_handler_deinit_f32(&g_batch[i].handler);
+      foc_model_deinit_f32(&g_single[i].model);
+      foc_model_deinit_f32(&g_batch[i].model);
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/****************************************************************************
+ * apps/industry/foc/host/foc_sim.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INDUSTRY_FOC_HOST_FOC_SIM_H
+#define __APPS_INDUSTRY_FOC_HOST_FOC_SIM_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Simulated drive.  The plant is always the float PMSM model, so both
+ * control stacks are measured against the same physics.
+ */
+
+#define FOC_SIM_PER        (1.0f / 10000.0f) /* 10 kHz control loop */
+#define FOC_SIM_VBUS       (12.0f)
+#define FOC_SIM_DUTY_MAX   (0.95f)
+#define FOC_SIM_IQREF      (1.0f)
+#define FOC_SIM_DAMP       (0.0001f)         /* Viscous load [Nm*s/rad] */
+#define FOC_SIM_KP         (0.05f)
+#define FOC_SIM_KI         (0.002f)
+
+#define FOC_SIM_POLES      7
+#define FOC_SIM_RES        (0.11f)
+#define FOC_SIM_IND        (0.0002f)
+#define FOC_SIM_INER       (0.0001f)
+#define FOC_SIM_FLUX       (0.001f)
+
+/* Observers */
+
+#define FOC_SIM_SMO_KSLIDE (1.0f)
+#define FOC_SIM_SMO_ERRMAX (1.0f)
+#define FOC_SIM_NFO_GAIN   (30000.0f)
+#define FOC_SIM_NFO_SLOW   (10.0f)
+#define FOC_SIM_DIV_SAMPLES 10
+#define FOC_SIM_DIV_FILTER (0.99f)
+#define FOC_SIM_PLL_KP     (1000.0f)
+#define FOC_SIM_PLL_KI     (100000.0f)
+
+/* Tracking errors are only accumulated once the drive has settled */
+
+#define FOC_SIM_SETTLE(steps) ((steps) / 10)
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Timed components of one control step */
+
+enum foc_sim_comp_e
+{
+  FOC_SIM_MODEL = 0,            /* PMSM model (plant) */
+  FOC_SIM_HANDLER,              /* FOC handler, current mode */
+  FOC_SIM_ANG_OSMO,             /* SMO angle observer */
+  FOC_SIM_ANG_ONFO,             /* NFO angle observer */
+  FOC_SIM_VEL_ODIV,             /* DIV velocity observer */
+  FOC_SIM_VEL_OPLL,             /* PLL velocity observer */
+  FOC_SIM_NCOMP
+};
+
+/* Tracked quantities */
+
+enum foc_sim_err_e
+{
+  FOC_SIM_ERR_IQ = 0,           /* q current vs. reference [A] */
+  FOC_SIM_ERR_OSMO,             /* SMO angle vs. model [rad] */
+  FOC_SIM_ERR_ONFO,             /* NFO angle vs. model [rad] */
+  FOC_SIM_ERR_ODIV,             /* DIV velocity vs. model [rad/s] */
+  FOC_SIM_ERR_OPLL,             /* PLL velocity vs. model [rad/s] */
+  FOC_SIM_NERR
+};
+
+struct foc_sim_err_s
+{
+  double sum2;                  /* Sum of squared errors */
+  double max;                   /* Largest absolute error */
+};
+
+struct foc_sim_result_s
+{
+  unsigned long        steps;
+  uint64_t             ns[FOC_SIM_NCOMP];
+  struct foc_sim_err_s err[FOC_SIM_NERR];
+  float                omega_e;  /* Final electrical speed */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: foc_sim_now
+ *
+ * Description:
+ *   Monotonic time in nanoseconds
+ *
+ ****************************************************************************/
+
+uint64_t foc_sim_now(void);
+
+/****************************************************************************
+ * Name: foc_sim_err_add
+ *
+ * Description:
+ *   Accumulate one tracking error sample
+ *
+ ****************************************************************************/
+
+void foc_sim_err_add(FAR struct foc_sim_err_s *err, double e);
+
+/****************************************************************************
+ * Name: foc_sim_angle_err
+ *
+ * Description:
+ *   Difference of two electrical angles wrapped to [-pi, pi)
+ *
+ ****************************************************************************/
+
+double foc_sim_angle_err(double angle, double ref);
+
+/****************************************************************************
+ * Name: foc_sim_run_f32 / foc_sim_run_b16
+ *
+ * Description:
+ *   Run the closed loop simulation for the given number of steps with the
+ *   float or the fixed16 control stack.
+ *
+ * Returned Value:
+ *   OK on success, a negated errno value if initialization failed.
+ *
+ ****************************************************************************/
+
+int foc_sim_run_f32(unsigned long steps,
+                    FAR struct foc_sim_result_s *result);
+int foc_sim_run_b16(unsigned long steps,
+                    FAR struct foc_sim_result_s *result);
+
+#endif /* __APPS_INDUSTRY_FOC_HOST_FOC_SIM_H */
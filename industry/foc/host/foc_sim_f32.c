@@ -0,0 +1,318 @@
+/****************************************************************************
+ * apps/industry/foc/host/foc_sim_f32.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <math.h>
+#include <string.h>
+
+#include "industry/foc/foc_common.h"
+#include "industry/foc/float/foc_angle.h"
+#include "industry/foc/float/foc_handler.h"
+#include "industry/foc/float/foc_model.h"
+#include "industry/foc/float/foc_velocity.h"
+
+#include "foc_sim.h"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct foc_sim_f32_s
+{
+  foc_model_f32_t                 model;
+  foc_handler_f32_t               handler;
+  foc_angle_f32_t                 ang_smo;
+  foc_angle_f32_t                 ang_nfo;
+  foc_velocity_f32_t              vel_div;
+  foc_velocity_f32_t              vel_pll;
+  struct motor_phy_params_f32_s   phy;
+  struct foc_model_state_f32_s    state;
+  struct foc_state_f32_s          foc;
+  struct foc_handler_input_f32_s  in;
+  struct foc_handler_output_f32_s out;
+  dq_frame_f32_t                  dq_ref;
+  dq_frame_f32_t                  vdq_comp;
+  float                           current[CONFIG_MOTOR_FOC_PHASES];
+  float                           angle;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct foc_sim_f32_s g_sim_f32;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int foc_sim_init_f32(FAR struct foc_sim_f32_s *sim)
+{
+  struct foc_initdata_f32_s       ctrl_cfg;
+  struct foc_mod_cfg_f32_s        mod_cfg;
+  struct foc_model_pmsm_cfg_f32_s pmsm_cfg;
+  struct foc_angle_osmo_cfg_f32_s smo_cfg;
+  struct foc_angle_onfo_cfg_f32_s nfo_cfg;
+  struct foc_vel_div_f32_cfg_s    div_cfg;
+  struct foc_vel_pll_f32_cfg_s    pll_cfg;
+  int                             ret;
+
+  memset(sim, 0, sizeof(*sim));
+
+  /* Plant */
+
+  ret = foc_model_init_f32(&sim->model, &g_foc_model_pmsm_ops_f32);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  pmsm_cfg.poles      = FOC_SIM_POLES;
+  pmsm_cfg.res        = FOC_SIM_RES;
+  pmsm_cfg.ind        = FOC_SIM_IND;
+  pmsm_cfg.iner       = FOC_SIM_INER;
+  pmsm_cfg.flux_link  = FOC_SIM_FLUX;
+  pmsm_cfg.ind_d      = FOC_SIM_IND;
+  pmsm_cfg.ind_q      = FOC_SIM_IND;
+  pmsm_cfg.per        = FOC_SIM_PER;
+  pmsm_cfg.iphase_adc = 1.0f;
+  foc_model_cfg_f32(&sim->model, &pmsm_cfg);
+
+  /* Controller */
+
+  ret = foc_handler_init_f32(&sim->handler, &g_foc_control_pi_f32,
+                             &g_foc_mod_svm3_f32);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ctrl_cfg.id_kp = FOC_SIM_KP;
+  ctrl_cfg.id_ki = FOC_SIM_KI;
+  ctrl_cfg.iq_kp = FOC_SIM_KP;
+  ctrl_cfg.iq_ki = FOC_SIM_KI;
+  mod_cfg.pwm_duty_max = FOC_SIM_DUTY_MAX;
+  foc_handler_cfg_f32(&sim->handler, &ctrl_cfg, &mod_cfg);
+
+  /* Observers, fed with the controller state */
+
+  motor_phy_params_init(&sim->phy, FOC_SIM_POLES, FOC_SIM_RES,
+                        FOC_SIM_IND, FOC_SIM_FLUX);
+
+  ret = foc_angle_init_f32(&sim->ang_smo, &g_foc_angle_osmo_f32);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  smo_cfg.per     = FOC_SIM_PER;
+  smo_cfg.k_slide = FOC_SIM_SMO_KSLIDE;
+  smo_cfg.err_max = FOC_SIM_SMO_ERRMAX;
+  memcpy(&smo_cfg.phy, &sim->phy, sizeof(struct motor_phy_params_f32_s));
+
+  ret = foc_angle_cfg_f32(&sim->ang_smo, &smo_cfg);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = foc_angle_init_f32(&sim->ang_nfo, &g_foc_angle_onfo_f32);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  nfo_cfg.per       = FOC_SIM_PER;
+  nfo_cfg.gain      = FOC_SIM_NFO_GAIN;
+  nfo_cfg.gain_slow = FOC_SIM_NFO_SLOW;
+  memcpy(&nfo_cfg.phy, &sim->phy, sizeof(struct motor_phy_params_f32_s));
+
+  ret = foc_angle_cfg_f32(&sim->ang_nfo, &nfo_cfg);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = foc_velocity_init_f32(&sim->vel_div, &g_foc_velocity_odiv_f32);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  div_cfg.samples = FOC_SIM_DIV_SAMPLES;
+  div_cfg.filter  = FOC_SIM_DIV_FILTER;
+  div_cfg.per     = FOC_SIM_PER;
+
+  ret = foc_velocity_cfg_f32(&sim->vel_div, &div_cfg);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = foc_velocity_init_f32(&sim->vel_pll, &g_foc_velocity_opll_f32);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  pll_cfg.kp  = FOC_SIM_PLL_KP;
+  pll_cfg.ki  = FOC_SIM_PLL_KI;
+  pll_cfg.per = FOC_SIM_PER;
+
+  ret = foc_velocity_cfg_f32(&sim->vel_pll, &pll_cfg);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* Current mode with a constant torque request */
+
+  sim->dq_ref.d    = 0.0f;
+  sim->dq_ref.q    = FOC_SIM_IQREF;
+  sim->in.current  = sim->current;
+  sim->in.dq_ref   = &sim->dq_ref;
+  sim->in.vdq_comp = &sim->vdq_comp;
+  sim->in.vbus     = FOC_SIM_VBUS;
+  sim->in.mode     = FOC_HANDLER_MODE_CURRENT;
+
+  return OK;
+}
+
+static void foc_sim_deinit_f32(FAR struct foc_sim_f32_s *sim)
+{
+  foc_velocity_deinit_f32(&sim->vel_pll);
+  foc_velocity_deinit_f32(&sim->vel_div);
+  foc_angle_deinit_f32(&sim->ang_nfo);
+  foc_angle_deinit_f32(&sim->ang_smo);
+  foc_handler_deinit_f32(&sim->handler);
+  foc_model_deinit_f32(&sim->model);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: foc_sim_run_f32
+ ****************************************************************************/
+
+int foc_sim_run_f32(unsigned long steps,
+                    FAR struct foc_sim_result_s *result)
+{
+  FAR struct foc_sim_f32_s     *sim = &g_sim_f32;
+  struct foc_angle_in_f32_s     ain;
+  struct foc_angle_out_f32_s    smo_out;
+  struct foc_angle_out_f32_s    nfo_out;
+  struct foc_velocity_in_f32_s  vin;
+  struct foc_velocity_out_f32_s div_out;
+  struct foc_velocity_out_f32_s pll_out;
+  unsigned long                 settle = FOC_SIM_SETTLE(steps);
+  unsigned long                 step;
+  uint64_t                      t[FOC_SIM_NCOMP + 1];
+  int                           ret;
+  int                           i;
+
+  memset(result, 0, sizeof(*result));
+  result->steps = steps;
+
+  /* The program exits on failure, so a partial init is not unwound */
+
+  ret = foc_sim_init_f32(sim);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  for (step = 0; step < steps; step++)
+    {
+      /* Sample the plant.  The angle is a perfect sensor. */
+
+      foc_model_state_f32(&sim->model, &sim->state);
+      memcpy(sim->current, sim->state.curr, sizeof(sim->current));
+
+      sim->angle += sim->state.omega_e * FOC_SIM_PER;
+      angle_norm_2pi(&sim->angle, 0.0f, 2.0f * M_PI);
+      sim->in.angle = sim->angle;
+
+      ain.state = &sim->foc;
+      ain.angle = sim->angle;
+      ain.vel   = sim->state.omega_e;
+      ain.dir   = DIR_CW;
+
+      vin.state = &sim->foc;
+      vin.angle = sim->angle;
+      vin.vel   = sim->state.omega_e;
+      vin.dir   = DIR_CW;
+
+      /* Control step, every component timed on its own */
+
+      t[0] = foc_sim_now();
+      foc_handler_run_f32(&sim->handler, &sim->in, &sim->out);
+      foc_handler_state_f32(&sim->handler, &sim->foc, NULL);
+      t[1] = foc_sim_now();
+      foc_angle_run_f32(&sim->ang_smo, &ain, &smo_out);
+      t[2] = foc_sim_now();
+      foc_angle_run_f32(&sim->ang_nfo, &ain, &nfo_out);
+      t[3] = foc_sim_now();
+      foc_velocity_run_f32(&sim->vel_div, &vin, &div_out);
+      t[4] = foc_sim_now();
+      foc_velocity_run_f32(&sim->vel_pll, &vin, &pll_out);
+      t[5] = foc_sim_now();
+      foc_model_run_f32(&sim->model,
+                        FOC_SIM_DAMP * sim->state.omega_m,
+                        &sim->foc.vab);
+      t[6] = foc_sim_now();
+
+      for (i = FOC_SIM_HANDLER; i < FOC_SIM_NCOMP; i++)
+        {
+          result->ns[i] += t[i] - t[i - 1];
+        }
+
+      result->ns[FOC_SIM_MODEL] += t[6] - t[5];
+
+      if (step < settle)
+        {
+          continue;
+        }
+
+      foc_sim_err_add(&result->err[FOC_SIM_ERR_IQ],
+                      sim->foc.idq.q - sim->dq_ref.q);
+      foc_sim_err_add(&result->err[FOC_SIM_ERR_OSMO],
+                      foc_sim_angle_err(smo_out.angle, sim->angle));
+      foc_sim_err_add(&result->err[FOC_SIM_ERR_ONFO],
+                      foc_sim_angle_err(nfo_out.angle, sim->angle));
+      foc_sim_err_add(&result->err[FOC_SIM_ERR_ODIV],
+                      div_out.velocity - sim->state.omega_e);
+      foc_sim_err_add(&result->err[FOC_SIM_ERR_OPLL],
+                      pll_out.velocity - sim->state.omega_e);
+    }
+
+  result->omega_e = sim->state.omega_e;
+
+  foc_sim_deinit_f32(sim);
+  return OK;
+}
@@ -0,0 +1,220 @@
+/****************************************************************************
+ * apps/industry/foc/host/foc_sim_main.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Host closed-loop FOC simulation.  A PMSM model is driven by the PI/SVM3
+ * current controller while the SMO and NFO angle observers and the DIV and
+ * PLL velocity observers run on the controller state.  The same loop runs
+ * once with the float and once with the fixed16 stack.  For every
+ * component the cost per control step is reported, and for the controller
+ * and the observers the tracking error against the model.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "foc_sim.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define FOC_SIM_STEPS      1000000
+#define FOC_SIM_CALIBRATE  1000000
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char *g_comp_name[FOC_SIM_NCOMP] =
+{
+  "model",
+  "handler",
+  "ang_osmo",
+  "ang_onfo",
+  "vel_odiv",
+  "vel_opll"
+};
+
+static const char *g_err_name[FOC_SIM_NERR] =
+{
+  "iq [A]",
+  "osmo angle [rad]",
+  "onfo angle [rad]",
+  "odiv vel [rad/s]",
+  "opll vel [rad/s]"
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Cost of one foc_sim_now() pair, subtracted from every component */
+
+static double foc_sim_overhead(void)
+{
+  uint64_t start;
+  uint64_t sum = 0;
+  int      i;
+
+  for (i = 0; i < FOC_SIM_CALIBRATE; i++)
+    {
+      start = foc_sim_now();
+      sum += foc_sim_now() - start;
+    }
+
+  return (double)sum / FOC_SIM_CALIBRATE;
+}
+
+static void foc_sim_print(FAR const struct foc_sim_result_s *f32,
+                          FAR const struct foc_sim_result_s *b16,
+                          double overhead)
+{
+  unsigned long n = f32->steps - FOC_SIM_SETTLE(f32->steps);
+  double        total_f32 = 0.0;
+  double        total_b16 = 0.0;
+  double        ns_f32;
+  double        ns_b16;
+  int           i;
+
+  printf("%lu steps, final speed %.1f / %.1f rad/s (float / fixed16)\n\n",
+         f32->steps, f32->omega_e, b16->omega_e);
+
+  printf("%-18s %12s %12s\n", "ns/step", "float", "fixed16");
+  for (i = 0; i < FOC_SIM_NCOMP; i++)
+    {
+      ns_f32 = (double)f32->ns[i] / f32->steps - overhead;
+      ns_b16 = (double)b16->ns[i] / b16->steps - overhead;
+      printf("%-18s %12.1f %12.1f\n", g_comp_name[i], ns_f32, ns_b16);
+
+      if (i != FOC_SIM_MODEL)
+        {
+          total_f32 += ns_f32;
+          total_b16 += ns_b16;
+        }
+    }
+
+  printf("%-18s %12.1f %12.1f\n\n", "control total", total_f32, total_b16);
+
+  printf("%-18s %12s %12s %12s %12s\n", "tracking error",
+         "float rms", "float max", "fixed16 rms", "fixed16 max");
+  for (i = 0; i < FOC_SIM_NERR; i++)
+    {
+      printf("%-18s %12.4f %12.4f %12.4f %12.4f\n", g_err_name[i],
+             sqrt(f32->err[i].sum2 / n), f32->err[i].max,
+             sqrt(b16->err[i].sum2 / n), b16->err[i].max);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: foc_sim_now
+ ****************************************************************************/
+
+uint64_t foc_sim_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/****************************************************************************
+ * Name: foc_sim_err_add
+ ****************************************************************************/
+
+void foc_sim_err_add(FAR struct foc_sim_err_s *err, double e)
+{
+  err->sum2 += e * e;
+  if (fabs(e) > err->max)
+    {
+      err->max = fabs(e);
+    }
+}
+
+/****************************************************************************
+ * Name: foc_sim_angle_err
+ ****************************************************************************/
+
+double foc_sim_angle_err(double angle, double ref)
+{
+  double e = fmod(angle - ref + M_PI, 2.0 * M_PI);
+
+  if (e < 0.0)
+    {
+      e += 2.0 * M_PI;
+    }
+
+  return e - M_PI;
+}
+
+/****************************************************************************
+ * Name: main
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  struct foc_sim_result_s f32;
+  struct foc_sim_result_s b16;
+  unsigned long           steps = FOC_SIM_STEPS;
+  double                  overhead;
+  int                     ret;
+
+  if (argc > 1)
+    {
+      steps = strtoul(argv[1], NULL, 0);
+      if (steps < 10)
+        {
+          fprintf(stderr, "USAGE: %s [<steps>]\n", argv[0]);
+          return EXIT_FAILURE;
+        }
+    }
+
+  overhead = foc_sim_overhead();
+
+  ret = foc_sim_run_f32(steps, &f32);
+  if (ret < 0)
+    {
+      fprintf(stderr, "ERROR: float simulation failed %d\n", ret);
+      return EXIT_FAILURE;
+    }
+
+  ret = foc_sim_run_b16(steps, &b16);
+  if (ret < 0)
+    {
+      fprintf(stderr, "ERROR: fixed16 simulation failed %d\n", ret);
+      return EXIT_FAILURE;
+    }
+
+  foc_sim_print(&f32, &b16, overhead);
+  return EXIT_SUCCESS;
+}
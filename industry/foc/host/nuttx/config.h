@@ -0,0 +1,81 @@
+/****************************************************************************
+ * apps/industry/foc/host/nuttx/config.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INDUSTRY_FOC_HOST_NUTTX_CONFIG_H
+#define __APPS_INDUSTRY_FOC_HOST_NUTTX_CONFIG_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Environment stuff */
+
+#define OK 0
+#define ERROR -1
+#define FAR
+#define CODE
+#define DEBUGASSERT assert
+#define CONFIG_HAVE_LONG_LONG 1
+#define CONFIG_HAVE_FLOAT 1
+
+/* Configuration */
+
+#define CONFIG_LIBDSP 1
+#define CONFIG_MOTOR_FOC_PHASES 3
+#define CONFIG_MOTOR_FOC_SHUNTS 3
+#define CONFIG_INDUSTRY_FOC 1
+#define CONFIG_INDUSTRY_FOC_FLOAT 1
+#define CONFIG_INDUSTRY_FOC_FIXED16 1
+#define CONFIG_INDUSTRY_FOC_BATCH_MAX 8
+#define CONFIG_INDUSTRY_FOC_CONTROL_PI 1
+#define CONFIG_INDUSTRY_FOC_MODULATION_SVM3 1
+#define CONFIG_INDUSTRY_FOC_HAVE_MODEL 1
+#define CONFIG_INDUSTRY_FOC_MODEL_PMSM 1
+#define CONFIG_INDUSTRY_FOC_ANGLE_OSMO 1
+#define CONFIG_INDUSTRY_FOC_ANGLE_ONFO 1
+#define CONFIG_INDUSTRY_FOC_VELOCITY_ODIV 1
+#define CONFIG_INDUSTRY_FOC_VELOCITY_OPLL 1
+
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+static inline void *zalloc(unsigned long size)
+{
+  void *ret = malloc(size);
+  if (ret)
+    {
+      memset(ret, 0, size);
+    }
+
+  return ret;
+}
+
+#endif /* __APPS_INDUSTRY_FOC_HOST_NUTTX_CONFIG_H */
@@ -0,0 +1,265 @@
+/****************************************************************************
+ * apps/lte/alt1250/alt1250_cmdstat.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <nuttx/modem/alt1250.h>
+
+#include "alt1250_dbg.h"
+#include "alt1250_container.h"
+#include "alt1250_cmdstat.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Room for every pool container plus the daemon's own containers */
+
+#define INFLIGHT_MAX (CONFIG_LTE_ALT1250_CONTAINERS_MAX + 4)
+
+/****************************************************************************
+ * Private Data Types
+ ****************************************************************************/
+
+/* A command handed to the driver whose response has not arrived yet */
+
+struct inflight_s
+{
+  FAR struct alt_container_s *container;
+  uint32_t cmdid;
+  uint32_t sendtime;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct inflight_s g_inflight[INFLIGHT_MAX];
+static struct lapi_cmdstat_s g_cmdstat;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * name: cmdstat_now
+ ****************************************************************************/
+
+static uint32_t cmdstat_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+/****************************************************************************
+ * name: cmdstat_entry
+ ****************************************************************************/
+
+static FAR struct lapi_cmdlatency_s *cmdstat_entry(uint32_t cmdid)
+{
+  FAR struct lapi_cmdlatency_s *entry;
+  uint32_t i;
+
+  for (i = 0; i < g_cmdstat.ncmds; i++)
+    {
+      if (g_cmdstat.cmds[i].cmdid == cmdid)
+        {
+          return &g_cmdstat.cmds[i];
+        }
+    }
+
+  /* Keep the last entry for the commands that do not fit */
+
+  if (g_cmdstat.ncmds < LAPI_CMDSTAT_MAXCMDS - 1)
+    {
+      entry = &g_cmdstat.cmds[g_cmdstat.ncmds++];
+      entry->cmdid = cmdid;
+      return entry;
+    }
+
+  entry = &g_cmdstat.cmds[LAPI_CMDSTAT_MAXCMDS - 1];
+  if (g_cmdstat.ncmds < LAPI_CMDSTAT_MAXCMDS)
+    {
+      g_cmdstat.ncmds++;
+      entry->cmdid = LAPI_CMDSTAT_OTHERS;
+    }
+
+  return entry;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * name: cmdstat_init
+ ****************************************************************************/
+
+void cmdstat_init(void)
+{
+  memset(g_inflight, 0, sizeof(g_inflight));
+  memset(&g_cmdstat, 0, sizeof(g_cmdstat));
+}
+
+/****************************************************************************
+ * name: cmdstat_sent
+ *
+ * Description:
+ *   Record a command accepted by the driver.  Only commands with output
+ *   parameters are answered with their container, the others are not
+ *   tracked.
+ *
+ ****************************************************************************/
+
+void cmdstat_sent(FAR struct alt_container_s *container)
+{
+  int i;
+
+  if (container->outparam == NULL)
+    {
+      return;
+    }
+
+  for (i = 0; i < INFLIGHT_MAX; i++)
+    {
+      if (g_inflight[i].container == NULL)
+        {
+          g_inflight[i].container = container;
+          g_inflight[i].cmdid = container->cmdid;
+          g_inflight[i].sendtime = cmdstat_now();
+
+          g_cmdstat.inflight++;
+          if (g_cmdstat.inflight > g_cmdstat.inflight_max)
+            {
+              g_cmdstat.inflight_max = g_cmdstat.inflight;
+            }
+
+          return;
+        }
+    }
+
+  dbg_alt1250("No room to track cmdid 0x%08lx\n", container->cmdid);
+}
+
+/****************************************************************************
+ * name: cmdstat_replied
+ *
+ * Description:
+ *   Match a response to its command by container and command ID and
+ *   account for the latency.
+ *
+ ****************************************************************************/
+
+void cmdstat_replied(FAR struct alt_container_s *container)
+{
+  FAR struct lapi_cmdlatency_s *entry;
+  uint32_t latency;
+  int i;
+
+  for (i = 0; i < INFLIGHT_MAX; i++)
+    {
+      if (g_inflight[i].container == container &&
+          g_inflight[i].cmdid == container->cmdid)
+        {
+          latency = cmdstat_now() - g_inflight[i].sendtime;
+
+          entry = cmdstat_entry(g_inflight[i].cmdid);
+          entry->count++;
+          entry->total_ms += latency;
+          if (latency > entry->max_ms)
+            {
+              entry->max_ms = latency;
+            }
+
+          g_inflight[i].container = NULL;
+          g_cmdstat.inflight--;
+          return;
+        }
+    }
+}
+
+/****************************************************************************
+ * name: cmdstat_freed
+ *
+ * Description:
+ *   Stop tracking a container that is freed without its response, so that
+ *   a later command in a container at the same address is not matched
+ *   with the old send time.
+ *
+ ****************************************************************************/
+
+void cmdstat_freed(FAR struct alt_container_s *container)
+{
+  int i;
+
+  for (i = 0; i < INFLIGHT_MAX; i++)
+    {
+      if (g_inflight[i].container == container)
+        {
+          g_inflight[i].container = NULL;
+          g_cmdstat.inflight--;
+        }
+    }
+}
+
+/****************************************************************************
+ * name: cmdstat_clearinflight
+ *
+ * Description:
+ *   Forget the commands in flight, their responses are lost on a modem
+ *   reset.
+ *
+ ****************************************************************************/
+
+void cmdstat_clearinflight(void)
+{
+  memset(g_inflight, 0, sizeof(g_inflight));
+  g_cmdstat.inflight = 0;
+}
+
+/****************************************************************************
+ * name: cmdstat_nocontainer
+ ****************************************************************************/
+
+void cmdstat_nocontainer(void)
+{
+  g_cmdstat.nocontainer++;
+}
+
+/****************************************************************************
+ * name: cmdstat_get
+ ****************************************************************************/
+
+void cmdstat_get(FAR struct lapi_cmdstat_s *stat)
+{
+  memcpy(stat, &g_cmdstat, sizeof(struct lapi_cmdstat_s));
+  container_usage(&stat->containers, &stat->containers_max);
+}
@@ -0,0 +1,46 @@
+/****************************************************************************
+ * apps/lte/alt1250/alt1250_cmdstat.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_LTE_ALT1250_ALT1250_CMDSTAT_H
+#define __APPS_LTE_ALT1250_ALT1250_CMDSTAT_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/modem/alt1250.h>
+
+#include "lte/lapi.h"
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+void cmdstat_init(void);
+void cmdstat_sent(FAR struct alt_container_s *container);
+void cmdstat_replied(FAR struct alt_container_s *container);
+void cmdstat_freed(FAR struct alt_container_s *container);
+void cmdstat_clearinflight(void);
+void cmdstat_nocontainer(void);
+void cmdstat_get(FAR struct lapi_cmdstat_s *stat);
+
+#endif  /* __APPS_LTE_ALT1250_ALT1250_CMDSTAT_H */
@@ -26,20 +26,109 @@
 
 #include <nuttx/config.h>
 
+#include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 #include <nuttx/queue.h>
 
 #include "alt1250_dbg.h"
 #include "alt1250_daemon.h"
 #include "alt1250_container.h"
+#include "alt1250_cmdstat.h"
 
 /****************************************************************************
  * Private Data Types
  ****************************************************************************/
 
+/* Container allocated from the heap once the static pool is exhausted */
+
+struct heap_container_s
+{
+  struct alt_container_s container;
+  struct postproc_s postproc;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
 static struct postproc_s postproc_obj[CONFIG_LTE_ALT1250_CONTAINERS];
 static struct alt_container_s container_obj[CONFIG_LTE_ALT1250_CONTAINERS];
 static sq_queue_t free_containers;
+static uint16_t g_nused;
+static uint16_t g_nused_max;
+static uint16_t g_nheap;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * name: is_heap_container
+ ****************************************************************************/
+
+static bool is_heap_container(FAR struct alt_container_s *container)
+{
+  FAR struct heap_container_s *obj =
+    (FAR struct heap_container_s *)container;
+
+  if (container >= &container_obj[0] &&
+      container < &container_obj[CONFIG_LTE_ALT1250_CONTAINERS])
+    {
+      return false;
+    }
+
+  return container->priv == (unsigned long)&obj->postproc;
+}
+
+/****************************************************************************
+ * name: is_free_container
+ ****************************************************************************/
+
+static bool is_free_container(FAR struct alt_container_s *container)
+{
+  FAR sq_entry_t *node;
+
+  for (node = sq_peek(&free_containers); node != NULL; node = sq_next(node))
+    {
+      if (node == &container->node)
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * name: heap_container_alloc
+ ****************************************************************************/
+
+static FAR struct alt_container_s *heap_container_alloc(void)
+{
+  FAR struct heap_container_s *obj;
+
+  if (CONFIG_LTE_ALT1250_CONTAINERS + g_nheap >=
+      CONFIG_LTE_ALT1250_CONTAINERS_MAX)
+    {
+      return NULL;
+    }
+
+  obj = malloc(sizeof(struct heap_container_s));
+  if (obj == NULL)
+    {
+      return NULL;
+    }
+
+  memset(obj, 0, sizeof(struct heap_container_s));
+  obj->container.priv = (unsigned long)&obj->postproc;
+  g_nheap++;
+
+  dbg_alt1250("Container grown to %d\n",
+              CONFIG_LTE_ALT1250_CONTAINERS + g_nheap);
+
+  return &obj->container;
+}
 
 /****************************************************************************
  * Public Functions
@@ -56,6 +145,11 @@ void init_containers(void)
   memset(&container_obj, 0, sizeof(container_obj));
 
   sq_init(&free_containers);
+  g_nused = 0;
+  g_nused_max = 0;
+  g_nheap = 0;
+
+  cmdstat_init();
 
   for (i = 0; i < CONFIG_LTE_ALT1250_CONTAINERS; i++)
     {
@@ -78,9 +172,27 @@ FAR struct alt_container_s *container_alloc(void)
       sq_rem(&ret->node, &free_containers);
       clear_container(ret);
     }
+  else
+    {
+      /* Grow rather than stall the request behind the commands in
+       * flight.
+       */
+
+      ret = heap_container_alloc();
+    }
+
+  if (ret)
+    {
+      g_nused++;
+      if (g_nused > g_nused_max)
+        {
+          g_nused_max = g_nused;
+        }
+    }
   else
     {
       dbg_alt1250("No more container\n");
+      cmdstat_nocontainer();
     }
 
   return ret;
@@ -94,6 +206,31 @@ void container_free(FAR struct alt_container_s *container)
 {
   dbg_alt1250("Container free <cmdid : 0x%08lx\n>\n", container->cmdid);
 
+  /* Freeing a container of the static pool twice would put it on the free
+   * list twice and count it out of the in-use containers twice.
+   */
+
+  if (!is_heap_container(container) && is_free_container(container))
+    {
+      dbg_alt1250("Container already free\n");
+      DEBUGASSERT(false);
+      return;
+    }
+
+  DEBUGASSERT(g_nused > 0);
+  g_nused--;
+
+  cmdstat_freed(container);
+
+  /* Heap containers are only kept while the static pool is in use */
+
+  if (is_heap_container(container))
+    {
+      free(container);
+      g_nheap--;
+      return;
+    }
+
   sq_addlast(&container->node, &free_containers);
 }
 
@@ -186,3 +323,13 @@ FAR struct alt_container_s *container_pick_listtop(
 
   return ret;
 }
+
+/****************************************************************************
+ * name: container_usage
+ ****************************************************************************/
+
+void container_usage(FAR uint16_t *nused, FAR uint16_t *nused_max)
+{
+  *nused = g_nused;
+  *nused_max = g_nused_max;
+}
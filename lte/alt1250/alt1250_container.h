@@ -73,4 +73,6 @@ void container_free_all(FAR struct alt_container_s *head);
 FAR struct alt_container_s *
     container_pick_listtop(FAR struct alt_container_s **head);
 
+void container_usage(FAR uint16_t *nused, FAR uint16_t *nused_max);
+
 #endif /* __APPS_LTE_ALT1250_ALT1250_CONTAINER_H */
@@ -36,6 +36,7 @@
 #include "alt1250_devevent.h"
 #include "alt1250_postproc.h"
 #include "alt1250_container.h"
+#include "alt1250_cmdstat.h"
 #include "alt1250_usockif.h"
 #include "alt1250_usockevent.h"
 #include "alt1250_socket.h"
@@ -98,6 +99,8 @@ static int perform_alt1250_reply(FAR struct alt1250_s *dev,
   uint32_t ack_xid = 0;
   struct usock_ackinfo_s ackinfo;
 
+  cmdstat_replied(container);
+
   ret = handle_replypkt(dev, container, &ack_result, &ack_xid, &ackinfo);
 
   if (LTE_IS_ASYNC_CMD(container->cmdid))
@@ -167,6 +170,7 @@ static int perform_alt1250_resetevt(FAR struct alt1250_s *dev,
   int ret;
 
   container_free_all(rlist);
+  cmdstat_clearinflight();
 
   dev->sid = -1;
 
@@ -34,6 +34,7 @@
 #include <nuttx/wireless/lte/lte_ioctl.h>
 
 #include "alt1250_devif.h"
+#include "alt1250_cmdstat.h"
 #include "alt1250_usockevent.h"
 
 /****************************************************************************
@@ -125,6 +126,7 @@ int altdevice_send_command(FAR struct alt1250_s *dev, int fd,
     {
       /* In case of send succeeded */
 
+      cmdstat_sent(container);
       ret = container->outparam ? REP_NO_ACK_WOFREE : REP_NO_ACK;
     }
 
@@ -29,6 +29,7 @@
 
 #include "alt1250_dbg.h"
 #include "alt1250_container.h"
+#include "alt1250_cmdstat.h"
 #include "alt1250_socket.h"
 #include "alt1250_usockevent.h"
 #include "alt1250_postproc.h"
@@ -153,6 +154,29 @@ static int perform_getapn(FAR struct alt1250_s *dev,
   return REP_SEND_ACK_WOFREE;
 }
 
+#ifdef LTE_CMDID_GETCMDSTAT
+/****************************************************************************
+ * name: perform_getcmdstat
+ ****************************************************************************/
+
+static int perform_getcmdstat(FAR struct alt1250_s *dev,
+                              FAR struct usrsock_request_buff_s *req,
+                              FAR int32_t *usock_result,
+                              FAR uint32_t *usock_xid,
+                              FAR struct usock_ackinfo_s *ackinfo)
+{
+  FAR struct lte_ioctl_data_s *ltecmd = &req->req_ioctl.ltecmd;
+
+  if (ltecmd->outparam && ltecmd->outparam[0])
+    {
+      cmdstat_get((FAR struct lapi_cmdstat_s *)(ltecmd->outparam[0]));
+      *usock_result = OK;
+    }
+
+  return REP_SEND_ACK_WOFREE;
+}
+#endif
+
 #ifdef CONFIG_LTE_ALT1250_ENABLE_HIBERNATION_MODE
 /****************************************************************************
  * name: perform_setctxcb
@@ -232,6 +256,12 @@ int usockreq_ioctl_other(FAR struct alt1250_s *dev,
         func = perform_getapn;
         break;
 
+#ifdef LTE_CMDID_GETCMDSTAT
+      case LTE_CMDID_GETCMDSTAT:
+        func = perform_getcmdstat;
+        break;
+#endif
+
 #ifdef CONFIG_LTE_ALT1250_ENABLE_HIBERNATION_MODE
       case LTE_CMDID_SETCTXCB:
         func = perform_setctxcb;
@@ -137,6 +137,26 @@ int lte_get_errinfo(FAR lte_errinfo_t *info)
   return ret;
 }
 
+#ifdef LTE_CMDID_GETCMDSTAT
+int lapi_getcmdstat(FAR struct lapi_cmdstat_s *stat)
+{
+  FAR void *outarg[] =
+    {
+      stat
+    };
+
+  if (!stat)
+    {
+      return -EINVAL;
+    }
+
+  return lapi_req(LTE_CMDID_GETCMDSTAT,
+                  NULL, 0,
+                  (FAR void *)outarg, nitems(outarg),
+                  NULL);
+}
+#endif
+
 int lte_send_atcmd_sync(FAR const char *cmd, int cmdlen,
   FAR char *respbuff, int respbufflen, FAR int *resplen)
 {
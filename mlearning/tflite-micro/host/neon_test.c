@@ -0,0 +1,537 @@
+/****************************************************************************
+ * apps/mlearning/tflite-micro/host/neon_test.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Host test of the NEON operators in operators/neon.  Every operator runs
+ * on random data next to the CMSIS-NN C kernel it replaces, which
+ * Makefile.host builds with a ref_ prefix.  The outputs must be identical
+ * byte for byte; the time spent in both is reported per operator.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "arm_nnfunctions.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TEST_BUF_SIZE   (256 * 1024)
+#define TEST_ROUNDS     20
+
+#define DW_PROTO(name) \
+  arm_cmsis_nn_status name(const cmsis_nn_context *ctx, \
+                           const cmsis_nn_dw_conv_params *dw_conv_params, \
+                           const cmsis_nn_per_channel_quant_params *quant, \
+                           const cmsis_nn_dims *input_dims, \
+                           const int8_t *input, \
+                           const cmsis_nn_dims *filter_dims, \
+                           const int8_t *kernel, \
+                           const cmsis_nn_dims *bias_dims, \
+                           const int32_t *bias, \
+                           const cmsis_nn_dims *output_dims, \
+                           int8_t *output)
+
+#define POOL_PROTO(name) \
+  arm_cmsis_nn_status name(const cmsis_nn_context *ctx, \
+                           const cmsis_nn_pool_params *pool_params, \
+                           const cmsis_nn_dims *input_dims, \
+                           const int8_t *src, \
+                           const cmsis_nn_dims *filter_dims, \
+                           const cmsis_nn_dims *output_dims, \
+                           int8_t *dst)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+typedef DW_PROTO((*dw_func_t));
+typedef POOL_PROTO((*pool_func_t));
+
+struct test_stat_s
+{
+  const char *name;
+  int         cases;
+  int         failed;
+  uint64_t    ns_ref;
+  uint64_t    ns_neon;
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* CMSIS-NN C kernels, renamed by Makefile.host */
+
+DW_PROTO(ref_arm_depthwise_conv_s8);
+DW_PROTO(ref_arm_depthwise_conv_s8_opt);
+DW_PROTO(ref_arm_depthwise_conv_3x3_s8);
+POOL_PROTO(ref_arm_max_pool_s8);
+POOL_PROTO(ref_arm_avgpool_s8);
+
+arm_cmsis_nn_status
+ref_arm_fully_connected_s8(const cmsis_nn_context *ctx,
+                           const cmsis_nn_fc_params *fc_params,
+                           const cmsis_nn_per_tensor_quant_params *quant,
+                           const cmsis_nn_dims *input_dims,
+                           const int8_t *input,
+                           const cmsis_nn_dims *filter_dims,
+                           const int8_t *kernel,
+                           const cmsis_nn_dims *bias_dims,
+                           const int32_t *bias,
+                           const cmsis_nn_dims *output_dims,
+                           int8_t *output);
+
+void ref_arm_softmax_s8(const int8_t *input, const int32_t num_rows,
+                        const int32_t row_size, const int32_t mult,
+                        const int32_t shift, const int32_t diff_min,
+                        int8_t *output);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint32_t g_seed = 0x12345678;
+
+static int8_t   g_input[TEST_BUF_SIZE];
+static int8_t   g_kernel[TEST_BUF_SIZE];
+static int32_t  g_bias[TEST_BUF_SIZE / 4];
+static int32_t  g_mult[TEST_BUF_SIZE / 4];
+static int32_t  g_shift[TEST_BUF_SIZE / 4];
+static int8_t   g_out_ref[TEST_BUF_SIZE];
+static int8_t   g_out_neon[TEST_BUF_SIZE];
+static int8_t   g_scratch[TEST_BUF_SIZE];
+
+static const cmsis_nn_context g_ctx =
+{
+  g_scratch, sizeof(g_scratch)
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint64_t test_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* xorshift32, uniform in [min, max] */
+
+static int32_t test_rand(int32_t min, int32_t max)
+{
+  g_seed ^= g_seed << 13;
+  g_seed ^= g_seed >> 17;
+  g_seed ^= g_seed << 5;
+  return min + (int32_t)(g_seed % (uint32_t)(max - min + 1));
+}
+
+static void test_fill_s8(int8_t *buf, int32_t len)
+{
+  while (len-- > 0)
+    {
+      *buf++ = (int8_t)test_rand(-128, 127);
+    }
+}
+
+static void test_fill_quant(int32_t len, int32_t shift_min,
+                            int32_t shift_max)
+{
+  int32_t i;
+
+  for (i = 0; i < len; i++)
+    {
+      g_bias[i]  = test_rand(-20000, 20000);
+      g_mult[i]  = test_rand(1 << 30, INT32_MAX);
+      g_shift[i] = test_rand(shift_min, shift_max);
+    }
+}
+
+static int32_t test_out_size(int32_t in, int32_t kernel, int32_t stride,
+                             int32_t pad, int32_t dilation)
+{
+  return (in + 2 * pad - dilation * (kernel - 1) - 1) / stride + 1;
+}
+
+/* Random activation range, the full int8 range every other call */
+
+static void test_activation(cmsis_nn_activation *act)
+{
+  if (test_rand(0, 1))
+    {
+      act->min = -128;
+      act->max = 127;
+    }
+  else
+    {
+      act->min = test_rand(-128, 0);
+      act->max = test_rand(act->min, 127);
+    }
+}
+
+static void test_check(struct test_stat_s *stat, int32_t len,
+                       const char *what)
+{
+  int32_t i;
+
+  stat->cases++;
+  for (i = 0; i < len; i++)
+    {
+      if (g_out_ref[i] != g_out_neon[i])
+        {
+          printf("FAIL: %s %s: output %d is %d, expected %d\n",
+                 stat->name, what, (int)i, g_out_neon[i], g_out_ref[i]);
+          stat->failed++;
+          return;
+        }
+    }
+}
+
+static void test_depthwise_case(struct test_stat_s *stat, dw_func_t ref,
+                                dw_func_t neon, int32_t n, int32_t h,
+                                int32_t w, int32_t c, int32_t ch_mult,
+                                int32_t k, int32_t stride, int32_t pad,
+                                int32_t dilation)
+{
+  cmsis_nn_dw_conv_params params;
+  cmsis_nn_per_channel_quant_params quant;
+  cmsis_nn_dims input_dims;
+  cmsis_nn_dims filter_dims;
+  cmsis_nn_dims bias_dims;
+  cmsis_nn_dims output_dims;
+  int32_t out_len;
+  int32_t round;
+  uint64_t start;
+  char what[64];
+
+  input_dims.n = n;
+  input_dims.h = h;
+  input_dims.w = w;
+  input_dims.c = c;
+  filter_dims.n = 1;
+  filter_dims.h = k;
+  filter_dims.w = k;
+  filter_dims.c = c * ch_mult;
+  bias_dims.n = 1;
+  bias_dims.h = 1;
+  bias_dims.w = 1;
+  bias_dims.c = c * ch_mult;
+  output_dims.n = n;
+  output_dims.h = test_out_size(h, k, stride, pad, dilation);
+  output_dims.w = test_out_size(w, k, stride, pad, dilation);
+  output_dims.c = c * ch_mult;
+
+  params.ch_mult = ch_mult;
+  params.stride.h = stride;
+  params.stride.w = stride;
+  params.padding.h = pad;
+  params.padding.w = pad;
+  params.dilation.h = dilation;
+  params.dilation.w = dilation;
+  params.input_offset = test_rand(-127, 128);
+  params.output_offset = test_rand(-128, 127);
+  test_activation(&params.activation);
+
+  test_fill_s8(g_input, n * h * w * c);
+  test_fill_s8(g_kernel, k * k * c * ch_mult);
+  test_fill_quant(c * ch_mult, -12, 1);
+  quant.multiplier = g_mult;
+  quant.shift = g_shift;
+
+  out_len = n * output_dims.h * output_dims.w * output_dims.c;
+
+  for (round = 0; round < TEST_ROUNDS; round++)
+    {
+      start = test_now();
+      ref(&g_ctx, &params, &quant, &input_dims, g_input, &filter_dims,
+          g_kernel, &bias_dims, g_bias, &output_dims, g_out_ref);
+      stat->ns_ref += test_now() - start;
+
+      start = test_now();
+      neon(&g_ctx, &params, &quant, &input_dims, g_input, &filter_dims,
+           g_kernel, &bias_dims, g_bias, &output_dims, g_out_neon);
+      stat->ns_neon += test_now() - start;
+    }
+
+  snprintf(what, sizeof(what), "%dx%dx%dx%d m%d k%d s%d p%d d%d",
+           (int)n, (int)h, (int)w, (int)c, (int)ch_mult, (int)k,
+           (int)stride, (int)pad, (int)dilation);
+  test_check(stat, out_len, what);
+}
+
+static void test_depthwise(struct test_stat_s *stat)
+{
+  /* Generic kernel: channel multipliers, dilation, batches */
+
+  test_depthwise_case(stat, ref_arm_depthwise_conv_s8,
+                      arm_depthwise_conv_s8, 1, 12, 12, 16, 1, 3, 1, 1, 1);
+  test_depthwise_case(stat, ref_arm_depthwise_conv_s8,
+                      arm_depthwise_conv_s8, 1, 9, 11, 13, 1, 5, 2, 2, 1);
+  test_depthwise_case(stat, ref_arm_depthwise_conv_s8,
+                      arm_depthwise_conv_s8, 2, 10, 10, 8, 2, 3, 1, 1, 1);
+  test_depthwise_case(stat, ref_arm_depthwise_conv_s8,
+                      arm_depthwise_conv_s8, 1, 14, 14, 21, 1, 3, 1, 2, 2);
+  test_depthwise_case(stat, ref_arm_depthwise_conv_s8,
+                      arm_depthwise_conv_s8, 1, 7, 7, 5, 3, 3, 2, 1, 1);
+
+  /* The entry points the wrapper picks for a channel multiplier of one */
+
+  test_depthwise_case(stat, ref_arm_depthwise_conv_s8_opt,
+                      arm_depthwise_conv_s8_opt, 1, 16, 16, 32, 1, 5, 1, 2,
+                      1);
+  test_depthwise_case(stat, ref_arm_depthwise_conv_s8_opt,
+                      arm_depthwise_conv_s8_opt, 1, 8, 8, 27, 1, 3, 2, 0, 1);
+  test_depthwise_case(stat, ref_arm_depthwise_conv_3x3_s8,
+                      arm_depthwise_conv_3x3_s8, 1, 16, 16, 32, 1, 3, 1, 1,
+                      1);
+  test_depthwise_case(stat, ref_arm_depthwise_conv_3x3_s8,
+                      arm_depthwise_conv_3x3_s8, 1, 15, 9, 44, 1, 3, 2, 1,
+                      1);
+}
+
+static void test_fc_case(struct test_stat_s *stat, int32_t n,
+                         int32_t accum, int32_t out_ch)
+{
+  cmsis_nn_fc_params params;
+  cmsis_nn_per_tensor_quant_params quant;
+  cmsis_nn_dims input_dims;
+  cmsis_nn_dims filter_dims;
+  cmsis_nn_dims bias_dims;
+  cmsis_nn_dims output_dims;
+  int32_t round;
+  uint64_t start;
+  char what[64];
+
+  input_dims.n = n;
+  input_dims.h = 1;
+  input_dims.w = 1;
+  input_dims.c = accum;
+  filter_dims.n = accum;
+  filter_dims.h = 1;
+  filter_dims.w = 1;
+  filter_dims.c = out_ch;
+  bias_dims.n = 1;
+  bias_dims.h = 1;
+  bias_dims.w = 1;
+  bias_dims.c = out_ch;
+  output_dims.n = n;
+  output_dims.h = 1;
+  output_dims.w = 1;
+  output_dims.c = out_ch;
+
+  params.input_offset = test_rand(-127, 128);
+  params.filter_offset = 0;
+  params.output_offset = test_rand(-128, 127);
+  test_activation(&params.activation);
+
+  test_fill_s8(g_input, n * accum);
+  test_fill_s8(g_kernel, accum * out_ch);
+  test_fill_quant(out_ch, -12, 1);
+  quant.multiplier = g_mult[0];
+  quant.shift = g_shift[0];
+
+  for (round = 0; round < TEST_ROUNDS; round++)
+    {
+      start = test_now();
+      ref_arm_fully_connected_s8(&g_ctx, &params, &quant, &input_dims,
+                                 g_input, &filter_dims, g_kernel,
+                                 &bias_dims, g_bias, &output_dims,
+                                 g_out_ref);
+      stat->ns_ref += test_now() - start;
+
+      start = test_now();
+      arm_fully_connected_s8(&g_ctx, &params, &quant, &input_dims,
+                             g_input, &filter_dims, g_kernel, &bias_dims,
+                             g_bias, &output_dims, g_out_neon);
+      stat->ns_neon += test_now() - start;
+    }
+
+  snprintf(what, sizeof(what), "%dx%d -> %d", (int)n, (int)accum,
+           (int)out_ch);
+  test_check(stat, n * out_ch, what);
+}
+
+static void test_fc(struct test_stat_s *stat)
+{
+  test_fc_case(stat, 1, 7, 3);
+  test_fc_case(stat, 1, 64, 10);
+  test_fc_case(stat, 2, 250, 33);
+  test_fc_case(stat, 1, 1024, 128);
+  test_fc_case(stat, 3, 517, 61);
+}
+
+static void test_pool_case(struct test_stat_s *stat, pool_func_t ref,
+                           pool_func_t neon, int32_t n, int32_t h,
+                           int32_t w, int32_t c, int32_t k, int32_t stride,
+                           int32_t pad)
+{
+  cmsis_nn_pool_params params;
+  cmsis_nn_dims input_dims;
+  cmsis_nn_dims filter_dims;
+  cmsis_nn_dims output_dims;
+  int32_t round;
+  uint64_t start;
+  char what[64];
+
+  input_dims.n = n;
+  input_dims.h = h;
+  input_dims.w = w;
+  input_dims.c = c;
+  filter_dims.n = 1;
+  filter_dims.h = k;
+  filter_dims.w = k;
+  filter_dims.c = 1;
+  output_dims.n = n;
+  output_dims.h = test_out_size(h, k, stride, pad, 1);
+  output_dims.w = test_out_size(w, k, stride, pad, 1);
+  output_dims.c = c;
+
+  params.stride.h = stride;
+  params.stride.w = stride;
+  params.padding.h = pad;
+  params.padding.w = pad;
+  test_activation(&params.activation);
+
+  test_fill_s8(g_input, n * h * w * c);
+
+  for (round = 0; round < TEST_ROUNDS; round++)
+    {
+      start = test_now();
+      ref(&g_ctx, &params, &input_dims, g_input, &filter_dims,
+          &output_dims, g_out_ref);
+      stat->ns_ref += test_now() - start;
+
+      start = test_now();
+      neon(&g_ctx, &params, &input_dims, g_input, &filter_dims,
+           &output_dims, g_out_neon);
+      stat->ns_neon += test_now() - start;
+    }
+
+  snprintf(what, sizeof(what), "%dx%dx%dx%d k%d s%d p%d", (int)n, (int)h,
+           (int)w, (int)c, (int)k, (int)stride, (int)pad);
+  test_check(stat, n * output_dims.h * output_dims.w * c, what);
+}
+
+static void test_pool(struct test_stat_s *stat, pool_func_t ref,
+                      pool_func_t neon)
+{
+  test_pool_case(stat, ref, neon, 1, 8, 8, 16, 2, 2, 0);
+  test_pool_case(stat, ref, neon, 1, 7, 7, 19, 3, 2, 1);
+  test_pool_case(stat, ref, neon, 1, 10, 6, 35, 3, 1, 1);
+  test_pool_case(stat, ref, neon, 1, 7, 7, 64, 7, 1, 0);
+  test_pool_case(stat, ref, neon, 1, 16, 16, 8, 5, 3, 2);
+}
+
+static void test_softmax_case(struct test_stat_s *stat, int32_t rows,
+                              int32_t row_size)
+{
+  const int32_t mult = test_rand(1 << 30, INT32_MAX);
+  const int32_t shift = test_rand(20, 23);
+  const int32_t diff_min = -test_rand(16, 255);
+  int32_t round;
+  uint64_t start;
+  char what[64];
+
+  test_fill_s8(g_input, rows * row_size);
+
+  for (round = 0; round < TEST_ROUNDS; round++)
+    {
+      start = test_now();
+      ref_arm_softmax_s8(g_input, rows, row_size, mult, shift, diff_min,
+                         g_out_ref);
+      stat->ns_ref += test_now() - start;
+
+      start = test_now();
+      arm_softmax_s8(g_input, rows, row_size, mult, shift, diff_min,
+                     g_out_neon);
+      stat->ns_neon += test_now() - start;
+    }
+
+  snprintf(what, sizeof(what), "%dx%d shift %d diff_min %d", (int)rows,
+           (int)row_size, (int)shift, (int)diff_min);
+  test_check(stat, rows * row_size, what);
+}
+
+static void test_softmax(struct test_stat_s *stat)
+{
+  test_softmax_case(stat, 1, 10);
+  test_softmax_case(stat, 4, 37);
+  test_softmax_case(stat, 2, 1000);
+  test_softmax_case(stat, 16, 128);
+  test_softmax_case(stat, 1, 3);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+  struct test_stat_s stats[] =
+  {
+    { "depthwise_conv", 0, 0, 0, 0 },
+    { "fully_connected", 0, 0, 0, 0 },
+    { "max_pool", 0, 0, 0, 0 },
+    { "avgpool", 0, 0, 0, 0 },
+    { "softmax", 0, 0, 0, 0 },
+  };
+
+  int failed = 0;
+  size_t i;
+
+  if (argc > 1)
+    {
+      g_seed = strtoul(argv[1], NULL, 0) | 1;
+    }
+
+  test_depthwise(&stats[0]);
+  test_fc(&stats[1]);
+  test_pool(&stats[2], ref_arm_max_pool_s8, arm_max_pool_s8);
+  test_pool(&stats[3], ref_arm_avgpool_s8, arm_avgpool_s8);
+  test_softmax(&stats[4]);
+
+  printf("%-16s %6s %6s %12s %12s %8s\n", "operator", "cases", "failed",
+         "ref [us]", "neon [us]", "speedup");
+
+  for (i = 0; i < sizeof(stats) / sizeof(stats[0]); i++)
+    {
+      printf("%-16s %6d %6d %12.1f %12.1f %7.2fx\n", stats[i].name,
+             stats[i].cases, stats[i].failed,
+             stats[i].ns_ref / 1000.0 / TEST_ROUNDS,
+             stats[i].ns_neon / 1000.0 / TEST_ROUNDS,
+             stats[i].ns_neon ?
+             (double)stats[i].ns_ref / stats[i].ns_neon : 0.0);
+      failed += stats[i].failed;
+    }
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,158 @@
+/****************************************************************************
+ * apps/mlearning/tflite-micro/operators/neon/arm_avgpool_s8.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * SPDX-FileCopyrightText: 2010-2023 Arm Limited and/or its affiliates
+ * <open-source-office@arm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <arm_neon.h>
+#include "arm_nnfunctions.h"
+#include "arm_nnsupportfunctions.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Rounded average of one channel, the same rounding as the reference */
+
+__STATIC_FORCEINLINE int8_t arm_avg_s8(int32_t sum,
+                                       const int32_t count,
+                                       const int32_t act_min,
+                                       const int32_t act_max)
+{
+  sum = sum > 0 ? (sum + count / 2) / count : (sum - count / 2) / count;
+  sum = MAX(sum, act_min);
+  sum = MIN(sum, act_max);
+  return (int8_t)sum;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* s8 average pooling function.
+ *
+ * Refer header file for details.  The window of eight channels is summed
+ * into 32-bit lanes; the division stays scalar as NEON has no integer
+ * divide.  No scratch buffer is needed.
+ */
+
+arm_cmsis_nn_status arm_avgpool_s8(const cmsis_nn_context *ctx,
+                                   const cmsis_nn_pool_params *pool_params,
+                                   const cmsis_nn_dims *input_dims,
+                                   const int8_t *src,
+                                   const cmsis_nn_dims *filter_dims,
+                                   const cmsis_nn_dims *output_dims,
+                                   int8_t *dst)
+{
+  (void)ctx;
+
+  const int32_t batch_cnt = input_dims->n;
+  const int32_t input_y = input_dims->h;
+  const int32_t input_x = input_dims->w;
+  const int32_t output_y = output_dims->h;
+  const int32_t output_x = output_dims->w;
+  const int32_t stride_y = pool_params->stride.h;
+  const int32_t stride_x = pool_params->stride.w;
+  const int32_t kernel_y = filter_dims->h;
+  const int32_t kernel_x = filter_dims->w;
+  const int32_t pad_y = pool_params->padding.h;
+  const int32_t pad_x = pool_params->padding.w;
+  const int32_t act_min = pool_params->activation.min;
+  const int32_t act_max = pool_params->activation.max;
+  const int32_t ch_src = input_dims->c;
+
+  for (int32_t batch = 0; batch < batch_cnt; batch++)
+    {
+      for (int32_t i_y = 0; i_y < output_y; i_y++)
+        {
+          const int32_t idx_y = i_y * stride_y - pad_y;
+          const int32_t k_y_start = MAX(0, -idx_y);
+          const int32_t k_y_end = MIN(kernel_y, input_y - idx_y);
+
+          for (int32_t i_x = 0; i_x < output_x; i_x++)
+            {
+              const int32_t idx_x = i_x * stride_x - pad_x;
+              const int32_t k_x_start = MAX(0, -idx_x);
+              const int32_t k_x_end = MIN(kernel_x, input_x - idx_x);
+              const int32_t count = (k_y_end - k_y_start) *
+                                    (k_x_end - k_x_start);
+              const int8_t *base = src + (idx_y * input_x + idx_x) *
+                                   ch_src;
+              int32_t c = 0;
+
+              /* Prevent static code issue DIVIDE_BY_ZERO */
+
+              if (k_y_end <= k_y_start || k_x_end <= k_x_start)
+                {
+                  return ARM_CMSIS_NN_ARG_ERROR;
+                }
+
+              for (; c <= ch_src - 8; c += 8)
+                {
+                  int32x4_t sum_lo = vdupq_n_s32(0);
+                  int32x4_t sum_hi = vdupq_n_s32(0);
+                  int32_t sum[8];
+
+                  for (int32_t k_y = k_y_start; k_y < k_y_end; k_y++)
+                    {
+                      for (int32_t k_x = k_x_start; k_x < k_x_end; k_x++)
+                        {
+                          int16x8_t in_s16 = vmovl_s8(vld1_s8(base +
+                                    (k_y * input_x + k_x) * ch_src + c));
+
+                          sum_lo = vaddw_s16(sum_lo, vget_low_s16(in_s16));
+                          sum_hi = vaddw_s16(sum_hi, vget_high_s16(in_s16));
+                        }
+                    }
+
+                  vst1q_s32(sum, sum_lo);
+                  vst1q_s32(sum + 4, sum_hi);
+
+                  for (int32_t i = 0; i < 8; i++)
+                    {
+                      *dst++ = arm_avg_s8(sum[i], count, act_min, act_max);
+                    }
+                }
+
+              /* Remaining channels */
+
+              for (; c < ch_src; c++)
+                {
+                  int32_t sum = 0;
+
+                  for (int32_t k_y = k_y_start; k_y < k_y_end; k_y++)
+                    {
+                      for (int32_t k_x = k_x_start; k_x < k_x_end; k_x++)
+                        {
+                          sum += base[(k_y * input_x + k_x) * ch_src + c];
+                        }
+                    }
+
+                  *dst++ = arm_avg_s8(sum, count, act_min, act_max);
+                }
+            }
+        }
+
+      src += input_x * input_y * ch_src;
+    }
+
+  return ARM_CMSIS_NN_SUCCESS;
+}
@@ -0,0 +1,323 @@
+/****************************************************************************
+ * apps/mlearning/tflite-micro/operators/neon/arm_depthwise_conv_s8.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * SPDX-FileCopyrightText: 2010-2023 Arm Limited and/or its affiliates
+ * <open-source-office@arm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <arm_neon.h>
+#include "arm_nnfunctions.h"
+#include "arm_nnsupportfunctions.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Per-channel arm_nn_requantize() of four lanes */
+
+__STATIC_FORCEINLINE int32x4_t
+arm_requantize_ch_neon(const int32x4_t val,
+                       const int32_t *multiplier,
+                       const int32_t *shift)
+{
+  int32x4_t shift_s32 = vld1q_s32(shift);
+  int32x4_t left = vmaxq_s32(shift_s32, vdupq_n_s32(0));
+  int32x4_t right = vminq_s32(shift_s32, vdupq_n_s32(0));
+  int32x4_t dividend = vqrdmulhq_s32(vshlq_s32(val, left),
+                                     vld1q_s32(multiplier));
+  int32x4_t fixup = vshrq_n_s32(vandq_s32(dividend, right), 31);
+  return vrshlq_s32(vqaddq_s32(dividend, fixup), right);
+}
+
+/* Channel multiplier of one.  Eight channels of one output pixel are
+ * accumulated at a time, walking the taps of the filter window.
+ */
+
+static void depthwise_conv_s8_neon(const int8_t *input,
+                                   const int32_t input_x,
+                                   const int32_t input_y,
+                                   const int32_t ch,
+                                   const int8_t *kernel,
+                                   const int32_t kernel_x,
+                                   const int32_t kernel_y,
+                                   const int32_t *output_mult,
+                                   const int32_t *output_shift,
+                                   const int32_t *bias,
+                                   int8_t *output,
+                                   const int32_t output_x,
+                                   const int32_t output_y,
+                                   const cmsis_nn_dw_conv_params *params)
+{
+  const int32_t pad_x = params->padding.w;
+  const int32_t pad_y = params->padding.h;
+  const int32_t stride_x = params->stride.w;
+  const int32_t stride_y = params->stride.h;
+  const int32_t dilation_x = params->dilation.w;
+  const int32_t dilation_y = params->dilation.h;
+  const int32_t input_offset = params->input_offset;
+  const int32_t output_offset = params->output_offset;
+  const int32_t act_min = params->activation.min;
+  const int32_t act_max = params->activation.max;
+  const int16x8_t offset_s16 = vdupq_n_s16((int16_t)input_offset);
+  const int32x4_t out_offset_s32 = vdupq_n_s32(output_offset);
+  const int32x4_t act_min_s32 = vdupq_n_s32(act_min);
+  const int32x4_t act_max_s32 = vdupq_n_s32(act_max);
+
+  for (int32_t out_y = 0; out_y < output_y; out_y++)
+    {
+      const int32_t base_y = out_y * stride_y - pad_y;
+
+      for (int32_t out_x = 0; out_x < output_x; out_x++)
+        {
+          const int32_t base_x = out_x * stride_x - pad_x;
+          int32_t c = 0;
+
+          for (; c <= ch - 8; c += 8)
+            {
+              int32x4_t acc_lo = vdupq_n_s32(0);
+              int32x4_t acc_hi = vdupq_n_s32(0);
+
+              if (bias)
+                {
+                  acc_lo = vld1q_s32(bias + c);
+                  acc_hi = vld1q_s32(bias + c + 4);
+                }
+
+              for (int32_t ky = 0; ky < kernel_y; ky++)
+                {
+                  const int32_t in_y = base_y + ky * dilation_y;
+
+                  if (in_y < 0 || in_y >= input_y)
+                    {
+                      continue;
+                    }
+
+                  for (int32_t kx = 0; kx < kernel_x; kx++)
+                    {
+                      const int32_t in_x = base_x + kx * dilation_x;
+                      int16x8_t in_s16;
+                      int16x8_t ker_s16;
+
+                      if (in_x < 0 || in_x >= input_x)
+                        {
+                          continue;
+                        }
+
+                      in_s16 = vmovl_s8(vld1_s8(input +
+                                        (in_y * input_x + in_x) * ch + c));
+                      in_s16 = vaddq_s16(in_s16, offset_s16);
+                      ker_s16 = vmovl_s8(vld1_s8(kernel +
+                                         (ky * kernel_x + kx) * ch + c));
+
+                      acc_lo = vmlal_s16(acc_lo, vget_low_s16(in_s16),
+                                         vget_low_s16(ker_s16));
+                      acc_hi = vmlal_s16(acc_hi, vget_high_s16(in_s16),
+                                         vget_high_s16(ker_s16));
+                    }
+                }
+
+              acc_lo = arm_requantize_ch_neon(acc_lo, output_mult + c,
+                                              output_shift + c);
+              acc_hi = arm_requantize_ch_neon(acc_hi, output_mult + c + 4,
+                                              output_shift + c + 4);
+
+              acc_lo = vaddq_s32(acc_lo, out_offset_s32);
+              acc_hi = vaddq_s32(acc_hi, out_offset_s32);
+              acc_lo = vminq_s32(vmaxq_s32(acc_lo, act_min_s32),
+                                 act_max_s32);
+              acc_hi = vminq_s32(vmaxq_s32(acc_hi, act_min_s32),
+                                 act_max_s32);
+
+              vst1_s8(output, vmovn_s16(vcombine_s16(vmovn_s32(acc_lo),
+                                                     vmovn_s32(acc_hi))));
+              output += 8;
+            }
+
+          /* Remaining channels */
+
+          for (; c < ch; c++)
+            {
+              int32_t acc = bias ? bias[c] : 0;
+
+              for (int32_t ky = 0; ky < kernel_y; ky++)
+                {
+                  const int32_t in_y = base_y + ky * dilation_y;
+
+                  if (in_y < 0 || in_y >= input_y)
+                    {
+                      continue;
+                    }
+
+                  for (int32_t kx = 0; kx < kernel_x; kx++)
+                    {
+                      const int32_t in_x = base_x + kx * dilation_x;
+
+                      if (in_x < 0 || in_x >= input_x)
+                        {
+                          continue;
+                        }
+
+                      acc += (input[(in_y * input_x + in_x) * ch + c] +
+                              input_offset) *
+                             kernel[(ky * kernel_x + kx) * ch + c];
+                    }
+                }
+
+              acc = arm_nn_requantize(acc, output_mult[c], output_shift[c]);
+              acc += output_offset;
+              acc = MAX(acc, act_min);
+              acc = MIN(acc, act_max);
+              *output++ = (int8_t)acc;
+            }
+        }
+    }
+}
+
+/* Channel multiplier above one, output channel c * ch_mult + m reads input
+ * channel c.
+ */
+
+static void depthwise_conv_s8_generic(const int8_t *input,
+                                      const int32_t input_x,
+                                      const int32_t input_y,
+                                      const int32_t input_ch,
+                                      const int8_t *kernel,
+                                      const int32_t kernel_x,
+                                      const int32_t kernel_y,
+                                      const int32_t *output_mult,
+                                      const int32_t *output_shift,
+                                      const int32_t *bias,
+                                      int8_t *output,
+                                      const int32_t output_x,
+                                      const int32_t output_y,
+                                      const cmsis_nn_dw_conv_params *params)
+{
+  const int32_t ch_mult = params->ch_mult;
+  const int32_t output_ch = input_ch * ch_mult;
+  const int32_t input_offset = params->input_offset;
+
+  for (int32_t out_y = 0; out_y < output_y; out_y++)
+    {
+      const int32_t base_y = out_y * params->stride.h - params->padding.h;
+
+      for (int32_t out_x = 0; out_x < output_x; out_x++)
+        {
+          const int32_t base_x = out_x * params->stride.w -
+                                 params->padding.w;
+
+          for (int32_t oc = 0; oc < output_ch; oc++)
+            {
+              const int32_t ic = oc / ch_mult;
+              int32_t acc = bias ? bias[oc] : 0;
+
+              for (int32_t ky = 0; ky < kernel_y; ky++)
+                {
+                  const int32_t in_y = base_y + ky * params->dilation.h;
+
+                  if (in_y < 0 || in_y >= input_y)
+                    {
+                      continue;
+                    }
+
+                  for (int32_t kx = 0; kx < kernel_x; kx++)
+                    {
+                      const int32_t in_x = base_x + kx * params->dilation.w;
+
+                      if (in_x < 0 || in_x >= input_x)
+                        {
+                          continue;
+                        }
+
+                      acc += (input[(in_y * input_x + in_x) * input_ch +
+                                    ic] + input_offset) *
+                             kernel[(ky * kernel_x + kx) * output_ch + oc];
+                    }
+                }
+
+              acc = arm_nn_requantize(acc, output_mult[oc],
+                                      output_shift[oc]);
+              acc += params->output_offset;
+              acc = MAX(acc, params->activation.min);
+              acc = MIN(acc, params->activation.max);
+              *output++ = (int8_t)acc;
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* Basic s8 depthwise convolution function.
+ *
+ * Refer header file for details.  Also serves arm_depthwise_conv_s8_opt()
+ * and arm_depthwise_conv_3x3_s8(), no scratch buffer is needed.
+ */
+
+arm_cmsis_nn_status
+arm_depthwise_conv_s8(const cmsis_nn_context *ctx,
+                      const cmsis_nn_dw_conv_params *dw_conv_params,
+                      const cmsis_nn_per_channel_quant_params *quant_params,
+                      const cmsis_nn_dims *input_dims,
+                      const int8_t *input,
+                      const cmsis_nn_dims *filter_dims,
+                      const int8_t *kernel,
+                      const cmsis_nn_dims *bias_dims,
+                      const int32_t *bias,
+                      const cmsis_nn_dims *output_dims,
+                      int8_t *output)
+{
+  (void)ctx;
+  (void)bias_dims;
+
+  const int32_t input_batches = input_dims->n;
+  const int32_t input_x = input_dims->w;
+  const int32_t input_y = input_dims->h;
+  const int32_t input_ch = input_dims->c;
+  const int32_t output_x = output_dims->w;
+  const int32_t output_y = output_dims->h;
+  const int32_t output_ch = output_dims->c;
+
+  for (int32_t batch = 0; batch < input_batches; batch++)
+    {
+      if (dw_conv_params->ch_mult == 1)
+        {
+          depthwise_conv_s8_neon(input, input_x, input_y, input_ch,
+                                 kernel, filter_dims->w, filter_dims->h,
+                                 quant_params->multiplier,
+                                 quant_params->shift, bias, output,
+                                 output_x, output_y, dw_conv_params);
+        }
+      else
+        {
+          depthwise_conv_s8_generic(input, input_x, input_y, input_ch,
+                                    kernel, filter_dims->w, filter_dims->h,
+                                    quant_params->multiplier,
+                                    quant_params->shift, bias, output,
+                                    output_x, output_y, dw_conv_params);
+        }
+
+      input += input_x * input_y * input_ch;
+      output += output_x * output_y * output_ch;
+    }
+
+  return ARM_CMSIS_NN_SUCCESS;
+}
@@ -0,0 +1,56 @@
+/****************************************************************************
+ * apps/mlearning/tflite-micro/operators/neon/arm_depthwise_conv_s8_opt.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * SPDX-FileCopyrightText: 2010-2023 Arm Limited and/or its affiliates
+ * <open-source-office@arm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "arm_nnfunctions.h"
+#include "arm_nnsupportfunctions.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* Optimized s8 depthwise convolution function with the constraint that
+ * in_channel equals out_channel.
+ *
+ * Refer header file for details.  The NEON arm_depthwise_conv_s8() covers
+ * this case, so no scratch buffer is needed.
+ */
+
+arm_cmsis_nn_status
+arm_depthwise_conv_s8_opt(const cmsis_nn_context *ctx,
+                          const cmsis_nn_dw_conv_params *dw_conv_params,
+                          const cmsis_nn_per_channel_quant_params
+                          *quant_params,
+                          const cmsis_nn_dims *input_dims,
+                          const int8_t *input,
+                          const cmsis_nn_dims *filter_dims,
+                          const int8_t *kernel,
+                          const cmsis_nn_dims *bias_dims,
+                          const int32_t *bias,
+                          const cmsis_nn_dims *output_dims,
+                          int8_t *output)
+{
+  return arm_depthwise_conv_s8(ctx, dw_conv_params, quant_params,
+                               input_dims, input, filter_dims, kernel,
+                               bias_dims, bias, output_dims, output);
+}
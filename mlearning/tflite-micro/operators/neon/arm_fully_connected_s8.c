@@ -0,0 +1,236 @@
+/****************************************************************************
+ * apps/mlearning/tflite-micro/operators/neon/arm_fully_connected_s8.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * SPDX-FileCopyrightText: 2010-2023 Arm Limited and/or its affiliates
+ * <open-source-office@arm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <arm_neon.h>
+#include "arm_nnfunctions.h"
+#include "arm_nnsupportfunctions.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Horizontal sums of four accumulators, lane i holds the sum of acc_i */
+
+__STATIC_FORCEINLINE int32x4_t arm_hadd4_neon(const int32x4_t acc_0,
+                                              const int32x4_t acc_1,
+                                              const int32x4_t acc_2,
+                                              const int32x4_t acc_3)
+{
+  int32x2_t sum_0 = vpadd_s32(vget_low_s32(acc_0), vget_high_s32(acc_0));
+  int32x2_t sum_1 = vpadd_s32(vget_low_s32(acc_1), vget_high_s32(acc_1));
+  int32x2_t sum_2 = vpadd_s32(vget_low_s32(acc_2), vget_high_s32(acc_2));
+  int32x2_t sum_3 = vpadd_s32(vget_low_s32(acc_3), vget_high_s32(acc_3));
+
+  return vcombine_s32(vpadd_s32(sum_0, sum_1), vpadd_s32(sum_2, sum_3));
+}
+
+__STATIC_FORCEINLINE int8_t arm_fc_output_s8(int32_t acc,
+                                             const int32_t multiplier,
+                                             const int32_t shift,
+                                             const int32_t out_offset,
+                                             const int32_t act_min,
+                                             const int32_t act_max)
+{
+  acc = arm_nn_requantize(acc, multiplier, shift);
+  acc += out_offset;
+  acc = MAX(acc, act_min);
+  acc = MIN(acc, act_max);
+  return (int8_t)acc;
+}
+
+/* One batch: output[r] = sum_k (lhs[k] + lhs_offset) * rhs[r][k] + bias[r].
+ * Four rows of the weight matrix share every widened input vector.
+ */
+
+static void vec_mat_mult_t_s8_neon(const int8_t *lhs,
+                                   const int8_t *rhs,
+                                   const int32_t *bias,
+                                   int8_t *dst,
+                                   const int32_t lhs_offset,
+                                   const int32_t dst_offset,
+                                   const int32_t dst_multiplier,
+                                   const int32_t dst_shift,
+                                   const int32_t rhs_cols,
+                                   const int32_t rhs_rows,
+                                   const int32_t act_min,
+                                   const int32_t act_max)
+{
+  const int16x8_t offset_s16 = vdupq_n_s16((int16_t)lhs_offset);
+  const int32_t col_loop = rhs_cols / 8;
+  int32_t row = 0;
+
+  for (; row <= rhs_rows - 4; row += 4)
+    {
+      const int8_t *rhs_0 = rhs + row * rhs_cols;
+      const int8_t *rhs_1 = rhs_0 + rhs_cols;
+      const int8_t *rhs_2 = rhs_1 + rhs_cols;
+      const int8_t *rhs_3 = rhs_2 + rhs_cols;
+      const int8_t *lhs_ptr = lhs;
+      int32x4_t acc_0 = vdupq_n_s32(0);
+      int32x4_t acc_1 = vdupq_n_s32(0);
+      int32x4_t acc_2 = vdupq_n_s32(0);
+      int32x4_t acc_3 = vdupq_n_s32(0);
+      int32_t sum[4];
+      int32_t col;
+
+      for (col = 0; col < col_loop; col++)
+        {
+          int16x8_t in_s16 = vaddq_s16(vmovl_s8(vld1_s8(lhs_ptr)),
+                                       offset_s16);
+          int16x4_t in_lo = vget_low_s16(in_s16);
+          int16x4_t in_hi = vget_high_s16(in_s16);
+          int16x8_t ker_s16;
+
+          ker_s16 = vmovl_s8(vld1_s8(rhs_0));
+          acc_0 = vmlal_s16(acc_0, in_lo, vget_low_s16(ker_s16));
+          acc_0 = vmlal_s16(acc_0, in_hi, vget_high_s16(ker_s16));
+          ker_s16 = vmovl_s8(vld1_s8(rhs_1));
+          acc_1 = vmlal_s16(acc_1, in_lo, vget_low_s16(ker_s16));
+          acc_1 = vmlal_s16(acc_1, in_hi, vget_high_s16(ker_s16));
+          ker_s16 = vmovl_s8(vld1_s8(rhs_2));
+          acc_2 = vmlal_s16(acc_2, in_lo, vget_low_s16(ker_s16));
+          acc_2 = vmlal_s16(acc_2, in_hi, vget_high_s16(ker_s16));
+          ker_s16 = vmovl_s8(vld1_s8(rhs_3));
+          acc_3 = vmlal_s16(acc_3, in_lo, vget_low_s16(ker_s16));
+          acc_3 = vmlal_s16(acc_3, in_hi, vget_high_s16(ker_s16));
+
+          lhs_ptr += 8;
+          rhs_0 += 8;
+          rhs_1 += 8;
+          rhs_2 += 8;
+          rhs_3 += 8;
+        }
+
+      vst1q_s32(sum, arm_hadd4_neon(acc_0, acc_1, acc_2, acc_3));
+
+      for (col = col_loop * 8; col < rhs_cols; col++)
+        {
+          const int32_t in = *lhs_ptr++ + lhs_offset;
+
+          sum[0] += in * *rhs_0++;
+          sum[1] += in * *rhs_1++;
+          sum[2] += in * *rhs_2++;
+          sum[3] += in * *rhs_3++;
+        }
+
+      for (col = 0; col < 4; col++)
+        {
+          if (bias)
+            {
+              sum[col] += bias[row + col];
+            }
+
+          *dst++ = arm_fc_output_s8(sum[col], dst_multiplier, dst_shift,
+                                    dst_offset, act_min, act_max);
+        }
+    }
+
+  /* Remaining rows */
+
+  for (; row < rhs_rows; row++)
+    {
+      const int8_t *rhs_0 = rhs + row * rhs_cols;
+      const int8_t *lhs_ptr = lhs;
+      int32x4_t acc_0 = vdupq_n_s32(0);
+      int32_t sum;
+      int32_t col;
+
+      for (col = 0; col < col_loop; col++)
+        {
+          int16x8_t in_s16 = vaddq_s16(vmovl_s8(vld1_s8(lhs_ptr)),
+                                       offset_s16);
+          int16x8_t ker_s16 = vmovl_s8(vld1_s8(rhs_0));
+
+          acc_0 = vmlal_s16(acc_0, vget_low_s16(in_s16),
+                            vget_low_s16(ker_s16));
+          acc_0 = vmlal_s16(acc_0, vget_high_s16(in_s16),
+                            vget_high_s16(ker_s16));
+          lhs_ptr += 8;
+          rhs_0 += 8;
+        }
+
+      sum = vgetq_lane_s32(arm_hadd4_neon(acc_0, acc_0, acc_0, acc_0), 0);
+
+      for (col = col_loop * 8; col < rhs_cols; col++)
+        {
+          sum += (*lhs_ptr++ + lhs_offset) * *rhs_0++;
+        }
+
+      if (bias)
+        {
+          sum += bias[row];
+        }
+
+      *dst++ = arm_fc_output_s8(sum, dst_multiplier, dst_shift,
+                                dst_offset, act_min, act_max);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* S8 basic fully-connected and matrix multiplication layer function for
+ * TensorFlow Lite.
+ *
+ * Refer header file for details.
+ */
+
+arm_cmsis_nn_status
+arm_fully_connected_s8(const cmsis_nn_context *ctx,
+                       const cmsis_nn_fc_params *fc_params,
+                       const cmsis_nn_per_tensor_quant_params *quant_params,
+                       const cmsis_nn_dims *input_dims,
+                       const int8_t *input,
+                       const cmsis_nn_dims *filter_dims,
+                       const int8_t *kernel,
+                       const cmsis_nn_dims *bias_dims,
+                       const int32_t *bias,
+                       const cmsis_nn_dims *output_dims,
+                       int8_t *output)
+{
+  (void)bias_dims;
+  (void)ctx;
+  (void)fc_params->filter_offset;
+
+  int32_t batch_cnt = input_dims->n;
+
+  while (batch_cnt)
+    {
+      vec_mat_mult_t_s8_neon(input, kernel, bias, output,
+                             fc_params->input_offset,
+                             fc_params->output_offset,
+                             quant_params->multiplier,
+                             quant_params->shift,
+                             filter_dims->n, /* col_dim or accum_depth */
+                             output_dims->c, /* row_dim or output_depth */
+                             fc_params->activation.min,
+                             fc_params->activation.max);
+      input += filter_dims->n;
+      output += output_dims->c;
+      batch_cnt--;
+    }
+
+  return ARM_CMSIS_NN_SUCCESS;
+}
@@ -0,0 +1,130 @@
+/****************************************************************************
+ * apps/mlearning/tflite-micro/operators/neon/arm_max_pool_s8.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * SPDX-FileCopyrightText: 2010-2023 Arm Limited and/or its affiliates
+ * <open-source-office@arm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <arm_neon.h>
+#include "arm_nnfunctions.h"
+#include "arm_nnsupportfunctions.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* Optimized s8 max pooling function.
+ *
+ * Refer header file for details.  Sixteen channels of one output pixel are
+ * reduced at a time over the part of the window inside the input.
+ */
+
+arm_cmsis_nn_status arm_max_pool_s8(const cmsis_nn_context *ctx,
+                                    const cmsis_nn_pool_params *pool_params,
+                                    const cmsis_nn_dims *input_dims,
+                                    const int8_t *src,
+                                    const cmsis_nn_dims *filter_dims,
+                                    const cmsis_nn_dims *output_dims,
+                                    int8_t *dst)
+{
+  (void)ctx;
+
+  const int32_t batch_cnt = input_dims->n;
+  const int32_t input_y = input_dims->h;
+  const int32_t input_x = input_dims->w;
+  const int32_t output_y = output_dims->h;
+  const int32_t output_x = output_dims->w;
+  const int32_t stride_y = pool_params->stride.h;
+  const int32_t stride_x = pool_params->stride.w;
+  const int32_t kernel_y = filter_dims->h;
+  const int32_t kernel_x = filter_dims->w;
+  const int32_t pad_y = pool_params->padding.h;
+  const int32_t pad_x = pool_params->padding.w;
+  const int32_t act_min = pool_params->activation.min;
+  const int32_t act_max = pool_params->activation.max;
+  const int32_t channel_in = input_dims->c;
+  const int8x16_t act_min_s8 = vdupq_n_s8((int8_t)act_min);
+  const int8x16_t act_max_s8 = vdupq_n_s8((int8_t)act_max);
+
+  for (int32_t batch = 0; batch < batch_cnt; batch++)
+    {
+      for (int32_t i_y = 0; i_y < output_y; i_y++)
+        {
+          const int32_t idx_y = i_y * stride_y - pad_y;
+          const int32_t ker_y_start = MAX(0, -idx_y);
+          const int32_t ker_y_end = MIN(kernel_y, input_y - idx_y);
+
+          for (int32_t i_x = 0; i_x < output_x; i_x++)
+            {
+              const int32_t idx_x = i_x * stride_x - pad_x;
+              const int32_t ker_x_start = MAX(0, -idx_x);
+              const int32_t ker_x_end = MIN(kernel_x, input_x - idx_x);
+              const int8_t *base = src + (idx_y * input_x + idx_x) *
+                                   channel_in;
+              int32_t c = 0;
+
+              for (; c <= channel_in - 16; c += 16)
+                {
+                  int8x16_t max = vdupq_n_s8(NN_Q7_MIN);
+
+                  for (int32_t k_y = ker_y_start; k_y < ker_y_end; k_y++)
+                    {
+                      for (int32_t k_x = ker_x_start; k_x < ker_x_end;
+                           k_x++)
+                        {
+                          max = vmaxq_s8(max, vld1q_s8(base +
+                                (k_y * input_x + k_x) * channel_in + c));
+                        }
+                    }
+
+                  max = vmaxq_s8(max, act_min_s8);
+                  max = vminq_s8(max, act_max_s8);
+                  vst1q_s8(dst, max);
+                  dst += 16;
+                }
+
+              /* Remaining channels */
+
+              for (; c < channel_in; c++)
+                {
+                  int32_t max = NN_Q7_MIN;
+
+                  for (int32_t k_y = ker_y_start; k_y < ker_y_end; k_y++)
+                    {
+                      for (int32_t k_x = ker_x_start; k_x < ker_x_end;
+                           k_x++)
+                        {
+                          max = MAX(max, base[(k_y * input_x + k_x) *
+                                              channel_in + c]);
+                        }
+                    }
+
+                  max = MAX(max, act_min);
+                  max = MIN(max, act_max);
+                  *dst++ = (int8_t)max;
+                }
+            }
+        }
+
+      src += input_x * input_y * channel_in;
+    }
+
+  return ARM_CMSIS_NN_SUCCESS;
+}
@@ -0,0 +1,178 @@
+/****************************************************************************
+ * apps/mlearning/tflite-micro/operators/neon/arm_softmax_s8.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ * SPDX-FileCopyrightText: 2010-2023 Arm Limited and/or its affiliates
+ * <open-source-office@arm.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <arm_neon.h>
+#include "arm_nnfunctions.h"
+#include "arm_nnsupportfunctions.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define ACCUM_BITS 12
+
+/* input - max of a row lies in [-255, 0] */
+
+#define EXP_LUT_SIZE 256
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Largest and smallest element of a row */
+
+static void arm_minmax_s8_neon(const int8_t *input,
+                               const int32_t row_size,
+                               int8_t *min,
+                               int8_t *max)
+{
+  int8x16_t max_s8 = vdupq_n_s8(input[0]);
+  int8x16_t min_s8 = max_s8;
+  int8x8_t max_d;
+  int8x8_t min_d;
+  int32_t col = 0;
+
+  for (; col <= row_size - 16; col += 16)
+    {
+      int8x16_t in = vld1q_s8(input + col);
+
+      max_s8 = vmaxq_s8(max_s8, in);
+      min_s8 = vminq_s8(min_s8, in);
+    }
+
+  max_d = vmax_s8(vget_low_s8(max_s8), vget_high_s8(max_s8));
+  min_d = vmin_s8(vget_low_s8(min_s8), vget_high_s8(min_s8));
+  max_d = vpmax_s8(max_d, max_d);
+  min_d = vpmin_s8(min_d, min_d);
+  max_d = vpmax_s8(max_d, max_d);
+  min_d = vpmin_s8(min_d, min_d);
+  max_d = vpmax_s8(max_d, max_d);
+  min_d = vpmin_s8(min_d, min_d);
+
+  *max = vget_lane_s8(max_d, 0);
+  *min = vget_lane_s8(min_d, 0);
+
+  for (; col < row_size; col++)
+    {
+      *max = MAX(*max, input[col]);
+      *min = MIN(*min, input[col]);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* S8 softmax function.
+ *
+ * Refer header file for details.  The difference to the row maximum takes
+ * at most 256 values, so exp() of each difference is computed once per
+ * call into a table, in the exact fixed point arithmetic of the reference,
+ * and the table is filled only as far as the rows reach.  Differences below
+ * diff_min map to zero, which yields NN_Q7_MIN as in the reference.  The
+ * final scaling runs on four lanes.
+ */
+
+void arm_softmax_s8(const int8_t *input,
+                    const int32_t num_rows,
+                    const int32_t row_size,
+                    const int32_t mult,
+                    const int32_t shift,
+                    const int32_t diff_min,
+                    int8_t *output)
+{
+  const int32_t mask = (1 << shift);
+  const int32x4_t q7_min_s32 = vdupq_n_s32(NN_Q7_MIN);
+  const int32x4_t q7_max_s32 = vdupq_n_s32(NN_Q7_MAX);
+  int32_t exp_lut[EXP_LUT_SIZE];
+  int32_t lut_filled = 0;
+  int32_t row_idx;
+
+  for (row_idx = 0; row_idx < num_rows; ++row_idx)
+    {
+      int32_t sum = 0;
+      int32_t col = 0;
+      int8_t max;
+      int8_t min;
+
+      arm_minmax_s8_neon(input, row_size, &min, &max);
+
+      for (; lut_filled <= max - min; lut_filled++)
+        {
+          const int32_t diff = -lut_filled;
+
+          exp_lut[lut_filled] = diff >= diff_min ?
+                                EXP_ON_NEG(MUL_SAT(diff * mask, mult)) : 0;
+        }
+
+      for (col = 0; col < row_size; ++col)
+        {
+          sum += DIV_POW2(exp_lut[max - input[col]], ACCUM_BITS);
+        }
+
+      const int32_t headroom = __CLZ(sum);
+      const int32_t shifted_scale =
+        ONE_OVER1((sum > 0 ? sum << headroom : 0) - (1 << 31));
+      const int32_t bits_over_unit = ACCUM_BITS - headroom + 23;
+      const int32x4_t right = vdupq_n_s32(-bits_over_unit);
+
+      for (col = 0; col <= row_size - 4; col += 4)
+        {
+          int32_t exp[4];
+          int32x4_t res;
+
+          exp[0] = exp_lut[max - input[col]];
+          exp[1] = exp_lut[max - input[col + 1]];
+          exp[2] = exp_lut[max - input[col + 2]];
+          exp[3] = exp_lut[max - input[col + 3]];
+
+          /* DIV_POW2(MUL_SAT(shifted_scale, exp), bits_over_unit) */
+
+          res = vqrdmulhq_n_s32(vld1q_s32(exp), shifted_scale);
+          res = vqaddq_s32(res, vshrq_n_s32(vandq_s32(res, right), 31));
+          res = vrshlq_s32(res, right);
+
+          res = vaddq_s32(res, q7_min_s32);
+          res = vminq_s32(vmaxq_s32(res, q7_min_s32), q7_max_s32);
+
+          output[col] = (int8_t)vgetq_lane_s32(res, 0);
+          output[col + 1] = (int8_t)vgetq_lane_s32(res, 1);
+          output[col + 2] = (int8_t)vgetq_lane_s32(res, 2);
+          output[col + 3] = (int8_t)vgetq_lane_s32(res, 3);
+        }
+
+      for (; col < row_size; ++col)
+        {
+          const int32_t res =
+            DIV_POW2(MUL_SAT(shifted_scale, exp_lut[max - input[col]]),
+                     bits_over_unit) + NN_Q7_MIN;
+
+          output[col] = (int8_t)CLAMP(res, (int32_t)NN_Q7_MAX,
+                                      (int32_t)NN_Q7_MIN);
+        }
+
+      input += row_size;
+      output += row_size;
+    }
+}
@@ -24,32 +24,472 @@
  * Included Files
  ****************************************************************************/
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <time.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <memory>
+#include <new>
+#include <vector>
 
 #include "tensorflow/lite/micro/micro_interpreter.h"
 #include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
 #include "tensorflow/lite/micro/micro_profiler.h"
 
+#ifdef CONFIG_TFLITEMICRO_TOOL_RESOLVER
+#  include "tflm_resolver.h"
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Arena sizes found by the search are rounded up to this granularity.
+ * The arenas are aligned to it too, the smallest size found holds for
+ * arenas aligned the same way only.
+ */
+
+#define TFLM_ARENA_ALIGN  16
+#define TFLM_ARENA_MAX    (64 * 1024 * 1024)
+
+/* Alignment tflite-micro expects of a model used in place */
+
+#define TFLM_MODEL_ALIGN  16
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static uint64_t tflm_now(void);
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The model flatbuffer.  It is either read into the heap, mapped, which
+ * on NuttX points straight into ROMFS or other XIP media, or used in
+ * place at a given address.  The last two cost no RAM for the model.
+ */
+
+class ModelImage
+{
+public:
+  ~ModelImage()
+  {
+    if (mapped_)
+      {
+        munmap(const_cast<uint8_t*>(data_), size_);
+      }
+  }
+
+  bool Read(const char* path)
+  {
+    std::ifstream ifs(path, std::ios::binary);
+
+    if (!ifs)
+      {
+        return false;
+      }
+
+    ifs.seekg(0, std::ios::end);
+    size_ = ifs.tellg();
+    heap_.reset(new uint8_t[size_]);
+
+    ifs.seekg(0, std::ios::beg);
+    ifs.read(reinterpret_cast<char*>(heap_.get()), size_);
+    data_ = heap_.get();
+    return ifs.good();
+  }
+
+  bool Map(const char* path)
+  {
+    struct stat st;
+    void* addr;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+      {
+        return false;
+      }
+
+    if (fstat(fd, &st) < 0)
+      {
+        close(fd);
+        return false;
+      }
+
+    addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+      {
+        return false;
+      }
+
+    data_ = static_cast<const uint8_t*>(addr);
+    size_ = st.st_size;
+    mapped_ = true;
+    return true;
+  }
+
+  void Place(uintptr_t addr)
+  {
+    data_ = reinterpret_cast<const uint8_t*>(addr);
+  }
+
+  const uint8_t* data(void) const
+  {
+    return data_;
+  }
+
+private:
+  std::unique_ptr<uint8_t[]> heap_;
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+};
+
+/* A tensor arena starting at a TFLM_ARENA_ALIGN boundary.  The usable
+ * size of an arena does not depend on where the heap placed it then, so
+ * the size found by the search works for every arena allocated here.
+ * get() is nullptr if the allocation failed.
+ */
+
+class TensorArena
+{
+public:
+  explicit TensorArena(size_t size)
+    : heap_(new (std::nothrow) uint8_t[size + TFLM_ARENA_ALIGN - 1])
+  {
+  }
+
+  uint8_t* get(void) const
+  {
+    uintptr_t addr = reinterpret_cast<uintptr_t>(heap_.get());
+
+    if (addr == 0)
+      {
+        return nullptr;
+      }
+
+    addr = (addr + TFLM_ARENA_ALIGN - 1) & ~(uintptr_t)(TFLM_ARENA_ALIGN - 1);
+    return reinterpret_cast<uint8_t*>(addr);
+  }
+
+private:
+  std::unique_ptr<uint8_t[]> heap_;
+};
+
+/* Profiler for the benchmark mode.  MicroProfiler keeps only the last
+ * invocation and its tick source is the coarse clock(), so record the
+ * duration of every event with CLOCK_MONOTONIC instead and keep one
+ * sample per operator and invocation.  Operators run in the same order
+ * on every invocation, so the position of an event identifies it.
+ */
+
+class BenchProfiler : public tflite::MicroProfilerInterface
+{
+public:
+  uint32_t BeginEvent(const char* tag) override
+  {
+    uint32_t handle = events_.size();
+
+    events_.push_back({tag, tflm_now()});
+    return handle;
+  }
+
+  void EndEvent(uint32_t event_handle) override
+  {
+    Event& ev = events_[event_handle];
+
+    ev.start = tflm_now() - ev.start;
+  }
+
+  /* Start recording a new invocation */
+
+  void Begin(void)
+  {
+    events_.clear();
+  }
+
+  /* Add the invocation just recorded to the samples */
+
+  void Commit(void)
+  {
+    if (samples_.size() < events_.size())
+      {
+        samples_.resize(events_.size());
+        tags_.resize(events_.size());
+      }
+
+    for (size_t i = 0; i < events_.size(); i++)
+      {
+        tags_[i] = events_[i].tag;
+        samples_[i].push_back(events_[i].start);
+      }
+  }
+
+  size_t Count(void) const
+  {
+    return samples_.size();
+  }
+
+  const char* Tag(size_t i) const
+  {
+    return tags_[i];
+  }
+
+  /* Minimum, median and 99th percentile of an operator in nanoseconds */
+
+  void Stats(size_t i, uint64_t* min, uint64_t* median, uint64_t* p99)
+  {
+    std::vector<uint64_t>& v = samples_[i];
+    size_t n = v.size();
+
+    std::sort(v.begin(), v.end());
+    *min = v[0];
+    *median = v[n / 2];
+    *p99 = v[std::min(n - 1, (n * 99 + 99) / 100 - 1)];
+  }
+
+private:
+  struct Event
+  {
+    const char* tag;
+    uint64_t start;       /* Start time, the duration once ended */
+  };
+
+  std::vector<Event> events_;
+  std::vector<const char*> tags_;
+  std::vector<std::vector<uint64_t>> samples_;
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+static uint64_t tflm_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
 static void usage(void)
 {
   printf("\nUtility to use tflite micro on nuttx.\n"
     "[ -C       ] Compile tflite model into c++ codes.\n"
     "[ -E       ] Do once evaluation (for profiling).\n"
+    "[ -B       ] Benchmark: warm-up plus timed evaluations.\n"
+    "[ -S       ] Search the smallest working arena size.\n"
+    "[ -w <int> ] Warm-up evaluations of -B (default 2).\n"
+    "[ -n <int> ] Timed evaluations of -B (default 10).\n"
+    "[ -c <str> ] Writable CSV file path of -B and -S, - for stdout.\n"
     "[ -i <str> ] Readable model file path.\n"
+    "[ -m       ] Map the model file instead of reading it.\n"
+    "[ -x <int> ] Use the model in place at this (XIP) address.\n"
     "[ -o <str> ] Writable c++ file path.\n"
     "[ -p <str> ] Prefix of compiled code.\n"
     "[ -a <int> ] Arena size (mempool).\n"
     "[ -h       ] Print this message.\n");
 }
 
+/* Check whether all tensors of the model fit into an aligned arena of the
+ * given size.  Prepare of every operator runs here, so an arena passing
+ * this check also works for Invoke().  Returns 1 if the model fits, 0 if
+ * not and -1 if the arena cannot be allocated.
+ */
+
+static int arena_fits(const tflite::Model* model,
+                      const tflite::MicroOpResolver& resolver,
+                      size_t arenaSize)
+{
+  TensorArena arena(arenaSize);
+
+  if (arena.get() == nullptr)
+    {
+      printf("Failed to allocate a %zu byte arena.\n", arenaSize);
+      return -1;
+    }
+
+  tflite::MicroInterpreter interpreter(model, resolver, arena.get(),
+                                       arenaSize);
+
+  return interpreter.AllocateTensors() == kTfLiteOk;
+}
+
+/* Find the smallest TFLM_ARENA_ALIGN aligned arena the model can be
+ * allocated in, starting the search from the given size.  Arenas at other
+ * addresses may lose up to TFLM_ARENA_ALIGN - 1 bytes to alignment.
+ * Returns 0 if even TFLM_ARENA_MAX fails or memory runs out.
+ */
+
+static size_t arena_search(const tflite::Model* model,
+                           const tflite::MicroOpResolver& resolver,
+                           size_t arenaSize)
+{
+  size_t lo = 0;
+  size_t hi = (arenaSize + TFLM_ARENA_ALIGN - 1) & ~(TFLM_ARENA_ALIGN - 1);
+  int fits;
+
+  /* Grow until the model fits, then bisect between the last failing and
+   * the first working size.
+   */
+
+  while ((fits = arena_fits(model, resolver, hi)) == 0)
+    {
+      lo = hi;
+      hi *= 2;
+      if (hi > TFLM_ARENA_MAX)
+        {
+          printf("Model does not fit in %d bytes.\n", TFLM_ARENA_MAX);
+          return 0;
+        }
+    }
+
+  if (fits < 0)
+    {
+      return 0;
+    }
+
+  while (hi - lo > TFLM_ARENA_ALIGN)
+    {
+      size_t mid = (lo + (hi - lo) / 2) & ~(TFLM_ARENA_ALIGN - 1);
+
+      if (mid <= lo)
+        {
+          mid = lo + TFLM_ARENA_ALIGN;
+        }
+
+      fits = arena_fits(model, resolver, mid);
+      if (fits < 0)
+        {
+          return 0;
+        }
+      else if (fits)
+        {
+          hi = mid;
+        }
+      else
+        {
+          lo = mid;
+        }
+    }
+
+  return hi;
+}
+
+/* AllocateTensors() runs Prepare of every operator and plans the arena,
+ * which is most of the startup cost besides loading the model.
+ */
+
+static bool allocate_tensors(tflite::MicroInterpreter& interpreter)
+{
+  uint64_t start = tflm_now();
+
+  if (interpreter.AllocateTensors() != kTfLiteOk)
+    {
+      printf("AllocateTensors failed, try a larger arena (-a or -S).\n");
+      return false;
+    }
+
+  printf("AllocateTensors: %.1f us, arena used %zu bytes\n",
+         (tflm_now() - start) / 1000.0, interpreter.arena_used_bytes());
+  return true;
+}
+
+static int benchmark(tflite::MicroInterpreter& interpreter,
+                     BenchProfiler& profiler, int warmup, int iterations,
+                     FILE* csv)
+{
+  std::vector<uint64_t> total;
+  uint64_t min;
+  uint64_t median;
+  uint64_t p99;
+  uint64_t start;
+  int i;
+
+  if (!allocate_tensors(interpreter))
+    {
+      return -1;
+    }
+
+  for (i = 0; i < warmup; i++)
+    {
+      profiler.Begin();
+      if (interpreter.Invoke() != kTfLiteOk)
+        {
+          printf("Invoke failed.\n");
+          return -1;
+        }
+    }
+
+  total.reserve(iterations);
+  for (i = 0; i < iterations; i++)
+    {
+      profiler.Begin();
+      start = tflm_now();
+      if (interpreter.Invoke() != kTfLiteOk)
+        {
+          printf("Invoke failed.\n");
+          return -1;
+        }
+
+      total.push_back(tflm_now() - start);
+      profiler.Commit();
+    }
+
+  std::sort(total.begin(), total.end());
+
+  printf("%d warm-up, %d timed evaluations, arena used %zu bytes\n",
+         warmup, iterations, interpreter.arena_used_bytes());
+  printf("%-4s %-24s %12s %12s %12s\n",
+         "op", "tag", "min_us", "median_us", "p99_us");
+
+  if (csv != nullptr)
+    {
+      fprintf(csv, "op,tag,min_ns,median_ns,p99_ns\n");
+    }
+
+  for (size_t op = 0; op < profiler.Count(); op++)
+    {
+      profiler.Stats(op, &min, &median, &p99);
+      printf("%-4zu %-24s %12.1f %12.1f %12.1f\n", op, profiler.Tag(op),
+             min / 1000.0, median / 1000.0, p99 / 1000.0);
+      if (csv != nullptr)
+        {
+          fprintf(csv, "%zu,%s,%llu,%llu,%llu\n", op, profiler.Tag(op),
+                  (unsigned long long)min, (unsigned long long)median,
+                  (unsigned long long)p99);
+        }
+    }
+
+  min = total[0];
+  median = total[iterations / 2];
+  p99 = total[std::min<size_t>(iterations - 1,
+                               (iterations * 99 + 99) / 100 - 1)];
+
+  printf("%-4s %-24s %12.1f %12.1f %12.1f\n", "", "total",
+         min / 1000.0, median / 1000.0, p99 / 1000.0);
+  if (csv != nullptr)
+    {
+      fprintf(csv, ",total,%llu,%llu,%llu\n", (unsigned long long)min,
+              (unsigned long long)median, (unsigned long long)p99);
+      fprintf(csv, ",arena_used_bytes,%zu,,\n",
+              interpreter.arena_used_bytes());
+    }
+
+  return 0;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -58,34 +498,66 @@ extern "C" int main(int argc, FAR char* argv[])
 {
   const char* modelFileName = nullptr;
   const char* codeFileName = nullptr;
+  const char* csvFileName = nullptr;
   const char* prefix = "NXAI";
   bool need_compile = false;
   bool need_invoke = false;
+  bool need_bench = false;
+  bool need_search = false;
+  bool need_map = false;
+  uintptr_t modelAddr = 0;
+  const char* how = "read";
+  bool loaded = true;
   int arenaSize = 1024 * 8;
+  int warmup = 2;
+  int iterations = 10;
+  FILE* csv = nullptr;
+  int ret = 0;
 
   int ch;
-  while ((ch = getopt(argc, argv, "CEhi:o:p:a:")) != EOF)
+  while ((ch = getopt(argc, argv, "BCEShmi:o:p:a:w:n:c:x:")) != EOF)
     {
       switch (ch)
         {
+          case 'B':
+            need_bench = true;
+            break;
           case 'C':
             need_compile = true;
             break;
           case 'E':
             need_invoke = true;
             break;
+          case 'S':
+            need_search = true;
+            break;
           case 'p':
             prefix = optarg;
             break;
           case 'i':
             modelFileName = optarg;
             break;
+          case 'm':
+            need_map = true;
+            break;
+          case 'x':
+            modelAddr = strtoul(optarg, NULL, 0);
+            break;
           case 'o':
             codeFileName = optarg;
             break;
           case 'a':
             arenaSize = strtol(optarg, NULL, 0);
             break;
+          case 'w':
+            warmup = strtol(optarg, NULL, 0);
+            break;
+          case 'n':
+            iterations = strtol(optarg, NULL, 0);
+            break;
+          case 'c':
+            csvFileName = optarg;
+            break;
           case 'h':
           default:
             usage();
@@ -93,21 +565,54 @@ extern "C" int main(int argc, FAR char* argv[])
         }
     }
 
-  if (!modelFileName || !codeFileName)
+  if ((!modelFileName && !modelAddr) || (need_compile && !codeFileName) ||
+      arenaSize <= 0 || warmup < 0 || iterations <= 0)
     {
       usage();
       return -1;
     }
 
-  std::ifstream ifs(modelFileName, std::ios::binary);
-  ifs.seekg(0, std::ios::end);
-  size_t modelSize = ifs.tellg();
-  std::unique_ptr<uint8_t[]> pModel(new uint8_t[modelSize]);
+  /* Reading copies the whole model into the heap, mapping and XIP don't */
 
-  ifs.seekg(0, std::ios::beg);
-  ifs.read(reinterpret_cast<char*>(pModel.get()), modelSize);
-  ifs.close();
+  ModelImage image;
+  uint64_t start = tflm_now();
 
+  if (modelAddr != 0)
+    {
+      image.Place(modelAddr);
+      how = "in place";
+    }
+  else if (need_map)
+    {
+      loaded = image.Map(modelFileName);
+      how = "mapped";
+    }
+  else
+    {
+      loaded = image.Read(modelFileName);
+    }
+
+  if (!loaded)
+    {
+      printf("Failed to load %s.\n", modelFileName);
+      return -1;
+    }
+
+  const tflite::Model* model = tflite::GetModel(image.data());
+
+  printf("Model load (%s): %.1f us\n", how, (tflm_now() - start) / 1000.0);
+  if (reinterpret_cast<uintptr_t>(image.data()) % TFLM_MODEL_ALIGN != 0)
+    {
+      printf("Warning: model at %p is not %d-byte aligned.\n",
+             image.data(), TFLM_MODEL_ALIGN);
+    }
+
+#ifdef CONFIG_TFLITEMICRO_TOOL_RESOLVER
+  /* Exactly the operators of CONFIG_TFLITEMICRO_TOOL_RESOLVER_MODEL */
+
+  tflm_resolver_t resolver;
+  tflm_resolver_init(resolver);
+#else
   /* HACK: can change operators here. */
 
   tflite::MicroMutableOpResolver<8> resolver;
@@ -119,34 +624,113 @@ extern "C" int main(int argc, FAR char* argv[])
   resolver.AddReshape();
   resolver.AddFullyConnected(tflite::Register_FULLY_CONNECTED_INT8());
   resolver.AddSoftmax(tflite::Register_SOFTMAX_INT8());
+#endif
 
-  std::unique_ptr<uint8_t[]> pArena(new uint8_t[arenaSize]);
+  if (csvFileName != nullptr)
+    {
+      csv = strcmp(csvFileName, "-") == 0 ? stdout :
+            fopen(csvFileName, "w");
+      if (csv == nullptr)
+        {
+          printf("Failed to open %s.\n", csvFileName);
+          return -1;
+        }
+    }
+
+  /* The search result replaces -a for the modes below */
+
+  if (need_search)
+    {
+      size_t minSize = arena_search(model, resolver, arenaSize);
 
-  tflite::MicroProfiler profiler;
-  tflite::MicroInterpreter interpreter(tflite::GetModel(pModel.get()),
-    resolver, pArena.get(), arenaSize, nullptr,
-    reinterpret_cast<tflite::MicroProfilerInterface*>(&profiler));
+      if (minSize == 0)
+        {
+          ret = -1;
+          goto out;
+        }
+
+      printf("Smallest arena: %zu bytes, %d byte aligned\n", minSize,
+             TFLM_ARENA_ALIGN);
+      if (csv != nullptr)
+        {
+          fprintf(csv, ",arena_min_bytes,%zu,,\n", minSize);
+        }
 
-  /* HACK: can add testcases here. */
+      arenaSize = minSize;
+    }
 
-  if (need_invoke)
+  if (need_bench)
     {
-      interpreter.Invoke();
-      profiler.LogCsv();
-      profiler.LogTicksPerTagCsv();
+      TensorArena arena(arenaSize);
+      BenchProfiler profiler;
+
+      if (arena.get() == nullptr)
+        {
+          printf("Failed to allocate a %d byte arena.\n", arenaSize);
+          ret = -1;
+          goto out;
+        }
+
+      tflite::MicroInterpreter interpreter(model, resolver, arena.get(),
+                                           arenaSize, nullptr, &profiler);
+
+      ret = benchmark(interpreter, profiler, warmup, iterations, csv);
+      if (ret < 0)
+        {
+          goto out;
+        }
     }
 
-  if (need_compile)
+  if (need_invoke || need_compile)
     {
+      TensorArena arena(arenaSize);
+
+      if (arena.get() == nullptr)
+        {
+          printf("Failed to allocate a %d byte arena.\n", arenaSize);
+          ret = -1;
+          goto out;
+        }
+
+      tflite::MicroProfiler profiler;
+      tflite::MicroInterpreter interpreter(model,
+        resolver, arena.get(), arenaSize, nullptr,
+        reinterpret_cast<tflite::MicroProfilerInterface*>(&profiler));
+
+      /* HACK: can add testcases here. */
+
+      if (need_invoke)
+        {
+          if (!allocate_tensors(interpreter))
+            {
+              ret = -1;
+              goto out;
+            }
+
+          interpreter.Invoke();
+          profiler.LogCsv();
+          profiler.LogTicksPerTagCsv();
+        }
+
+      if (need_compile)
+        {
 #ifdef TFLITE_MODEL_COMPILER
-      std::ofstream ofs(codeFileName);
-      interpreter.Compile(ofs, prefix);
-      ofs.close();
+          std::ofstream ofs(codeFileName);
+          interpreter.Compile(ofs, prefix);
+          ofs.close();
 #else
-      printf("Not supported compiling %s.\n", prefix);
+          printf("Not supported compiling %s.\n", prefix);
 #endif
+        }
     }
 
   printf("nxai done!\n");
-  return 0;
-}
\ No newline at end of file
+
+out:
+  if (csv != nullptr && csv != stdout)
+    {
+      fclose(csv);
+    }
+
+  return ret;
+}
@@ -0,0 +1,344 @@
+#!/usr/bin/env python3
+############################################################################
+# apps/mlearning/tflite-micro/tools/tflm_resolver.py
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed to the Apache Software Foundation (ASF) under one or more
+# contributor license agreements.  See the NOTICE file distributed with
+# this work for additional information regarding copyright ownership.  The
+# ASF licenses this file to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance with the
+# License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+# License for the specific language governing permissions and limitations
+# under the License.
+#
+############################################################################
+"""Generate a MicroMutableOpResolver holding exactly the operators of a
+.tflite model.
+
+The flatbuffer is walked directly, so no TensorFlow or flatbuffers Python
+package is needed.  When every use of an operator has int8 input, the
+int8-only kernel variant is registered instead of the generic kernel,
+which lets the linker drop the code for the other data types.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+# BuiltinOperator value -> (name, MicroMutableOpResolver method)
+
+BUILTINS = {
+    0: ("ADD", "AddAdd"),
+    1: ("AVERAGE_POOL_2D", "AddAveragePool2D"),
+    2: ("CONCATENATION", "AddConcatenation"),
+    3: ("CONV_2D", "AddConv2D"),
+    4: ("DEPTHWISE_CONV_2D", "AddDepthwiseConv2D"),
+    5: ("DEPTH_TO_SPACE", "AddDepthToSpace"),
+    6: ("DEQUANTIZE", "AddDequantize"),
+    8: ("FLOOR", "AddFloor"),
+    9: ("FULLY_CONNECTED", "AddFullyConnected"),
+    11: ("L2_NORMALIZATION", "AddL2Normalization"),
+    12: ("L2_POOL_2D", "AddL2Pool2D"),
+    14: ("LOGISTIC", "AddLogistic"),
+    17: ("MAX_POOL_2D", "AddMaxPool2D"),
+    18: ("MUL", "AddMul"),
+    19: ("RELU", "AddRelu"),
+    21: ("RELU6", "AddRelu6"),
+    22: ("RESHAPE", "AddReshape"),
+    23: ("RESIZE_BILINEAR", "AddResizeBilinear"),
+    25: ("SOFTMAX", "AddSoftmax"),
+    26: ("SPACE_TO_DEPTH", "AddSpaceToDepth"),
+    27: ("SVDF", "AddSvdf"),
+    28: ("TANH", "AddTanh"),
+    34: ("PAD", "AddPad"),
+    36: ("GATHER", "AddGather"),
+    37: ("BATCH_TO_SPACE_ND", "AddBatchToSpaceNd"),
+    38: ("SPACE_TO_BATCH_ND", "AddSpaceToBatchNd"),
+    39: ("TRANSPOSE", "AddTranspose"),
+    40: ("MEAN", "AddMean"),
+    41: ("SUB", "AddSub"),
+    42: ("DIV", "AddDiv"),
+    43: ("SQUEEZE", "AddSqueeze"),
+    44: ("UNIDIRECTIONAL_SEQUENCE_LSTM", "AddUnidirectionalSequenceLSTM"),
+    45: ("STRIDED_SLICE", "AddStridedSlice"),
+    47: ("EXP", "AddExp"),
+    49: ("SPLIT", "AddSplit"),
+    50: ("LOG_SOFTMAX", "AddLogSoftmax"),
+    53: ("CAST", "AddCast"),
+    54: ("PRELU", "AddPrelu"),
+    55: ("MAXIMUM", "AddMaximum"),
+    56: ("ARG_MAX", "AddArgMax"),
+    57: ("MINIMUM", "AddMinimum"),
+    58: ("LESS", "AddLess"),
+    59: ("NEG", "AddNeg"),
+    60: ("PADV2", "AddPadV2"),
+    61: ("GREATER", "AddGreater"),
+    62: ("GREATER_EQUAL", "AddGreaterEqual"),
+    63: ("LESS_EQUAL", "AddLessEqual"),
+    65: ("SLICE", "AddSlice"),
+    66: ("SIN", "AddSin"),
+    67: ("TRANSPOSE_CONV", "AddTransposeConv"),
+    70: ("EXPAND_DIMS", "AddExpandDims"),
+    71: ("EQUAL", "AddEqual"),
+    72: ("NOT_EQUAL", "AddNotEqual"),
+    73: ("LOG", "AddLog"),
+    74: ("SUM", "AddSum"),
+    75: ("SQRT", "AddSqrt"),
+    76: ("RSQRT", "AddRsqrt"),
+    77: ("SHAPE", "AddShape"),
+    79: ("ARG_MIN", "AddArgMin"),
+    82: ("REDUCE_MAX", "AddReduceMax"),
+    83: ("PACK", "AddPack"),
+    84: ("LOGICAL_OR", "AddLogicalOr"),
+    86: ("LOGICAL_AND", "AddLogicalAnd"),
+    87: ("LOGICAL_NOT", "AddLogicalNot"),
+    88: ("UNPACK", "AddUnpack"),
+    90: ("FLOOR_DIV", "AddFloorDiv"),
+    92: ("SQUARE", "AddSquare"),
+    93: ("ZEROS_LIKE", "AddZerosLike"),
+    94: ("FILL", "AddFill"),
+    95: ("FLOOR_MOD", "AddFloorMod"),
+    97: ("RESIZE_NEAREST_NEIGHBOR", "AddResizeNearestNeighbor"),
+    98: ("LEAKY_RELU", "AddLeakyRelu"),
+    99: ("SQUARED_DIFFERENCE", "AddSquaredDifference"),
+    100: ("MIRROR_PAD", "AddMirrorPad"),
+    101: ("ABS", "AddAbs"),
+    102: ("SPLIT_V", "AddSplitV"),
+    104: ("CEIL", "AddCeil"),
+    106: ("ADD_N", "AddAddN"),
+    107: ("GATHER_ND", "AddGatherNd"),
+    108: ("COS", "AddCos"),
+    111: ("ELU", "AddElu"),
+    114: ("QUANTIZE", "AddQuantize"),
+    116: ("ROUND", "AddRound"),
+    117: ("HARD_SWISH", "AddHardSwish"),
+    118: ("IF", "AddIf"),
+    119: ("WHILE", "AddWhile"),
+    123: ("SELECT_V2", "AddSelectV2"),
+    126: ("BATCH_MATMUL", "AddBatchMatMul"),
+    128: ("CUMSUM", "AddCumSum"),
+    129: ("CALL_ONCE", "AddCallOnce"),
+    130: ("BROADCAST_TO", "AddBroadcastTo"),
+    142: ("VAR_HANDLE", "AddVarHandle"),
+    143: ("READ_VARIABLE", "AddReadVariable"),
+    144: ("ASSIGN_VARIABLE", "AddAssignVariable"),
+    145: ("BROADCAST_ARGS", "AddBroadcastArgs"),
+}
+
+# Custom operator name -> MicroMutableOpResolver method
+
+CUSTOMS = {
+    "TFLite_Detection_PostProcess": "AddDetectionPostprocess",
+    "ETHOSU": "AddEthosU",
+}
+
+# TensorType values
+
+FLOAT32 = 0
+INT8 = 9
+
+# Specialized kernels: operator -> (input type, output type, registration).
+# None matches any type.
+
+VARIANTS = {
+    "AVERAGE_POOL_2D": (INT8, None, "Register_AVERAGE_POOL_2D_INT8"),
+    "CONV_2D": (INT8, None, "Register_CONV_2D_INT8"),
+    "DEPTHWISE_CONV_2D": (INT8, None, "Register_DEPTHWISE_CONV_2D_INT8"),
+    "DEQUANTIZE": (INT8, None, "Register_DEQUANTIZE_INT8"),
+    "FULLY_CONNECTED": (INT8, None, "Register_FULLY_CONNECTED_INT8"),
+    "MAX_POOL_2D": (INT8, None, "Register_MAX_POOL_2D_INT8"),
+    "MEAN": (INT8, None, "Register_MEAN_INT8"),
+    "QUANTIZE": (FLOAT32, INT8, "Register_QUANTIZE_FLOAT32_INT8"),
+    "SOFTMAX": (INT8, INT8, "Register_SOFTMAX_INT8"),
+    "SVDF": (INT8, None, "Register_SVDF_INT8"),
+    "UNIDIRECTIONAL_SEQUENCE_LSTM": (
+        INT8,
+        None,
+        "Register_UNIDIRECTIONAL_SEQUENCE_LSTM_INT8",
+    ),
+}
+
+
+class FlatBuffer:
+    """Minimal read-only access to flatbuffer tables"""
+
+    def __init__(self, data):
+        self.data = data
+
+    def u32(self, pos):
+        return struct.unpack_from("<I", self.data, pos)[0]
+
+    def root(self):
+        return self.u32(0)
+
+    def field(self, table, index):
+        """Position of a table field, None if absent"""
+        vtable = table - struct.unpack_from("<i", self.data, table)[0]
+        vtsize = struct.unpack_from("<H", self.data, vtable)[0]
+        if 4 + 2 * index >= vtsize:
+            return None
+        off = struct.unpack_from("<H", self.data, vtable + 4 + 2 * index)[0]
+        return table + off if off else None
+
+    def scalar(self, table, index, fmt, default):
+        pos = self.field(table, index)
+        if pos is None:
+            return default
+        return struct.unpack_from("<" + fmt, self.data, pos)[0]
+
+    def vector(self, table, index):
+        """(position of the first element, length) of a vector field"""
+        pos = self.field(table, index)
+        if pos is None:
+            return 0, 0
+        pos += self.u32(pos)
+        return pos + 4, self.u32(pos)
+
+    def tables(self, table, index):
+        start, length = self.vector(table, index)
+        for i in range(length):
+            pos = start + 4 * i
+            yield pos + self.u32(pos)
+
+    def ints(self, table, index):
+        start, length = self.vector(table, index)
+        return struct.unpack_from("<%di" % length, self.data, start)
+
+    def string(self, table, index):
+        start, length = self.vector(table, index)
+        return self.data[start : start + length].decode()
+
+
+def model_operators(data):
+    """Return {op: [(input type, output type), ...]} of every use"""
+
+    fb = FlatBuffer(data)
+    if data[4:8] != b"TFL3":
+        raise ValueError("not a TFLite flatbuffer")
+
+    model = fb.root()
+
+    # Model.operator_codes
+
+    codes = []
+    for code in fb.tables(model, 1):
+        builtin = max(fb.scalar(code, 0, "b", 0), fb.scalar(code, 3, "i", 0))
+        if builtin == 32:
+            codes.append(("CUSTOM", fb.string(code, 1)))
+        elif builtin in BUILTINS:
+            codes.append(BUILTINS[builtin])
+        else:
+            raise ValueError("operator %d is not supported by tflite-micro" % builtin)
+
+    # Model.subgraphs -> SubGraph.operators, SubGraph.tensors
+
+    uses = {}
+    for subgraph in fb.tables(model, 2):
+        types = [fb.scalar(t, 1, "b", FLOAT32) for t in fb.tables(subgraph, 0)]
+        for op in fb.tables(subgraph, 3):
+            code = codes[fb.scalar(op, 0, "I", 0)]
+            inputs = [i for i in fb.ints(op, 1) if i >= 0]
+            outputs = [i for i in fb.ints(op, 2) if i >= 0]
+            itype = types[inputs[0]] if inputs else None
+            otype = types[outputs[0]] if outputs else None
+            uses.setdefault(code, []).append((itype, otype))
+
+    return uses
+
+
+def registration(name, uses):
+    """Registration argument of the resolver method, '' for the default"""
+
+    variant = VARIANTS.get(name)
+    if variant is None:
+        return ""
+
+    itype, otype, func = variant
+    for i, o in uses:
+        if (itype is not None and i != itype) or (otype is not None and o != otype):
+            return ""
+
+    return "tflite::%s()" % func
+
+
+def generate(model, uses):
+    if not uses:
+        raise ValueError("model has no operators")
+
+    lines = []
+    for code in sorted(uses, key=lambda c: c[0] + c[1]):
+        name, method = code
+        if name == "CUSTOM":
+            if method not in CUSTOMS:
+                raise ValueError(
+                    "custom operator %s must be registered by hand" % method
+                )
+            lines.append("  resolver.%s();" % CUSTOMS[method])
+        else:
+            lines.append(
+                "  resolver.%s(%s);" % (method, registration(name, uses[code]))
+            )
+
+    return """\
+/****************************************************************************
+ * tflm_resolver.h
+ *
+ * Automatically generated by tools/tflm_resolver.py from
+ * %s, do not edit.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_MLEARNING_TFLITE_MICRO_TFLM_RESOLVER_H
+#define __APPS_MLEARNING_TFLITE_MICRO_TFLM_RESOLVER_H
+
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+
+#define TFLM_RESOLVER_OPS %d
+
+typedef tflite::MicroMutableOpResolver<TFLM_RESOLVER_OPS> tflm_resolver_t;
+
+static inline void tflm_resolver_init(tflm_resolver_t& resolver)
+{
+%s
+}
+
+#endif /* __APPS_MLEARNING_TFLITE_MICRO_TFLM_RESOLVER_H */
+""" % (
+        os.path.basename(model),
+        len(lines),
+        "\n".join(lines),
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("model", help=".tflite model file")
+    parser.add_argument("-o", "--output", help="header to write, default stdout")
+    args = parser.parse_args()
+
+    with open(args.model, "rb") as f:
+        data = f.read()
+
+    try:
+        header = generate(args.model, model_operators(data))
+    except (ValueError, IndexError, struct.error) as e:
+        sys.exit("%s: %s" % (args.model, e))
+
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(header)
+    else:
+        sys.stdout.write(header)
+
+
+if __name__ == "__main__":
+    main()
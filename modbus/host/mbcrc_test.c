@@ -0,0 +1,196 @@
+/****************************************************************************
+ * apps/modbus/host/mbcrc_test.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Host test and benchmark of usMBCRC16().  The configured implementation
+ * is checked against a bit-wise reference for every frame length up to
+ * the RTU maximum and every buffer alignment, then its throughput is
+ * measured on full-size frames.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mbcrc.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MBCRC_FRAME_MAX  256    /* Largest RTU frame */
+#define MBCRC_ALIGN_MAX  8
+#define MBCRC_BENCH_MB   64     /* Data checksummed by the benchmark */
+
+#if defined(CONFIG_MB_CRC16_SLICE8)
+#  define MBCRC_VARIANT "slicing-by-8"
+#elif defined(CONFIG_MB_CRC16_SLICE4)
+#  define MBCRC_VARIANT "slicing-by-4"
+#else
+#  define MBCRC_VARIANT "byte-wise"
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint16_t mbcrc_reference(FAR const uint8_t *data, size_t len)
+{
+  uint16_t crc = 0xffff;
+  int bit;
+
+  while (len-- > 0)
+    {
+      crc ^= *data++;
+      for (bit = 0; bit < 8; bit++)
+        {
+          crc = (crc & 1) ? (crc >> 1) ^ 0xa001 : crc >> 1;
+        }
+    }
+
+  return crc;
+}
+
+static double mbcrc_elapsed(FAR const struct timespec *start)
+{
+  struct timespec end;
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) +
+         (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  static uint8_t check[] = "123456789";
+  uint8_t buffer[MBCRC_FRAME_MAX + MBCRC_ALIGN_MAX];
+  struct timespec start;
+  volatile uint16_t sink = 0;
+  unsigned long frames;
+  unsigned long i;
+  double elapsed;
+  size_t align;
+  size_t len;
+  int errors = 0;
+
+  srand(1);
+  for (i = 0; i < sizeof(buffer); i++)
+    {
+      buffer[i] = rand();
+    }
+
+  /* Standard check value of CRC-16/MODBUS */
+
+  if (usMBCRC16(check, 9) != 0x4b37)
+    {
+      printf("FAIL: check value %04x, expected 4b37\n",
+             usMBCRC16(check, 9));
+      errors++;
+    }
+
+  for (align = 0; align < MBCRC_ALIGN_MAX; align++)
+    {
+      for (len = 0; len <= MBCRC_FRAME_MAX; len++)
+        {
+          uint16_t expect = mbcrc_reference(buffer + align, len);
+          uint16_t crc = usMBCRC16(buffer + align, len);
+
+          if (crc != expect)
+            {
+              printf("FAIL: offset %zu length %zu: %04x, expected %04x\n",
+                     align, len, crc, expect);
+              errors++;
+            }
+        }
+    }
+
+  /* A frame followed by its CRC, low byte first, checks to zero.  This is
+   * how the RTU receivers validate frames.
+   */
+
+  for (len = 1; len <= MBCRC_FRAME_MAX - 2; len++)
+    {
+      uint16_t crc = usMBCRC16(buffer, len);
+      uint8_t frame[MBCRC_FRAME_MAX];
+
+      memcpy(frame, buffer, len);
+      frame[len] = crc & 0xff;
+      frame[len + 1] = crc >> 8;
+      if (usMBCRC16(frame, len + 2) != 0)
+        {
+          printf("FAIL: length %zu does not check to zero\n", len);
+          errors++;
+        }
+    }
+
+  if (errors > 0)
+    {
+      printf("%s: %d errors\n", MBCRC_VARIANT, errors);
+      return EXIT_FAILURE;
+    }
+
+  printf("%s: results match the reference\n", MBCRC_VARIANT);
+
+  /* Benchmark */
+
+  frames = (MBCRC_BENCH_MB * 1024ul * 1024) / MBCRC_FRAME_MAX;
+  if (argc > 1)
+    {
+      frames = strtoul(argv[1], NULL, 0);
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (i = 0; i < frames / 16; i++)
+    {
+      sink ^= mbcrc_reference(buffer, MBCRC_FRAME_MAX);
+    }
+
+  elapsed = mbcrc_elapsed(&start);
+  printf("bit-wise:     %8.1f MiB/s\n",
+         frames / 16 * MBCRC_FRAME_MAX / elapsed / (1024 * 1024));
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (i = 0; i < frames; i++)
+    {
+      sink ^= usMBCRC16(buffer, MBCRC_FRAME_MAX);
+    }
+
+  elapsed = mbcrc_elapsed(&start);
+  printf("%-13s %8.1f MiB/s (%.0f ns per %d byte frame)\n",
+         MBCRC_VARIANT ":",
+         frames * MBCRC_FRAME_MAX / elapsed / (1024 * 1024),
+         elapsed * 1e9 / frames, MBCRC_FRAME_MAX);
+
+  (void)sink;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,45 @@
+/****************************************************************************
+ * apps/modbus/host/nuttx/config.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_MODBUS_HOST_NUTTX_CONFIG_H
+#define __APPS_MODBUS_HOST_NUTTX_CONFIG_H
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Environment stuff */
+
+#define OK 0
+#define ERROR -1
+#define FAR
+#define printf_like(a, b) __attribute__((format(printf, a, b)))
+
+/* Configuration.  The CRC16 variant (CONFIG_MB_CRC16_*) is selected on the
+ * compiler command line by Makefile.host.
+ */
+
+#define CONFIG_MODBUS 1
+#define CONFIG_MB_RTU_ENABLED 1
+#define CONFIG_MODBUS_DISABLE_LOG 1
+
+#endif /* __APPS_MODBUS_HOST_NUTTX_CONFIG_H */
@@ -45,6 +45,7 @@
 #include "modbus/mbfunc.h"
 
 #include "modbus/mbport.h"
+#include "port_m.h"
 
 #ifdef CONFIG_MB_RTU_MASTER
 #  include "mbrtu_m.h"
@@ -70,46 +71,11 @@
  * Private Data
  ****************************************************************************/
 
-static uint8_t ucMBMasterDestAddress;
-static bool xMBRunInMasterMode = false;
-static eMBMasterErrorEventType eMBMasterCurErrorType;
-
-static enum
-{
-  STATE_ENABLED,
-  STATE_DISABLED,
-  STATE_NOT_INITIALIZED
-} eMBState = STATE_NOT_INITIALIZED;
-
-/* Functions pointer which are initialized in eMBInit( ). Depending on the
- * mode (RTU or ASCII) the are set to the correct implementations.
- * Using for Modbus Master,Add by Armink 20130813
- */
-
-static peMBFrameSend peMBMasterFrameSendCur;
-static pvMBFrameStart pvMBMasterFrameStartCur;
-static pvMBFrameStop pvMBMasterFrameStopCur;
-static peMBFrameReceive peMBMasterFrameReceiveCur;
-static pvMBFrameClose pvMBMasterFrameCloseCur;
-
-/* Callback functions required by the porting layer. They are called when
- * an external event has happened which includes a timeout or the reception
- * or transmission of a character.
- * Using for Modbus Master,Add by Armink 20130813
- */
-
-bool(*pxMBMasterFrameCBByteReceived) (void);
-bool(*pxMBMasterFrameCBTransmitterEmpty) (void);
-bool(*pxMBMasterPortCBTimerExpired) (void);
-
-bool(*pxMBMasterFrameCBReceiveFSMCur) (void);
-bool(*pxMBMasterFrameCBTransmitFSMCur) (void);
-
 /* An array of Modbus functions handlers which associates Modbus function
  * codes with implementing functions.
  */
 
-static xMBFunctionHandler xMasterFuncHandlers[CONFIG_MB_FUNC_HANDLERS_MAX] = {
+static const xMBFunctionHandler xMasterFuncHandlers[CONFIG_MB_FUNC_HANDLERS_MAX] = {
 #ifdef CONFIG_MB_FUNC_OTHER_REP_SLAVEID_ENABLED
 
   /* TODO Add Master function define */
@@ -153,34 +119,35 @@ static xMBFunctionHandler xMasterFuncHandlers[CONFIG_MB_FUNC_HANDLERS_MAX] = {
 eMBErrorCode eMBMasterInit(eMBMode eMode, uint8_t ucPort,
                            speed_t ulBaudRate, eMBParity eParity)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   eMBErrorCode eStatus = MB_ENOERR;
 
   switch (eMode)
     {
 #ifdef CONFIG_MB_RTU_MASTER
     case MB_RTU:
-      pvMBMasterFrameStartCur = eMBMasterRTUStart;
-      pvMBMasterFrameStopCur = eMBMasterRTUStop;
-      peMBMasterFrameSendCur = eMBMasterRTUSend;
-      peMBMasterFrameReceiveCur = eMBMasterRTUReceive;
-      pvMBMasterFrameCloseCur = MB_PORT_HAS_CLOSE ? vMBMasterPortClose : NULL;
-      pxMBMasterFrameCBByteReceived = xMBMasterRTUReceiveFSM;
-      pxMBMasterFrameCBTransmitterEmpty = xMBMasterRTUTransmitFSM;
-      pxMBMasterPortCBTimerExpired = xMBMasterRTUTimerExpired;
+      pxInst->pvFrameStartCur = eMBMasterRTUStart;
+      pxInst->pvFrameStopCur = eMBMasterRTUStop;
+      pxInst->peFrameSendCur = eMBMasterRTUSend;
+      pxInst->peFrameReceiveCur = eMBMasterRTUReceive;
+      pxInst->pvFrameCloseCur = MB_PORT_HAS_CLOSE ? vMBMasterPortClose : NULL;
+      pxInst->pxFrameCBByteReceived = xMBMasterRTUReceiveFSM;
+      pxInst->pxFrameCBTransmitterEmpty = xMBMasterRTUTransmitFSM;
+      pxInst->pxPortCBTimerExpired = xMBMasterRTUTimerExpired;
 
       eStatus = eMBMasterRTUInit(ucPort, ulBaudRate, eParity);
       break;
 #endif
 #ifdef CONFIG_MB_ASCII_MASTER
     case MB_ASCII:
-      pvMBMasterFrameStartCur = eMBMasterASCIIStart;
-      pvMBMasterFrameStopCur = eMBMasterASCIIStop;
-      peMBMasterFrameSendCur = eMBMasterASCIISend;
-      peMBMasterFrameReceiveCur = eMBMasterASCIIReceive;
-      pvMBMasterFrameCloseCur = MB_PORT_HAS_CLOSE ? vMBMasterPortClose : NULL;
-      pxMBMasterFrameCBByteReceived = xMBMasterASCIIReceiveFSM;
-      pxMBMasterFrameCBTransmitterEmpty = xMBMasterASCIITransmitFSM;
-      pxMBMasterPortCBTimerExpired = xMBMasterASCIITimerT1SExpired;
+      pxInst->pvFrameStartCur = eMBMasterASCIIStart;
+      pxInst->pvFrameStopCur = eMBMasterASCIIStop;
+      pxInst->peFrameSendCur = eMBMasterASCIISend;
+      pxInst->peFrameReceiveCur = eMBMasterASCIIReceive;
+      pxInst->pvFrameCloseCur = MB_PORT_HAS_CLOSE ? vMBMasterPortClose : NULL;
+      pxInst->pxFrameCBByteReceived = xMBMasterASCIIReceiveFSM;
+      pxInst->pxFrameCBTransmitterEmpty = xMBMasterASCIITransmitFSM;
+      pxInst->pxPortCBTimerExpired = xMBMasterASCIITimerT1SExpired;
 
       eStatus = eMBMasterASCIIInit(ucPort, ulBaudRate, eParity);
       break;
@@ -200,7 +167,7 @@ eMBErrorCode eMBMasterInit(eMBMode eMode, uint8_t ucPort,
         }
       else
         {
-          eMBState = STATE_DISABLED;
+          pxInst->eState = STATE_DISABLED;
         }
 
       /* Initialize the OS resource for modbus master. */
@@ -213,13 +180,14 @@ eMBErrorCode eMBMasterInit(eMBMode eMode, uint8_t ucPort,
 
 eMBErrorCode eMBMasterClose(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   eMBErrorCode eStatus = MB_ENOERR;
 
-  if (eMBState == STATE_DISABLED)
+  if (pxInst->eState == STATE_DISABLED)
     {
-      if (pvMBMasterFrameCloseCur != NULL)
+      if (pxInst->pvFrameCloseCur != NULL)
         {
-          pvMBMasterFrameCloseCur();
+          pxInst->pvFrameCloseCur();
         }
     }
   else
@@ -232,14 +200,15 @@ eMBErrorCode eMBMasterClose(void)
 
 eMBErrorCode eMBMasterEnable(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   eMBErrorCode eStatus = MB_ENOERR;
 
-  if (eMBState == STATE_DISABLED)
+  if (pxInst->eState == STATE_DISABLED)
     {
       /* Activate the protocol stack. */
 
-      pvMBMasterFrameStartCur();
-      eMBState = STATE_ENABLED;
+      pxInst->pvFrameStartCur();
+      pxInst->eState = STATE_ENABLED;
     }
   else
     {
@@ -251,15 +220,16 @@ eMBErrorCode eMBMasterEnable(void)
 
 eMBErrorCode eMBMasterDisable(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   eMBErrorCode eStatus;
 
-  if (eMBState == STATE_ENABLED)
+  if (pxInst->eState == STATE_ENABLED)
     {
-      pvMBMasterFrameStopCur();
-      eMBState = STATE_DISABLED;
+      pxInst->pvFrameStopCur();
+      pxInst->eState = STATE_DISABLED;
       eStatus = MB_ENOERR;
     }
-  else if (eMBState == STATE_DISABLED)
+  else if (pxInst->eState == STATE_DISABLED)
     {
       eStatus = MB_ENOERR;
     }
@@ -273,11 +243,10 @@ eMBErrorCode eMBMasterDisable(void)
 
 eMBErrorCode eMBMasterPoll(void)
 {
-  static uint8_t *ucMBFrame;
-  static uint8_t ucRcvAddress;
-  static uint8_t ucFunctionCode;
-  static uint16_t usLength;
-  static eMBException eException;
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+  uint8_t *ucMBFrame;
+  uint8_t ucFunctionCode;
+  eMBException eException;
   int i;
   int j;
 
@@ -287,7 +256,7 @@ eMBErrorCode eMBMasterPoll(void)
 
   /* Check if the protocol stack is ready. */
 
-  if (eMBState != STATE_ENABLED)
+  if (pxInst->eState != STATE_ENABLED)
     {
       return MB_EILLSTATE;
     }
@@ -305,12 +274,14 @@ eMBErrorCode eMBMasterPoll(void)
 
         case EV_MASTER_FRAME_RECEIVED:
           eStatus =
-            peMBMasterFrameReceiveCur(&ucRcvAddress, &ucMBFrame, &usLength);
+            pxInst->peFrameReceiveCur(&pxInst->ucPollRcvAddress,
+                                      &pxInst->pucPollFrame,
+                                      &pxInst->usPollLength);
 
           /* Check if the frame is for us. If not, send an error process event. */
 
           if ((eStatus == MB_ENOERR) &&
-              (ucRcvAddress == ucMBMasterGetDestAddress()))
+              (pxInst->ucPollRcvAddress == pxInst->ucDestAddress))
             {
               xMBMasterPortEventPost(EV_MASTER_EXECUTE);
             }
@@ -322,6 +293,7 @@ eMBErrorCode eMBMasterPoll(void)
           break;
 
         case EV_MASTER_EXECUTE:
+          ucMBFrame = pxInst->pucPollFrame;
           ucFunctionCode = ucMBFrame[MB_PDU_FUNC_OFF];
           eException = MB_EX_ILLEGAL_FUNCTION;
 
@@ -353,21 +325,21 @@ eMBErrorCode eMBMasterPoll(void)
 
                       if (xMBMasterRequestIsBroadcast())
                         {
-                          usLength = usMBMasterGetPDUSndLength();
+                          pxInst->usPollLength = usMBMasterGetPDUSndLength();
                           for (j = 1; j <= CONFIG_MB_MASTER_TOTAL_SLAVE_NUM;
                                j++)
                             {
                               vMBMasterSetDestAddress(j);
                               eException =
-                                xMasterFuncHandlers[i].pxHandler(ucMBFrame,
-                                                                 &usLength);
+                                xMasterFuncHandlers[i].pxHandler(
+                                  ucMBFrame, &pxInst->usPollLength);
                             }
                         }
                       else
                         {
                           eException =
-                            xMasterFuncHandlers[i].pxHandler(ucMBFrame,
-                                                             &usLength);
+                            xMasterFuncHandlers[i].pxHandler(
+                              ucMBFrame, &pxInst->usPollLength);
                         }
 
                       vMBMasterSetCBRunInMasterMode(false);
@@ -398,7 +370,7 @@ eMBErrorCode eMBMasterPoll(void)
 
           vMBMasterGetPDUSndBuf(&ucMBFrame);
           eStatus =
-            peMBMasterFrameSendCur(ucMBMasterGetDestAddress(), ucMBFrame,
+            pxInst->peFrameSendCur(ucMBMasterGetDestAddress(), ucMBFrame,
                                    usMBMasterGetPDUSndLength());
           break;
 
@@ -446,42 +418,42 @@ eMBErrorCode eMBMasterPoll(void)
 
 bool xMBMasterGetCBRunInMasterMode(void)
 {
-  return xMBRunInMasterMode;
+  return MB_MASTER_INST()->xRunInMasterMode;
 }
 
 /* Set whether the Modbus Master is run in master mode.*/
 
 void vMBMasterSetCBRunInMasterMode(bool IsMasterMode)
 {
-  xMBRunInMasterMode = IsMasterMode;
+  MB_MASTER_INST()->xRunInMasterMode = IsMasterMode;
 }
 
 /* Get Modbus Master send destination address. */
 
 uint8_t ucMBMasterGetDestAddress(void)
 {
-  return ucMBMasterDestAddress;
+  return MB_MASTER_INST()->ucDestAddress;
 }
 
 /* Set Modbus Master send destination address. */
 
 void vMBMasterSetDestAddress(uint8_t Address)
 {
-  ucMBMasterDestAddress = Address;
+  MB_MASTER_INST()->ucDestAddress = Address;
 }
 
 /* Get Modbus Master current error event type. */
 
 eMBMasterErrorEventType eMBMasterGetErrorType(void)
 {
-  return eMBMasterCurErrorType;
+  return MB_MASTER_INST()->eCurErrorType;
 }
 
 /* Set Modbus Master current error event type. */
 
 void vMBMasterSetErrorType(eMBMasterErrorEventType errorType)
 {
-  eMBMasterCurErrorType = errorType;
+  MB_MASTER_INST()->eCurErrorType = errorType;
 }
 
 #endif /* defined(CONFIG_MB_RTU_MASTER) || defined(CONFIG_MB_ASCII_MASTER) */
@@ -0,0 +1,353 @@
+/****************************************************************************
+ * apps/modbus/mb_m_queue.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "port.h"
+
+#include "modbus/mb.h"
+#include "modbus/mb_m.h"
+#include "modbus/mbport.h"
+#include "port_m.h"
+
+#ifdef CONFIG_MB_MASTER_QUEUE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_MB_MASTER_QUEUE_GAP
+#  define CONFIG_MB_MASTER_QUEUE_GAP 0
+#endif
+
+#ifndef CONFIG_MB_MASTER_QUEUE_BACKOFF
+#  define CONFIG_MB_MASTER_QUEUE_BACKOFF 4
+#endif
+
+#if CONFIG_MB_MASTER_QUEUE_BACKOFF > UINT8_MAX
+#  error CONFIG_MB_MASTER_QUEUE_BACKOFF does not fit into ucBackoff[]
+#endif
+
+/* Largest count a single read request may carry */
+
+#define MB_MQ_REGCNT_MAX    0x007d
+#define MB_MQ_BITCNT_MAX    0x07d0
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Return the largest count allowed for eType, or zero if reading that
+ * register table is not enabled.
+ */
+
+static uint16_t prvusMBMasterQueueMax(eMBMasterQueueRegType eType)
+{
+  switch (eType)
+    {
+#ifdef CONFIG_MB_MASTER_FUNC_READ_HOLDING_ENABLED
+      case MB_MQ_REG_HOLDING:
+        return MB_MQ_REGCNT_MAX;
+#endif
+#ifdef CONFIG_MB_MASTER_FUNC_READ_INPUT_ENABLED
+      case MB_MQ_REG_INPUT:
+        return MB_MQ_REGCNT_MAX;
+#endif
+#ifdef CONFIG_MB_MASTER_FUNC_READ_COILS_ENABLED
+      case MB_MQ_REG_COILS:
+        return MB_MQ_BITCNT_MAX;
+#endif
+#ifdef CONFIG_MB_MASTER_FUNC_READ_DISCRETE_INPUTS_ENABLED
+      case MB_MQ_REG_DISCRETE:
+        return MB_MQ_BITCNT_MAX;
+#endif
+      default:
+        return 0;
+    }
+}
+
+/* Try to extend pxEntry so that it also covers usNRegs registers starting
+ * at usRegAddr.
+ */
+
+static bool prvxMBMasterQueueMerge(FAR struct xMBMasterQueueEntry *pxEntry,
+                                   uint16_t usRegAddr, uint16_t usNRegs,
+                                   uint16_t usMax)
+{
+  uint32_t ulStart = pxEntry->usRegAddr;
+  uint32_t ulEnd = ulStart + pxEntry->usNRegs;
+  uint32_t ulNewStart = usRegAddr;
+  uint32_t ulNewEnd = ulNewStart + usNRegs;
+
+  if (ulNewStart > ulEnd + CONFIG_MB_MASTER_QUEUE_GAP ||
+      ulStart > ulNewEnd + CONFIG_MB_MASTER_QUEUE_GAP)
+    {
+      return false;
+    }
+
+  ulStart = ulNewStart < ulStart ? ulNewStart : ulStart;
+  ulEnd = ulNewEnd > ulEnd ? ulNewEnd : ulEnd;
+  if (ulEnd - ulStart > usMax)
+    {
+      return false;
+    }
+
+  pxEntry->usRegAddr = (uint16_t)ulStart;
+  pxEntry->usNRegs = (uint16_t)(ulEnd - ulStart);
+  return true;
+}
+
+static eMBMasterReqErrCode
+prveMBMasterQueueIssue(FAR const struct xMBMasterQueueEntry *pxEntry,
+                       uint32_t lTimeOut)
+{
+  switch (pxEntry->eType)
+    {
+#ifdef CONFIG_MB_MASTER_FUNC_READ_HOLDING_ENABLED
+      case MB_MQ_REG_HOLDING:
+        return eMBMasterReqReadHoldingRegister(pxEntry->ucSndAddr,
+                                               pxEntry->usRegAddr,
+                                               pxEntry->usNRegs, lTimeOut);
+#endif
+#ifdef CONFIG_MB_MASTER_FUNC_READ_INPUT_ENABLED
+      case MB_MQ_REG_INPUT:
+        return eMBMasterReqReadInputRegister(pxEntry->ucSndAddr,
+                                             pxEntry->usRegAddr,
+                                             pxEntry->usNRegs, lTimeOut);
+#endif
+#ifdef CONFIG_MB_MASTER_FUNC_READ_COILS_ENABLED
+      case MB_MQ_REG_COILS:
+        return eMBMasterReqReadCoils(pxEntry->ucSndAddr,
+                                     pxEntry->usRegAddr,
+                                     pxEntry->usNRegs, lTimeOut);
+#endif
+#ifdef CONFIG_MB_MASTER_FUNC_READ_DISCRETE_INPUTS_ENABLED
+      case MB_MQ_REG_DISCRETE:
+        return eMBMasterReqReadDiscreteInputs(pxEntry->ucSndAddr,
+                                              pxEntry->usRegAddr,
+                                              pxEntry->usNRegs, lTimeOut);
+#endif
+      default:
+        return MB_MRE_ILL_ARG;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+eMBMasterReqErrCode eMBMasterQueueRead(uint8_t ucSndAddr,
+                                       eMBMasterQueueRegType eType,
+                                       uint16_t usRegAddr,
+                                       uint16_t usNRegs)
+{
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+  FAR struct xMBMasterQueueEntry *pxEntry;
+  uint16_t usMax = prvusMBMasterQueueMax(eType);
+  int i;
+  int j;
+
+  if (ucSndAddr == MB_ADDRESS_BROADCAST ||
+      ucSndAddr > CONFIG_MB_MASTER_TOTAL_SLAVE_NUM ||
+      usNRegs == 0 || usNRegs > usMax ||
+      (uint32_t)usRegAddr + usNRegs > 0x10000)
+    {
+      return MB_MRE_ILL_ARG;
+    }
+
+  /* Fold the request into a queued one if possible.  A grown entry may now
+   * reach its neighbours, so keep merging until nothing changes.
+   */
+
+  for (i = 0; i < pxInst->usQueueLen; i++)
+    {
+      pxEntry = &pxInst->xQueue[i];
+      if (pxEntry->ucSndAddr == ucSndAddr && pxEntry->eType == eType &&
+          prvxMBMasterQueueMerge(pxEntry, usRegAddr, usNRegs, usMax))
+        {
+          break;
+        }
+    }
+
+  if (i == pxInst->usQueueLen)
+    {
+      if (pxInst->usQueueLen >= CONFIG_MB_MASTER_QUEUE_DEPTH)
+        {
+          return MB_MRE_MASTER_BUSY;
+        }
+
+      pxEntry = &pxInst->xQueue[pxInst->usQueueLen++];
+      pxEntry->ucSndAddr = ucSndAddr;
+      pxEntry->eType = eType;
+      pxEntry->usRegAddr = usRegAddr;
+      pxEntry->usNRegs = usNRegs;
+      return MB_MRE_NO_ERR;
+    }
+
+  for (j = 0; j < pxInst->usQueueLen; j++)
+    {
+      if (j != i &&
+          pxInst->xQueue[j].ucSndAddr == ucSndAddr &&
+          pxInst->xQueue[j].eType == eType &&
+          prvxMBMasterQueueMerge(&pxInst->xQueue[j],
+                                 pxInst->xQueue[i].usRegAddr,
+                                 pxInst->xQueue[i].usNRegs, usMax))
+        {
+          /* Entry i is now covered by entry j, drop it */
+
+          memmove(&pxInst->xQueue[i], &pxInst->xQueue[i + 1],
+                  (pxInst->usQueueLen - i - 1) *
+                  sizeof(struct xMBMasterQueueEntry));
+          pxInst->usQueueLen--;
+
+          i = j > i ? j - 1 : j;
+          j = -1;
+        }
+    }
+
+  return MB_MRE_NO_ERR;
+}
+
+void vMBMasterQueueFlush(void)
+{
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
+  pxInst->usQueueLen = 0;
+  memset(pxInst->ucBackoff, 0, sizeof(pxInst->ucBackoff));
+}
+
+eMBMasterReqErrCode eMBMasterQueueRun(uint32_t lTimeOut)
+{
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+  FAR struct xMBMasterQueueEntry *pxEntry;
+  eMBMasterReqErrCode eFirstErr = MB_MRE_NO_ERR;
+  eMBMasterReqErrCode eErr;
+  bool xDone[CONFIG_MB_MASTER_QUEUE_DEPTH];
+  uint16_t usRemaining = pxInst->usQueueLen;
+  uint8_t ucSlave = pxInst->ucQueueNext;
+  unsigned int uiDist;
+  unsigned int uiBest;
+  int iBest;
+  int i;
+
+  if (ucSlave == 0 || ucSlave > CONFIG_MB_MASTER_TOTAL_SLAVE_NUM)
+    {
+      ucSlave = 1;
+    }
+
+  /* Slaves which recently timed out sit this run out */
+
+  for (i = 0; i < pxInst->usQueueLen; i++)
+    {
+      xDone[i] = pxInst->ucBackoff[pxInst->xQueue[i].ucSndAddr] > 0;
+      if (xDone[i])
+        {
+          usRemaining--;
+        }
+    }
+
+  for (i = 1; i <= CONFIG_MB_MASTER_TOTAL_SLAVE_NUM; i++)
+    {
+      if (pxInst->ucBackoff[i] > 0)
+        {
+          pxInst->ucBackoff[i]--;
+        }
+    }
+
+  while (usRemaining > 0)
+    {
+      /* Pick the pending request of the next slave in round-robin order,
+       * so that one slave with many requests cannot starve the others.
+       */
+
+      iBest = -1;
+      uiBest = CONFIG_MB_MASTER_TOTAL_SLAVE_NUM;
+      for (i = 0; i < pxInst->usQueueLen; i++)
+        {
+          if (xDone[i])
+            {
+              continue;
+            }
+
+          uiDist = (pxInst->xQueue[i].ucSndAddr - ucSlave +
+                    CONFIG_MB_MASTER_TOTAL_SLAVE_NUM) %
+                   CONFIG_MB_MASTER_TOTAL_SLAVE_NUM;
+          if (uiDist < uiBest)
+            {
+              uiBest = uiDist;
+              iBest = i;
+            }
+        }
+
+      pxEntry = &pxInst->xQueue[iBest];
+      xDone[iBest] = true;
+      usRemaining--;
+
+      ucSlave = pxEntry->ucSndAddr + 1;
+      if (ucSlave > CONFIG_MB_MASTER_TOTAL_SLAVE_NUM)
+        {
+          ucSlave = 1;
+        }
+
+      eErr = prveMBMasterQueueIssue(pxEntry, lTimeOut);
+      if (eErr == MB_MRE_NO_ERR)
+        {
+          continue;
+        }
+
+      if (eFirstErr == MB_MRE_NO_ERR)
+        {
+          eFirstErr = eErr;
+        }
+
+      if (eErr == MB_MRE_TIMEDOUT)
+        {
+          /* The slave is not answering: do not wait for it again */
+
+          pxInst->ucBackoff[pxEntry->ucSndAddr] =
+            CONFIG_MB_MASTER_QUEUE_BACKOFF;
+
+          for (i = 0; i < pxInst->usQueueLen; i++)
+            {
+              if (!xDone[i] &&
+                  pxInst->xQueue[i].ucSndAddr == pxEntry->ucSndAddr)
+                {
+                  xDone[i] = true;
+                  usRemaining--;
+                }
+            }
+        }
+    }
+
+  pxInst->ucQueueNext = ucSlave;
+  return eFirstErr;
+}
+
+#endif /* CONFIG_MB_MASTER_QUEUE */
@@ -88,6 +88,9 @@ void vMBPortLog(eMBPortLogLevel eLevel, const char *szModule,
 void vMBPortTimerPoll(void);
 bool xMBPortSerialPoll(void);
 bool xMBPortSerialSetTimeout(uint32_t dwTimeoutMs);
+#ifdef CONFIG_MB_TCP_ENABLED
+bool xMBTCPPortPoll(void);
+#endif
 
 #if defined(CONFIG_MB_RTU_MASTER) || defined(CONFIG_MB_ASCII_MASTER)
   void vMBMasterPortEnterCritical(void);
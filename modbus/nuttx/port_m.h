@@ -0,0 +1,202 @@
+/****************************************************************************
+ * apps/modbus/nuttx/port_m.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_MODBUS_NUTTX_PORT_M_H
+#define __APPS_MODBUS_NUTTX_PORT_M_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/time.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <semaphore.h>
+#include <termios.h>
+
+#include "modbus/mb.h"
+#include "modbus/mb_m.h"
+#include "modbus/mbframe.h"
+#include "modbus/mbport.h"
+
+#if defined(CONFIG_MB_RTU_MASTER) || defined(CONFIG_MB_ASCII_MASTER)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifdef CONFIG_MB_ASCII_ENABLED
+#  define MB_MASTER_SER_BUF_SIZE  513   /* must hold a complete ASCII frame. */
+#else
+#  define MB_MASTER_SER_BUF_SIZE  256   /* must hold a complete RTU frame. */
+#endif
+
+#define MB_MASTER_SER_PDU_SIZE_MAX  256 /* Maximum size of a Modbus RTU
+                                         * frame. */
+
+#ifndef CONFIG_MB_MASTER_QUEUE_DEPTH
+#  define CONFIG_MB_MASTER_QUEUE_DEPTH 32
+#endif
+
+/* Return the master instance used by the calling thread.  Without
+ * CONFIG_MB_MASTER_MULTI_INSTANCE there is exactly one instance and the
+ * lookup folds into a constant address.
+ */
+
+#ifdef CONFIG_MB_MASTER_MULTI_INSTANCE
+#  define MB_MASTER_INST() pxMBMasterInstanceGet()
+#else
+#  define MB_MASTER_INST() (&xMBMasterDefaultInstance)
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One queued (and possibly merged) read request of the master poll list */
+
+struct xMBMasterQueueEntry
+{
+  uint8_t  ucSndAddr;               /* Destination slave address */
+  uint8_t  eType;                   /* eMBMasterQueueRegType */
+  uint16_t usRegAddr;               /* First register / coil */
+  uint16_t usNRegs;                 /* Number of registers / coils */
+};
+
+/* All state of one Modbus master.  Every serial port served by the master
+ * gets its own instance so that several ports can be polled concurrently
+ * from separate threads.
+ */
+
+struct xMBMasterInstance
+{
+  /* Protocol stack (mb_m.c) */
+
+  uint8_t ucDestAddress;
+  bool xRunInMasterMode;
+  eMBMasterErrorEventType eCurErrorType;
+  enum
+  {
+    STATE_ENABLED,
+    STATE_DISABLED,
+    STATE_NOT_INITIALIZED
+  } eState;
+
+  /* Frame functions, set by eMBMasterInit() according to the mode */
+
+  peMBFrameSend peFrameSendCur;
+  pvMBFrameStart pvFrameStartCur;
+  pvMBFrameStop pvFrameStopCur;
+  peMBFrameReceive peFrameReceiveCur;
+  pvMBFrameClose pvFrameCloseCur;
+
+  /* Callback functions required by the porting layer. They are called
+   * when an external event has happened which includes a timeout or the
+   * reception or transmission of a character.
+   */
+
+  bool (*pxFrameCBByteReceived)(void);
+  bool (*pxFrameCBTransmitterEmpty)(void);
+  bool (*pxPortCBTimerExpired)(void);
+
+  /* Received frame, kept between the FRAME_RECEIVED and EXECUTE events */
+
+  uint8_t *pucPollFrame;
+  uint8_t ucPollRcvAddress;
+  uint16_t usPollLength;
+
+#ifdef CONFIG_MB_RTU_MASTER
+  /* RTU framing (mbrtu_m.c) */
+
+  volatile uint8_t eSndState;
+  volatile uint8_t eRcvState;
+  volatile uint8_t ucRTUSndBuf[MB_MASTER_SER_PDU_SIZE_MAX];
+  volatile uint8_t ucRTURcvBuf[MB_MASTER_SER_PDU_SIZE_MAX];
+  volatile uint16_t usSendPDULength;
+  volatile uint8_t *pucSndBufferCur;
+  volatile uint16_t usSndBufferCount;
+  volatile uint16_t usRcvBufferPos;
+  volatile bool xFrameIsBroadcast;
+  volatile eMBMasterTimerMode eCurTimerMode;
+#endif
+
+  /* Serial port (portserial_m.c) */
+
+  int iSerialFd;
+  bool bRxEnabled;
+  bool bTxEnabled;
+  uint32_t ulSerialTimeoutMs;
+  uint8_t ucSerialBuffer[MB_MASTER_SER_BUF_SIZE];
+  int uiRxBufferPos;
+  int uiTxBufferPos;
+  struct termios xOldTIO;
+
+  /* Timers (porttimer_m.c) */
+
+  uint32_t ulTimeOut;               /* current timeout duration        */
+  uint32_t ulTimeoutT35;            /* 3.5 byte transmission duration  */
+  uint32_t ulTimeoutConvertDelay;   /* timeout after broadcast message */
+  uint32_t ulTimeoutResponse;       /* response timeout duration       */
+  struct timeval xTimeLast;
+  bool bTimeoutEnable;              /* timeout is active */
+
+  /* Events and OS resources (portevent_m.c) */
+
+  sem_t xBusySem;
+  sem_t xWaiterSem;
+  volatile eMBMasterEventType eQueuedEvent;
+
+#ifdef CONFIG_MB_MASTER_QUEUE
+  /* Poll list (mb_m_queue.c) */
+
+  struct xMBMasterQueueEntry xQueue[CONFIG_MB_MASTER_QUEUE_DEPTH];
+  uint16_t usQueueLen;
+  uint8_t ucQueueNext;
+  uint8_t ucBackoff[CONFIG_MB_MASTER_TOTAL_SLAVE_NUM + 1];
+#endif
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern struct xMBMasterInstance xMBMasterDefaultInstance;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+void vMBMasterInstanceReset(FAR struct xMBMasterInstance *pxInst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_MB_RTU_MASTER || CONFIG_MB_ASCII_MASTER */
+#endif /* __APPS_MODBUS_NUTTX_PORT_M_H */
@@ -82,6 +82,15 @@ bool xMBPortEventGet(eMBEventType * eEvent)
 
       xMBPortSerialPoll();
 
+#ifdef CONFIG_MB_TCP_ENABLED
+      /* Serve the Modbus TCP connections.  This posts EV_FRAME_RECEIVED
+       * once a complete request has arrived on any of them.  It returns
+       * at once while xMBTCPPortInit() has not opened the listener.
+       */
+
+      xMBTCPPortPoll();
+#endif
+
       /* Check if any of the timers have expired. */
 
       vMBPortTimerPoll();
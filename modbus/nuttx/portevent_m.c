@@ -38,10 +38,12 @@
 #include "modbus/mbport.h"
 #include <sys/time.h>
 #include <semaphore.h>
+#include <time.h>
 #include <mqueue.h>
 #include <errno.h>
 
 #include "port.h"
+#include "port_m.h"
 
 #if defined(CONFIG_MB_RTU_MASTER) || defined(CONFIG_MB_ASCII_MASTER)
 
@@ -54,81 +56,80 @@
                        | EV_MASTER_ERROR_RECEIVE_DATA      \
                        | EV_MASTER_ERROR_EXECUTE_FUNCTION)
 
-/****************************************************************************
- * Private Data
- ****************************************************************************/
-
-static sem_t bussysem;
-static sem_t waitersem;
-static eMBMasterEventType eQueuedEvent;
-
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
 bool xMBMasterPortEventInit(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
   /* Initialize semaphore for waiter */
 
-  sem_init(&waitersem, 0, 0);
+  sem_init(&pxInst->xWaiterSem, 0, 0);
 
   /* No event in queue */
 
-  eQueuedEvent = 0;
+  pxInst->eQueuedEvent = 0;
 
   return true;
 }
 
 bool xMBMasterPortEventPost(eMBMasterEventType eEvent)
 {
-  /* Post waiter sem, if event belongs to one of waiter events */
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
+  pxInst->eQueuedEvent |= eEvent;
+
+  /* Post waiter sem, if event belongs to one of waiter events.  The event
+   * must be queued first: the waiter reads it as soon as it wakes up.
+   */
 
   if (eEvent & WAITER_EVENTS)
     {
-      sem_post(&waitersem);
+      sem_post(&pxInst->xWaiterSem);
     }
 
-  eQueuedEvent |= eEvent;
-
   return true;
 }
 
 bool xMBMasterPortEventGet(eMBMasterEventType *eEvent)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   bool xEventHappened = false;
 
   *eEvent = 0;
 
-  if (eQueuedEvent & ~(WAITER_EVENTS))
+  if (pxInst->eQueuedEvent & ~(WAITER_EVENTS))
     {
       /* Fetch events by priority */
 
-      if (eQueuedEvent & EV_MASTER_READY)
+      if (pxInst->eQueuedEvent & EV_MASTER_READY)
         {
           *eEvent = EV_MASTER_READY;
         }
-      else if (eQueuedEvent & EV_MASTER_FRAME_RECEIVED)
+      else if (pxInst->eQueuedEvent & EV_MASTER_FRAME_RECEIVED)
         {
           *eEvent = EV_MASTER_FRAME_RECEIVED;
         }
-      else if (eQueuedEvent & EV_MASTER_EXECUTE)
+      else if (pxInst->eQueuedEvent & EV_MASTER_EXECUTE)
         {
           *eEvent = EV_MASTER_EXECUTE;
         }
-      else if (eQueuedEvent & EV_MASTER_FRAME_SENT)
+      else if (pxInst->eQueuedEvent & EV_MASTER_FRAME_SENT)
         {
           *eEvent = EV_MASTER_FRAME_SENT;
         }
-      else if (eQueuedEvent & EV_MASTER_FRAME_SENT)
+      else if (pxInst->eQueuedEvent & EV_MASTER_FRAME_SENT)
         {
           *eEvent = EV_MASTER_FRAME_SENT;
         }
-      else if (eQueuedEvent & EV_MASTER_ERROR_PROCESS)
+      else if (pxInst->eQueuedEvent & EV_MASTER_ERROR_PROCESS)
         {
           *eEvent = EV_MASTER_ERROR_PROCESS;
         }
 
-      eQueuedEvent &= ~(*eEvent);
+      pxInst->eQueuedEvent &= ~(*eEvent);
       xEventHappened = true;
     }
   else
@@ -153,16 +154,17 @@ bool xMBMasterPortEventGet(eMBMasterEventType *eEvent)
 
 void vMBMasterOsResInit(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   int res;
 
-  if ((res = sem_init(&bussysem, 0, 0)) != OK)
+  if ((res = sem_init(&pxInst->xBusySem, 0, 0)) != OK)
     {
       vMBPortLog(MB_LOG_ERROR,
                  "EVENT-INIT",
                  "Can't initialize locking semaphore. Err: %d\n", res);
     }
 
-  sem_post(&bussysem);
+  sem_post(&pxInst->xBusySem);
 }
 
 /* This function should take Modbus Master running resource.
@@ -178,11 +180,12 @@ void vMBMasterOsResInit(void)
 
 bool xMBMasterRunResTake(int32_t lTimeOut)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   struct timespec time;
 
   if (lTimeOut == -1)
     {
-      if (sem_wait(&bussysem) != OK)
+      if (sem_wait(&pxInst->xBusySem) != OK)
         {
           return false;
         }
@@ -191,9 +194,18 @@ bool xMBMasterRunResTake(int32_t lTimeOut)
     }
   else
     {
-      time.tv_sec = 0;
-      time.tv_nsec = lTimeOut * 1000;   /* convert to nano seconds */
-      if (sem_timedwait(&bussysem, &time) != OK)
+      /* sem_timedwait() expects an absolute deadline */
+
+      clock_gettime(CLOCK_REALTIME, &time);
+      time.tv_sec  += lTimeOut / 1000000;
+      time.tv_nsec += (lTimeOut % 1000000) * 1000; /* usec to nsec */
+      if (time.tv_nsec >= 1000000000)
+        {
+          time.tv_sec++;
+          time.tv_nsec -= 1000000000;
+        }
+
+      if (sem_timedwait(&pxInst->xBusySem, &time) != OK)
         {
           return false;
         }
@@ -209,7 +221,9 @@ bool xMBMasterRunResTake(int32_t lTimeOut)
 
 void vMBMasterRunResRelease(void)
 {
-  if (sem_post(&bussysem) != OK)
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
+  if (sem_post(&pxInst->xBusySem) != OK)
     {
       vMBPortLog(MB_LOG_ERROR,
                  "RUN-RES-RELEASE",
@@ -280,32 +294,34 @@ void vMBMasterCBRequestSuccess(void)
 
 eMBMasterReqErrCode eMBMasterWaitRequestFinish(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
   eMBMasterReqErrCode eErrStatus = MB_MRE_NO_ERR;
 
   /* wait forever for OS event */
 
-  sem_wait(&waitersem);
+  sem_wait(&pxInst->xWaiterSem);
 
-  if (eQueuedEvent & WAITER_EVENTS)
+  if (pxInst->eQueuedEvent & WAITER_EVENTS)
     {
-      if (eQueuedEvent & EV_MASTER_PROCESS_SUCCESS)
+      if (pxInst->eQueuedEvent & EV_MASTER_PROCESS_SUCCESS)
         {
           /* Do nothing */
         }
-      else if (eQueuedEvent & EV_MASTER_ERROR_RESPOND_TIMEOUT)
+      else if (pxInst->eQueuedEvent & EV_MASTER_ERROR_RESPOND_TIMEOUT)
         {
           eErrStatus = MB_MRE_TIMEDOUT;
         }
-      else if (eQueuedEvent & EV_MASTER_ERROR_RECEIVE_DATA)
+      else if (pxInst->eQueuedEvent & EV_MASTER_ERROR_RECEIVE_DATA)
         {
           eErrStatus = MB_MRE_REV_DATA;
         }
-      else if (eQueuedEvent & EV_MASTER_ERROR_EXECUTE_FUNCTION)
+      else if (pxInst->eQueuedEvent & EV_MASTER_ERROR_EXECUTE_FUNCTION)
         {
           eErrStatus = MB_MRE_EXE_FUN;
         }
 
-      eQueuedEvent &= ~WAITER_EVENTS;
+      pxInst->eQueuedEvent &= ~WAITER_EVENTS;
     }
 
   return eErrStatus;
@@ -45,6 +45,7 @@
 #include "modbus/mb.h"
 #include "modbus/mb_m.h"
 #include "modbus/mbport.h"
+#include "port_m.h"
 
 #if defined(CONFIG_MB_RTU_MASTER) || defined(CONFIG_MB_ASCII_MASTER)
 
@@ -61,6 +62,40 @@
 static FILE *fLogFile = NULL;
 static eMBPortLogLevel eLevelMax = MB_LOG_DEBUG;
 
+#ifdef CONFIG_MB_MASTER_MULTI_INSTANCE
+static pthread_once_t xInstanceOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t xInstanceKey;
+#endif
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* The instance used by threads which never selected one */
+
+struct xMBMasterInstance xMBMasterDefaultInstance =
+{
+  .eState    = STATE_NOT_INITIALIZED,
+  .iSerialFd = -1,
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_MB_MASTER_MULTI_INSTANCE
+static void prvvMBMasterInstanceKeyCreate(void)
+{
+  int ret = pthread_key_create(&xInstanceKey, NULL);
+
+  if (ret != 0)
+    {
+      vMBMasterPortLog(MB_LOG_ERROR, "INSTANCE",
+                       "Can't create instance key: %d\n", ret);
+    }
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -107,4 +142,58 @@ void vMBMasterPortLog(eMBPortLogLevel eLevel, const char * szModule,
     }
 }
 
+void vMBMasterInstanceReset(FAR struct xMBMasterInstance *pxInst)
+{
+  memset(pxInst, 0, sizeof(*pxInst));
+  pxInst->eState    = STATE_NOT_INITIALIZED;
+  pxInst->iSerialFd = -1;
+}
+
+#ifdef CONFIG_MB_MASTER_MULTI_INSTANCE
+xMBMasterInstance *pxMBMasterInstanceCreate(void)
+{
+  FAR struct xMBMasterInstance *pxInst;
+
+  pxInst = malloc(sizeof(struct xMBMasterInstance));
+  if (pxInst != NULL)
+    {
+      vMBMasterInstanceReset(pxInst);
+    }
+
+  return pxInst;
+}
+
+void vMBMasterInstanceDelete(xMBMasterInstance *pxInst)
+{
+  if (pxInst == NULL || pxInst == &xMBMasterDefaultInstance)
+    {
+      return;
+    }
+
+  if (pxInst->eState != STATE_NOT_INITIALIZED)
+    {
+      sem_destroy(&pxInst->xBusySem);
+      sem_destroy(&pxInst->xWaiterSem);
+    }
+
+  free(pxInst);
+}
+
+void vMBMasterInstanceSelect(xMBMasterInstance *pxInst)
+{
+  pthread_once(&xInstanceOnce, prvvMBMasterInstanceKeyCreate);
+  pthread_setspecific(xInstanceKey, pxInst);
+}
+
+xMBMasterInstance *pxMBMasterInstanceGet(void)
+{
+  FAR struct xMBMasterInstance *pxInst;
+
+  pthread_once(&xInstanceOnce, prvvMBMasterInstanceKeyCreate);
+  pxInst = pthread_getspecific(xInstanceKey);
+
+  return pxInst != NULL ? pxInst : &xMBMasterDefaultInstance;
+}
+#endif
+
 #endif /* defined(CONFIG_MB_RTU_MASTER) || defined(CONFIG_MB_ASCII_MASTER) */
@@ -52,34 +52,10 @@
 #include "modbus/mb.h"
 #include "modbus/mb_m.h"
 #include "modbus/mbport.h"
+#include "port_m.h"
 
 #if defined(CONFIG_MB_RTU_MASTER) || defined(CONFIG_MB_ASCII_MASTER)
 
-/****************************************************************************
- * Pre-processor Definitions
- ****************************************************************************/
-
-#ifdef CONFIG_MB_ASCII_ENABLED
-#define BUF_SIZE    513         /* must hold a complete ASCII frame. */
-#else
-#define BUF_SIZE    256         /* must hold a complete RTU frame. */
-#endif
-
-/****************************************************************************
- * Private Data
- ****************************************************************************/
-
-static int      iSerialFd = -1;
-static bool     bRxEnabled;
-static bool     bTxEnabled;
-
-static uint32_t ulTimeoutMs;
-static uint8_t  ucBuffer[BUF_SIZE];
-static int      uiRxBufferPos;
-static int      uiTxBufferPos;
-
-static struct termios xOldTIO;
-
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -96,6 +72,7 @@ static bool prvbMBMasterPortSerialWrite(uint8_t *pucBuffer,
 static bool prvbMBMasterPortSerialRead(uint8_t *pucBuffer, uint16_t usNBytes,
                                        uint16_t *usNBytesRead)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   bool            bResult = true;
   ssize_t         res;
   fd_set          rfds;
@@ -104,7 +81,7 @@ static bool prvbMBMasterPortSerialRead(uint8_t *pucBuffer, uint16_t usNBytes,
   tv.tv_sec = 0;
   tv.tv_usec = 5000;
   FD_ZERO(&rfds);
-  FD_SET(iSerialFd, &rfds);
+  FD_SET(pxInst->iSerialFd, &rfds);
 
   /* Wait until character received or timeout. Recover in case of an
    * interrupted read system call.
@@ -112,16 +89,16 @@ static bool prvbMBMasterPortSerialRead(uint8_t *pucBuffer, uint16_t usNBytes,
 
   do
     {
-      if (select(iSerialFd + 1, &rfds, NULL, NULL, &tv) == -1)
+      if (select(pxInst->iSerialFd + 1, &rfds, NULL, NULL, &tv) == -1)
         {
           if (errno != EINTR)
             {
               bResult = false;
             }
         }
-      else if (FD_ISSET(iSerialFd, &rfds))
+      else if (FD_ISSET(pxInst->iSerialFd, &rfds))
         {
-          if ((res = read(iSerialFd, pucBuffer, usNBytes)) == -1)
+          if ((res = read(pxInst->iSerialFd, pucBuffer, usNBytes)) == -1)
             {
               bResult = false;
             }
@@ -145,13 +122,14 @@ static bool prvbMBMasterPortSerialRead(uint8_t *pucBuffer, uint16_t usNBytes,
 static bool prvbMBMasterPortSerialWrite(uint8_t *pucBuffer,
                                         uint16_t usNBytes)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   ssize_t res;
   size_t  left = (size_t) usNBytes;
   size_t  done = 0;
 
   while (left > 0)
     {
-      if ((res = write(iSerialFd, pucBuffer + done, left)) == -1)
+      if ((res = write(pxInst->iSerialFd, pucBuffer + done, left)) == -1)
         {
           if (errno != EINTR)
             {
@@ -176,49 +154,52 @@ static bool prvbMBMasterPortSerialWrite(uint8_t *pucBuffer,
 
 void vMBMasterPortSerialEnable(bool bEnableRx, bool bEnableTx)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
   /* it is not allowed that both receiver and transmitter are enabled. */
 
   DEBUGASSERT(!bEnableRx || !bEnableTx);
 
   if (bEnableRx)
     {
-      tcflush(iSerialFd, TCIFLUSH);
-      uiRxBufferPos = 0;
-      bRxEnabled = true;
+      tcflush(pxInst->iSerialFd, TCIFLUSH);
+      pxInst->uiRxBufferPos = 0;
+      pxInst->bRxEnabled = true;
     }
   else
     {
-      bRxEnabled = false;
+      pxInst->bRxEnabled = false;
     }
 
   if (bEnableTx)
     {
-      bTxEnabled = true;
-      uiTxBufferPos = 0;
+      pxInst->bTxEnabled = true;
+      pxInst->uiTxBufferPos = 0;
     }
   else
     {
-      bTxEnabled = false;
+      pxInst->bTxEnabled = false;
     }
 }
 
 bool xMBMasterPortSerialInit(uint8_t ucPort, speed_t ulBaudRate,
                        uint8_t ucDataBits, eMBParity eParity)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   char szDevice[16];
   bool bStatus = true;
   struct termios xNewTIO;
 
   snprintf(szDevice, 16, "/dev/ttyS%d", ucPort);
 
-  if ((iSerialFd = open(szDevice, O_RDWR | O_NOCTTY)) < 0)
+  if ((pxInst->iSerialFd = open(szDevice, O_RDWR | O_NOCTTY)) < 0)
     {
       vMBMasterPortLog(MB_LOG_ERROR, "SER-INIT",
                        "Can't open serial port %s: %d\n",
                        szDevice, errno);
       bStatus = false;
     }
-  else if (tcgetattr(iSerialFd, &xOldTIO) != 0)
+  else if (tcgetattr(pxInst->iSerialFd, &pxInst->xOldTIO) != 0)
     {
       vMBMasterPortLog(MB_LOG_ERROR, "SER-INIT",
                        "Can't get settings from port %s: %d\n",
@@ -283,7 +264,7 @@ bool xMBMasterPortSerialInit(uint8_t ucPort, speed_t ulBaudRate,
                                "Can't set baud rate %ld for port %s: %d\n",
                                ulBaudRate, szDevice, errno);
             }
-          else if (tcsetattr(iSerialFd, TCSANOW, &xNewTIO) != 0)
+          else if (tcsetattr(pxInst->iSerialFd, TCSANOW, &xNewTIO) != 0)
             {
               vMBMasterPortLog(MB_LOG_ERROR, "SER-INIT",
                                "Can't set settings for port %s: %d\n",
@@ -302,13 +283,15 @@ bool xMBMasterPortSerialInit(uint8_t ucPort, speed_t ulBaudRate,
 
 bool xMBMasterPortSerialSetTimeout(uint32_t ulNewTimeoutMs)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
   if (ulNewTimeoutMs > 0)
     {
-      ulTimeoutMs = ulNewTimeoutMs;
+      pxInst->ulSerialTimeoutMs = ulNewTimeoutMs;
     }
   else
     {
-      ulTimeoutMs = 1;
+      pxInst->ulSerialTimeoutMs = 1;
     }
 
   return true;
@@ -316,23 +299,27 @@ bool xMBMasterPortSerialSetTimeout(uint32_t ulNewTimeoutMs)
 
 void vMBMasterPortClose(void)
 {
-  if (iSerialFd != -1)
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
+  if (pxInst->iSerialFd != -1)
     {
-      tcsetattr(iSerialFd, TCSANOW, &xOldTIO);
-      close(iSerialFd);
-      iSerialFd = -1;
+      tcsetattr(pxInst->iSerialFd, TCSANOW, &pxInst->xOldTIO);
+      close(pxInst->iSerialFd);
+      pxInst->iSerialFd = -1;
     }
 }
 
 bool xMBMasterPortSerialPoll(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   bool     bStatus = true;
   uint16_t usBytesRead;
   int      i;
 
-  while (bRxEnabled)
+  while (pxInst->bRxEnabled)
     {
-      if (prvbMBMasterPortSerialRead(&ucBuffer[0], BUF_SIZE, &usBytesRead))
+      if (prvbMBMasterPortSerialRead(&pxInst->ucSerialBuffer[0],
+                                     MB_MASTER_SER_BUF_SIZE, &usBytesRead))
         {
           if (usBytesRead == 0)
             {
@@ -346,10 +333,10 @@ bool xMBMasterPortSerialPoll(void)
                 {
                   /* Call the modbus stack and let him fill the buffers. */
 
-                  pxMBMasterFrameCBByteReceived();
+                  pxInst->pxFrameCBByteReceived();
                 }
 
-              uiRxBufferPos = 0;
+              pxInst->uiRxBufferPos = 0;
             }
         }
       else
@@ -361,16 +348,17 @@ bool xMBMasterPortSerialPoll(void)
         }
     }
 
-  if (bTxEnabled)
+  if (pxInst->bTxEnabled)
     {
-      while (bTxEnabled)
+      while (pxInst->bTxEnabled)
         {
-          pxMBMasterFrameCBTransmitterEmpty();
+          pxInst->pxFrameCBTransmitterEmpty();
 
           /* Call the modbus stack to let him fill the buffer. */
         }
 
-      if (!prvbMBMasterPortSerialWrite(&ucBuffer[0], uiTxBufferPos))
+      if (!prvbMBMasterPortSerialWrite(&pxInst->ucSerialBuffer[0],
+                                       pxInst->uiTxBufferPos))
         {
           vMBMasterPortLog(MB_LOG_ERROR, "SER-POLL",
                            "write failed on serial device: %d\n",
@@ -384,17 +372,21 @@ bool xMBMasterPortSerialPoll(void)
 
 bool xMBMasterPortSerialPutByte(int8_t ucByte)
 {
-  DEBUGASSERT(uiTxBufferPos < BUF_SIZE);
-  ucBuffer[uiTxBufferPos] = ucByte;
-  uiTxBufferPos++;
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
+  DEBUGASSERT(pxInst->uiTxBufferPos < MB_MASTER_SER_BUF_SIZE);
+  pxInst->ucSerialBuffer[pxInst->uiTxBufferPos] = ucByte;
+  pxInst->uiTxBufferPos++;
   return true;
 }
 
 bool xMBMasterPortSerialGetByte(int8_t *pucByte)
 {
-  DEBUGASSERT(uiRxBufferPos < BUF_SIZE);
-  *pucByte = ucBuffer[uiRxBufferPos];
-  uiRxBufferPos++;
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
+  DEBUGASSERT(pxInst->uiRxBufferPos < MB_MASTER_SER_BUF_SIZE);
+  *pucByte = pxInst->ucSerialBuffer[pxInst->uiRxBufferPos];
+  pxInst->uiRxBufferPos++;
   return true;
 }
 
@@ -0,0 +1,578 @@
+/****************************************************************************
+ * apps/modbus/nuttx/porttcp.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Modbus TCP port layer.  All client connections are served from the
+ * thread calling eMBPoll() with a single poll() call.  Connections are kept
+ * open across transactions, and a client may send several requests without
+ * waiting for the responses: complete requests are buffered per
+ * connection and handed to the protocol stack one at a time, round-robin
+ * between connections, while the responses are queued for transmission in
+ * request order.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+
+#include "port.h"
+
+#include "modbus/mb.h"
+#include "modbus/mbport.h"
+
+#ifdef CONFIG_MB_TCP_ENABLED
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_MB_TCP_MAX_CLIENTS
+#  define CONFIG_MB_TCP_MAX_CLIENTS 4
+#endif
+
+#ifndef CONFIG_MB_TCP_CLIENT_BUFSIZE
+#  define CONFIG_MB_TCP_CLIENT_BUFSIZE 1040
+#endif
+
+#define MB_TCP_DEFAULT_PORT 502
+
+/* Size of the MBAP header and of the largest Modbus TCP ADU */
+
+#define MB_TCP_HDR_SIZE     7
+#define MB_TCP_BUF_SIZE     (MB_TCP_HDR_SIZE + 253)
+
+#define MB_TCP_LEN          4   /* Offset of the length field */
+
+/* How long one poll may block when nothing is pending, in milliseconds */
+
+#define MB_TCP_POLL_TIMEOUT 50
+
+#if CONFIG_MB_TCP_CLIENT_BUFSIZE < MB_TCP_BUF_SIZE
+#  error CONFIG_MB_TCP_CLIENT_BUFSIZE must hold at least one ADU
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct xMBTCPClient
+{
+  int      iFd;                 /* Socket, -1 if the slot is free */
+  uint16_t usRxLen;             /* Bytes buffered in ucRxBuf */
+  uint16_t usTxLen;             /* Bytes waiting in ucTxBuf */
+  time_t   xLastActive;         /* Last time data was received */
+  uint8_t  ucRxBuf[CONFIG_MB_TCP_CLIENT_BUFSIZE];
+  uint8_t  ucTxBuf[CONFIG_MB_TCP_CLIENT_BUFSIZE];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int iListenFd = -1;
+static FAR struct xMBTCPClient *pxClients;
+
+/* The request currently handed to the protocol stack.  It is copied out of
+ * the connection buffer because the stack builds the response in place,
+ * and the response may be longer than the request.
+ */
+
+static uint8_t ucTCPFrame[MB_TCP_BUF_SIZE];
+static int iCurClient = -1;     /* Connection of the current request */
+static int iNextClient;         /* Where the round-robin scan resumes */
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static time_t prvxMBTCPNow(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec;
+}
+
+static void prvvMBTCPClientClose(int i)
+{
+  FAR struct xMBTCPClient *pxClient = &pxClients[i];
+
+  if (pxClient->iFd >= 0)
+    {
+      close(pxClient->iFd);
+      pxClient->iFd = -1;
+    }
+
+  pxClient->usRxLen = 0;
+  pxClient->usTxLen = 0;
+
+  if (iCurClient == i)
+    {
+      iCurClient = -1;
+    }
+}
+
+static void prvvMBTCPRelease(void)
+{
+  int i;
+
+  if (pxClients != NULL)
+    {
+      for (i = 0; i < CONFIG_MB_TCP_MAX_CLIENTS; i++)
+        {
+          prvvMBTCPClientClose(i);
+        }
+    }
+
+  if (iListenFd >= 0)
+    {
+      close(iListenFd);
+      iListenFd = -1;
+    }
+
+  free(pxClients);
+  pxClients = NULL;
+}
+
+/* Return the length of the complete ADU at the start of the receive
+ * buffer, 0 if more data is needed, or -1 if the stream is corrupt.
+ */
+
+static int prviMBTCPFrameLength(FAR const struct xMBTCPClient *pxClient)
+{
+  uint16_t usLength;
+
+  if (pxClient->usRxLen < MB_TCP_HDR_SIZE)
+    {
+      return 0;
+    }
+
+  /* The length field counts the unit identifier and the PDU */
+
+  usLength  = pxClient->ucRxBuf[MB_TCP_LEN] << 8;
+  usLength |= pxClient->ucRxBuf[MB_TCP_LEN + 1];
+  if (usLength < 2 || usLength + MB_TCP_HDR_SIZE - 1 > MB_TCP_BUF_SIZE)
+    {
+      return -1;
+    }
+
+  usLength += MB_TCP_HDR_SIZE - 1;
+  return pxClient->usRxLen >= usLength ? usLength : 0;
+}
+
+/* Send as much of the queued response data as the socket accepts */
+
+static void prvvMBTCPClientFlush(int i)
+{
+  FAR struct xMBTCPClient *pxClient = &pxClients[i];
+  ssize_t nsent;
+
+  while (pxClient->usTxLen > 0)
+    {
+      nsent = send(pxClient->iFd, pxClient->ucTxBuf, pxClient->usTxLen,
+                   MSG_DONTWAIT);
+      if (nsent < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+              prvvMBTCPClientClose(i);
+            }
+
+          return;
+        }
+
+      pxClient->usTxLen -= nsent;
+      memmove(pxClient->ucTxBuf, pxClient->ucTxBuf + nsent,
+              pxClient->usTxLen);
+    }
+}
+
+static void prvvMBTCPClientReceive(int i)
+{
+  FAR struct xMBTCPClient *pxClient = &pxClients[i];
+  ssize_t nrecv;
+
+  /* A full buffer always starts with a complete frame, or with a bad MBAP
+   * header that prviMBTCPNextReady() drops the client for.  Receive more
+   * once that frame was taken out; recv() of 0 bytes would return 0 and
+   * look like the peer closed the connection.
+   */
+
+  if (pxClient->usRxLen >= sizeof(pxClient->ucRxBuf))
+    {
+      return;
+    }
+
+  nrecv = recv(pxClient->iFd, pxClient->ucRxBuf + pxClient->usRxLen,
+               sizeof(pxClient->ucRxBuf) - pxClient->usRxLen, MSG_DONTWAIT);
+  if (nrecv > 0)
+    {
+      pxClient->usRxLen += nrecv;
+      pxClient->xLastActive = prvxMBTCPNow();
+    }
+  else if (nrecv == 0 ||
+           (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK))
+    {
+      /* Peer closed the connection or it failed */
+
+      prvvMBTCPClientClose(i);
+    }
+}
+
+static void prvvMBTCPAccept(void)
+{
+  int iOldest = -1;
+  int iSlot = -1;
+  int iOne = 1;
+  int iFd;
+  int i;
+
+  iFd = accept(iListenFd, NULL, NULL);
+  if (iFd < 0)
+    {
+      return;
+    }
+
+  for (i = 0; i < CONFIG_MB_TCP_MAX_CLIENTS; i++)
+    {
+      if (pxClients[i].iFd < 0)
+        {
+          iSlot = i;
+          break;
+        }
+
+      if (i != iCurClient && (iOldest < 0 ||
+          pxClients[i].xLastActive < pxClients[iOldest].xLastActive))
+        {
+          iOldest = i;
+        }
+    }
+
+  /* All slots busy: as recommended by the Modbus TCP implementation guide,
+   * make room by dropping the connection that has been idle longest.
+   */
+
+  if (iSlot < 0)
+    {
+      if (iOldest < 0)
+        {
+          close(iFd);
+          return;
+        }
+
+      vMBPortLog(MB_LOG_INFO, "TCP", "Dropping idle connection %d\n",
+                 iOldest);
+      prvvMBTCPClientClose(iOldest);
+      iSlot = iOldest;
+    }
+
+  /* Responses are small and latency matters more than segment count */
+
+  setsockopt(iFd, IPPROTO_TCP, TCP_NODELAY, &iOne, sizeof(iOne));
+  fcntl(iFd, F_SETFL, fcntl(iFd, F_GETFL) | O_NONBLOCK);
+
+  pxClients[iSlot].iFd = iFd;
+  pxClients[iSlot].usRxLen = 0;
+  pxClients[iSlot].usTxLen = 0;
+  pxClients[iSlot].xLastActive = prvxMBTCPNow();
+}
+
+/* Pick the next connection, round-robin, that has a complete request
+ * buffered and room for the response.
+ */
+
+static int prviMBTCPNextReady(void)
+{
+  FAR struct xMBTCPClient *pxClient;
+  int iLength;
+  int i;
+  int n;
+
+  for (n = 0; n < CONFIG_MB_TCP_MAX_CLIENTS; n++)
+    {
+      i = (iNextClient + n) % CONFIG_MB_TCP_MAX_CLIENTS;
+      pxClient = &pxClients[i];
+      if (pxClient->iFd < 0 ||
+          sizeof(pxClient->ucTxBuf) - pxClient->usTxLen < MB_TCP_BUF_SIZE)
+        {
+          continue;
+        }
+
+      iLength = prviMBTCPFrameLength(pxClient);
+      if (iLength < 0)
+        {
+          vMBPortLog(MB_LOG_WARN, "TCP", "Bad MBAP header on %d\n", i);
+          prvvMBTCPClientClose(i);
+        }
+      else if (iLength > 0)
+        {
+          iNextClient = (i + 1) % CONFIG_MB_TCP_MAX_CLIENTS;
+          return i;
+        }
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+bool xMBTCPPortInit(uint16_t usTCPPort)
+{
+  struct sockaddr_in xAddr;
+  int iOne = 1;
+  int i;
+
+  pxClients = calloc(CONFIG_MB_TCP_MAX_CLIENTS, sizeof(*pxClients));
+  if (pxClients == NULL)
+    {
+      return false;
+    }
+
+  for (i = 0; i < CONFIG_MB_TCP_MAX_CLIENTS; i++)
+    {
+      pxClients[i].iFd = -1;
+    }
+
+  iListenFd = socket(AF_INET, SOCK_STREAM, 0);
+  if (iListenFd < 0)
+    {
+      vMBPortLog(MB_LOG_ERROR, "TCP-INIT", "socket failed: %d\n", errno);
+      goto errout;
+    }
+
+  setsockopt(iListenFd, SOL_SOCKET, SO_REUSEADDR, &iOne, sizeof(iOne));
+
+  memset(&xAddr, 0, sizeof(xAddr));
+  xAddr.sin_family = AF_INET;
+  xAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+  xAddr.sin_port = htons(usTCPPort == 0 ? MB_TCP_DEFAULT_PORT : usTCPPort);
+
+  if (bind(iListenFd, (FAR struct sockaddr *)&xAddr, sizeof(xAddr)) < 0 ||
+      listen(iListenFd, CONFIG_MB_TCP_MAX_CLIENTS) < 0)
+    {
+      vMBPortLog(MB_LOG_ERROR, "TCP-INIT", "bind/listen failed: %d\n",
+                 errno);
+      goto errout;
+    }
+
+  fcntl(iListenFd, F_SETFL, fcntl(iListenFd, F_GETFL) | O_NONBLOCK);
+  iCurClient = -1;
+  iNextClient = 0;
+  return true;
+
+errout:
+  prvvMBTCPRelease();
+  return false;
+}
+
+void vMBTCPPortClose(void)
+{
+  prvvMBTCPRelease();
+}
+
+void vMBTCPPortDisable(void)
+{
+  int i;
+
+  if (pxClients != NULL)
+    {
+      for (i = 0; i < CONFIG_MB_TCP_MAX_CLIENTS; i++)
+        {
+          prvvMBTCPClientClose(i);
+        }
+    }
+}
+
+bool xMBTCPPortPoll(void)
+{
+  struct pollfd xFds[CONFIG_MB_TCP_MAX_CLIENTS + 1];
+  FAR struct xMBTCPClient *pxClient;
+  int iClient[CONFIG_MB_TCP_MAX_CLIENTS + 1];
+  int nfds = 0;
+  int ret;
+  int i;
+
+  if (iListenFd < 0)
+    {
+      return false;
+    }
+
+  /* Requests left over from the previous poll are handled right away */
+
+  i = prviMBTCPNextReady();
+  if (i >= 0)
+    {
+      iCurClient = i;
+      return xMBPortEventPost(EV_FRAME_RECEIVED);
+    }
+
+  xFds[nfds].fd = iListenFd;
+  xFds[nfds].events = POLLIN;
+  iClient[nfds++] = -1;
+
+  for (i = 0; i < CONFIG_MB_TCP_MAX_CLIENTS; i++)
+    {
+      pxClient = &pxClients[i];
+      if (pxClient->iFd < 0)
+        {
+          continue;
+        }
+
+      xFds[nfds].fd = pxClient->iFd;
+      xFds[nfds].events = 0;
+      if (pxClient->usRxLen < sizeof(pxClient->ucRxBuf))
+        {
+          xFds[nfds].events |= POLLIN;
+        }
+
+      if (pxClient->usTxLen > 0)
+        {
+          xFds[nfds].events |= POLLOUT;
+        }
+
+      iClient[nfds++] = i;
+    }
+
+  ret = poll(xFds, nfds, MB_TCP_POLL_TIMEOUT);
+  if (ret <= 0)
+    {
+      return ret == 0 || errno == EINTR;
+    }
+
+  for (i = 1; i < nfds; i++)
+    {
+      if (pxClients[iClient[i]].iFd < 0)
+        {
+          continue;
+        }
+
+      if (xFds[i].revents & POLLOUT)
+        {
+          prvvMBTCPClientFlush(iClient[i]);
+        }
+
+      if (xFds[i].revents & (POLLIN | POLLHUP | POLLERR))
+        {
+          prvvMBTCPClientReceive(iClient[i]);
+        }
+    }
+
+  if (xFds[0].revents & POLLIN)
+    {
+      prvvMBTCPAccept();
+    }
+
+  i = prviMBTCPNextReady();
+  if (i >= 0)
+    {
+      iCurClient = i;
+      xMBPortEventPost(EV_FRAME_RECEIVED);
+    }
+
+  return true;
+}
+
+bool xMBTCPPortGetRequest(uint8_t **ppucMBTCPFrame, uint16_t *usTCPLength)
+{
+  FAR struct xMBTCPClient *pxClient;
+  int iLength;
+
+  if (iCurClient < 0)
+    {
+      return false;
+    }
+
+  pxClient = &pxClients[iCurClient];
+  iLength = prviMBTCPFrameLength(pxClient);
+  if (iLength <= 0)
+    {
+      return false;
+    }
+
+  /* Hand out a copy and consume the request from the connection buffer */
+
+  memcpy(ucTCPFrame, pxClient->ucRxBuf, iLength);
+  pxClient->usRxLen -= iLength;
+  memmove(pxClient->ucRxBuf, pxClient->ucRxBuf + iLength,
+          pxClient->usRxLen);
+
+  *ppucMBTCPFrame = ucTCPFrame;
+  *usTCPLength = iLength;
+  return true;
+}
+
+bool xMBTCPPortSendResponse(const uint8_t *pucMBTCPFrame,
+                            uint16_t usTCPLength)
+{
+  FAR struct xMBTCPClient *pxClient;
+
+  if (iCurClient < 0)
+    {
+      /* The connection went away while the request was processed */
+
+      return false;
+    }
+
+  pxClient = &pxClients[iCurClient];
+  if (usTCPLength > sizeof(pxClient->ucTxBuf) - pxClient->usTxLen)
+    {
+      return false;
+    }
+
+  memcpy(pxClient->ucTxBuf + pxClient->usTxLen, pucMBTCPFrame, usTCPLength);
+  pxClient->usTxLen += usTCPLength;
+
+  /* Only push the data out once no further request of this connection is
+   * pending, so that pipelined responses leave in as few segments as
+   * possible.
+   */
+
+  if (prviMBTCPFrameLength(pxClient) == 0)
+    {
+      prvvMBTCPClientFlush(iCurClient);
+    }
+
+  return true;
+}
+
+#endif /* CONFIG_MB_TCP_ENABLED */
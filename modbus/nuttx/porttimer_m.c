@@ -44,6 +44,7 @@
 #include "modbus/mb.h"
 #include "modbus/mb_m.h"
 #include "modbus/mbport.h"
+#include "port_m.h"
 
 #if defined(CONFIG_MB_RTU_MASTER) || defined(CONFIG_MB_ASCII_MASTER)
 
@@ -59,27 +60,17 @@
 #  define MB_MASTER_TIMEOUT_MS_RESPOND CONFIG_MB_MASTER_TIMEOUT_MS_RESPOND
 #endif
 
-/****************************************************************************
- * Public Data
- ****************************************************************************/
-
-uint32_t ulTimeOut;                /* current timeout duration        */
-uint32_t ulTimeoutT35;             /* 3.5 byte transmission duration  */
-uint32_t ulTimeoutConvertDelay;    /* timeout after broadcast message */
-uint32_t ulTimeoutResponse;        /* response timeout duration       */
-static struct timeval xTimeLast;
-bool bTimeoutEnable;               /* timeout is active */
-
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
 void vMBMasterPortTimersEnable(void)
 {
-  int res = gettimeofday(&xTimeLast, NULL);
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+  int res = gettimeofday(&pxInst->xTimeLast, NULL);
 
   DEBUGASSERT(res == 0);
-  bTimeoutEnable = true;
+  pxInst->bTimeoutEnable = true;
 }
 
 /****************************************************************************
@@ -88,29 +79,31 @@ void vMBMasterPortTimersEnable(void)
 
 bool xMBMasterPortTimersInit(uint16_t usTimeOut50us)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
   /* Configure all timeout values */
 
-  ulTimeoutT35 = usTimeOut50us / 20U;
-  if (ulTimeoutT35 == 0)
+  pxInst->ulTimeoutT35 = usTimeOut50us / 20U;
+  if (pxInst->ulTimeoutT35 == 0)
     {
-      ulTimeoutT35 = 1;
+      pxInst->ulTimeoutT35 = 1;
     }
 
-  ulTimeoutConvertDelay = MB_MASTER_DELAY_MS_CONVERT;
-  if (ulTimeoutConvertDelay == 0)
+  pxInst->ulTimeoutConvertDelay = MB_MASTER_DELAY_MS_CONVERT;
+  if (pxInst->ulTimeoutConvertDelay == 0)
     {
-      ulTimeoutConvertDelay = 1;
+      pxInst->ulTimeoutConvertDelay = 1;
     }
 
-  ulTimeoutResponse = MB_MASTER_TIMEOUT_MS_RESPOND;
-  if (ulTimeoutResponse == 0)
+  pxInst->ulTimeoutResponse = MB_MASTER_TIMEOUT_MS_RESPOND;
+  if (pxInst->ulTimeoutResponse == 0)
     {
-      ulTimeoutResponse = 1;
+      pxInst->ulTimeoutResponse = 1;
     }
 
-  ulTimeOut = ulTimeoutT35;
+  pxInst->ulTimeOut = pxInst->ulTimeoutT35;
 
-  return xMBMasterPortSerialSetTimeout(ulTimeOut);
+  return xMBMasterPortSerialSetTimeout(pxInst->ulTimeOut);
 }
 
 void xMBMasterPortTimersClose(void)
@@ -120,27 +113,34 @@ void xMBMasterPortTimersClose(void)
 
 INLINE void vMBMasterPortTimersT35Enable(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
   vMBMasterPortTimersEnable();
-  ulTimeOut = ulTimeoutT35;
+  pxInst->ulTimeOut = pxInst->ulTimeoutT35;
   vMBMasterSetCurTimerMode(MB_TMODE_T35);
 }
 
 INLINE void vMBMasterPortTimersConvertDelayEnable(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
   vMBMasterPortTimersEnable();
-  ulTimeOut = ulTimeoutConvertDelay;
+  pxInst->ulTimeOut = pxInst->ulTimeoutConvertDelay;
   vMBMasterSetCurTimerMode(MB_TMODE_CONVERT_DELAY);
 }
 
 INLINE void vMBMasterPortTimersRespondTimeoutEnable(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
   vMBMasterPortTimersEnable();
-  ulTimeOut = ulTimeoutResponse;
+  pxInst->ulTimeOut = pxInst->ulTimeoutResponse;
   vMBMasterSetCurTimerMode(MB_TMODE_RESPOND_TIMEOUT);
 }
 
 void vMBMasterPortTimerPoll(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   uint32_t       ulDeltaMS;
   struct timeval xTimeCur;
 
@@ -148,7 +148,7 @@ void vMBMasterPortTimerPoll(void)
    * res timer in Win32.
    */
 
-  if (bTimeoutEnable)
+  if (pxInst->bTimeoutEnable)
     {
       if (gettimeofday(&xTimeCur, NULL) != 0)
         {
@@ -156,12 +156,12 @@ void vMBMasterPortTimerPoll(void)
         }
       else
         {
-          ulDeltaMS = (xTimeCur.tv_sec - xTimeLast.tv_sec) * 1000L +
-                      (xTimeCur.tv_usec - xTimeLast.tv_usec) / 1000L;
-          if (ulDeltaMS > ulTimeOut)
+          ulDeltaMS = (xTimeCur.tv_sec - pxInst->xTimeLast.tv_sec) * 1000L +
+                      (xTimeCur.tv_usec - pxInst->xTimeLast.tv_usec) / 1000L;
+          if (ulDeltaMS > pxInst->ulTimeOut)
             {
-              bTimeoutEnable = false;
-              pxMBMasterPortCBTimerExpired();
+              pxInst->bTimeoutEnable = false;
+              pxInst->pxPortCBTimerExpired();
             }
         }
     }
@@ -169,7 +169,9 @@ void vMBMasterPortTimerPoll(void)
 
 void vMBMasterPortTimersDisable(void)
 {
-  bTimeoutEnable = false;
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
+  pxInst->bTimeoutEnable = false;
 }
 
 #endif /* if defined(CONFIG_MB_RTU_MASTER) || defined(CONFIG_MB_ASCII_MASTER) */
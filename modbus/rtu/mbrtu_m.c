@@ -47,6 +47,7 @@
 #include "mbcrc.h"
 
 #include "modbus/mbport.h"
+#include "port_m.h"
 
 #if defined(CONFIG_MB_RTU_MASTER)
 
@@ -56,8 +57,7 @@
 
 #define MB_SER_PDU_SIZE_MIN     4     /* Minimum size of a Modbus RTU
                                        * frame. */
-#define MB_SER_PDU_SIZE_MAX     256   /* Maximum size of a Modbus RTU
-                                       * frame. */
+#define MB_SER_PDU_SIZE_MAX     MB_MASTER_SER_PDU_SIZE_MAX
 #define MB_SER_PDU_SIZE_CRC     2     /* Size of CRC field in PDU. */
 #define MB_SER_PDU_ADDR_OFF     0     /* Offset of slave address in
                                        * Ser-PDU. */
@@ -83,25 +83,6 @@ typedef enum
                                  * wait receive state. */
   } eMBMasterSndState;
 
-/****************************************************************************
- * Private Data
- ****************************************************************************/
-
-static volatile eMBMasterSndState eSndState;
-static volatile eMBMasterRcvState eRcvState;
-
-static volatile uint8_t ucMasterRTUSndBuf[MB_PDU_SIZE_MAX];
-static volatile uint8_t ucMasterRTURcvBuf[MB_SER_PDU_SIZE_MAX];
-static volatile uint16_t usMasterSendPDULength;
-
-static volatile uint8_t *pucMasterSndBufferCur;
-static volatile uint16_t usMasterSndBufferCount;
-
-static volatile uint16_t usMasterRcvBufferPos;
-static volatile bool xFrameIsBroadcast = false;
-
-static volatile eMBMasterTimerMode eMasterCurTimerMode;
-
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -153,6 +134,8 @@ eMBErrorCode eMBMasterRTUInit(uint8_t ucPort, speed_t ulBaudRate,
 
 void eMBMasterRTUStart(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
   ENTER_CRITICAL_SECTION();
 
   /* Initially the receiver is in the state STATE_M_RX_INIT. we start the timer
@@ -161,7 +144,7 @@ void eMBMasterRTUStart(void)
    * the bus is free.
    */
 
-  eRcvState = STATE_M_RX_INIT;
+  pxInst->eRcvState = STATE_M_RX_INIT;
   vMBMasterPortSerialEnable(true, false);
   vMBMasterPortTimersT35Enable();
 
@@ -179,33 +162,35 @@ void eMBMasterRTUStop(void)
 eMBErrorCode eMBMasterRTUReceive(uint8_t *pucRcvAddress, uint8_t **pucFrame,
                                  uint16_t *pusLength)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   eMBErrorCode eStatus = MB_ENOERR;
 
   ENTER_CRITICAL_SECTION();
-  DEBUGASSERT(usMasterRcvBufferPos < MB_SER_PDU_SIZE_MAX);
+  DEBUGASSERT(pxInst->usRcvBufferPos < MB_SER_PDU_SIZE_MAX);
 
   /* Length and CRC check */
 
-  if ((usMasterRcvBufferPos >= MB_SER_PDU_SIZE_MIN)
-      && (usMBCRC16((uint8_t *) ucMasterRTURcvBuf, usMasterRcvBufferPos) == 0))
+  if ((pxInst->usRcvBufferPos >= MB_SER_PDU_SIZE_MIN)
+      && (usMBCRC16((uint8_t *) pxInst->ucRTURcvBuf,
+                    pxInst->usRcvBufferPos) == 0))
     {
       /* Save the address field. All frames are passed to the upper laid and
        * the decision if a frame is used is done there.
        */
 
-      *pucRcvAddress = ucMasterRTURcvBuf[MB_SER_PDU_ADDR_OFF];
+      *pucRcvAddress = pxInst->ucRTURcvBuf[MB_SER_PDU_ADDR_OFF];
 
       /* Total length of Modbus-PDU is Modbus-Serial-Line-PDU minus size of
        * address field and CRC checksum.
        */
 
       *pusLength =
-        (uint16_t) (usMasterRcvBufferPos - MB_SER_PDU_PDU_OFF -
+        (uint16_t) (pxInst->usRcvBufferPos - MB_SER_PDU_PDU_OFF -
                     MB_SER_PDU_SIZE_CRC);
 
       /* Return the start of the Modbus PDU to the caller. */
 
-      *pucFrame = (uint8_t *) & ucMasterRTURcvBuf[MB_SER_PDU_PDU_OFF];
+      *pucFrame = (uint8_t *) & pxInst->ucRTURcvBuf[MB_SER_PDU_PDU_OFF];
     }
   else
     {
@@ -219,6 +204,7 @@ eMBErrorCode eMBMasterRTUReceive(uint8_t *pucRcvAddress, uint8_t **pucFrame,
 eMBErrorCode eMBMasterRTUSend(uint8_t ucSlaveAddress, const uint8_t *pucFrame,
                               uint16_t usLength)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   eMBErrorCode eStatus = MB_ENOERR;
   uint16_t usCRC16;
 
@@ -234,28 +220,30 @@ eMBErrorCode eMBMasterRTUSend(uint8_t ucSlaveAddress, const uint8_t *pucFrame,
    * network. We have to abort sending the frame.
    */
 
-  if (eRcvState == STATE_M_RX_IDLE)
+  if (pxInst->eRcvState == STATE_M_RX_IDLE)
     {
       /* First byte before the Modbus-PDU is the slave address. */
 
-      pucMasterSndBufferCur = (uint8_t *) pucFrame - 1;
-      usMasterSndBufferCount = 1;
+      pxInst->pucSndBufferCur = (uint8_t *) pucFrame - 1;
+      pxInst->usSndBufferCount = 1;
 
       /* Now copy the Modbus-PDU into the Modbus-Serial-Line-PDU. */
 
-      pucMasterSndBufferCur[MB_SER_PDU_ADDR_OFF] = ucSlaveAddress;
-      usMasterSndBufferCount += usLength;
+      pxInst->pucSndBufferCur[MB_SER_PDU_ADDR_OFF] = ucSlaveAddress;
+      pxInst->usSndBufferCount += usLength;
 
       /* Calculate CRC16 checksum for Modbus-Serial-Line-PDU. */
 
-      usCRC16 =
-        usMBCRC16((uint8_t *) pucMasterSndBufferCur, usMasterSndBufferCount);
-      ucMasterRTUSndBuf[usMasterSndBufferCount++] = (uint8_t) (usCRC16 & 0xFF);
-      ucMasterRTUSndBuf[usMasterSndBufferCount++] = (uint8_t) (usCRC16 >> 8);
+      usCRC16 = usMBCRC16((uint8_t *) pxInst->pucSndBufferCur,
+                          pxInst->usSndBufferCount);
+      pxInst->ucRTUSndBuf[pxInst->usSndBufferCount++] =
+        (uint8_t) (usCRC16 & 0xFF);
+      pxInst->ucRTUSndBuf[pxInst->usSndBufferCount++] =
+        (uint8_t) (usCRC16 >> 8);
 
       /* Activate the transmitter. */
 
-      eSndState = STATE_M_TX_XMIT;
+      pxInst->eSndState = STATE_M_TX_XMIT;
       vMBMasterPortSerialEnable(false, true);
     }
   else
@@ -269,17 +257,18 @@ eMBErrorCode eMBMasterRTUSend(uint8_t ucSlaveAddress, const uint8_t *pucFrame,
 
 bool xMBMasterRTUReceiveFSM(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   bool xTaskNeedSwitch = false;
   uint8_t ucByte;
 
-  DEBUGASSERT((eSndState == STATE_M_TX_IDLE) ||
-         (eSndState == STATE_M_TX_XFWR));
+  DEBUGASSERT((pxInst->eSndState == STATE_M_TX_IDLE) ||
+         (pxInst->eSndState == STATE_M_TX_XFWR));
 
   /* Always read the character. */
 
   xMBMasterPortSerialGetByte((int8_t *) & ucByte);
 
-  switch (eRcvState)
+  switch (pxInst->eRcvState)
     {
       /* If we have received a character in the init state we have to wait
        * until the frame is finished.
@@ -309,11 +298,11 @@ bool xMBMasterRTUReceiveFSM(void)
        */
 
       vMBMasterPortTimersDisable();
-      eSndState = STATE_M_TX_IDLE;
+      pxInst->eSndState = STATE_M_TX_IDLE;
 
-      usMasterRcvBufferPos = 0;
-      ucMasterRTURcvBuf[usMasterRcvBufferPos++] = ucByte;
-      eRcvState = STATE_M_RX_RCV;
+      pxInst->usRcvBufferPos = 0;
+      pxInst->ucRTURcvBuf[pxInst->usRcvBufferPos++] = ucByte;
+      pxInst->eRcvState = STATE_M_RX_RCV;
 
       /* Enable t3.5 timers. */
 
@@ -326,13 +315,13 @@ bool xMBMasterRTUReceiveFSM(void)
        */
 
     case STATE_M_RX_RCV:
-      if (usMasterRcvBufferPos < MB_SER_PDU_SIZE_MAX)
+      if (pxInst->usRcvBufferPos < MB_SER_PDU_SIZE_MAX)
         {
-          ucMasterRTURcvBuf[usMasterRcvBufferPos++] = ucByte;
+          pxInst->ucRTURcvBuf[pxInst->usRcvBufferPos++] = ucByte;
         }
       else
         {
-          eRcvState = STATE_M_RX_ERROR;
+          pxInst->eRcvState = STATE_M_RX_ERROR;
         }
 
       vMBMasterPortTimersT35Enable();
@@ -344,11 +333,12 @@ bool xMBMasterRTUReceiveFSM(void)
 
 bool xMBMasterRTUTransmitFSM(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   bool xNeedPoll = false;
 
-  DEBUGASSERT(eRcvState == STATE_M_RX_IDLE);
+  DEBUGASSERT(pxInst->eRcvState == STATE_M_RX_IDLE);
 
-  switch (eSndState)
+  switch (pxInst->eSndState)
     {
       /* We should not get a transmitter event if the transmitter is in idle
        * state.
@@ -363,16 +353,16 @@ bool xMBMasterRTUTransmitFSM(void)
     case STATE_M_TX_XMIT:
       /* check if we are finished. */
 
-      if (usMasterSndBufferCount != 0)
+      if (pxInst->usSndBufferCount != 0)
         {
-          xMBMasterPortSerialPutByte((uint8_t) * pucMasterSndBufferCur);
-          pucMasterSndBufferCur++;      /* next byte in sendbuffer. */
-          usMasterSndBufferCount--;
+          xMBMasterPortSerialPutByte((uint8_t) * pxInst->pucSndBufferCur);
+          pxInst->pucSndBufferCur++;      /* next byte in sendbuffer. */
+          pxInst->usSndBufferCount--;
         }
       else
         {
-          xFrameIsBroadcast =
-            (ucMasterRTUSndBuf[MB_SER_PDU_ADDR_OFF] ==
+          pxInst->xFrameIsBroadcast =
+            (pxInst->ucRTUSndBuf[MB_SER_PDU_ADDR_OFF] ==
              MB_ADDRESS_BROADCAST) ? true : false;
 
           /* Disable transmitter. This prevents another transmit buffer empty
@@ -380,13 +370,13 @@ bool xMBMasterRTUTransmitFSM(void)
            */
 
           vMBMasterPortSerialEnable(true, false);
-          eSndState = STATE_M_TX_XFWR;
+          pxInst->eSndState = STATE_M_TX_XFWR;
 
           /* If the frame is broadcast ,master will enable timer of convert
            * delay, else master will enable timer of respond timeout.
            */
 
-          if (xFrameIsBroadcast == true)
+          if (pxInst->xFrameIsBroadcast == true)
             {
               vMBMasterPortTimersConvertDelayEnable();
             }
@@ -407,9 +397,10 @@ bool xMBMasterRTUTransmitFSM(void)
 
 bool xMBMasterRTUTimerExpired(void)
 {
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
   bool xNeedPoll = false;
 
-  switch (eRcvState)
+  switch (pxInst->eRcvState)
     {
       /* Timer t35 expired. Startup phase is finished. */
 
@@ -435,16 +426,16 @@ bool xMBMasterRTUTimerExpired(void)
       /* Function called in an illegal state. */
 
     default:
-      DEBUGASSERT((eRcvState == STATE_M_RX_INIT) ||
-             (eRcvState == STATE_M_RX_RCV) ||
-             (eRcvState == STATE_M_RX_ERROR) ||
-             (eRcvState == STATE_M_RX_IDLE));
+      DEBUGASSERT((pxInst->eRcvState == STATE_M_RX_INIT) ||
+             (pxInst->eRcvState == STATE_M_RX_RCV) ||
+             (pxInst->eRcvState == STATE_M_RX_ERROR) ||
+             (pxInst->eRcvState == STATE_M_RX_IDLE));
       break;
     }
 
-  eRcvState = STATE_M_RX_IDLE;
+  pxInst->eRcvState = STATE_M_RX_IDLE;
 
-  switch (eSndState)
+  switch (pxInst->eSndState)
     {
       /* A frame was send finish and convert delay or respond timeout expired.
        * If the frame is broadcast,The master will idle,and if the frame is not
@@ -452,7 +443,7 @@ bool xMBMasterRTUTimerExpired(void)
        */
 
     case STATE_M_TX_XFWR:
-      if (xFrameIsBroadcast == false)
+      if (pxInst->xFrameIsBroadcast == false)
         {
           vMBMasterSetErrorType(EV_ERROR_RESPOND_TIMEOUT);
           xNeedPoll = xMBMasterPortEventPost(EV_MASTER_ERROR_PROCESS);
@@ -462,12 +453,12 @@ bool xMBMasterRTUTimerExpired(void)
       /* Function called in an illegal state. */
 
     default:
-      DEBUGASSERT((eSndState == STATE_M_TX_XFWR) ||
-             (eSndState == STATE_M_TX_IDLE));
+      DEBUGASSERT((pxInst->eSndState == STATE_M_TX_XFWR) ||
+             (pxInst->eSndState == STATE_M_TX_IDLE));
       break;
     }
 
-  eSndState = STATE_M_TX_IDLE;
+  pxInst->eSndState = STATE_M_TX_IDLE;
 
   vMBMasterPortTimersDisable();
 
@@ -475,7 +466,7 @@ bool xMBMasterRTUTimerExpired(void)
    * EV_MASTER_EXECUTE status.
    */
 
-  if (eMasterCurTimerMode == MB_TMODE_CONVERT_DELAY)
+  if (pxInst->eCurTimerMode == MB_TMODE_CONVERT_DELAY)
     {
       xNeedPoll = xMBMasterPortEventPost(EV_MASTER_EXECUTE);
     }
@@ -487,41 +478,53 @@ bool xMBMasterRTUTimerExpired(void)
 
 void vMBMasterGetRTUSndBuf(uint8_t **pucFrame)
 {
-  *pucFrame = (uint8_t *) ucMasterRTUSndBuf;
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
+  *pucFrame = (uint8_t *) pxInst->ucRTUSndBuf;
 }
 
 /* Get Modbus Master send PDU's buffer address pointer.*/
 
 void vMBMasterGetPDUSndBuf(uint8_t **pucFrame)
 {
-  *pucFrame = (uint8_t *) & ucMasterRTUSndBuf[MB_SER_PDU_PDU_OFF];
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
+  *pucFrame = (uint8_t *) & pxInst->ucRTUSndBuf[MB_SER_PDU_PDU_OFF];
 }
 
 /* Set Modbus Master send PDU's buffer length.*/
 
 void vMBMasterSetPDUSndLength(uint16_t SendPDULength)
 {
-  usMasterSendPDULength = SendPDULength;
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
+  pxInst->usSendPDULength = SendPDULength;
 }
 
 /* Get Modbus Master send PDU's buffer length.*/
 
 uint16_t usMBMasterGetPDUSndLength(void)
 {
-  return usMasterSendPDULength;
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
+  return pxInst->usSendPDULength;
 }
 
 /* Set Modbus Master current timer mode.*/
 
 void vMBMasterSetCurTimerMode(eMBMasterTimerMode eMBTimerMode)
 {
-  eMasterCurTimerMode = eMBTimerMode;
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
+  pxInst->eCurTimerMode = eMBTimerMode;
 }
 
 /* The master request is broadcast? */
 
 bool xMBMasterRequestIsBroadcast(void)
 {
-  return xFrameIsBroadcast;
+  FAR struct xMBMasterInstance *pxInst = MB_MASTER_INST();
+
+  return pxInst->xFrameIsBroadcast;
 }
 #endif
@@ -42,7 +42,6 @@
 #  include <nuttx/config.h>          /* NuttX configuration */
 #  include <debug.h>                 /* For nerr, info */
 #  include <nuttx/compiler.h>        /* For CONFIG_CPP_HAVE_WARNING */
-#  include "netutils/dhcpd.h"        /* Advertised DHCPD APIs */
 #endif
 
 #include <sys/socket.h>
@@ -50,10 +49,15 @@
 #include <sys/wait.h>
 
 #include <inttypes.h>
+#include <limits.h>
+#include <poll.h>
 #include <sched.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include <time.h>
 #include <errno.h>
@@ -64,6 +68,7 @@
 #include <arpa/inet.h>
 
 #include "netutils/netlib.h"
+#include "netutils/dhcpd.h"
 
 /****************************************************************************
  * Private Data
@@ -155,6 +160,14 @@
 #  define CONFIG_NETUTILS_DHCPD_MAXLEASES 16
 #endif
 
+#ifndef CONFIG_NETUTILS_DHCPD_MAXIFACES
+#  define CONFIG_NETUTILS_DHCPD_MAXIFACES 1
+#endif
+
+#ifndef CONFIG_NETUTILS_DHCPD_LEASEFILE
+#  define CONFIG_NETUTILS_DHCPD_LEASEFILE ""
+#endif
+
 #ifndef CONFIG_NETUTILS_DHCPD_STARTIP
 #  define CONFIG_NETUTILS_DHCPD_STARTIP (10L<<24|0L<<16|0L<<16|2L)
 #endif
@@ -191,7 +204,31 @@
 #  define HAVE_LEASE_TIME 1
 #endif
 
+/* Every interface binds its own socket to the server port */
+
+#if CONFIG_NETUTILS_DHCPD_MAXIFACES > 1 && !defined(HAVE_SO_REUSEADDR)
+#  define HAVE_SO_REUSEADDR 1
+#endif
+
+/* Separators in the interface list passed to dhcpd_run() */
+
+#define DHCPD_IFSEP              ", "
+
+/* The lease table of an interface has one slot per address.  Slots that
+ * belong to a client are chained into a hash table by MAC address and a
+ * bitmap records which slots are allocated.
+ */
+
+#define DHCPD_HASHSIZE           CONFIG_NETUTILS_DHCPD_MAXLEASES
+#define DHCPD_MAPWORDS \
+  ((CONFIG_NETUTILS_DHCPD_MAXLEASES + 31) / 32)
+
+#define DHCPD_NOLEASE            (-1)  /* End of a hash chain */
+#define DHCPD_UNLINKED           (-2)  /* Slot is not in any hash chain */
+
 #define g_state  (*g_dhcpd_daemon.ds_data)
+#define g_iface  (*g_state.ds_iface)
+#define g_config (*g_iface.ds_config)
 
 /****************************************************************************
  * Private Types
@@ -199,15 +236,17 @@
 
 /* This structure describes one element in the lease table. There is one
  * slot in the lease table for each assign-able IP address (hence, the IP
- * address itself does not have to be in the table.
+ * address itself does not have to be in the table.  Whether the slot is
+ * allocated is kept in the bitmap of the interface.
  */
 
 struct lease_s
 {
   uint8_t  mac[DHCP_HLEN_ETHERNET]; /* MAC address (network order) -- could be larger! */
-  bool     allocated;               /* true: IP address is allocated */
+  int16_t  next;                    /* Next slot in the MAC hash chain */
 #ifdef HAVE_LEASE_TIME
   time_t   expiry;                  /* Lease expiration time (seconds past Epoch) */
+  time_t   saved;                   /* Expiration in the lease file, 0 if none */
 #endif
 };
 
@@ -243,11 +282,48 @@ enum dhcpd_daemon_e
   DHCPD_STOPPED
 };
 
-struct dhcpd_state_s
+/* Address pool configuration */
+
+struct dhcpd_config_s
 {
-  /* Server configuration */
+  in_addr_t ds_startip;
+  in_addr_t ds_endip;
+  in_addr_t ds_routerip;            /* 0: Not sent to clients */
+  in_addr_t ds_netmask;             /* 0: Not sent to clients */
+  in_addr_t ds_dnsip;               /* 0: Not sent to clients */
+};
+
+/* Pool configuration registered for an interface by dhcpd_set_pool() */
 
+struct dhcpd_ifconfig_s
+{
+  char                  ds_name[IFNAMSIZ];
+  struct dhcpd_config_s ds_config;
+};
+
+/* State of one interface served by the daemon */
+
+struct dhcpd_iface_s
+{
+  char             ds_name[IFNAMSIZ];
+  int              ds_sockfd;       /* Listener socket, -1 if not open */
   in_addr_t        ds_serverip;     /* The server IP address */
+  FAR struct dhcpd_config_s *ds_config;
+
+  /* Leases */
+
+  int16_t          ds_hash[DHCPD_HASHSIZE];
+  uint32_t         ds_inuse[DHCPD_MAPWORDS];
+  struct lease_s   ds_leases[CONFIG_NETUTILS_DHCPD_MAXLEASES];
+};
+
+struct dhcpd_state_s
+{
+  /* Interfaces, and the one the current message came from */
+
+  struct dhcpd_iface_s ds_ifaces[CONFIG_NETUTILS_DHCPD_MAXIFACES];
+  int              ds_nifaces;
+  FAR struct dhcpd_iface_s *ds_iface;
 
   /* Message buffers */
 
@@ -264,10 +340,6 @@ struct dhcpd_state_s
   /* End option pointer for outgoing DHCP server message */
 
   uint8_t         *ds_optend;
-
-  /* Leases */
-
-  struct lease_s   ds_leases[CONFIG_NETUTILS_DHCPD_MAXLEASES];
 };
 
 /* This type describes the state of the DHCPD client daemon.  Only one
@@ -281,21 +353,6 @@ struct dhcpd_daemon_s
   FAR struct dhcpd_state_s *ds_data;  /* DHCPD daemon data */
 };
 
-struct dhcpd_config_s
-{
-  in_addr_t ds_startip;
-  in_addr_t ds_endip;
-#ifdef HAVE_ROUTERIP
-  in_addr_t ds_routerip;
-#endif
-#ifdef HAVE_NETMASK
-  in_addr_t ds_netmask;
-#endif
-#ifdef HAVE_DNSIP
-  in_addr_t ds_dnsip;
-#endif
-};
-
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -323,15 +380,26 @@ static struct dhcpd_config_s g_dhcpd_config =
   CONFIG_NETUTILS_DHCP_OPTION_ENDIP,
 #ifdef HAVE_ROUTERIP
   CONFIG_NETUTILS_DHCPD_ROUTERIP,
+#else
+  0,
 #endif
 #ifdef HAVE_NETMASK
   CONFIG_NETUTILS_DHCPD_NETMASK,
+#else
+  0,
 #endif
 #ifdef HAVE_DNSIP
   CONFIG_NETUTILS_DHCPD_DNSIP
+#else
+  0
 #endif
 };
 
+/* Pools of the interfaces that do not use the configuration above */
+
+static struct dhcpd_ifconfig_s
+  g_dhcpd_ifconfig[CONFIG_NETUTILS_DHCPD_MAXIFACES];
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -386,6 +454,93 @@ static time_t dhcpd_time(void)
 #  define dhcpd_time() (0)
 #endif
 
+/****************************************************************************
+ * Name: dhcpd_machash
+ ****************************************************************************/
+
+static inline int dhcpd_machash(FAR const uint8_t *mac)
+{
+  uint32_t hash = 2166136261u;
+  int i;
+
+  /* FNV-1a over the hardware address */
+
+  for (i = 0; i < DHCP_HLEN_ETHERNET; i++)
+    {
+      hash = (hash ^ mac[i]) * 16777619u;
+    }
+
+  return hash % DHCPD_HASHSIZE;
+}
+
+/****************************************************************************
+ * Name: dhcpd_linkmac
+ ****************************************************************************/
+
+static void dhcpd_linkmac(FAR struct lease_s *lease)
+{
+  FAR int16_t *head = &g_iface.ds_hash[dhcpd_machash(lease->mac)];
+
+  lease->next = *head;
+  *head       = lease - g_iface.ds_leases;
+}
+
+/****************************************************************************
+ * Name: dhcpd_unlinkmac
+ ****************************************************************************/
+
+static void dhcpd_unlinkmac(FAR struct lease_s *lease)
+{
+  FAR int16_t *link;
+  int ndx;
+
+  if (lease->next == DHCPD_UNLINKED)
+    {
+      return;
+    }
+
+  ndx  = lease - g_iface.ds_leases;
+  link = &g_iface.ds_hash[dhcpd_machash(lease->mac)];
+
+  while (*link != DHCPD_NOLEASE)
+    {
+      if (*link == ndx)
+        {
+          *link = lease->next;
+          break;
+        }
+
+      link = &g_iface.ds_leases[*link].next;
+    }
+
+  lease->next = DHCPD_UNLINKED;
+}
+
+/****************************************************************************
+ * Name: dhcpd_isallocated
+ ****************************************************************************/
+
+static inline bool dhcpd_isallocated(int ndx)
+{
+  return (g_iface.ds_inuse[ndx >> 5] & (UINT32_C(1) << (ndx & 31))) != 0;
+}
+
+/****************************************************************************
+ * Name: dhcpd_freelease
+ ****************************************************************************/
+
+static void dhcpd_freelease(FAR struct lease_s *lease)
+{
+  int ndx = lease - g_iface.ds_leases;
+
+  dhcpd_unlinkmac(lease);
+  memset(lease->mac, 0, DHCP_HLEN_ETHERNET);
+#ifdef HAVE_LEASE_TIME
+  lease->expiry = 0;
+#endif
+  g_iface.ds_inuse[ndx >> 5] &= ~(UINT32_C(1) << (ndx & 31));
+}
+
 /****************************************************************************
  * Name: dhcpd_leaseexpired
  ****************************************************************************/
@@ -399,7 +554,7 @@ static inline bool dhcpd_leaseexpired(struct lease_s *lease)
     }
   else
     {
-      memset(lease, 0, sizeof(struct lease_s));
+      dhcpd_freelease(lease);
       return true;
     }
 }
@@ -418,20 +573,30 @@ struct lease_s *dhcpd_setlease(const uint8_t *mac,
    * ipaddr must be in host order!
    */
 
-  int ndx = ipaddr - g_dhcpd_config.ds_startip;
+  int ndx = ipaddr - g_config.ds_startip;
   struct lease_s *ret = NULL;
 
   ninfo("ipaddr: %08" PRIx32 " ipaddr: %08" PRIx32 " ndx: %d MAX: %d\n",
-        (uint32_t)ipaddr, (uint32_t)g_dhcpd_config.ds_startip, ndx,
+        (uint32_t)ipaddr, (uint32_t)g_config.ds_startip, ndx,
         CONFIG_NETUTILS_DHCPD_MAXLEASES);
 
   /* Verify that the address offset is within the supported range */
 
   if (ndx >= 0 && ndx < CONFIG_NETUTILS_DHCPD_MAXLEASES)
     {
-       ret = &g_state.ds_leases[ndx];
-       memcpy(ret->mac, mac, DHCP_HLEN_ETHERNET);
-       ret->allocated = true;
+       ret = &g_iface.ds_leases[ndx];
+       if (ret->next == DHCPD_UNLINKED ||
+           memcmp(ret->mac, mac, DHCP_HLEN_ETHERNET) != 0)
+         {
+           dhcpd_unlinkmac(ret);
+           memcpy(ret->mac, mac, DHCP_HLEN_ETHERNET);
+           dhcpd_linkmac(ret);
+#ifdef HAVE_LEASE_TIME
+           ret->saved = 0;
+#endif
+         }
+
+       g_iface.ds_inuse[ndx >> 5] |= UINT32_C(1) << (ndx & 31);
 #ifdef HAVE_LEASE_TIME
        ret->expiry = dhcpd_time() + expiry;
 #endif
@@ -448,8 +613,7 @@ static inline in_addr_t dhcp_leaseipaddr(FAR struct lease_s *lease)
 {
   /* Return IP address in host order */
 
-  return (in_addr_t)(lease - g_state.ds_leases) +
-         g_dhcpd_config.ds_startip;
+  return (in_addr_t)(lease - g_iface.ds_leases) + g_config.ds_startip;
 }
 
 /****************************************************************************
@@ -458,13 +622,15 @@ static inline in_addr_t dhcp_leaseipaddr(FAR struct lease_s *lease)
 
 static FAR struct lease_s *dhcpd_findbymac(FAR const uint8_t *mac)
 {
-  int i;
+  int ndx;
 
-  for (i = 0; i < CONFIG_NETUTILS_DHCPD_MAXLEASES; i++)
+  for (ndx = g_iface.ds_hash[dhcpd_machash(mac)];
+       ndx != DHCPD_NOLEASE;
+       ndx = g_iface.ds_leases[ndx].next)
     {
-      if (memcmp(g_state.ds_leases[i].mac, mac, DHCP_HLEN_ETHERNET) == 0)
+      if (memcmp(g_iface.ds_leases[ndx].mac, mac, DHCP_HLEN_ETHERNET) == 0)
         {
-          return &(g_state.ds_leases[i]);
+          return &(g_iface.ds_leases[ndx]);
         }
     }
 
@@ -477,63 +643,276 @@ static FAR struct lease_s *dhcpd_findbymac(FAR const uint8_t *mac)
 
 static FAR struct lease_s *dhcpd_findbyipaddr(in_addr_t ipaddr)
 {
-  if (ipaddr >= g_dhcpd_config.ds_startip &&
-      ipaddr <= g_dhcpd_config.ds_endip)
+  if (ipaddr >= g_config.ds_startip && ipaddr <= g_config.ds_endip)
     {
-      FAR struct lease_s *lease =
-        &g_state.ds_leases[ipaddr - g_dhcpd_config.ds_startip];
-      if (lease->allocated > 0)
+      int ndx = ipaddr - g_config.ds_startip;
+
+      if (dhcpd_isallocated(ndx))
         {
-          return lease;
+          return &g_iface.ds_leases[ndx];
         }
     }
 
   return NULL;
 }
 
+/****************************************************************************
+ * Name: dhcpd_holdipaddr
+ ****************************************************************************/
+
+static in_addr_t dhcpd_holdipaddr(int ndx)
+{
+  FAR struct lease_s *lease = &g_iface.ds_leases[ndx];
+
+#ifdef CONFIG_CPP_HAVE_WARNING
+#  warning "FIXME: Should check if anything responds to an ARP request or ping"
+#  warning "       to verify that there is no other user of this IP address"
+#endif
+
+  /* Reserve the address for the offer, without an owner yet */
+
+  dhcpd_freelease(lease);
+  g_iface.ds_inuse[ndx >> 5] |= UINT32_C(1) << (ndx & 31);
+#ifdef HAVE_LEASE_TIME
+  lease->expiry = dhcpd_time() + CONFIG_NETUTILS_DHCPD_OFFERTIME;
+#endif
+
+  /* Return the address in host order */
+
+  return g_config.ds_startip + ndx;
+}
+
 /****************************************************************************
  * Name: dhcpd_allocipaddr
  ****************************************************************************/
 
 static in_addr_t dhcpd_allocipaddr(void)
 {
-  struct lease_s *lease = NULL;
-  in_addr_t ipaddr, startaddr;
+  in_addr_t ipaddr;
+  uint32_t avail;
+  int word;
+  int ndx;
 
-  ipaddr = startaddr = g_dhcpd_config.ds_startip;
-  for (; ipaddr <= g_dhcpd_config.ds_endip; ipaddr++)
+  /* Take the first address that is not allocated.  The bits past the end
+   * of the table are always set.
+   */
+
+  for (word = 0; word < DHCPD_MAPWORDS; word++)
     {
-      /* Skip over address ending in 0 or 255 */
+      avail = ~g_iface.ds_inuse[word];
+      while (avail != 0)
+        {
+          ndx    = (word << 5) + ffs((int)avail) - 1;
+          avail &= avail - 1;
+
+          /* Skip over address ending in 0 or 255 */
 
-      if ((ipaddr & 0xff) == 0 || (ipaddr & 0xff) == 0xff)
+          ipaddr = g_config.ds_startip + ndx;
+          if ((ipaddr & 0xff) != 0 && (ipaddr & 0xff) != 0xff)
+            {
+              return dhcpd_holdipaddr(ndx);
+            }
+        }
+    }
+
+  /* All addresses are allocated.  Has any lease or offer expired? */
+
+  for (ndx = 0; ndx < CONFIG_NETUTILS_DHCPD_MAXLEASES; ndx++)
+    {
+      ipaddr = g_config.ds_startip + ndx;
+      if ((ipaddr & 0xff) != 0 && (ipaddr & 0xff) != 0xff &&
+          dhcpd_leaseexpired(&g_iface.ds_leases[ndx]))
         {
-          continue;
+          return dhcpd_holdipaddr(ndx);
         }
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: dhcpd_saveleases
+ *
+ * Description:
+ *   Write the leases held by clients to CONFIG_NETUTILS_DHCPD_LEASEFILE.
+ *   The file is replaced by rename() so that a reset never leaves it
+ *   half written.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LEASE_TIME
+static void dhcpd_saveleases(void)
+{
+  FAR const char *path = CONFIG_NETUTILS_DHCPD_LEASEFILE;
+  FAR struct dhcpd_iface_s *iface;
+  FAR struct lease_s *lease;
+  char tmppath[PATH_MAX];
+  FAR FILE *stream;
+  time_t now;
+  int i;
+  int ndx;
 
-      /* Is there already a lease on this address?  If so, has it expired? */
+  if (path[0] == '\0')
+    {
+      return;
+    }
 
-      lease = dhcpd_findbyipaddr(ipaddr);
-      if ((!lease || dhcpd_leaseexpired(lease)))
+  snprintf(tmppath, sizeof(tmppath), "%s.tmp", path);
+  stream = fopen(tmppath, "w");
+  if (stream == NULL)
+    {
+      nerr("ERROR: Failed to open %s: %d\n", tmppath, errno);
+      return;
+    }
+
+  now = dhcpd_time();
+  for (i = 0; i < g_state.ds_nifaces; i++)
+    {
+      iface = &g_state.ds_ifaces[i];
+      for (ndx = 0; ndx < CONFIG_NETUTILS_DHCPD_MAXLEASES; ndx++)
         {
-#ifdef CONFIG_CPP_HAVE_WARNING
-#  warning "FIXME: Should check if anything responds to an ARP request or ping"
-#  warning "       to verify that there is no other user of this IP address"
+          /* Only slots with an owner are in a hash chain */
+
+          lease = &iface->ds_leases[ndx];
+          if (lease->next == DHCPD_UNLINKED || lease->expiry <= now)
+            {
+              lease->saved = 0;
+              continue;
+            }
+
+          lease->saved = lease->expiry;
+
+          fprintf(stream, "%s %08" PRIx32
+                  " %02x:%02x:%02x:%02x:%02x:%02x %lu\n",
+                  iface->ds_name,
+                  (uint32_t)(iface->ds_config->ds_startip + ndx),
+                  lease->mac[0], lease->mac[1], lease->mac[2],
+                  lease->mac[3], lease->mac[4], lease->mac[5],
+                  (unsigned long)lease->expiry);
+        }
+    }
+
+  if (fclose(stream) != 0 || rename(tmppath, path) < 0)
+    {
+      nerr("ERROR: Failed to write %s: %d\n", path, errno);
+      unlink(tmppath);
+    }
+}
+
+/****************************************************************************
+ * Name: dhcpd_leasedirty
+ *
+ * Description:
+ *   Tell whether an acknowledged lease has to be written to the lease
+ *   file.  New bindings are.  Renewals are only once the expiration has
+ *   moved by more than half the lease time since the file was written, so
+ *   that a flash file system is not rewritten on every renewal.  The file
+ *   still keeps the lease until the client renews it at T1 then, and a
+ *   renewal of a lease lost in a restart is acknowledged if the address
+ *   is still free.
+ *
+ ****************************************************************************/
+
+static bool dhcpd_leasedirty(FAR struct lease_s *lease, uint32_t leasetime)
+{
+  return lease->saved == 0 || lease->expiry - lease->saved > leasetime / 2;
+}
+#else
+#  define dhcpd_saveleases()
+#  define dhcpd_leasedirty(lease, leasetime) (false)
 #endif
-          memset(g_state.ds_leases[ipaddr - startaddr].mac,
-          0, DHCP_HLEN_ETHERNET);
-          g_state.ds_leases[ipaddr - startaddr].allocated = true;
+
+/****************************************************************************
+ * Name: dhcpd_loadleases
+ *
+ * Description:
+ *   Restore the leases written by dhcpd_saveleases().  Leases of unknown
+ *   interfaces, outside of the pools or expired are dropped.  The remaining
+ *   time is clipped to CONFIG_NETUTILS_DHCPD_MAXLEASETIME, in case the
+ *   clock was not kept across the restart.
+ *
+ ****************************************************************************/
+
 #ifdef HAVE_LEASE_TIME
-          g_state.ds_leases[ipaddr - startaddr].expiry =
-            dhcpd_time() + CONFIG_NETUTILS_DHCPD_OFFERTIME;
-#endif
-          /* Return the address in host order */
+static void dhcpd_loadleases(void)
+{
+  FAR const char *path = CONFIG_NETUTILS_DHCPD_LEASEFILE;
+  FAR struct dhcpd_iface_s *iface;
+  FAR struct lease_s *lease;
+  unsigned long expiry;
+  unsigned int mac[DHCP_HLEN_ETHERNET];
+  uint8_t hwaddr[DHCP_HLEN_ETHERNET];
+  FAR FILE *stream;
+  uint32_t ipaddr;
+  char name[16];
+  char line[80];
+  time_t now;
+  int nleases = 0;
+  int i;
+
+  if (path[0] == '\0')
+    {
+      return;
+    }
+
+  stream = fopen(path, "r");
+  if (stream == NULL)
+    {
+      ninfo("No lease file %s: %d\n", path, errno);
+      return;
+    }
 
-          return ipaddr;
+  now = dhcpd_time();
+  while (fgets(line, sizeof(line), stream) != NULL)
+    {
+      if (sscanf(line, "%15s %" SCNx32 " %x:%x:%x:%x:%x:%x %lu",
+                 name, &ipaddr, &mac[0], &mac[1], &mac[2],
+                 &mac[3], &mac[4], &mac[5], &expiry) != 9 ||
+          (time_t)expiry <= now)
+        {
+          continue;
+        }
+
+      for (i = 0; i < g_state.ds_nifaces; i++)
+        {
+          iface = &g_state.ds_ifaces[i];
+          if (strcmp(iface->ds_name, name) == 0)
+            {
+              break;
+            }
+        }
+
+      if (i >= g_state.ds_nifaces)
+        {
+          continue;
+        }
+
+      for (i = 0; i < DHCP_HLEN_ETHERNET; i++)
+        {
+          hwaddr[i] = (uint8_t)mac[i];
+        }
+
+      expiry -= now;
+      if (expiry > CONFIG_NETUTILS_DHCPD_MAXLEASETIME)
+        {
+          expiry = CONFIG_NETUTILS_DHCPD_MAXLEASETIME;
+        }
+
+      g_state.ds_iface = iface;
+      lease = dhcpd_setlease(hwaddr, ipaddr, expiry);
+      if (lease != NULL)
+        {
+          lease->saved = lease->expiry;
+          nleases++;
         }
     }
 
-  return 0;
+  fclose(stream);
+  ninfo("Restored %d leases from %s\n", nleases, path);
 }
+#else
+#  define dhcpd_loadleases()
+#endif
 
 /****************************************************************************
  * Name: dhcpd_parseoptions
@@ -712,8 +1091,8 @@ static inline bool dhcpd_verifyreqip(void)
    * range
    */
 
-  if (g_state.ds_optreqip >= g_dhcpd_config.ds_startip &&
-      g_state.ds_optreqip <= g_dhcpd_config.ds_endip)
+  if (g_state.ds_optreqip >= g_config.ds_startip &&
+      g_state.ds_optreqip <= g_config.ds_endip)
     {
       /* And verify that the lease has not already been taken or offered
        * (unless the lease/offer is expired, then the address is free game).
@@ -834,7 +1213,6 @@ static int dhcpd_addoption32(uint8_t code, uint32_t value)
  * Name: dhcp_addoption32p
  ****************************************************************************/
 
-#ifdef HAVE_DNSIP
 static int dhcp_addoption32p(uint8_t code, FAR uint8_t *value)
 {
   uint8_t option[6];
@@ -849,7 +1227,34 @@ static int dhcp_addoption32p(uint8_t code, FAR uint8_t *value)
 
   return dhcpd_addoption(option);
 }
-#endif
+
+/****************************************************************************
+ * Name: dhcpd_addpooloptions
+ ****************************************************************************/
+
+static void dhcpd_addpooloptions(void)
+{
+  uint32_t dnsaddr;
+
+  /* Add the options configured for the pool of the interface */
+
+  if (g_config.ds_netmask != 0)
+    {
+      dhcpd_addoption32(DHCP_OPTION_SUBNET_MASK,
+                        htonl(g_config.ds_netmask));
+    }
+
+  if (g_config.ds_routerip != 0)
+    {
+      dhcpd_addoption32(DHCP_OPTION_ROUTER, htonl(g_config.ds_routerip));
+    }
+
+  if (g_config.ds_dnsip != 0)
+    {
+      dnsaddr = htonl(g_config.ds_dnsip);
+      dhcp_addoption32p(DHCP_OPTION_DNS_SERVER, (FAR uint8_t *)&dnsaddr);
+    }
+}
 
 /****************************************************************************
  * Name: dhcpd_socket
@@ -947,7 +1352,7 @@ static void dhcpd_initpacket(uint8_t mtype)
   g_state.ds_optend = &g_state.ds_outpacket.options[4];
  *g_state.ds_optend = DHCP_OPTION_END;
   dhcpd_addoption8(DHCP_OPTION_MSG_TYPE, mtype);
-  dhcpd_addoption32(DHCP_OPTION_SERVER_ID, g_state.ds_serverip);
+  dhcpd_addoption32(DHCP_OPTION_SERVER_ID, g_iface.ds_serverip);
 }
 
 /****************************************************************************
@@ -1044,10 +1449,7 @@ static inline int dhcpd_sendoffer(int sockfd, in_addr_t ipaddr,
                                   uint32_t leasetime)
 {
   in_addr_t netaddr;
-#ifdef HAVE_DNSIP
-  uint32_t dnsaddr;
-  dnsaddr = htonl(g_dhcpd_config.ds_dnsip);
-#endif
+
   /* IP address is in host order */
 
   ninfo("Sending offer: %08lx\n", (long)ipaddr);
@@ -1064,17 +1466,7 @@ static inline int dhcpd_sendoffer(int sockfd, in_addr_t ipaddr,
   /* Add the leasetime to the response options */
 
   dhcpd_addoption32(DHCP_OPTION_LEASE_TIME, htonl(leasetime));
-#ifdef HAVE_NETMASK
-  dhcpd_addoption32(DHCP_OPTION_SUBNET_MASK,
-                    htonl(g_dhcpd_config.ds_netmask));
-#endif
-#ifdef HAVE_ROUTERIP
-  dhcpd_addoption32(DHCP_OPTION_ROUTER,
-                    htonl(g_dhcpd_config.ds_routerip));
-#endif
-#ifdef HAVE_DNSIP
-  dhcp_addoption32p(DHCP_OPTION_DNS_SERVER, (FAR uint8_t *)&dnsaddr);
-#endif
+  dhcpd_addpooloptions();
 
   /* Send the offer response */
 
@@ -1105,11 +1497,8 @@ static int dhcpd_sendnak(int sockfd)
 int dhcpd_sendack(int sockfd, in_addr_t ipaddr)
 {
   uint32_t leasetime = CONFIG_NETUTILS_DHCPD_LEASETIME;
+  FAR struct lease_s *lease;
   in_addr_t netaddr;
-#ifdef HAVE_DNSIP
-  uint32_t dnsaddr;
-  dnsaddr = htonl(g_dhcpd_config.ds_dnsip);
-#endif
 
   /* Initialize the ACK response */
 
@@ -1128,17 +1517,7 @@ int dhcpd_sendack(int sockfd, in_addr_t ipaddr)
   /* Add the lease time to the response */
 
   dhcpd_addoption32(DHCP_OPTION_LEASE_TIME, htonl(leasetime));
-#ifdef HAVE_NETMASK
-  dhcpd_addoption32(DHCP_OPTION_SUBNET_MASK,
-                    htonl(g_dhcpd_config.ds_netmask));
-#endif
-#ifdef HAVE_ROUTERIP
-  dhcpd_addoption32(DHCP_OPTION_ROUTER,
-                    htonl(g_dhcpd_config.ds_routerip));
-#endif
-#ifdef HAVE_DNSIP
-  dhcp_addoption32p(DHCP_OPTION_DNS_SERVER, (FAR uint8_t *)&dnsaddr);
-#endif
+  dhcpd_addpooloptions();
 
 #ifdef CONFIG_NETUTILS_DHCPD_IGNOREBROADCAST
   if (dhcpd_sendpacket(sockfd, true) < 0)
@@ -1149,7 +1528,12 @@ int dhcpd_sendack(int sockfd, in_addr_t ipaddr)
       return ERROR;
     }
 
-  dhcpd_setlease(g_state.ds_inpacket.chaddr, ipaddr, leasetime);
+  lease = dhcpd_setlease(g_state.ds_inpacket.chaddr, ipaddr, leasetime);
+  if (lease != NULL && dhcpd_leasedirty(lease, leasetime))
+    {
+      dhcpd_saveleases();
+    }
+
   return OK;
 }
 
@@ -1268,7 +1652,7 @@ static inline int dhcpd_request(int sockfd)
            * the one already offered to the client.
            */
 
-          if (g_state.ds_optserverip == ntohl(g_state.ds_serverip) &&
+          if (g_state.ds_optserverip == ntohl(g_iface.ds_serverip) &&
              (g_state.ds_optreqip != 0 || g_state.ds_optreqip == ipaddr))
             {
               response = DHCPACK;
@@ -1350,8 +1734,8 @@ static inline int dhcpd_request(int sockfd)
        * maybe requested before the last shutdown, lease again.
        */
 
-      else if (g_state.ds_optreqip >= g_dhcpd_config.ds_startip &&
-               g_state.ds_optreqip <= g_dhcpd_config.ds_endip)
+      else if (g_state.ds_optreqip >= g_config.ds_startip &&
+               g_state.ds_optreqip <= g_config.ds_endip)
         {
           ipaddr = g_state.ds_optreqip;
           response = DHCPACK;
@@ -1408,15 +1792,21 @@ static inline int dhcpd_decline(void)
        * address for a period of time.
        */
 
+      dhcpd_unlinkmac(lease);
       memset(lease->mac, 0, DHCP_HLEN_ETHERNET);
 #ifdef HAVE_LEASE_TIME
       lease->expiry = dhcpd_time() + CONFIG_NETUTILS_DHCPD_DECLINETIME;
 #endif
+      dhcpd_saveleases();
     }
 
   return OK;
 }
 
+/****************************************************************************
+ * Name: dhcpd_release
+ ****************************************************************************/
+
 static inline int dhcpd_release(void)
 {
   struct lease_s *lease;
@@ -1428,7 +1818,8 @@ static inline int dhcpd_release(void)
     {
       /* Release the IP address now */
 
-      memset(lease, 0, sizeof(struct lease_s));
+      dhcpd_freelease(lease);
+      dhcpd_saveleases();
     }
 
   return OK;
@@ -1438,7 +1829,7 @@ static inline int dhcpd_release(void)
  * Name: dhcpd_openlistener
  ****************************************************************************/
 
-static inline int dhcpd_openlistener(FAR const char *interface)
+static inline int dhcpd_openlistener(FAR struct dhcpd_iface_s *iface)
 {
   struct sockaddr_in addr;
   struct ifreq req;
@@ -1447,7 +1838,7 @@ static inline int dhcpd_openlistener(FAR const char *interface)
 
   /* Create a socket to listen for requests from DHCP clients */
 
-  sockfd = dhcpd_socket(interface);
+  sockfd = dhcpd_socket(iface->ds_name);
   if (sockfd < 0)
     {
       nerr("ERROR: socket failed: %d\n", errno);
@@ -1456,7 +1847,7 @@ static inline int dhcpd_openlistener(FAR const char *interface)
 
   /* Get the IP address of the selected device */
 
-  strlcpy(req.ifr_name, interface, IFNAMSIZ);
+  strlcpy(req.ifr_name, iface->ds_name, IFNAMSIZ);
   ret = ioctl(sockfd, SIOCGIFADDR, (unsigned long)&req);
   if (ret < 0)
     {
@@ -1465,10 +1856,11 @@ static inline int dhcpd_openlistener(FAR const char *interface)
       return ERROR;
     }
 
-  g_state.ds_serverip = ((FAR struct sockaddr_in *)
+  iface->ds_serverip = ((FAR struct sockaddr_in *)
     &req.ifr_addr)->sin_addr.s_addr;
 
-  ninfo("serverip: %08" PRIx32 "\n", ntohl(g_state.ds_serverip));
+  ninfo("%s serverip: %08" PRIx32 "\n",
+        iface->ds_name, ntohl(iface->ds_serverip));
 
   /* Bind the socket to a local port. We have to bind to INADDRY_ANY to
    * receive broadcast messages.
@@ -1490,6 +1882,172 @@ static inline int dhcpd_openlistener(FAR const char *interface)
   return sockfd;
 }
 
+/****************************************************************************
+ * Name: dhcpd_initifaces
+ *
+ * Description:
+ *   Set up the interfaces named in a list separated by commas or spaces.
+ *   An interface uses the pool registered for it by dhcpd_set_pool(); one
+ *   interface at most may fall back to the pool of the dhcpd_set_*()
+ *   configuration.
+ *
+ ****************************************************************************/
+
+static int dhcpd_initifaces(FAR const char *interfaces)
+{
+  FAR struct dhcpd_config_s *defconfig = &g_dhcpd_config;
+  FAR struct dhcpd_iface_s *iface;
+  FAR const char *name = interfaces;
+  size_t len;
+  int i;
+
+  for (; ; )
+    {
+      name += strspn(name, DHCPD_IFSEP);
+      if (*name == '\0')
+        {
+          break;
+        }
+
+      len = strcspn(name, DHCPD_IFSEP);
+      if (len >= IFNAMSIZ ||
+          g_state.ds_nifaces >= CONFIG_NETUTILS_DHCPD_MAXIFACES)
+        {
+          nerr("ERROR: Bad interface list: %s\n", interfaces);
+          return -EINVAL;
+        }
+
+      iface = &g_state.ds_ifaces[g_state.ds_nifaces++];
+      memcpy(iface->ds_name, name, len);
+      iface->ds_sockfd = -1;
+      name += len;
+
+      /* Find the pool of the interface */
+
+      for (i = 0; i < CONFIG_NETUTILS_DHCPD_MAXIFACES; i++)
+        {
+          if (strcmp(g_dhcpd_ifconfig[i].ds_name, iface->ds_name) == 0)
+            {
+              iface->ds_config = &g_dhcpd_ifconfig[i].ds_config;
+              break;
+            }
+        }
+
+      if (iface->ds_config == NULL)
+        {
+          if (defconfig == NULL)
+            {
+              nerr("ERROR: No pool for %s\n", iface->ds_name);
+              return -EINVAL;
+            }
+
+          iface->ds_config = defconfig;
+          defconfig = NULL;
+        }
+
+      /* Start with empty hash chains and all addresses free.  The bits
+       * past the end of the table stay set.
+       */
+
+      for (i = 0; i < DHCPD_HASHSIZE; i++)
+        {
+          iface->ds_hash[i] = DHCPD_NOLEASE;
+        }
+
+      for (i = 0; i < CONFIG_NETUTILS_DHCPD_MAXLEASES; i++)
+        {
+          iface->ds_leases[i].next = DHCPD_UNLINKED;
+        }
+
+#if (CONFIG_NETUTILS_DHCPD_MAXLEASES & 31) != 0
+      iface->ds_inuse[DHCPD_MAPWORDS - 1] =
+        ~((UINT32_C(1) << (CONFIG_NETUTILS_DHCPD_MAXLEASES & 31)) - 1);
+#endif
+    }
+
+  if (g_state.ds_nifaces == 0)
+    {
+      nerr("ERROR: No interface\n");
+      return -EINVAL;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: dhcpd_handlepacket
+ ****************************************************************************/
+
+static void dhcpd_handlepacket(void)
+{
+  int nbytes;
+
+  /* Read the next g_state.ds_inpacket */
+
+  nbytes = recv(g_iface.ds_sockfd, &g_state.ds_inpacket,
+                sizeof(struct dhcpmsg_s), 0);
+  if (nbytes < 0)
+    {
+      /* On errors (other EINTR), close the socket and try again */
+
+      nerr("ERROR: recv failed: %d\n", errno);
+      if (errno != EINTR && errno != EAGAIN)
+        {
+          close(g_iface.ds_sockfd);
+          g_iface.ds_sockfd = -1;
+        }
+
+      return;
+    }
+
+  /* Parse the incoming message options */
+
+  if (!dhcpd_parseoptions())
+    {
+      /* Failed to parse the message options */
+
+      nerr("ERROR: No msg type\n");
+      return;
+    }
+
+#ifdef CONFIG_NETUTILS_DHCPD_HOST
+  /* Get the poor little uC a change to get its recvfrom in place */
+
+  usleep(500 * 1000);
+#endif
+
+  /* Now process the incoming DHCP message by its message type */
+
+  switch (g_state.ds_optmsgtype)
+    {
+      case DHCPDISCOVER:
+        ninfo("DHCPDISCOVER\n");
+        dhcpd_discover(g_iface.ds_sockfd);
+        break;
+
+      case DHCPREQUEST:
+        ninfo("DHCPREQUEST\n");
+        dhcpd_request(g_iface.ds_sockfd);
+        break;
+
+      case DHCPDECLINE:
+        ninfo("DHCPDECLINE\n");
+        dhcpd_decline();
+        break;
+
+      case DHCPRELEASE:
+        ninfo("DHCPRELEASE\n");
+        dhcpd_release();
+        break;
+
+      case DHCPINFORM: /* Not supported */
+      default:
+        nerr("ERROR: Unsupported message type: %d\n",
+             g_state.ds_optmsgtype);
+        break;
+    }
+}
+
 /****************************************************************************
  * Name: dhcpd_task_run
  ****************************************************************************/
@@ -1571,6 +2129,11 @@ dhcpd_signal_handler(int signo, FAR siginfo_t *info, FAR void *ctx)
 
 /****************************************************************************
  * Name: dhcpd_run
+ *
+ * Description:
+ *   Run the DHCPD daemon on one interface or on a list of interfaces
+ *   separated by commas or spaces, e.g. "eth0,eth1".
+ *
  ****************************************************************************/
 
 int dhcpd_run(FAR const char *interface)
@@ -1578,8 +2141,10 @@ int dhcpd_run(FAR const char *interface)
 #ifdef CONFIG_ENABLE_ALL_SIGNALS
   struct sigaction act;
 #endif
-  int sockfd = -1;
-  int nbytes;
+  struct pollfd fds[CONFIG_NETUTILS_DHCPD_MAXIFACES];
+  FAR struct dhcpd_iface_s *iface;
+  int ret;
+  int i;
 
   ninfo("Started\n");
 
@@ -1600,6 +2165,16 @@ int dhcpd_run(FAR const char *interface)
 
   memset(g_dhcpd_daemon.ds_data, 0, sizeof(struct dhcpd_state_s));
 
+  ret = dhcpd_initifaces(interface);
+  if (ret < 0)
+    {
+      free(g_dhcpd_daemon.ds_data);
+      g_dhcpd_daemon.ds_data = NULL;
+      return ret;
+    }
+
+  dhcpd_loadleases();
+
   /* Update the pid if running in daemon mode */
 
   g_dhcpd_daemon.ds_pid = getpid();
@@ -1616,85 +2191,64 @@ int dhcpd_run(FAR const char *interface)
 
   g_dhcpd_daemon.ds_state = DHCPD_RUNNING;
 
-  /* Now loop indefinitely, reading packets from the DHCP server socket */
+  /* Now loop indefinitely, reading packets from the DHCP server sockets */
 
   while (g_dhcpd_daemon.ds_state != DHCPD_STOP_REQUESTED)
     {
-      /* Create a socket to listen for requests from DHCP clients */
+      /* Create the sockets to listen for requests from DHCP clients */
 
-      if (sockfd < 0)
+      for (i = 0; i < g_state.ds_nifaces; i++)
         {
-          sockfd = dhcpd_openlistener(interface);
-          if (sockfd < 0)
+          iface = &g_state.ds_ifaces[i];
+          if (iface->ds_sockfd < 0)
             {
-                nerr("ERROR: Failed to create socket\n");
-                break;
+              iface->ds_sockfd = dhcpd_openlistener(iface);
+              if (iface->ds_sockfd < 0)
+                {
+                  nerr("ERROR: Failed to create socket\n");
+                  break;
+                }
             }
-        }
 
-      /* Read the next g_state.ds_outpacket */
+          fds[i].fd      = iface->ds_sockfd;
+          fds[i].events  = POLLIN;
+          fds[i].revents = 0;
+        }
 
-      nbytes = recv(sockfd, &g_state.ds_inpacket,
-                    sizeof(struct dhcpmsg_s), 0);
-      if (nbytes < 0)
+      if (i < g_state.ds_nifaces)
         {
-          /* On errors (other EINTR), close the socket and try again */
+          break;
+        }
+
+      /* Wait for a message on any of the interfaces */
 
-          nerr("ERROR: recv failed: %d\n", errno);
-          if (errno != EINTR && errno != EAGAIN)
+      ret = poll(fds, g_state.ds_nifaces, -1);
+      if (ret < 0)
+        {
+          nerr("ERROR: poll failed: %d\n", errno);
+          if (errno != EINTR)
             {
-              close(sockfd);
-              sockfd = -1;
+              break;
             }
 
           continue;
         }
 
-      /* Parse the incoming message options */
-
-      if (!dhcpd_parseoptions())
+      for (i = 0; i < g_state.ds_nifaces; i++)
         {
-          /* Failed to parse the message options */
-
-          nerr("ERROR: No msg type\n");
-          continue;
+          if (fds[i].revents != 0)
+            {
+              g_state.ds_iface = &g_state.ds_ifaces[i];
+              dhcpd_handlepacket();
+            }
         }
+    }
 
-#ifdef CONFIG_NETUTILS_DHCPD_HOST
-      /* Get the poor little uC a change to get its recvfrom in place */
-
-      usleep(500 * 1000);
-#endif
-
-      /* Now process the incoming DHCP message by its message type */
-
-      switch (g_state.ds_optmsgtype)
+  for (i = 0; i < g_state.ds_nifaces; i++)
+    {
+      if (g_state.ds_ifaces[i].ds_sockfd >= 0)
         {
-          case DHCPDISCOVER:
-            ninfo("DHCPDISCOVER\n");
-            dhcpd_discover(sockfd);
-            break;
-
-          case DHCPREQUEST:
-            ninfo("DHCPREQUEST\n");
-            dhcpd_request(sockfd);
-            break;
-
-          case DHCPDECLINE:
-            ninfo("DHCPDECLINE\n");
-            dhcpd_decline();
-            break;
-
-          case DHCPRELEASE:
-            ninfo("DHCPRELEASE\n");
-            dhcpd_release();
-            break;
-
-          case DHCPINFORM: /* Not supported */
-          default:
-            nerr("ERROR: Unsupported message type: %d\n",
-                 g_state.ds_optmsgtype);
-            break;
+          close(g_state.ds_ifaces[i].ds_sockfd);
         }
     }
 
@@ -1869,3 +2423,58 @@ int dhcpd_set_dnsip(in_addr_t dnsip)
   return OK;
 }
 #endif
+
+/****************************************************************************
+ * Name: dhcpd_set_pool
+ *
+ * Description:
+ *   Set the address pool served on an interface.  The pool is used by the
+ *   next dhcpd_run() or dhcpd_start() naming the interface.
+ *
+ * Returned Value:
+ *   OK on success; -EINVAL for a bad interface name; -ENOSPC if pools are
+ *   already set for CONFIG_NETUTILS_DHCPD_MAXIFACES interfaces.
+ *
+ ****************************************************************************/
+
+int dhcpd_set_pool(FAR const char *interface,
+                   FAR const struct dhcpd_pool_s *pool)
+{
+  FAR struct dhcpd_ifconfig_s *ifconfig = NULL;
+  int i;
+
+  if (interface == NULL || pool == NULL ||
+      interface[0] == '\0' || strlen(interface) >= IFNAMSIZ)
+    {
+      return -EINVAL;
+    }
+
+  /* Reuse the entry of the interface, else take a free one */
+
+  for (i = 0; i < CONFIG_NETUTILS_DHCPD_MAXIFACES; i++)
+    {
+      if (strcmp(g_dhcpd_ifconfig[i].ds_name, interface) == 0)
+        {
+          ifconfig = &g_dhcpd_ifconfig[i];
+          break;
+        }
+      else if (ifconfig == NULL && g_dhcpd_ifconfig[i].ds_name[0] == '\0')
+        {
+          ifconfig = &g_dhcpd_ifconfig[i];
+        }
+    }
+
+  if (ifconfig == NULL)
+    {
+      return -ENOSPC;
+    }
+
+  strlcpy(ifconfig->ds_name, interface, IFNAMSIZ);
+  ifconfig->ds_config.ds_startip  = pool->startip;
+  ifconfig->ds_config.ds_endip    = pool->startip +
+                                    CONFIG_NETUTILS_DHCPD_MAXLEASES - 1;
+  ifconfig->ds_config.ds_routerip = pool->routerip;
+  ifconfig->ds_config.ds_netmask  = pool->netmask;
+  ifconfig->ds_config.ds_dnsip    = pool->dnsip;
+  return OK;
+}
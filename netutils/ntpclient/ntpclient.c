@@ -33,6 +33,7 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -81,6 +82,20 @@
 #  error "NTP sample number below 1, invalid configuration"
 #endif
 
+#ifndef CONFIG_NETUTILS_NTPCLIENT_REQUEST_TRIES
+#  define CONFIG_NETUTILS_NTPCLIENT_REQUEST_TRIES 3
+#elif CONFIG_NETUTILS_NTPCLIENT_REQUEST_TRIES < 1
+#  error "NTP request tries below 1, invalid configuration"
+#endif
+
+#ifndef CONFIG_NETUTILS_NTPCLIENT_MINPOLLSEC
+#  define CONFIG_NETUTILS_NTPCLIENT_MINPOLLSEC \
+          CONFIG_NETUTILS_NTPCLIENT_POLLDELAYSEC
+#elif CONFIG_NETUTILS_NTPCLIENT_MINPOLLSEC > \
+      CONFIG_NETUTILS_NTPCLIENT_POLLDELAYSEC
+#  error "NTP minimum poll interval above the maximum poll interval"
+#endif
+
 #ifndef CONFIG_NETUTILS_NTPCLIENT_SERVER
 #  ifdef CONFIG_NETUTILS_NTPCLIENT_SERVERIP
 /* Old config support */
@@ -106,6 +121,18 @@
 
 #define MAX_RETRY_INTERVAL 120
 
+/* The poll interval is doubled after a round whose offset stays below this
+ * (128 ms, the NTP step threshold) and reset to the minimum otherwise.
+ */
+
+#define NTP_POLL_STABLE_OFFSET ((int64_t)1 << 29)
+
+/* Index of the socket used for an address family in a sampling round */
+
+#define NTP_SOCK_IPv4        0
+#define NTP_SOCK_IPv6        1
+#define NTP_NSOCKS           2
+
 #ifndef STR
 #  define STR2(x) #x
 #  define STR(x) STR2(x)
@@ -158,8 +185,30 @@ struct ntp_sample_s
 {
   int64_t offset;
   int64_t delay;
+  int64_t dist;              /* Half width of the correctness interval */
   union ntp_addr_u srv_addr;
-} packet_struct;
+  bool selected;             /* Survived the intersection selection */
+};
+
+/* Outstanding request of a sampling round.  Replies are matched by the
+ * server address and by the origin timestamp, which echoes xmit_time.
+ */
+
+struct ntp_request_s
+{
+  union ntp_addr_u srv_addr;
+  uint64_t xmit_time;        /* Transmit timestamp of the last request */
+  int sock;                  /* NTP_SOCK_IPv4 or NTP_SOCK_IPv6 */
+  bool done;                 /* Valid reply received */
+};
+
+/* Endpoint of a correctness interval for the intersection algorithm */
+
+struct ntp_edge_s
+{
+  int64_t value;
+  int type;                  /* -1 for the low end, +1 for the high end */
+};
 
 /* Server address list. */
 
@@ -204,6 +253,7 @@ static struct ntpc_daemon_s g_ntpc_daemon =
 static struct ntp_sample_s g_last_samples
     [CONFIG_NETUTILS_NTPCLIENT_NUM_SAMPLES];
 unsigned int g_last_nsamples = 0;
+static unsigned int g_last_poll;
 
 /****************************************************************************
  * Private Functions
@@ -233,6 +283,28 @@ static int sample_cmp(FAR const void *_a, FAR const void *_b)
     }
 }
 
+/****************************************************************************
+ * Name: edge_cmp
+ *
+ * Description:
+ *   Order interval endpoints by value, low ends before high ends of the
+ *   same value so that touching intervals count as intersecting.
+ *
+ ****************************************************************************/
+
+static int edge_cmp(FAR const void *_a, FAR const void *_b)
+{
+  FAR const struct ntp_edge_s *a = _a;
+  FAR const struct ntp_edge_s *b = _b;
+
+  if (a->value != b->value)
+    {
+      return a->value < b->value ? -1 : 1;
+    }
+
+  return a->type - b->type;
+}
+
 /****************************************************************************
  * Name: int64abs
  ****************************************************************************/
@@ -703,24 +775,15 @@ static bool ntp_is_kiss_of_death(FAR const struct ntp_datagram_s *recv,
 }
 
 /****************************************************************************
- * Name: ntpc_verify_recvd_ntp_datagram
+ * Name: ntpc_same_peer
  ****************************************************************************/
 
-static bool ntpc_verify_recvd_ntp_datagram(
-                FAR const struct ntp_datagram_s *xmit,
-                FAR const struct ntp_datagram_s *recv,
-                size_t nbytes,
-                FAR const union ntp_addr_u *xmitaddr,
-                FAR const union ntp_addr_u *recvaddr,
-                size_t recvaddrlen)
+static bool ntpc_same_peer(FAR const union ntp_addr_u *xmitaddr,
+                           FAR const union ntp_addr_u *recvaddr,
+                           size_t recvaddrlen)
 {
-  time_t buildtime;
-  time_t seconds;
-
   if (recvaddr->sa.sa_family != xmitaddr->sa.sa_family)
     {
-      ninfo("wrong address family\n");
-
       return false;
     }
 
@@ -731,8 +794,6 @@ static bool ntpc_verify_recvd_ntp_datagram(
           xmitaddr->in4.sin_addr.s_addr != recvaddr->in4.sin_addr.s_addr ||
           xmitaddr->in4.sin_port != recvaddr->in4.sin_port)
         {
-          ninfo("response from wrong peer\n");
-
           return false;
         }
     }
@@ -746,13 +807,36 @@ static bool ntpc_verify_recvd_ntp_datagram(
                  &recvaddr->in6.sin6_addr, sizeof(struct in6_addr)) != 0 ||
           xmitaddr->in6.sin6_port != recvaddr->in6.sin6_port)
         {
-          ninfo("response from wrong peer\n");
-
           return false;
         }
     }
 #endif /* CONFIG_NET_IPv6 */
 
+  return true;
+}
+
+/****************************************************************************
+ * Name: ntpc_verify_recvd_ntp_datagram
+ ****************************************************************************/
+
+static bool ntpc_verify_recvd_ntp_datagram(
+                uint64_t xmit_time,
+                FAR const struct ntp_datagram_s *recv,
+                size_t nbytes,
+                FAR const union ntp_addr_u *xmitaddr,
+                FAR const union ntp_addr_u *recvaddr,
+                size_t recvaddrlen)
+{
+  time_t buildtime;
+  time_t seconds;
+
+  if (!ntpc_same_peer(xmitaddr, recvaddr, recvaddrlen))
+    {
+      ninfo("response from wrong peer\n");
+
+      return false;
+    }
+
   if (nbytes < NTP_DATAGRAM_MINSIZE)
     {
       /* Too short. */
@@ -799,7 +883,7 @@ static bool ntpc_verify_recvd_ntp_datagram(
       return false;
     }
 
-  if (memcmp(recv->origtimestamp, xmit->xmittimestamp, 8) != 0)
+  if (ntpc_getuint64(recv->origtimestamp) != xmit_time)
     {
       /* "The Originate Timestamp in the server reply should match the
        * Transmit Timestamp used in the client request."
@@ -1037,107 +1121,131 @@ static int ntp_get_next_hostip(FAR struct ntp_servers_s *srvs,
 }
 
 /****************************************************************************
- * Name: ntpc_get_ntp_sample
+ * Name: ntpc_now_ms
  ****************************************************************************/
 
-static int ntpc_get_ntp_sample(FAR struct ntp_servers_s *srvs,
-                               FAR struct ntp_sample_s *samples,
-                               int curr_idx)
+static int64_t ntpc_now_ms(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * MSEC_PER_SEC + ts.tv_nsec / NSEC_PER_MSEC;
+}
+
+/****************************************************************************
+ * Name: ntpc_select_servers
+ *
+ * Description:
+ *   Fill the request list of a sampling round with server addresses that
+ *   are not on the KoD list, preferring addresses not yet in the list.
+ *
+ * Returned Value:
+ *   The number of requests; on failure ERROR with errno set.
+ *
+ ****************************************************************************/
+
+static int ntpc_select_servers(FAR struct ntp_servers_s *srvs,
+                               FAR struct ntp_request_s *reqs)
 {
-  FAR struct ntp_sample_s *sample = &samples[curr_idx];
-  uint64_t xmit_time, recv_time;
   union ntp_addr_u server;
-  union ntp_addr_u recvaddr;
-  struct ntp_datagram_s xmit;
-  struct ntp_datagram_s recv;
-  socklen_t socklen;
-  ssize_t nbytes;
-  int errval;
-  int retry = 0;
-  int nsamples = curr_idx;
-  bool addr_ok;
+  int nreqs = 0;
+  int errval = 0;
+  int retry;
   int ret;
-  int sd = -1;
   int i;
 
-  /* Setup an ntp_addr_u with information about the server we are
-   * going to ask the time from.
-   */
-
   memset(&server, 0, sizeof(server));
 
-  do
+  while (nreqs < CONFIG_NETUTILS_NTPCLIENT_NUM_SAMPLES)
     {
-      addr_ok = true;
+      bool addr_ok;
 
-      ret = ntp_get_next_hostip(srvs, &server);
-      if (ret < 0)
+      retry = 0;
+      do
         {
-          errval = errno;
+          addr_ok = true;
 
-          nerr("ERROR: ntp_get_next_hostip() failed: %d\n", errval);
+          ret = ntp_get_next_hostip(srvs, &server);
+          if (ret < 0)
+            {
+              errval = errno;
 
-          goto sock_error;
-        }
+              nerr("ERROR: ntp_get_next_hostip() failed: %d\n", errval);
+              break;
+            }
 
-      /* Make sure that server not in exclusion list. */
+          /* Make sure that server not in exclusion list. */
 
-      if (ntp_address_in_kod_list(&server))
-        {
-          if (retry < MAX_SERVER_SELECTION_RETRIES)
+          if (ntp_address_in_kod_list(&server))
             {
               ninfo("on KoD list. retry DNS.\n");
 
-              retry++;
               addr_ok = false;
-              continue;
-            }
-          else
-            {
-              errval = -EALREADY;
-              goto sock_error;
+              if (retry++ < MAX_SERVER_SELECTION_RETRIES)
+                {
+                  continue;
+                }
+
+              errval = EALREADY;
+              break;
             }
-        }
 
-      /* Make sure that this sample is from new server. */
+          /* Make sure that this request is to a new server.  Accept the
+           * same server if cannot get DNS for other server.
+           */
 
-      for (i = 0; i < nsamples; i++)
-        {
-          if (memcmp(&server, &samples[i].srv_addr, sizeof(server)) == 0)
+          for (i = 0; i < nreqs; i++)
             {
-              /* Already have sample from this server, retry DNS. */
-
-              ninfo("retry DNS\n");
-
-              if (retry < MAX_SERVER_SELECTION_RETRIES)
+              if (memcmp(&server, &reqs[i].srv_addr, sizeof(server)) == 0)
                 {
-                  retry++;
-                  addr_ok = false;
-                  break;
-                }
-              else
-                {
-                  /* Accept same server if cannot get DNS for other server. */
+                  ninfo("retry DNS\n");
+
+                  if (retry++ < MAX_SERVER_SELECTION_RETRIES)
+                    {
+                      addr_ok = false;
+                    }
 
                   break;
                 }
             }
         }
-    }
-  while (!addr_ok);
+      while (!addr_ok);
 
-  /* Open socket. */
+      if (!addr_ok)
+        {
+          /* No more usable addresses in this round. */
 
-  sd = ntpc_create_dgram_socket(server.sa.sa_family);
-  if (sd < 0)
-    {
-      errval = errno;
+          break;
+        }
 
-      nerr("ERROR: ntpc_create_dgram_socket() failed: %d\n", errval);
+      memset(&reqs[nreqs], 0, sizeof(reqs[nreqs]));
+      reqs[nreqs].srv_addr = server;
+      reqs[nreqs].sock = server.sa.sa_family == AF_INET ? NTP_SOCK_IPv4
+                                                        : NTP_SOCK_IPv6;
+      nreqs++;
+    }
 
-      goto sock_error;
+  if (nreqs == 0)
+    {
+      errno = errval;
+      return ERROR;
     }
 
+  return nreqs;
+}
+
+/****************************************************************************
+ * Name: ntpc_send_request
+ ****************************************************************************/
+
+static int ntpc_send_request(int sd, FAR struct ntp_request_s *req,
+                             FAR uint64_t *last_xmit)
+{
+  struct ntp_datagram_s xmit;
+  socklen_t socklen;
+  uint64_t xmit_time;
+  int ret;
+
   /* Format the transmit datagram */
 
   memset(&xmit, 0, sizeof(xmit));
@@ -1145,79 +1253,379 @@ static int ntpc_get_ntp_sample(FAR struct ntp_servers_s *srvs,
 
   ninfo("Sending a NTPv%d packet\n", NTP_VERSION);
 
+  /* The transmit timestamp identifies the request, so keep it unique
+   * within the round even if the clock did not tick between two sends.
+   */
+
   xmit_time = ntp_localtime();
+  if (xmit_time <= *last_xmit)
+    {
+      xmit_time = *last_xmit + 1;
+    }
+
+  *last_xmit = xmit_time;
+  req->xmit_time = xmit_time;
   ntpc_setuint64(xmit.xmittimestamp, xmit_time);
 
-  socklen = (server.sa.sa_family == AF_INET) ? sizeof(struct sockaddr_in)
-                                             : sizeof(struct sockaddr_in6);
+  socklen = (req->srv_addr.sa.sa_family == AF_INET) ?
+            sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6);
   ret = sendto(sd, &xmit, sizeof(struct ntp_datagram_s),
-               0, &server.sa, socklen);
+               0, &req->srv_addr.sa, socklen);
   if (ret < 0)
     {
-      errval = errno;
+      nerr("ERROR: sendto() failed: %d\n", errno);
+      return ERROR;
+    }
 
-      nerr("ERROR: sendto() failed: %d\n", errval);
+  return OK;
+}
 
-      goto sock_error;
-    }
+/****************************************************************************
+ * Name: ntpc_recv_response
+ *
+ * Description:
+ *   Receive one datagram and turn it into a sample if it answers one of
+ *   the outstanding requests.
+ *
+ * Returned Value:
+ *   1 if a sample was stored, 0 if the datagram was discarded, ERROR with
+ *   errno set if receiving failed.
+ *
+ ****************************************************************************/
 
-  /* Attempt to receive a packet (with a timeout that was set up via
-   * setsockopt() above)
-   */
+static int ntpc_recv_response(int sd, FAR struct ntp_request_s *reqs,
+                              int nreqs, FAR struct ntp_sample_s *sample)
+{
+  FAR struct ntp_request_s *req = NULL;
+  union ntp_addr_u recvaddr;
+  struct ntp_datagram_s recv;
+  socklen_t socklen;
+  uint64_t recv_time;
+  uint64_t orig_time;
+  ssize_t nbytes;
+  int i;
 
+  socklen = sizeof(recvaddr);
   nbytes = recvfrom(sd, &recv, sizeof(struct ntp_datagram_s),
-                    0, &recvaddr.sa, &socklen);
+                    MSG_DONTWAIT, &recvaddr.sa, &socklen);
   recv_time = ntp_localtime();
 
+  if (nbytes < 0)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+          return 0;
+        }
+
+      nerr("ERROR: recvfrom() failed: %d\n", errno);
+      return ERROR;
+    }
+
+  /* Find the request this is the reply to.  Late replies to an earlier
+   * transmission of a request no longer match and are dropped.
+   */
+
+  orig_time = ntpc_getuint64(recv.origtimestamp);
+  for (i = 0; i < nreqs; i++)
+    {
+      if (!reqs[i].done && reqs[i].xmit_time == orig_time &&
+          ntpc_same_peer(&reqs[i].srv_addr, &recvaddr, socklen))
+        {
+          req = &reqs[i];
+          break;
+        }
+    }
+
+  if (req == NULL)
+    {
+      ninfo("response to no outstanding request\n");
+
+      return 0;
+    }
+
   /* Check if the received message was long enough to be a valid NTP
    * datagram.
    */
 
-  if (nbytes > 0 && ntpc_verify_recvd_ntp_datagram(
-                          &xmit, &recv, nbytes, &server, &recvaddr, socklen))
+  if (!ntpc_verify_recvd_ntp_datagram(req->xmit_time, &recv, nbytes,
+                                      &req->srv_addr, &recvaddr, socklen))
     {
-      close(sd);
-      sd = -1;
+      return 0;
+    }
+
+  ninfo("Calculate offset\n");
+
+  req->done = true;
+
+  memset(sample, 0, sizeof(struct ntp_sample_s));
+
+  sample->srv_addr = req->srv_addr;
+
+  ntpc_calculate_offset(&sample->offset, &sample->delay,
+                        req->xmit_time, recv_time, recv.recvtimestamp,
+                        recv.xmittimestamp);
+
+  /* The true offset lies within half the round-trip delay plus the root
+   * distance of the server.  Root delay and dispersion are 16.16 fixed
+   * point.
+   */
 
-      ninfo("Calculate offset\n");
+  sample->dist = MAX(sample->delay, 0) / 2 +
+                 ((int64_t)ntpc_getuint32(recv.rootdelay) << 15) +
+                 ((int64_t)ntpc_getuint32(recv.rootdispersion) << 16);
 
-      memset(sample, 0, sizeof(struct ntp_sample_s));
+  return 1;
+}
 
-      sample->srv_addr = server;
+/****************************************************************************
+ * Name: ntpc_get_ntp_samples
+ *
+ * Description:
+ *   Query all servers of a round concurrently and collect their samples.
+ *   One socket per address family carries every request; requests still
+ *   unanswered are retransmitted CONFIG_NETUTILS_NTPCLIENT_REQUEST_TRIES
+ *   times within CONFIG_NETUTILS_NTPCLIENT_TIMEOUT_MS.
+ *
+ * Returned Value:
+ *   The number of samples; on failure ERROR with errno set.
+ *
+ ****************************************************************************/
 
-      ntpc_calculate_offset(&sample->offset, &sample->delay,
-                            xmit_time, recv_time, recv.recvtimestamp,
-                            recv.xmittimestamp);
+static int ntpc_get_ntp_samples(FAR struct ntp_servers_s *srvs,
+                                FAR struct ntp_sample_s *samples)
+{
+  struct ntp_request_s reqs[CONFIG_NETUTILS_NTPCLIENT_NUM_SAMPLES];
+  struct pollfd fds[NTP_NSOCKS];
+  int sds[NTP_NSOCKS];
+  uint64_t last_xmit = 0;
+  int64_t deadline;
+  int64_t next_send;
+  int64_t wakeup;
+  int64_t now;
+  int nsamples = 0;
+  int nreqs;
+  int ntries = 0;
+  int errval = 0;
+  int nfds;
+  int ret;
+  int i;
 
-      return OK;
+  nreqs = ntpc_select_servers(srvs, reqs);
+  if (nreqs < 0)
+    {
+      return ERROR;
     }
-  else
+
+  /* Open one socket per address family in use. */
+
+  for (i = 0; i < NTP_NSOCKS; i++)
+    {
+      sds[i] = -1;
+    }
+
+  for (i = 0; i < nreqs; i++)
+    {
+      int sock = reqs[i].sock;
+
+      if (sds[sock] < 0)
+        {
+          sds[sock] = ntpc_create_dgram_socket(reqs[i].srv_addr.sa.sa_family);
+          if (sds[sock] < 0)
+            {
+              errval = errno;
+
+              nerr("ERROR: ntpc_create_dgram_socket() failed: %d\n",
+                   errval);
+
+              goto sock_error;
+            }
+        }
+    }
+
+  nfds = 0;
+  for (i = 0; i < NTP_NSOCKS; i++)
     {
-      /* Check for errors.  Short datagrams are handled as error. */
+      if (sds[i] >= 0)
+        {
+          fds[nfds].fd = sds[i];
+          fds[nfds].events = POLLIN;
+          nfds++;
+        }
+    }
 
-      errval = errno;
+  now = ntpc_now_ms();
+  deadline = now + CONFIG_NETUTILS_NTPCLIENT_TIMEOUT_MS;
+  next_send = now;
 
-      if (nbytes >= 0)
+  while (nsamples < nreqs)
+    {
+      now = ntpc_now_ms();
+      if (now >= next_send &&
+          ntries < CONFIG_NETUTILS_NTPCLIENT_REQUEST_TRIES)
         {
-          errval = EMSGSIZE;
+          /* Send all requests still unanswered. */
+
+          for (i = 0; i < nreqs; i++)
+            {
+              if (!reqs[i].done &&
+                  ntpc_send_request(sds[reqs[i].sock], &reqs[i],
+                                    &last_xmit) < 0)
+                {
+                  errval = errno;
+                }
+            }
+
+          ntries++;
+          next_send = now + CONFIG_NETUTILS_NTPCLIENT_TIMEOUT_MS /
+                            CONFIG_NETUTILS_NTPCLIENT_REQUEST_TRIES;
         }
-      else
+
+      if (now >= deadline)
         {
-          nerr("ERROR: recvfrom() failed: %d\n", errval);
+          errval = ETIMEDOUT;
+          break;
         }
 
-      goto sock_error;
+      /* Wait for responses until the next retransmission or the end of
+       * the round.
+       */
+
+      wakeup = deadline;
+      if (ntries < CONFIG_NETUTILS_NTPCLIENT_REQUEST_TRIES)
+        {
+          wakeup = MIN(next_send, deadline);
+        }
+
+      ret = poll(fds, nfds, (int)(wakeup - now));
+      if (ret < 0)
+        {
+          errval = errno;
+          if (errval == EINTR)
+            {
+              break;
+            }
+
+          nerr("ERROR: poll() failed: %d\n", errval);
+          goto sock_error;
+        }
+
+      for (i = 0; i < nfds && nsamples < nreqs; i++)
+        {
+          if ((fds[i].revents & POLLIN) == 0)
+            {
+              continue;
+            }
+
+          ret = ntpc_recv_response(fds[i].fd, reqs, nreqs,
+                                   &samples[nsamples]);
+          if (ret < 0)
+            {
+              errval = errno;
+            }
+          else
+            {
+              nsamples += ret;
+            }
+        }
     }
 
 sock_error:
-  if (sd >= 0)
+  for (i = 0; i < NTP_NSOCKS; i++)
     {
-      close(sd);
-      sd = -1;
+      if (sds[i] >= 0)
+        {
+          close(sds[i]);
+        }
     }
 
-  errno = errval;
-  return ERROR;
+  if (nsamples == 0)
+    {
+      errno = errval;
+      return ERROR;
+    }
+
+  return nsamples;
+}
+
+/****************************************************************************
+ * Name: ntpc_select_samples
+ *
+ * Description:
+ *   Marzullo's intersection algorithm as used by the NTP selection
+ *   algorithm (RFC 5905): find the smallest number of falsetickers for
+ *   which the correctness intervals of the other samples share a common
+ *   intersection, and mark the samples overlapping it as selected.  If
+ *   no majority agrees, all samples are kept.
+ *
+ ****************************************************************************/
+
+static void ntpc_select_samples(FAR struct ntp_sample_s *samples,
+                               int nsamples)
+{
+  struct ntp_edge_s edges[2 * CONFIG_NETUTILS_NTPCLIENT_NUM_SAMPLES];
+  int64_t low = INT64_MAX;
+  int64_t high = INT64_MIN;
+  int nedges = 0;
+  int allow;
+  int found;
+  int i;
+
+  for (i = 0; i < nsamples; i++)
+    {
+      edges[nedges].value = samples[i].offset - samples[i].dist;
+      edges[nedges++].type = -1;
+      edges[nedges].value = samples[i].offset + samples[i].dist;
+      edges[nedges++].type = 1;
+    }
+
+  qsort(edges, nedges, sizeof(*edges), edge_cmp);
+
+  /* Allow for fewer than half of the samples being falsetickers. */
+
+  for (allow = 0; 2 * allow < nsamples; allow++)
+    {
+      low = INT64_MAX;
+      high = INT64_MIN;
+
+      found = 0;
+      for (i = 0; i < nedges; i++)
+        {
+          found -= edges[i].type;
+          if (found >= nsamples - allow)
+            {
+              low = edges[i].value;
+              break;
+            }
+        }
+
+      found = 0;
+      for (i = nedges - 1; i >= 0; i--)
+        {
+          found += edges[i].type;
+          if (found >= nsamples - allow)
+            {
+              high = edges[i].value;
+              break;
+            }
+        }
+
+      if (low <= high)
+        {
+          break;
+        }
+    }
+
+  for (i = 0; i < nsamples; i++)
+    {
+      samples[i].selected = low > high ||
+                            (samples[i].offset - samples[i].dist <= high &&
+                             samples[i].offset + samples[i].dist >= low);
+    }
+
+  if (low > high)
+    {
+      nwarn("WARNING: no majority of NTP servers agrees\n");
+    }
 }
 
 /****************************************************************************
@@ -1237,6 +1645,9 @@ static int ntpc_daemon(int argc, FAR char **argv)
   int exitcode = EXIT_SUCCESS;
   int retries = 0;
   int retry_delay = 1;
+#ifdef CONFIG_NETUTILS_NTPCLIENT_STAY_ON
+  int poll_delay = CONFIG_NETUTILS_NTPCLIENT_MINPOLLSEC;
+#endif
   int nsamples;
   int ret;
 
@@ -1263,29 +1674,23 @@ static int ntpc_daemon(int argc, FAR char **argv)
   g_ntpc_daemon.state = NTP_RUNNING;
   sem_post(&g_ntpc_daemon.sync);
 
-  /* Here we do the communication with the NTP server. We collect set of
-   * NTP samples (hopefully from different servers when using DNS) and
-   * select median time-offset of samples. This is to filter out
+  /* Here we do the communication with the NTP servers. We query a set of
+   * servers concurrently (hopefully different servers when using DNS),
+   * drop the falsetickers with the intersection algorithm and select
+   * median time-offset of the remaining samples. This is to filter out
    * misconfigured server giving wrong timestamps.
    *
    * NOTE that the scheduler is locked whenever this loop runs.  That
    * assures both:  (1) that there are no asynchronous stop requests and
    * (2) that we are not suspended while in critical moments when we about
    * to set the new time.  This sounds harsh, but this function is suspended
-   * most of the time either: (1) sending a datagram, (2) receiving a
-   * datagram, or (3) waiting for the next poll cycle.
-   *
-   * TODO: The first datagram that is sent is usually lost.  That is because
-   * the MAC address of the NTP server is not in the ARP table.  This is
-   * particularly bad here because the request will not be sent again until
-   * the long delay expires leaving the system with bad time for a long time
-   * initially.  Solutions:
+   * most of the time either: (1) sending a datagram, (2) waiting for
+   * responses, or (3) waiting for the next poll cycle.
    *
-   * 1. Fix send logic so that it assures that the ARP request has been
-   *    sent and the entry is in the ARP table before sending the packet
-   *    (best).
-   * 2. Add some ad hoc logic here so that there is no delay until at least
-   *    one good time is received.
+   * The first datagram that is sent is usually lost because the MAC
+   * address of the NTP server is not in the ARP table yet.  Unanswered
+   * requests are therefore retransmitted within the round, and the poll
+   * interval starts short so that the time converges soon after boot.
    */
 
   sched_lock();
@@ -1311,19 +1716,14 @@ static int ntpc_daemon(int argc, FAR char **argv)
         {
           /* Collect samples. */
 
-          for (i = 0; i < CONFIG_NETUTILS_NTPCLIENT_NUM_SAMPLES; i++)
+          ret = ntpc_get_ntp_samples(srvs, samples);
+          if (ret < 0)
             {
-              /* Get next sample. */
-
-              ret = ntpc_get_ntp_sample(srvs, samples, nsamples);
-              if (ret < 0)
-                {
-                  errval = errno;
-                }
-              else
-                {
-                  ++nsamples;
-                }
+              errval = errno;
+            }
+          else
+            {
+              nsamples = ret;
             }
         }
 
@@ -1331,17 +1731,29 @@ static int ntpc_daemon(int argc, FAR char **argv)
 
       if (nsamples > 0)
         {
+          int64_t offsets[CONFIG_NETUTILS_NTPCLIENT_NUM_SAMPLES];
           int64_t offset;
+          int nselected;
+
+          /* Select median offset of the samples that survive the
+           * intersection algorithm.
+           */
 
-          /* Select median offset of samples. */
+          ntpc_select_samples(samples, nsamples);
 
           qsort(samples, nsamples, sizeof(*samples), sample_cmp);
 
+          nselected = 0;
           for (i = 0; i < nsamples; i++)
             {
-              ninfo("NTP sample[%d]: offset: %s%lu.%03lu sec, "
+              if (samples[i].selected)
+                {
+                  offsets[nselected++] = samples[i].offset;
+                }
+
+              ninfo("NTP sample[%d]%s: offset: %s%lu.%03lu sec, "
                     "round-trip delay: %s%lu.%03lu sec\n",
-                    i,
+                    i, samples[i].selected ? "" : " (falseticker)",
                     samples[i].offset < 0 ? "-" : "",
                     (unsigned long)ntp_secpart(int64abs(samples[i].offset)),
                     ntp_nsecpart(int64abs(samples[i].offset))
@@ -1352,14 +1764,14 @@ static int ntpc_daemon(int argc, FAR char **argv)
                       / NSEC_PER_MSEC);
             }
 
-          if ((nsamples % 2) == 1)
+          if ((nselected % 2) == 1)
             {
-              offset = samples[nsamples / 2].offset;
+              offset = offsets[nselected / 2];
             }
           else
             {
-              int64_t offset1 = samples[nsamples / 2].offset;
-              int64_t offset2 = samples[nsamples / 2 - 1].offset;
+              int64_t offset1 = offsets[nselected / 2];
+              int64_t offset2 = offsets[nselected / 2 - 1];
 
               /* Average of two middle offsets. */
 
@@ -1405,12 +1817,30 @@ static int ntpc_daemon(int argc, FAR char **argv)
            * more.  I think we can skip most of that here.
            */
 
+          /* Poll quickly until the clock has converged, then back off
+           * towards the configured poll interval.
+           */
+
+          if (2 * nselected > nsamples &&
+              int64abs(offset) < NTP_POLL_STABLE_OFFSET)
+            {
+              poll_delay = MIN(2 * poll_delay,
+                               CONFIG_NETUTILS_NTPCLIENT_POLLDELAYSEC);
+            }
+          else
+            {
+              poll_delay = CONFIG_NETUTILS_NTPCLIENT_MINPOLLSEC;
+            }
+
+          sem_wait(&g_ntpc_daemon.lock);
+          g_last_poll = poll_delay;
+          sem_post(&g_ntpc_daemon.lock);
+
           if (g_ntpc_daemon.state == NTP_RUNNING)
             {
-              ninfo("Waiting for %d seconds\n",
-                    CONFIG_NETUTILS_NTPCLIENT_POLLDELAYSEC);
+              ninfo("Waiting for %d seconds\n", poll_delay);
 
-              sleep(CONFIG_NETUTILS_NTPCLIENT_POLLDELAYSEC);
+              sleep(poll_delay);
               retries = 0;
               retry_delay = 1;
             }
@@ -1612,10 +2042,12 @@ int ntpc_status(struct ntpc_status_s *statusp)
 
   sem_wait(&g_ntpc_daemon.lock);
   statusp->nsamples = g_last_nsamples;
+  statusp->poll = g_last_poll;
   for (i = 0; i < g_last_nsamples; i++)
     {
       statusp->samples[i].offset = g_last_samples[i].offset;
       statusp->samples[i].delay = g_last_samples[i].delay;
+      statusp->samples[i].selected = g_last_samples[i].selected;
       statusp->samples[i]._srv_addr_store = g_last_samples[i].srv_addr.ss;
       statusp->samples[i].srv_addr = (FAR const struct sockaddr *)
                                      &statusp->samples[i]._srv_addr_store;
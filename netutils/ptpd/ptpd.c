@@ -60,6 +60,30 @@
 #include "netutils/netlib.h"
 #include "ptpv2.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS
+#  define CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS 0
+#endif
+
+#ifndef CONFIG_NETUTILS_PTPD_DELAYRESP_BATCH
+#  define CONFIG_NETUTILS_PTPD_DELAYRESP_BATCH 1
+#endif
+
+/* Message types that can be granted for unicast transmission */
+
+#define PTP_UNICAST_ANNOUNCE        0
+#define PTP_UNICAST_SYNC            1
+#define PTP_UNICAST_DELAY_RESP      2
+#define PTP_UNICAST_NTYPES          3
+
+/* Range of granted unicast message intervals, 2^-7 s to 2^12 s */
+
+#define PTP_UNICAST_MIN_LOGINTERVAL (-7)
+#define PTP_UNICAST_MAX_LOGINTERVAL 12
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -72,6 +96,39 @@ struct ptpd_statusreq_s
   FAR struct ptpd_status_s *dest;
 };
 
+#if CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS > 0
+/* A client that negotiated unicast transmission */
+
+struct ptp_unicast_client_s
+{
+  struct in_addr addr;
+  uint8_t identity[8];
+  uint8_t portindex[2];
+
+  /* Per PTP_UNICAST_xxx: end of the grant (CLOCK_MONOTONIC seconds,
+   * 0 if not granted), message interval and latest transmission.
+   */
+
+  time_t expiry[PTP_UNICAST_NTYPES];
+  int interval_ms[PTP_UNICAST_NTYPES];
+  struct timespec last_sent[PTP_UNICAST_NTYPES];
+
+  uint16_t announce_seq;
+  uint16_t sync_seq;
+};
+#endif
+
+/* Received delay request waiting for the response */
+
+struct ptp_delayreq_s
+{
+  struct timespec rxtime;
+  in_addr_t dest;           /* Multicast or the requester for unicast */
+  uint8_t identity[8];
+  uint8_t portindex[2];
+  uint8_t sequenceid[2];
+};
+
 /* Main PTPD state storage */
 
 struct ptp_state_s
@@ -146,9 +203,44 @@ struct ptp_state_s
   long path_delay_ns;
   long delayreq_interval;
 
+#ifdef CONFIG_NETUTILS_PTPD_SERVO_PI
+  /* PI servo: line fit of the first measurements for the initial
+   * frequency estimate, which then lives on in drift_ppb as the integral
+   * term.
+   */
+
+  int servo_count;
+  struct timespec servo_start;
+  int64_t servo_sum_t;
+  int64_t servo_sum_d;
+  int64_t servo_sum_tt;
+  int64_t servo_sum_td;
+#endif
+
+  /* Statistics of the clock error since the source was selected */
+
+  unsigned long stats_samples;
+  int64_t stats_offset_min_ns;
+  int64_t stats_offset_max_ns;
+  long stats_jitter_ns;
+  uint32_t offset_histogram[PTPD_HISTOGRAM_BINS];
+  uint32_t jitter_histogram[PTPD_HISTOGRAM_BINS];
+
+  /* Delay requests received since the responses were last sent */
+
+  struct ptp_delayreq_s delayreq_queue[CONFIG_NETUTILS_PTPD_DELAYRESP_BATCH];
+  int delayreq_count;
+  unsigned long delayresp_count;
+
+#if CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS > 0
+  struct ptp_unicast_client_s
+    unicast[CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS];
+#endif
+
   /* Latest received packet and its timestamp (CLOCK_REALTIME) */
 
   struct timespec rxtime;
+  struct sockaddr_in rxaddr;
   union
   {
     struct ptp_header_s     header;
@@ -157,6 +249,7 @@ struct ptp_state_s
     struct ptp_follow_up_s  follow_up;
     struct ptp_delay_req_s  delay_req;
     struct ptp_delay_resp_s delay_resp;
+    struct ptp_signaling_s  signaling;
     uint8_t                 raw[128];
   } rxbuf;
 
@@ -381,6 +474,78 @@ static uint16_t ptp_get_sequence(FAR const struct ptp_header_s *hdr)
   return ((uint16_t)hdr->sequenceid[0] << 8) | hdr->sequenceid[1];
 }
 
+/* Histogram bin of a clock error or jitter value, see PTPD_HISTOGRAM_BINS */
+
+static int ptp_histogram_bin(int64_t value_ns)
+{
+  uint64_t mag = value_ns < 0 ? -(uint64_t)value_ns : (uint64_t)value_ns;
+  int bin = 0;
+
+  mag >>= PTPD_HISTOGRAM_SHIFT;
+  while (mag != 0 && bin < PTPD_HISTOGRAM_BINS - 1)
+    {
+      mag >>= 1;
+      bin++;
+    }
+
+  return bin;
+}
+
+/* Forget the clock error statistics, e.g. when changing clock source */
+
+static void ptp_reset_stats(FAR struct ptp_state_s *state)
+{
+  state->stats_samples = 0;
+  state->stats_offset_min_ns = 0;
+  state->stats_offset_max_ns = 0;
+  state->stats_jitter_ns = 0;
+  memset(state->offset_histogram, 0, sizeof(state->offset_histogram));
+  memset(state->jitter_histogram, 0, sizeof(state->jitter_histogram));
+}
+
+/* Add a clock error measurement to the statistics.  Must be called before
+ * last_delta_ns is updated.
+ */
+
+static void ptp_update_stats(FAR struct ptp_state_s *state,
+                             int64_t delta_ns)
+{
+  int64_t jitter_ns;
+
+  state->offset_histogram[ptp_histogram_bin(delta_ns)]++;
+
+  if (state->stats_samples == 0)
+    {
+      state->stats_offset_min_ns = delta_ns;
+      state->stats_offset_max_ns = delta_ns;
+    }
+  else
+    {
+      if (delta_ns < state->stats_offset_min_ns)
+        {
+          state->stats_offset_min_ns = delta_ns;
+        }
+
+      if (delta_ns > state->stats_offset_max_ns)
+        {
+          state->stats_offset_max_ns = delta_ns;
+        }
+
+      /* Smoothed jitter as in RFC 3550 section 6.4.1 */
+
+      jitter_ns = delta_ns - state->last_delta_ns;
+      if (jitter_ns < 0)
+        {
+          jitter_ns = -jitter_ns;
+        }
+
+      state->jitter_histogram[ptp_histogram_bin(jitter_ns)]++;
+      state->stats_jitter_ns += (jitter_ns - state->stats_jitter_ns) / 16;
+    }
+
+  state->stats_samples++;
+}
+
 static clockid_t ptp_open(FAR const char *clock)
 {
   int fd;
@@ -815,9 +980,12 @@ static int ptp_sendmsg(FAR struct ptp_state_s *state, FAR const void *buf,
   return ret;
 }
 
-/* Send PTP server announcement packet */
+/* Send PTP server announcement packet to the multicast group or, for
+ * unicast, to a single client.
+ */
 
-static int ptp_send_announce(FAR struct ptp_state_s *state)
+static int ptp_send_announce(FAR struct ptp_state_s *state, in_addr_t dest,
+                             FAR uint16_t *seq)
 {
   struct ptp_announce_s msg;
   struct sockaddr_in addr;
@@ -825,7 +993,7 @@ static int ptp_send_announce(FAR struct ptp_state_s *state)
   int ret;
 
   addr.sin_family      = AF_INET;
-  addr.sin_addr.s_addr = HTONL(PTP_MULTICAST_ADDR);
+  addr.sin_addr.s_addr = dest;
   addr.sin_port        = HTONS(PTP_UDP_PORT_INFO);
 
   memset(&msg, 0, sizeof(msg));
@@ -833,7 +1001,12 @@ static int ptp_send_announce(FAR struct ptp_state_s *state)
   msg.header.messagetype = PTP_MSGTYPE_ANNOUNCE;
   msg.header.messagelength[1] = sizeof(msg);
 
-  ptp_increment_sequence(&state->announce_seq, &msg.header);
+  if (dest != HTONL(PTP_MULTICAST_ADDR))
+    {
+      msg.header.flags[0] |= PTP_FLAGS0_UNICAST;
+    }
+
+  ptp_increment_sequence(seq, &msg.header);
   ptp_gettime(state, &ts);
   timespec_to_ptp_format(&ts, msg.origintimestamp);
 
@@ -851,31 +1024,41 @@ static int ptp_send_announce(FAR struct ptp_state_s *state)
   return ret;
 }
 
-/* Send PTP server synchronization packet */
+/* Send PTP server synchronization packet to the multicast group or, for
+ * unicast, to a single client.
+ */
 
-static int ptp_send_sync(FAR struct ptp_state_s *state)
+static int ptp_send_sync(FAR struct ptp_state_s *state, in_addr_t dest,
+                         FAR uint16_t *seq)
 {
   struct ptp_sync_s msg;
   struct sockaddr_in addr;
   struct timespec ts;
+  uint8_t unicast = 0;
   int ret;
 
   addr.sin_family      = AF_INET;
-  addr.sin_addr.s_addr = HTONL(PTP_MULTICAST_ADDR);
+  addr.sin_addr.s_addr = dest;
   addr.sin_port        = HTONS(PTP_UDP_PORT_EVENT);
 
+  if (dest != HTONL(PTP_MULTICAST_ADDR))
+    {
+      unicast = PTP_FLAGS0_UNICAST;
+    }
+
   memset(&msg, 0, sizeof(msg));
   msg.header = state->own_identity.header;
   msg.header.messagetype = PTP_MSGTYPE_SYNC;
   msg.header.messagelength[1] = sizeof(msg);
+  msg.header.flags[0] = unicast;
 
 #ifdef CONFIG_NETUTILS_PTPD_TWOSTEP_SYNC
-  msg.header.flags[0] = PTP_FLAGS0_TWOSTEP;
+  msg.header.flags[0] |= PTP_FLAGS0_TWOSTEP;
 #endif
 
   /* Timestamp and send the sync message */
 
-  ptp_increment_sequence(&state->sync_seq, &msg.header);
+  ptp_increment_sequence(seq, &msg.header);
   ptp_gettime(state, &ts);
   timespec_to_ptp_format(&ts, msg.origintimestamp);
 
@@ -890,7 +1073,7 @@ static int ptp_send_sync(FAR struct ptp_state_s *state)
 
   timespec_to_ptp_format(&ts, msg.origintimestamp);
   msg.header.messagetype = PTP_MSGTYPE_FOLLOW_UP;
-  msg.header.flags[0] = 0;
+  msg.header.flags[0] = unicast;
   addr.sin_port = HTONS(PTP_UDP_PORT_INFO);
 
   ret = ptp_sendmsg(state, &msg, sizeof(msg), &addr, sizeof(addr), NULL);
@@ -947,6 +1130,229 @@ static int ptp_send_delay_req(FAR struct ptp_state_s *state)
   return ret;
 }
 
+#if CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS > 0
+/* Big-endian fields of TLVs */
+
+static uint16_t ptp_get_be16(FAR const uint8_t *buf)
+{
+  return ((uint16_t)buf[0] << 8) | buf[1];
+}
+
+static uint32_t ptp_get_be32(FAR const uint8_t *buf)
+{
+  return ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) |
+         ((uint32_t)buf[2] << 8) | buf[3];
+}
+
+static void ptp_put_be16(FAR uint8_t *buf, uint16_t value)
+{
+  buf[0] = (uint8_t)(value >> 8);
+  buf[1] = (uint8_t)value;
+}
+
+static void ptp_put_be32(FAR uint8_t *buf, uint32_t value)
+{
+  buf[0] = (uint8_t)(value >> 24);
+  buf[1] = (uint8_t)(value >> 16);
+  buf[2] = (uint8_t)(value >> 8);
+  buf[3] = (uint8_t)value;
+}
+
+/* Map a PTP message type to PTP_UNICAST_xxx, or -1 if it cannot be
+ * granted.
+ */
+
+static int ptp_unicast_index(uint8_t msgtype)
+{
+  switch (msgtype)
+    {
+    case PTP_MSGTYPE_ANNOUNCE:
+      return PTP_UNICAST_ANNOUNCE;
+
+    case PTP_MSGTYPE_SYNC:
+      return PTP_UNICAST_SYNC;
+
+    case PTP_MSGTYPE_DELAY_RESP:
+      return PTP_UNICAST_DELAY_RESP;
+
+    default:
+      return -1;
+    }
+}
+
+/* Check if a client holds a grant for a PTP_UNICAST_xxx message type */
+
+static bool ptp_unicast_active(FAR const struct ptp_unicast_client_s *client,
+                               int index, FAR const struct timespec *now)
+{
+  return client->expiry[index] > now->tv_sec;
+}
+
+static bool ptp_unicast_inuse(FAR const struct ptp_unicast_client_s *client,
+                              FAR const struct timespec *now)
+{
+  int i;
+
+  for (i = 0; i < PTP_UNICAST_NTYPES; i++)
+    {
+      if (ptp_unicast_active(client, i, now))
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/* Find the client with the given address and port identity.  With
+ * create, a free entry is set up for a new client.
+ */
+
+static FAR struct ptp_unicast_client_s *
+ptp_unicast_find(FAR struct ptp_state_s *state, struct in_addr addr,
+                 FAR const uint8_t *identity, FAR const uint8_t *portindex,
+                 bool create)
+{
+  FAR struct ptp_unicast_client_s *client;
+  FAR struct ptp_unicast_client_s *unused = NULL;
+  struct timespec now;
+  int i;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  for (i = 0; i < CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS; i++)
+    {
+      client = &state->unicast[i];
+      if (!ptp_unicast_inuse(client, &now))
+        {
+          if (unused == NULL)
+            {
+              unused = client;
+            }
+        }
+      else if (client->addr.s_addr == addr.s_addr &&
+               memcmp(client->identity, identity,
+                      sizeof(client->identity)) == 0 &&
+               memcmp(client->portindex, portindex,
+                      sizeof(client->portindex)) == 0)
+        {
+          return client;
+        }
+    }
+
+  if (!create || unused == NULL)
+    {
+      return NULL;
+    }
+
+  memset(unused, 0, sizeof(*unused));
+  unused->addr = addr;
+  memcpy(unused->identity, identity, sizeof(unused->identity));
+  memcpy(unused->portindex, portindex, sizeof(unused->portindex));
+  return unused;
+}
+#endif /* CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS */
+
+/* Number of clients that hold a unicast grant */
+
+static int ptp_unicast_count(FAR struct ptp_state_s *state)
+{
+  int count = 0;
+#if CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS > 0
+  struct timespec now;
+  int i;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  for (i = 0; i < CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS; i++)
+    {
+      if (ptp_unicast_inuse(&state->unicast[i], &now))
+        {
+          count++;
+        }
+    }
+#else
+  UNUSED(state);
+#endif
+
+  return count;
+}
+
+/* Send the announce and sync messages that are due to unicast clients */
+
+static void ptp_unicast_send(FAR struct ptp_state_s *state,
+                             FAR const struct timespec *now)
+{
+#if CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS > 0
+  FAR struct ptp_unicast_client_s *client;
+  struct timespec delta;
+  int i;
+
+  for (i = 0; i < CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS; i++)
+    {
+      client = &state->unicast[i];
+
+      if (ptp_unicast_active(client, PTP_UNICAST_ANNOUNCE, now))
+        {
+          clock_timespec_subtract(now,
+                                  &client->last_sent[PTP_UNICAST_ANNOUNCE],
+                                  &delta);
+          if (timespec_to_ms(&delta) >=
+              client->interval_ms[PTP_UNICAST_ANNOUNCE])
+            {
+              client->last_sent[PTP_UNICAST_ANNOUNCE] = *now;
+              ptp_send_announce(state, client->addr.s_addr,
+                                &client->announce_seq);
+            }
+        }
+
+      if (ptp_unicast_active(client, PTP_UNICAST_SYNC, now))
+        {
+          clock_timespec_subtract(now, &client->last_sent[PTP_UNICAST_SYNC],
+                                  &delta);
+          if (timespec_to_ms(&delta) >=
+              client->interval_ms[PTP_UNICAST_SYNC])
+            {
+              client->last_sent[PTP_UNICAST_SYNC] = *now;
+              ptp_send_sync(state, client->addr.s_addr, &client->sync_seq);
+            }
+        }
+    }
+#else
+  UNUSED(state);
+  UNUSED(now);
+#endif
+}
+
+/* Shorten the poll timeout to the shortest granted unicast interval */
+
+static int ptp_unicast_timeout(FAR struct ptp_state_s *state, int timeout)
+{
+#if CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS > 0
+  FAR struct ptp_unicast_client_s *client;
+  struct timespec now;
+  int i;
+  int j;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  for (i = 0; i < CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS; i++)
+    {
+      client = &state->unicast[i];
+      for (j = PTP_UNICAST_ANNOUNCE; j <= PTP_UNICAST_SYNC; j++)
+        {
+          if (ptp_unicast_active(client, j, &now) &&
+              client->interval_ms[j] < timeout)
+            {
+              timeout = client->interval_ms[j];
+            }
+        }
+    }
+#else
+  UNUSED(state);
+#endif
+
+  return timeout;
+}
+
 /* Check if we need to send packets */
 
 static int ptp_periodic_send(FAR struct ptp_state_s *state)
@@ -967,7 +1373,8 @@ static int ptp_periodic_send(FAR struct ptp_state_s *state)
           > CONFIG_NETUTILS_PTPD_ANNOUNCE_INTERVAL_MSEC)
         {
           state->last_transmitted_announce = time_now;
-          ptp_send_announce(state);
+          ptp_send_announce(state, HTONL(PTP_MULTICAST_ADDR),
+                            &state->announce_seq);
         }
 
       clock_timespec_subtract(&time_now,
@@ -975,8 +1382,10 @@ static int ptp_periodic_send(FAR struct ptp_state_s *state)
       if (timespec_to_ms(&delta) > CONFIG_NETUTILS_PTPD_SYNC_INTERVAL_MSEC)
         {
           state->last_transmitted_sync = time_now;
-          ptp_send_sync(state);
+          ptp_send_sync(state, HTONL(PTP_MULTICAST_ADDR), &state->sync_seq);
         }
+
+      ptp_unicast_send(state, &time_now);
     }
 
   if (state->config->delay_e2e && state->selected_source_valid &&
@@ -1005,7 +1414,7 @@ static int ptp_process_announce(FAR struct ptp_state_s *state,
 {
   clock_gettime(CLOCK_MONOTONIC, &state->last_received_announce);
 
-  if (state->conifg->bmca && is_better_clock(msg, &state->n_identity))
+  if (state->config->bmca && is_better_clock(msg, &state->own_identity))
     {
       if (!state->selected_source_valid ||
           is_better_clock(msg, &state->selected_source))
@@ -1017,12 +1426,266 @@ static int ptp_process_announce(FAR struct ptp_state_s *state,
           state->path_delay_avgcount = 0;
           state->path_delay_ns = 0;
           state->delayreq_time.tv_sec = 0;
+          ptp_reset_stats(state);
         }
     }
 
   return OK;
 }
 
+#ifndef CONFIG_NETUTILS_PTPD_SERVO_PI
+/* Averaged drift rate servo: track drift rate based on two consecutive
+ * measurements and the adjustment that was made previously.
+ */
+
+static int ptp_servo_driftavg(FAR struct ptp_state_s *state,
+                              int64_t delta_ns,
+                              FAR const struct timespec *local_timestamp)
+{
+  int64_t absdelta_ns = (delta_ns < 0) ? -delta_ns : delta_ns;
+  int64_t drift_ppb;
+  struct timespec interval;
+  int interval_ms;
+  int max_avg_period_ms;
+  int64_t adjustment_ns;
+  int ret;
+
+  clock_timespec_subtract(local_timestamp,
+                          &state->last_delta_timestamp,
+                          &interval);
+  interval_ms = timespec_to_ms(&interval);
+
+  if (interval_ms > 0 && interval_ms < CONFIG_NETUTILS_PTPD_TIMEOUT_MS)
+    {
+      drift_ppb = (delta_ns - state->last_delta_ns) * MSEC_PER_SEC
+                  / interval_ms;
+    }
+  else
+    {
+      ptpwarn("Measurement interval out of range: %d ms\n", interval_ms);
+      drift_ppb = 0;
+      interval_ms = 1;
+    }
+
+  /* Account for the adjustment previously made */
+
+  drift_ppb += state->last_adjtime_ns * MSEC_PER_SEC
+              / CONFIG_CLOCK_ADJTIME_PERIOD_MS;
+
+  if (drift_ppb > CONFIG_CLOCK_ADJTIME_SLEWLIMIT_PPM * 1000 ||
+      drift_ppb < -CONFIG_CLOCK_ADJTIME_SLEWLIMIT_PPM * 1000)
+    {
+      ptpwarn("Drift estimate out of range: %lld\n",
+              (long long)drift_ppb);
+      drift_ppb = state->drift_ppb;
+    }
+
+  /* Take direct average of drift estimate for first measurements,
+   * after that update the exponential sliding average.
+   * Measurements are weighted according to the interval, because
+   * drift estimate is more accurate over longer timespan.
+   */
+
+  state->drift_avg_total_ms += interval_ms;
+  max_avg_period_ms = CONFIG_NETUTILS_PTPD_DRIFT_AVERAGE_S
+                      * MSEC_PER_SEC;
+  if (state->drift_avg_total_ms > max_avg_period_ms)
+    {
+      state->drift_avg_total_ms = max_avg_period_ms;
+    }
+
+  state->drift_ppb += (drift_ppb - state->drift_ppb) * interval_ms
+                    / state->drift_avg_total_ms;
+
+  /* Compute the value we need to give to adjtime() to match the
+   * drift rate.
+   */
+
+  adjustment_ns = state->drift_ppb * CONFIG_CLOCK_ADJTIME_PERIOD_MS
+                  / MSEC_PER_SEC;
+
+  /* Drift estimation ensures local clock runs at same rate as remote.
+   *
+   * Adding the current clock offset to adjustment brings the clocks
+   * to match. To avoid individual outliers from causing jitter, we
+   * take the larger signed value of two previous deltas. This is based
+   * on the logic that packets can get delayed in transit, but do not
+   * travel backwards in time.
+   *
+   * Clock offset is applied over ADJTIME_PERIOD. If there is significant
+   * noise in measurements, increasing ADJTIME_PERIOD will reduce its
+   * effect on the local clock run rate.
+   */
+
+  if (state->last_delta_ns > delta_ns)
+    {
+      adjustment_ns += state->last_delta_ns;
+    }
+  else
+    {
+      adjustment_ns += delta_ns;
+    }
+
+  /* Apply adjustment and store information for next time */
+
+  state->last_delta_ns = delta_ns;
+  state->last_delta_timestamp = *local_timestamp;
+  state->last_adjtime_ns = adjustment_ns;
+
+  ptpinfo("Delta: %+lld ns, adjustment %+lld ns, drift rate %+lld ppb\n",
+          (long long)delta_ns,
+          (long long)state->last_adjtime_ns,
+          (long long)state->drift_ppb);
+
+  if (absdelta_ns > CONFIG_NETUTILS_PTPD_ADJTIME_THRESHOLD_NS)
+    {
+      ret = ptp_adjtime(state, delta_ns, drift_ppb);
+    }
+  else
+    {
+      ret = ptp_adjtime(state, adjustment_ns, state->drift_ppb);
+    }
+
+  if (ret != OK)
+    {
+      ptperr("ptp_adjtime() failed: %d\n", errno);
+    }
+
+  return ret;
+}
+#endif /* !CONFIG_NETUTILS_PTPD_SERVO_PI */
+
+#ifdef CONFIG_NETUTILS_PTPD_SERVO_PI
+/* PI servo.  The first CONFIG_NETUTILS_PTPD_SERVO_FREQWINDOW measurements
+ * are fitted with a line whose slope is the frequency error left by the
+ * current correction.  After that, the rate correction is the clock error
+ * times KP plus the integral term, which starts at the frequency estimate
+ * and gathers the clock error times KI over time.
+ */
+
+static int ptp_servo_pi(FAR struct ptp_state_s *state, int64_t delta_ns,
+                        FAR const struct timespec *local_timestamp)
+{
+  const int64_t max_ppb = CONFIG_CLOCK_ADJTIME_SLEWLIMIT_PPM * 1000;
+  struct timespec interval;
+  int64_t interval_ms;
+  int64_t ki_term;
+  int64_t ppb;
+  int ret;
+
+  if (state->servo_count < CONFIG_NETUTILS_PTPD_SERVO_FREQWINDOW)
+    {
+      const int64_t n = CONFIG_NETUTILS_PTPD_SERVO_FREQWINDOW;
+      int64_t num;
+      int64_t den;
+      int64_t t;
+
+      if (state->servo_count == 0)
+        {
+          state->servo_start  = *local_timestamp;
+          state->servo_sum_t  = 0;
+          state->servo_sum_d  = 0;
+          state->servo_sum_tt = 0;
+          state->servo_sum_td = 0;
+        }
+
+      clock_timespec_subtract(local_timestamp, &state->servo_start,
+                              &interval);
+      t = timespec_to_ms(&interval);
+
+      state->servo_sum_t  += t;
+      state->servo_sum_d  += delta_ns;
+      state->servo_sum_tt += t * t;
+      state->servo_sum_td += t * delta_ns;
+      state->servo_count++;
+
+      state->last_delta_ns = delta_ns;
+      state->last_delta_timestamp = *local_timestamp;
+
+      if (state->servo_count < CONFIG_NETUTILS_PTPD_SERVO_FREQWINDOW)
+        {
+          return OK;
+        }
+
+      /* Least squares slope in ns per ms, i.e. ppm */
+
+      num = n * state->servo_sum_td - state->servo_sum_t * state->servo_sum_d;
+      den = n * state->servo_sum_tt - state->servo_sum_t * state->servo_sum_t;
+      if (den > 0)
+        {
+          if (num < INT64_MAX / 1000 && num > INT64_MIN / 1000)
+            {
+              ppb = num * 1000 / den;
+            }
+          else
+            {
+              ppb = num / den * 1000;
+            }
+
+          ppb += state->drift_ppb;
+          if (ppb > max_ppb || ppb < -max_ppb)
+            {
+              ptpwarn("Frequency estimate out of range: %lld ppb\n",
+                      (long long)ppb);
+              state->servo_count = 0;
+              return OK;
+            }
+
+          state->drift_ppb = ppb;
+          ptpinfo("Frequency estimate %+lld ppb\n", (long long)ppb);
+        }
+    }
+
+  clock_timespec_subtract(local_timestamp, &state->last_delta_timestamp,
+                          &interval);
+  interval_ms = timespec_to_ms(&interval);
+
+  if (interval_ms < 0 || interval_ms >= CONFIG_NETUTILS_PTPD_TIMEOUT_MS)
+    {
+      ptpwarn("Measurement interval out of range: %lld ms\n",
+              (long long)interval_ms);
+      interval_ms = 0;
+    }
+
+  ki_term = delta_ns * CONFIG_NETUTILS_PTPD_SERVO_KI * interval_ms /
+            (1000 * MSEC_PER_SEC);
+  ppb = delta_ns * CONFIG_NETUTILS_PTPD_SERVO_KP / 1000 +
+        state->drift_ppb + ki_term;
+
+  /* Stop integrating while the output is limited */
+
+  if (ppb > max_ppb)
+    {
+      ppb = max_ppb;
+    }
+  else if (ppb < -max_ppb)
+    {
+      ppb = -max_ppb;
+    }
+  else
+    {
+      state->drift_ppb += ki_term;
+    }
+
+  state->last_delta_ns = delta_ns;
+  state->last_delta_timestamp = *local_timestamp;
+  state->last_adjtime_ns = ppb * CONFIG_CLOCK_ADJTIME_PERIOD_MS /
+                           MSEC_PER_SEC;
+
+  ptpinfo("Delta: %+lld ns, adjustment %+lld ppb, frequency %+lld ppb\n",
+          (long long)delta_ns, (long long)ppb,
+          (long long)state->drift_ppb);
+
+  ret = ptp_adjtime(state, state->last_adjtime_ns, ppb);
+  if (ret != OK)
+    {
+      ptperr("ptp_adjtime() failed: %d\n", errno);
+    }
+
+  return ret;
+}
+#endif /* CONFIG_NETUTILS_PTPD_SERVO_PI */
+
 /* Update local clock either by smooth adjustment or by jumping.
  * Remote time was remote_timestamp at local_timestamp.
  */
@@ -1066,6 +1729,9 @@ static int ptp_update_local_clock(FAR struct ptp_state_s *state,
       state->last_adjtime_ns = 0;
       state->drift_avg_total_ms = 0;
       state->drift_ppb = 0;
+#ifdef CONFIG_NETUTILS_PTPD_SERVO_PI
+      state->servo_count = 0;
+#endif
 
       if (ret == OK)
         {
@@ -1079,116 +1745,13 @@ static int ptp_update_local_clock(FAR struct ptp_state_s *state,
     }
   else
     {
-      /* Track drift rate based on two consecutive measurements and
-       * the adjustment that was made previously.
-       */
-
-      int64_t drift_ppb;
-      struct timespec interval;
-      int interval_ms;
-      int max_avg_period_ms;
-      int64_t adjustment_ns;
-
-      clock_timespec_subtract(local_timestamp,
-                              &state->last_delta_timestamp,
-                              &interval);
-      interval_ms = timespec_to_ms(&interval);
-
-      if (interval_ms > 0 && interval_ms < CONFIG_NETUTILS_PTPD_TIMEOUT_MS)
-        {
-          drift_ppb = (delta_ns - state->last_delta_ns) * MSEC_PER_SEC
-                      / interval_ms;
-        }
-      else
-        {
-          ptpwarn("Measurement interval out of range: %d ms\n", interval_ms);
-          drift_ppb = 0;
-          interval_ms = 1;
-        }
-
-      /* Account for the adjustment previously made */
-
-      drift_ppb += state->last_adjtime_ns * MSEC_PER_SEC
-                  / CONFIG_CLOCK_ADJTIME_PERIOD_MS;
-
-      if (drift_ppb > CONFIG_CLOCK_ADJTIME_SLEWLIMIT_PPM * 1000 ||
-          drift_ppb < -CONFIG_CLOCK_ADJTIME_SLEWLIMIT_PPM * 1000)
-        {
-          ptpwarn("Drift estimate out of range: %lld\n",
-                  (long long)drift_ppb);
-          drift_ppb = state->drift_ppb;
-        }
-
-      /* Take direct average of drift estimate for first measurements,
-       * after that update the exponential sliding average.
-       * Measurements are weighted according to the interval, because
-       * drift estimate is more accurate over longer timespan.
-       */
-
-      state->drift_avg_total_ms += interval_ms;
-      max_avg_period_ms = CONFIG_NETUTILS_PTPD_DRIFT_AVERAGE_S
-                          * MSEC_PER_SEC;
-      if (state->drift_avg_total_ms > max_avg_period_ms)
-        {
-          state->drift_avg_total_ms = max_avg_period_ms;
-        }
-
-      state->drift_ppb += (drift_ppb - state->drift_ppb) * interval_ms
-                        / state->drift_avg_total_ms;
-
-      /* Compute the value we need to give to adjtime() to match the
-       * drift rate.
-       */
-
-      adjustment_ns = state->drift_ppb * CONFIG_CLOCK_ADJTIME_PERIOD_MS
-                      / MSEC_PER_SEC;
-
-      /* Drift estimation ensures local clock runs at same rate as remote.
-       *
-       * Adding the current clock offset to adjustment brings the clocks
-       * to match. To avoid individual outliers from causing jitter, we
-       * take the larger signed value of two previous deltas. This is based
-       * on the logic that packets can get delayed in transit, but do not
-       * travel backwards in time.
-       *
-       * Clock offset is applied over ADJTIME_PERIOD. If there is significant
-       * noise in measurements, increasing ADJTIME_PERIOD will reduce its
-       * effect on the local clock run rate.
-       */
-
-      if (state->last_delta_ns > delta_ns)
-        {
-          adjustment_ns += state->last_delta_ns;
-        }
-      else
-        {
-          adjustment_ns += delta_ns;
-        }
-
-      /* Apply adjustment and store information for next time */
-
-      state->last_delta_ns = delta_ns;
-      state->last_delta_timestamp = *local_timestamp;
-      state->last_adjtime_ns = adjustment_ns;
-
-      ptpinfo("Delta: %+lld ns, adjustment %+lld ns, drift rate %+lld ppb\n",
-              (long long)delta_ns,
-              (long long)state->last_adjtime_ns,
-              (long long)state->drift_ppb);
-
-      if (absdelta_ns > CONFIG_NETUTILS_PTPD_ADJTIME_THRESHOLD_NS)
-        {
-          ret = ptp_adjtime(state, delta_ns, drift_ppb);
-        }
-      else
-        {
-          ret = ptp_adjtime(state, adjustment_ns, state->drift_ppb);
-        }
+      ptp_update_stats(state, delta_ns);
 
-      if (ret != OK)
-        {
-          ptperr("ptp_adjtime() failed: %d\n", errno);
-        }
+#ifdef CONFIG_NETUTILS_PTPD_SERVO_PI
+      ret = ptp_servo_pi(state, delta_ns, local_timestamp);
+#else
+      ret = ptp_servo_driftavg(state, delta_ns, local_timestamp);
+#endif
 
       /* Check if clock is stable enough for sending delay requests */
 
@@ -1301,50 +1864,284 @@ static int ptp_process_followup(FAR struct ptp_state_s *state,
   return ptp_update_local_clock(state, &remote_time, &state->twostep_rxtime);
 }
 
-static int ptp_process_delay_req(FAR struct ptp_state_s *state,
-                                 FAR struct ptp_delay_req_s *msg)
+/* Send the responses to the queued delay requests */
+
+static void ptp_send_delay_resps(FAR struct ptp_state_s *state)
 {
+  FAR struct ptp_delayreq_s *req;
   struct ptp_delay_resp_s resp;
   struct sockaddr_in addr;
   int ret;
+  int i;
 
-  if (state->selected_source_valid)
+  if (state->delayreq_count == 0)
     {
-      /* We are operating as a client, ignore delay requests */
-
-      return OK;
+      return;
     }
 
-  addr.sin_family      = AF_INET;
-  addr.sin_addr.s_addr = HTONL(PTP_MULTICAST_ADDR);
-  addr.sin_port        = HTONS(PTP_UDP_PORT_INFO);
+  addr.sin_family = AF_INET;
+  addr.sin_port   = HTONS(PTP_UDP_PORT_INFO);
 
   memset(&resp, 0, sizeof(resp));
   resp.header = state->own_identity.header;
   resp.header.messagetype = PTP_MSGTYPE_DELAY_RESP;
   resp.header.messagelength[1] = sizeof(resp);
-  timespec_to_ptp_format(&state->rxtime, resp.receivetimestamp);
-  memcpy(resp.reqidentity, msg->header.sourceidentity,
-         sizeof(resp.reqidentity));
-  memcpy(resp.reqportindex, msg->header.sourceportindex,
-         sizeof(resp.reqportindex));
-  memcpy(resp.header.sequenceid, msg->header.sequenceid,
-         sizeof(resp.header.sequenceid));
   resp.header.logmessageinterval = CONFIG_NETUTILS_PTPD_DELAYRESP_INTERVAL;
 
-  ret = ptp_sendmsg(state, &resp, sizeof(resp), &addr, sizeof(addr), NULL);
-  if (ret < 0)
+  for (i = 0; i < state->delayreq_count; i++)
     {
-      ptperr("ptp sendmsg failed: %d", errno);
+      req = &state->delayreq_queue[i];
+
+      addr.sin_addr.s_addr = req->dest;
+      resp.header.flags[0] = req->dest != HTONL(PTP_MULTICAST_ADDR) ?
+                             PTP_FLAGS0_UNICAST : 0;
+      timespec_to_ptp_format(&req->rxtime, resp.receivetimestamp);
+      memcpy(resp.reqidentity, req->identity, sizeof(resp.reqidentity));
+      memcpy(resp.reqportindex, req->portindex,
+             sizeof(resp.reqportindex));
+      memcpy(resp.header.sequenceid, req->sequenceid,
+             sizeof(resp.header.sequenceid));
+
+      ret = ptp_sendmsg(state, &resp, sizeof(resp), &addr, sizeof(addr),
+                        NULL);
+      if (ret < 0)
+        {
+          ptperr("ptp sendmsg failed: %d", errno);
+        }
+      else
+        {
+          state->delayresp_count++;
+          ptpinfo("Sent delay resp, seq %ld\n",
+                  (long)ptp_get_sequence(&resp.header));
+        }
     }
-  else
+
+  clock_gettime(CLOCK_MONOTONIC, &state->last_transmitted_delayresp);
+  state->delayreq_count = 0;
+}
+
+/* Process a signaling message: grant or cancel unicast transmission as
+ * requested by its TLVs, and answer with the corresponding TLVs.
+ */
+
+static int ptp_process_signaling(FAR struct ptp_state_s *state,
+                                 FAR struct ptp_signaling_s *msg,
+                                 ssize_t length)
+{
+#if CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS > 0
+  static const uint8_t any_identity[8] =
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+  };
+
+  FAR struct ptp_unicast_client_s *client;
+  FAR const struct ptp_unicast_tlv_s *req;
+  FAR struct ptp_unicast_tlv_s *ans;
+  FAR struct ptp_signaling_s *resp;
+  FAR const uint8_t *tlv;
+  FAR const uint8_t *end;
+  struct sockaddr_in addr;
+  struct timespec now;
+  uint8_t txbuf[sizeof(struct ptp_signaling_s) +
+                8 * sizeof(struct ptp_unicast_tlv_s)];
+  uint32_t duration;
+  uint16_t type;
+  uint16_t len;
+  size_t txlen;
+  int8_t loginterval;
+  int index;
+  int ret;
+
+  if (state->config->client_only || state->selected_source_valid ||
+      state->config->af != AF_INET ||
+      length < (ssize_t)sizeof(struct ptp_signaling_s))
     {
-      clock_gettime(CLOCK_MONOTONIC, &state->last_transmitted_delayresp);
-      ptpinfo("Sent delay resp, seq %ld\n",
-              (long)ptp_get_sequence(&msg->header));
+      return OK;
+    }
+
+  if (memcmp(msg->targetidentity, any_identity,
+             sizeof(msg->targetidentity)) != 0 &&
+      memcmp(msg->targetidentity, state->own_identity.header.sourceidentity,
+             sizeof(msg->targetidentity)) != 0)
+    {
+      return OK; /* Addressed to another clock */
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  client = ptp_unicast_find(state, state->rxaddr.sin_addr,
+                            msg->header.sourceidentity,
+                            msg->header.sourceportindex, true);
+
+  resp = (FAR struct ptp_signaling_s *)txbuf;
+  memset(resp, 0, sizeof(*resp));
+  resp->header = state->own_identity.header;
+  resp->header.messagetype = PTP_MSGTYPE_SIGNALING;
+  resp->header.flags[0] = PTP_FLAGS0_UNICAST;
+  resp->header.controlfield = 5; /* All others */
+  resp->header.logmessageinterval = 0x7f;
+  memcpy(resp->header.sequenceid, msg->header.sequenceid,
+         sizeof(resp->header.sequenceid));
+  memcpy(resp->targetidentity, msg->header.sourceidentity,
+         sizeof(resp->targetidentity));
+  memcpy(resp->targetportindex, msg->header.sourceportindex,
+         sizeof(resp->targetportindex));
+  txlen = sizeof(*resp);
+
+  tlv = (FAR const uint8_t *)(msg + 1);
+  end = state->rxbuf.raw + length;
+
+  while (end - tlv >= (ssize_t)sizeof(struct ptp_tlv_s) &&
+         txlen + sizeof(struct ptp_unicast_tlv_s) <= sizeof(txbuf))
+    {
+      req  = (FAR const struct ptp_unicast_tlv_s *)tlv;
+      type = ptp_get_be16(req->tlv.type);
+      len  = ptp_get_be16(req->tlv.length);
+      if (len > end - tlv - sizeof(struct ptp_tlv_s))
+        {
+          break;
+        }
+
+      tlv += sizeof(struct ptp_tlv_s) + len;
+      index = ptp_unicast_index(req->messagetype >> 4);
+      ans = (FAR struct ptp_unicast_tlv_s *)&txbuf[txlen];
+      memset(ans, 0, sizeof(*ans));
+      ans->messagetype = req->messagetype & 0xf0;
+
+      if (type == PTP_TLV_REQUEST_UNICAST &&
+          len >= PTP_TLVLEN_REQUEST_UNICAST)
+        {
+          duration = ptp_get_be32(req->duration);
+          loginterval = req->loginterval;
+
+          if (loginterval < PTP_UNICAST_MIN_LOGINTERVAL)
+            {
+              loginterval = PTP_UNICAST_MIN_LOGINTERVAL;
+            }
+          else if (loginterval > PTP_UNICAST_MAX_LOGINTERVAL)
+            {
+              loginterval = PTP_UNICAST_MAX_LOGINTERVAL;
+            }
+
+          if (duration > CONFIG_NETUTILS_PTPD_UNICAST_MAXDURATION)
+            {
+              duration = CONFIG_NETUTILS_PTPD_UNICAST_MAXDURATION;
+            }
+
+          /* A grant with zero duration denies the request */
+
+          if (client == NULL || index < 0)
+            {
+              duration = 0;
+            }
+          else if (duration > 0)
+            {
+              client->expiry[index] = now.tv_sec + duration;
+              client->interval_ms[index] = loginterval >= 0 ?
+                                           MSEC_PER_SEC << loginterval :
+                                           MSEC_PER_SEC >> -loginterval;
+            }
+
+          ptpinfo("Unicast grant type %d for %d s, log interval %d\n",
+                  req->messagetype >> 4, (int)duration, loginterval);
+
+          ptp_put_be16(ans->tlv.type, PTP_TLV_GRANT_UNICAST);
+          ptp_put_be16(ans->tlv.length, PTP_TLVLEN_GRANT_UNICAST);
+          ans->loginterval = loginterval;
+          ptp_put_be32(ans->duration, duration);
+          ans->renewal = PTP_GRANT_RENEWAL;
+          txlen += sizeof(struct ptp_tlv_s) + PTP_TLVLEN_GRANT_UNICAST;
+        }
+      else if (type == PTP_TLV_CANCEL_UNICAST &&
+               len >= PTP_TLVLEN_CANCEL_UNICAST)
+        {
+          if (client != NULL && index >= 0)
+            {
+              client->expiry[index] = 0;
+            }
+
+          ptp_put_be16(ans->tlv.type, PTP_TLV_ACK_CANCEL_UNICAST);
+          ptp_put_be16(ans->tlv.length, PTP_TLVLEN_CANCEL_UNICAST);
+          txlen += sizeof(struct ptp_tlv_s) + PTP_TLVLEN_CANCEL_UNICAST;
+        }
+    }
+
+  if (txlen == sizeof(*resp))
+    {
+      return OK;
+    }
+
+  resp->header.messagelength[0] = (uint8_t)(txlen >> 8);
+  resp->header.messagelength[1] = (uint8_t)txlen;
+
+  addr.sin_family = AF_INET;
+  addr.sin_addr   = state->rxaddr.sin_addr;
+  addr.sin_port   = HTONS(PTP_UDP_PORT_INFO);
+
+  ret = ptp_sendmsg(state, txbuf, txlen, &addr, sizeof(addr), NULL);
+  if (ret < 0)
+    {
+      ptperr("ptp sendmsg for signaling failed: %d\n", errno);
     }
 
   return ret;
+#else
+  UNUSED(state);
+  UNUSED(msg);
+  UNUSED(length);
+  return OK;
+#endif /* CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS */
+}
+
+/* Queue a delay request.  The responses are sent by
+ * ptp_send_delay_resps() once the pending requests have been read.
+ */
+
+static int ptp_process_delay_req(FAR struct ptp_state_s *state,
+                                 FAR struct ptp_delay_req_s *msg)
+{
+  FAR struct ptp_delayreq_s *req;
+#if CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS > 0
+  FAR struct ptp_unicast_client_s *client;
+  struct timespec now;
+#endif
+
+  if (state->selected_source_valid)
+    {
+      /* We are operating as a client, ignore delay requests */
+
+      return OK;
+    }
+
+  if (state->delayreq_count == CONFIG_NETUTILS_PTPD_DELAYRESP_BATCH)
+    {
+      ptp_send_delay_resps(state);
+    }
+
+  req = &state->delayreq_queue[state->delayreq_count++];
+  req->rxtime = state->rxtime;
+  req->dest = HTONL(PTP_MULTICAST_ADDR);
+  memcpy(req->identity, msg->header.sourceidentity,
+         sizeof(req->identity));
+  memcpy(req->portindex, msg->header.sourceportindex,
+         sizeof(req->portindex));
+  memcpy(req->sequenceid, msg->header.sequenceid,
+         sizeof(req->sequenceid));
+
+#if CONFIG_NETUTILS_PTPD_UNICAST_MAXCLIENTS > 0
+  /* Answer clients with a delay response grant directly */
+
+  client = ptp_unicast_find(state, state->rxaddr.sin_addr,
+                            msg->header.sourceidentity,
+                            msg->header.sourceportindex, false);
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (client != NULL &&
+      ptp_unicast_active(client, PTP_UNICAST_DELAY_RESP, &now))
+    {
+      req->dest = client->addr.s_addr;
+    }
+#endif
+
+  return OK;
 }
 
 static int ptp_process_delay_resp(FAR struct ptp_state_s *state,
@@ -1487,6 +2284,11 @@ static int ptp_process_rx_packet(FAR struct ptp_state_s *state,
               (long)ptp_get_sequence(&state->rxbuf.header));
       return ptp_process_delay_req(state, &state->rxbuf.delay_req);
 
+    case PTP_MSGTYPE_SIGNALING:
+      ptpinfo("Got signaling, seq %ld\n",
+              (long)ptp_get_sequence(&state->rxbuf.header));
+      return ptp_process_signaling(state, &state->rxbuf.signaling, length);
+
     default:
       ptpinfo("Ignoring unknown PTP packet type: 0x%02x\n",
               state->rxbuf.header.messagetype);
@@ -1575,6 +2377,19 @@ static void ptp_process_statusreq(FAR struct ptp_state_s *state)
   status->drift_ppb         = state->drift_ppb;
   status->path_delay_ns     = state->path_delay_ns;
 
+  /* Copy statistics */
+
+  status->samples           = state->stats_samples;
+  status->offset_min_ns     = state->stats_offset_min_ns;
+  status->offset_max_ns     = state->stats_offset_max_ns;
+  status->jitter_ns         = state->stats_jitter_ns;
+  memcpy(status->offset_histogram, state->offset_histogram,
+         sizeof(status->offset_histogram));
+  memcpy(status->jitter_histogram, state->jitter_histogram,
+         sizeof(status->jitter_histogram));
+  status->unicast_clients   = ptp_unicast_count(state);
+  status->delayresp_count   = state->delayresp_count;
+
   /* Copy timestamps */
 
   status->last_received_multicast    = state->last_received_multicast;
@@ -1621,9 +2436,11 @@ int ptpd_start(FAR const struct ptpd_config_s *config)
   struct pollfd pollfds[2];
   struct msghdr rxhdr;
   struct iovec rxiov;
+  socklen_t addrlen;
   int timeout;
   int idx = 1;
   int ret;
+  int i;
 
   memset(&rxhdr, 0, sizeof(rxhdr));
   memset(&rxiov, 0, sizeof(rxiov));
@@ -1665,40 +2482,57 @@ int ptpd_start(FAR const struct ptpd_config_s *config)
     {
       state->can_send_delayreq = false;
 
-      rxhdr.msg_name = NULL;
-      rxhdr.msg_namelen = 0;
-      rxhdr.msg_iov = &rxiov;
-      rxhdr.msg_iovlen = 1;
-      rxhdr.msg_control = &state->rxcmsg;
-      rxhdr.msg_controllen = sizeof(state->rxcmsg);
-      rxhdr.msg_flags = 0;
-      rxiov.iov_base = &state->rxbuf;
-      rxiov.iov_len = sizeof(state->rxbuf);
-
       pollfds[0].revents = 0;
       pollfds[1].revents = 0;
-      ret = poll(pollfds, idx, timeout);
+      ret = poll(pollfds, idx, ptp_unicast_timeout(state, timeout));
 
       if (pollfds[0].revents)
         {
-          /* Receive time-critical packet, potentially with cmsg
-           * indicating the timestamp.
+          /* Receive time-critical packets, potentially with cmsg
+           * indicating the timestamp.  With many clients, delay requests
+           * arrive in bursts: read them all before sending the responses
+           * so that the receive timestamps are not delayed.
            */
 
-          ret = recvmsg(state->event_socket, &rxhdr, MSG_DONTWAIT);
-          if (ret > 0)
+          for (i = 0; i < CONFIG_NETUTILS_PTPD_DELAYRESP_BATCH; i++)
             {
+              rxhdr.msg_name = NULL;
+              rxhdr.msg_namelen = 0;
+              rxhdr.msg_iov = &rxiov;
+              rxhdr.msg_iovlen = 1;
+              rxhdr.msg_control = &state->rxcmsg;
+              rxhdr.msg_controllen = sizeof(state->rxcmsg);
+              rxhdr.msg_flags = 0;
+              rxiov.iov_base = &state->rxbuf;
+              rxiov.iov_len = sizeof(state->rxbuf);
+
+              if (config->af == AF_INET)
+                {
+                  rxhdr.msg_name = &state->rxaddr;
+                  rxhdr.msg_namelen = sizeof(state->rxaddr);
+                }
+
+              ret = recvmsg(state->event_socket, &rxhdr, MSG_DONTWAIT);
+              if (ret <= 0)
+                {
+                  break;
+                }
+
               ptp_getrxtime(state, &rxhdr, &state->rxtime);
               ptp_process_rx_packet(state, ret);
             }
+
+          ptp_send_delay_resps(state);
         }
 
       if (pollfds[1].revents)
         {
           /* Receive non-time-critical packet. */
 
-          ret = recv(state->info_socket, &state->rxbuf, sizeof(state->rxbuf),
-                     MSG_DONTWAIT);
+          addrlen = sizeof(state->rxaddr);
+          ret = recvfrom(state->info_socket, &state->rxbuf,
+                         sizeof(state->rxbuf), MSG_DONTWAIT,
+                         (FAR struct sockaddr *)&state->rxaddr, &addrlen);
           if (ret > 0)
             {
               ptp_process_rx_packet(state, ret);
@@ -54,10 +54,29 @@
 #define PTP_MSGTYPE_FOLLOW_UP     8
 #define PTP_MSGTYPE_DELAY_RESP    9
 #define PTP_MSGTYPE_ANNOUNCE     11
+#define PTP_MSGTYPE_SIGNALING    12
 
 /* Message flags */
 
 #define PTP_FLAGS0_TWOSTEP        (1 << 1)
+#define PTP_FLAGS0_UNICAST        (1 << 2)
+
+/* TLV types for unicast negotiation (IEEE 1588-2008 section 16.1) */
+
+#define PTP_TLV_REQUEST_UNICAST    0x0004
+#define PTP_TLV_GRANT_UNICAST      0x0005
+#define PTP_TLV_CANCEL_UNICAST     0x0006
+#define PTP_TLV_ACK_CANCEL_UNICAST 0x0007
+
+/* Value length of the unicast negotiation TLVs */
+
+#define PTP_TLVLEN_REQUEST_UNICAST 6
+#define PTP_TLVLEN_GRANT_UNICAST   8
+#define PTP_TLVLEN_CANCEL_UNICAST  2
+
+/* GRANT_UNICAST_TRANSMISSION renewal flag */
+
+#define PTP_GRANT_RENEWAL          (1 << 0)
 
 /****************************************************************************
  * Public Types
@@ -136,4 +155,36 @@ begin_packed_struct struct ptp_delay_resp_s
   uint8_t reqportindex[2];
 } end_packed_struct;
 
+/* Signaling: carries TLVs, e.g. for unicast negotiation */
+
+begin_packed_struct struct ptp_signaling_s
+{
+  struct ptp_header_s header;
+  uint8_t targetidentity[8];
+  uint8_t targetportindex[2];
+} end_packed_struct;
+
+/* Common TLV header */
+
+begin_packed_struct struct ptp_tlv_s
+{
+  uint8_t type[2];
+  uint8_t length[2];
+} end_packed_struct;
+
+/* REQUEST_UNICAST_TRANSMISSION, GRANT_UNICAST_TRANSMISSION and the
+ * CANCEL TLVs.  Requests end after duration, cancellations after
+ * messagetype.
+ */
+
+begin_packed_struct struct ptp_unicast_tlv_s
+{
+  struct ptp_tlv_s tlv;
+  uint8_t messagetype;  /* Message type in the upper nibble */
+  int8_t loginterval;   /* log2 of the message interval in seconds */
+  uint8_t duration[4];  /* Duration of the grant in seconds */
+  uint8_t reserved;
+  uint8_t renewal;      /* PTP_GRANT_RENEWAL */
+} end_packed_struct;
+
 #endif /* __APPS_NETUTILS_PTPD_PTPV2_H */
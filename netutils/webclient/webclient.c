@@ -64,6 +64,9 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
@@ -111,6 +114,24 @@
 #  define CONFIG_WEBCLIENT_MAX_REDIRECT 50
 #endif
 
+#if !defined(CONFIG_WEBCLIENT_DNSCACHE) || !defined(CONFIG_LIBC_NETDB)
+#  undef CONFIG_WEBCLIENT_DNSCACHE
+#  define CONFIG_WEBCLIENT_DNSCACHE 0
+#endif
+
+#ifndef CONFIG_WEBCLIENT_DNSCACHE_TTL
+#  define CONFIG_WEBCLIENT_DNSCACHE_TTL 60
+#endif
+
+#ifndef CONFIG_WEBCLIENT_TLS_SESSIONS
+#  define CONFIG_WEBCLIENT_TLS_SESSIONS 0
+#endif
+
+#if defined(CONFIG_WEBCLIENT_KEEPALIVE) || \
+    CONFIG_WEBCLIENT_DNSCACHE > 0 || CONFIG_WEBCLIENT_TLS_SESSIONS > 0
+#  define WEBCLIENT_HAVE_CACHE
+#endif
+
 #define HTTPSTATUS_NONE            0
 #define HTTPSTATUS_OK              1
 #define HTTPSTATUS_MOVED           2
@@ -166,6 +187,10 @@ enum webclient_state_e
 #define WGET_FLAG_GOT_CONTENT_LENGTH 1U
 #define WGET_FLAG_CHUNKED            2U
 #define WGET_FLAG_GOT_LOCATION       4U
+#define WGET_FLAG_CONN_CLOSE         8U  /* The server closes the conn */
+#define WGET_FLAG_REUSED             16U /* The connection is from the pool */
+#define WGET_FLAG_NO_REUSE           32U /* Open a new connection */
+#define WGET_FLAG_KEEP_CONN          64U /* Return the connection to pool */
 
 struct wget_target_s
 {
@@ -224,6 +249,41 @@ struct wget_s
   FAR struct webclient_context *tunnel;
 };
 
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+/* An idle connection kept for reuse */
+
+struct webclient_pool_s
+{
+  bool inuse;
+  uint16_t port;
+  char hostname[CONFIG_WEBCLIENT_MAXHOSTNAME];
+  struct webclient_conn_s conn;
+  time_t idle;       /* When the connection became idle */
+};
+#endif
+
+#if CONFIG_WEBCLIENT_DNSCACHE > 0
+struct webclient_dns_s
+{
+  char hostname[CONFIG_WEBCLIENT_MAXHOSTNAME];
+  struct in_addr addr;
+  time_t expiry;
+};
+#endif
+
+#if CONFIG_WEBCLIENT_TLS_SESSIONS > 0
+/* A TLS session saved for resumption */
+
+struct webclient_session_s
+{
+  uint16_t port;
+  char hostname[CONFIG_WEBCLIENT_MAXHOSTNAME];
+  FAR const struct webclient_tls_ops *tls_ops;
+  FAR void *tls_ctx;
+  FAR struct webclient_tls_session *session;
+};
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -235,6 +295,9 @@ static const char g_httpcontenttype[]      = "content-type: ";
 #endif
 static const char g_httphost[]             = "host: ";
 static const char g_httplocation[]         = "location: ";
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+static const char g_httpconnection[]       = "connection: ";
+#endif
 static const char g_httptransferencoding[] = "transfer-encoding: ";
 
 static const char g_httpuseragentfields[] =
@@ -253,6 +316,28 @@ static const char g_httpconn[]       = "Connection: Keep-Alive";
 static const char g_httpcache[]      = "Cache-Control: no-cache";
 #endif
 
+#ifdef WEBCLIENT_HAVE_CACHE
+/* Protects the connection pool and the caches below */
+
+static pthread_mutex_t g_webclient_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+static struct webclient_pool_s
+  g_webclient_pool[CONFIG_WEBCLIENT_KEEPALIVE_MAXCONNS];
+#endif
+
+#if CONFIG_WEBCLIENT_DNSCACHE > 0
+static struct webclient_dns_s g_webclient_dns[CONFIG_WEBCLIENT_DNSCACHE];
+static int g_webclient_dnsnext;
+#endif
+
+#if CONFIG_WEBCLIENT_TLS_SESSIONS > 0
+static struct webclient_session_s
+  g_webclient_sessions[CONFIG_WEBCLIENT_TLS_SESSIONS];
+static int g_webclient_sessionnext;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -497,7 +582,16 @@ static inline int wget_parsestatus(struct webclient_context *ctx,
           ws->state = WEBCLIENT_STATE_HEADERS;
           ws->internal_flags &= ~(WGET_FLAG_GOT_CONTENT_LENGTH |
                                   WGET_FLAG_CHUNKED |
-                                  WGET_FLAG_GOT_LOCATION);
+                                  WGET_FLAG_GOT_LOCATION |
+                                  WGET_FLAG_CONN_CLOSE);
+
+          /* An HTTP/1.0 server closes the connection by default */
+
+          if (strncmp(ws->line, g_http10, strlen(g_http10)) == 0)
+            {
+              ws->internal_flags |= WGET_FLAG_CONN_CLOSE;
+            }
+
           ndx = 0;
           break;
         }
@@ -756,6 +850,17 @@ static inline int wget_parseheaders(struct webclient_context *ctx,
                   ninfo("transfer encodings: '%s'\n", encodings);
                   ws->internal_flags |= WGET_FLAG_CHUNKED;
                 }
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+              else if (strncasecmp(ws->line, g_httpconnection,
+                                   strlen(g_httpconnection)) == 0)
+                {
+                  if (strcasestr(ws->line + strlen(g_httpconnection),
+                                 "close") != NULL)
+                    {
+                      ws->internal_flags |= WGET_FLAG_CONN_CLOSE;
+                    }
+                }
+#endif
             }
 
           if (found && !got_nl)
@@ -1018,6 +1123,542 @@ static inline int wget_parsechunktrailer(struct webclient_context *ctx,
   return ret;
 }
 
+/****************************************************************************
+ * Name: webclient_now
+ ****************************************************************************/
+
+#ifdef WEBCLIENT_HAVE_CACHE
+static time_t webclient_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec;
+}
+#endif
+
+/****************************************************************************
+ * Name: webclient_dns_get
+ *
+ * Description:
+ *   Look up a host name in the DNS cache.
+ *
+ ****************************************************************************/
+
+#if CONFIG_WEBCLIENT_DNSCACHE > 0
+static bool webclient_dns_get(FAR const char *hostname,
+                              FAR struct in_addr *dest)
+{
+  FAR struct webclient_dns_s *entry;
+  time_t now = webclient_now();
+  bool found = false;
+  int i;
+
+  pthread_mutex_lock(&g_webclient_lock);
+  for (i = 0; i < CONFIG_WEBCLIENT_DNSCACHE; i++)
+    {
+      entry = &g_webclient_dns[i];
+      if (entry->hostname[0] != '\0' && entry->expiry > now &&
+          strcmp(entry->hostname, hostname) == 0)
+        {
+          *dest = entry->addr;
+          found = true;
+          break;
+        }
+    }
+
+  pthread_mutex_unlock(&g_webclient_lock);
+  return found;
+}
+#endif
+
+/****************************************************************************
+ * Name: webclient_dns_put
+ *
+ * Description:
+ *   Remember the address of a host name.  An expired entry is reused
+ *   first, else the entries are replaced in turn.
+ *
+ ****************************************************************************/
+
+#if CONFIG_WEBCLIENT_DNSCACHE > 0
+static void webclient_dns_put(FAR const char *hostname,
+                              FAR const struct in_addr *addr)
+{
+  FAR struct webclient_dns_s *entry = NULL;
+  time_t now = webclient_now();
+  int i;
+
+  pthread_mutex_lock(&g_webclient_lock);
+  for (i = 0; i < CONFIG_WEBCLIENT_DNSCACHE; i++)
+    {
+      if (strcmp(g_webclient_dns[i].hostname, hostname) == 0)
+        {
+          entry = &g_webclient_dns[i];
+          break;
+        }
+      else if (entry == NULL && g_webclient_dns[i].expiry <= now)
+        {
+          entry = &g_webclient_dns[i];
+        }
+    }
+
+  if (entry == NULL)
+    {
+      entry = &g_webclient_dns[g_webclient_dnsnext];
+      g_webclient_dnsnext = (g_webclient_dnsnext + 1) %
+                            CONFIG_WEBCLIENT_DNSCACHE;
+    }
+
+  strlcpy(entry->hostname, hostname, sizeof(entry->hostname));
+  entry->addr   = *addr;
+  entry->expiry = now + CONFIG_WEBCLIENT_DNSCACHE_TTL;
+  pthread_mutex_unlock(&g_webclient_lock);
+}
+#endif
+
+/****************************************************************************
+ * Name: webclient_dns_forget
+ ****************************************************************************/
+
+#if CONFIG_WEBCLIENT_DNSCACHE > 0
+static void webclient_dns_forget(FAR const char *hostname)
+{
+  int i;
+
+  pthread_mutex_lock(&g_webclient_lock);
+  for (i = 0; i < CONFIG_WEBCLIENT_DNSCACHE; i++)
+    {
+      if (strcmp(g_webclient_dns[i].hostname, hostname) == 0)
+        {
+          g_webclient_dns[i].hostname[0] = '\0';
+        }
+    }
+
+  pthread_mutex_unlock(&g_webclient_lock);
+}
+#else
+#  define webclient_dns_forget(hostname)
+#endif
+
+/****************************************************************************
+ * Name: wget_keepalive
+ *
+ * Description:
+ *   Return true if the connection of the request may be kept open.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+static bool wget_keepalive(FAR const struct webclient_context *ctx)
+{
+  if ((ctx->flags & WEBCLIENT_FLAG_KEEP_ALIVE) == 0 ||
+      (ctx->flags & (WEBCLIENT_FLAG_NON_BLOCKING |
+                     WEBCLIENT_FLAG_TUNNEL)) != 0 ||
+      ctx->protocol_version != WEBCLIENT_PROTOCOL_VERSION_HTTP_1_1 ||
+      ctx->proxy != NULL)
+    {
+      return false;
+    }
+
+#if defined(CONFIG_WEBCLIENT_NET_LOCAL)
+  return ctx->unix_socket_path == NULL;
+#else
+  return true;
+#endif
+}
+#else
+#  define wget_keepalive(ctx) false
+#endif
+
+/****************************************************************************
+ * Name: wget_responsedone
+ *
+ * Description:
+ *   Return true once the whole response has been received, without
+ *   waiting for the server to close the connection.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+static bool wget_responsedone(FAR struct webclient_context *ctx,
+                              FAR struct wget_s *ws)
+{
+  if (ws->state == WEBCLIENT_STATE_WAIT_CLOSE)
+    {
+      /* The last chunk and the trailer have been received */
+
+      return true;
+    }
+
+  if (ws->state != WEBCLIENT_STATE_DATA)
+    {
+      return false;
+    }
+
+  /* Responses without a body */
+
+  if (strcmp(ctx->method, "HEAD") == 0 || ctx->http_status == 204 ||
+      ctx->http_status == 304)
+    {
+      return true;
+    }
+
+  return (ws->internal_flags & WGET_FLAG_GOT_CONTENT_LENGTH) != 0 &&
+         ws->received_body_len == ws->expected_resp_body_len;
+}
+#endif
+
+/****************************************************************************
+ * Name: webclient_conn_alive
+ *
+ * Description:
+ *   Check an idle connection before reusing it and apply the timeout of
+ *   the new request.  Data or EOF on an idle socket means that the server
+ *   has given it up.  TLS connections are left to the retry in
+ *   webclient_perform().
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+static bool webclient_conn_alive(FAR struct webclient_conn_s *conn,
+                                 unsigned int timeout_sec)
+{
+  struct pollfd pfd;
+  struct timeval tv;
+
+  if (conn->tls)
+    {
+      return true;
+    }
+
+  pfd.fd      = conn->sockfd;
+  pfd.events  = POLLIN;
+  pfd.revents = 0;
+  if (poll(&pfd, 1, 0) != 0)
+    {
+      return false;
+    }
+
+  tv.tv_sec  = timeout_sec;
+  tv.tv_usec = 0;
+
+  return setsockopt(conn->sockfd, SOL_SOCKET, SO_RCVTIMEO,
+                    &tv, sizeof(struct timeval)) == 0 &&
+         setsockopt(conn->sockfd, SOL_SOCKET, SO_SNDTIMEO,
+                    &tv, sizeof(struct timeval)) == 0;
+}
+#endif
+
+/****************************************************************************
+ * Name: webclient_pool_get
+ *
+ * Description:
+ *   Take an idle connection to the target of the request out of the pool.
+ *
+ * Returned Value:
+ *   true if conn has been set up with a connection from the pool.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+static bool webclient_pool_get(FAR struct webclient_context *ctx,
+                               FAR struct wget_s *ws,
+                               FAR struct webclient_conn_s *conn)
+{
+  FAR struct webclient_pool_s *entry;
+  struct webclient_conn_s idle;
+  time_t now = webclient_now();
+  time_t since;
+  bool found;
+  int i;
+
+  do
+    {
+      found = false;
+
+      pthread_mutex_lock(&g_webclient_lock);
+      for (i = 0; i < CONFIG_WEBCLIENT_KEEPALIVE_MAXCONNS; i++)
+        {
+          entry = &g_webclient_pool[i];
+          if (entry->inuse && entry->conn.tls == conn->tls &&
+              entry->port == ws->target.port &&
+              (!conn->tls || (entry->conn.tls_ops == ctx->tls_ops &&
+                              entry->conn.tls_ctx == ctx->tls_ctx)) &&
+              strcmp(entry->hostname, ws->target.hostname) == 0)
+            {
+              idle          = entry->conn;
+              since         = entry->idle;
+              entry->inuse  = false;
+              found         = true;
+              break;
+            }
+        }
+
+      pthread_mutex_unlock(&g_webclient_lock);
+
+      if (found)
+        {
+          if (now - since <= CONFIG_WEBCLIENT_KEEPALIVE_IDLETIME &&
+              webclient_conn_alive(&idle, ctx->timeout_sec))
+            {
+              ninfo("Reusing connection to %s:%u\n",
+                    ws->target.hostname, ws->target.port);
+              *conn = idle;
+              return true;
+            }
+
+          webclient_conn_close(&idle);
+        }
+    }
+  while (found);
+
+  return false;
+}
+#endif
+
+/****************************************************************************
+ * Name: webclient_pool_put
+ *
+ * Description:
+ *   Keep the connection of a completed request for reuse.  The connection
+ *   idle for the longest time makes room if the pool is full.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+static void webclient_pool_put(FAR struct wget_s *ws,
+                               FAR struct webclient_conn_s *conn)
+{
+  FAR struct webclient_pool_s *entry = NULL;
+  struct webclient_conn_s victim;
+  bool evict = false;
+  int i;
+
+  pthread_mutex_lock(&g_webclient_lock);
+  for (i = 0; i < CONFIG_WEBCLIENT_KEEPALIVE_MAXCONNS; i++)
+    {
+      if (!g_webclient_pool[i].inuse)
+        {
+          entry = &g_webclient_pool[i];
+          break;
+        }
+
+      if (entry == NULL || g_webclient_pool[i].idle < entry->idle)
+        {
+          entry = &g_webclient_pool[i];
+        }
+    }
+
+  if (entry->inuse)
+    {
+      victim = entry->conn;
+      evict  = true;
+    }
+
+  strlcpy(entry->hostname, ws->target.hostname, sizeof(entry->hostname));
+  entry->port  = ws->target.port;
+  entry->conn  = *conn;
+  entry->idle  = webclient_now();
+  entry->inuse = true;
+  pthread_mutex_unlock(&g_webclient_lock);
+
+  if (evict)
+    {
+      webclient_conn_close(&victim);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: wget_retry
+ *
+ * Description:
+ *   Decide whether a request that failed on a reused connection is sent
+ *   again on a new connection.  Servers may close an idle connection at
+ *   any time, which shows as an error or EOF before any response arrives.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+static bool wget_retry(FAR struct webclient_context *ctx,
+                       FAR struct wget_s *ws)
+{
+  if ((ws->internal_flags & WGET_FLAG_REUSED) == 0)
+    {
+      return false;
+    }
+
+  /* Nothing of the response may have been received */
+
+  if (ws->state != WEBCLIENT_STATE_SEND_REQUEST &&
+      ws->state != WEBCLIENT_STATE_SEND_REQUEST_BODY &&
+      (ws->state != WEBCLIENT_STATE_STATUSLINE || ws->ndx != 0 ||
+       ws->datend != 0))
+    {
+      return false;
+    }
+
+  /* The body must be available again */
+
+  if (ctx->bodylen != 0 &&
+      ctx->body_callback != webclient_static_body_func)
+    {
+      return false;
+    }
+
+  nwarn("WARNING: Reused connection closed, reconnecting\n");
+  webclient_conn_close(ws->conn);
+  ws->need_conn_close = false;
+  ws->internal_flags &= ~WGET_FLAG_REUSED;
+  ws->internal_flags |= WGET_FLAG_NO_REUSE;
+  ws->state = WEBCLIENT_STATE_SOCKET;
+  return true;
+}
+#else
+#  define wget_retry(ctx, ws) false
+#endif
+
+/****************************************************************************
+ * Name: webclient_session_take
+ *
+ * Description:
+ *   Take the TLS session saved for the target of the request, if any.
+ *   The caller frees it with tls_ops->free_session().
+ *
+ ****************************************************************************/
+
+#if CONFIG_WEBCLIENT_TLS_SESSIONS > 0
+static FAR struct webclient_tls_session *
+webclient_session_take(FAR struct webclient_context *ctx,
+                       FAR struct wget_s *ws)
+{
+  FAR struct webclient_tls_session *session = NULL;
+  FAR struct webclient_session_s *entry;
+  int i;
+
+  pthread_mutex_lock(&g_webclient_lock);
+  for (i = 0; i < CONFIG_WEBCLIENT_TLS_SESSIONS; i++)
+    {
+      entry = &g_webclient_sessions[i];
+      if (entry->session != NULL && entry->port == ws->target.port &&
+          entry->tls_ops == ctx->tls_ops && entry->tls_ctx == ctx->tls_ctx &&
+          strcmp(entry->hostname, ws->target.hostname) == 0)
+        {
+          session        = entry->session;
+          entry->session = NULL;
+          break;
+        }
+    }
+
+  pthread_mutex_unlock(&g_webclient_lock);
+  return session;
+}
+#endif
+
+/****************************************************************************
+ * Name: webclient_session_save
+ *
+ * Description:
+ *   Save the session of a new TLS connection.  Empty entries are used
+ *   first, else the entries are replaced in turn.
+ *
+ ****************************************************************************/
+
+#if CONFIG_WEBCLIENT_TLS_SESSIONS > 0
+static void webclient_session_save(FAR struct webclient_context *ctx,
+                                   FAR struct wget_s *ws,
+                                   FAR struct webclient_conn_s *conn)
+{
+  FAR const struct webclient_tls_ops *tls_ops = ctx->tls_ops;
+  FAR struct webclient_session_s *entry = NULL;
+  struct webclient_session_s old;
+  FAR struct webclient_tls_session *session;
+  int i;
+
+  if (tls_ops->get_session(ctx->tls_ctx, conn->tls_conn, &session) != 0 ||
+      session == NULL)
+    {
+      return;
+    }
+
+  pthread_mutex_lock(&g_webclient_lock);
+  for (i = 0; i < CONFIG_WEBCLIENT_TLS_SESSIONS; i++)
+    {
+      if (g_webclient_sessions[i].session == NULL)
+        {
+          entry = &g_webclient_sessions[i];
+          break;
+        }
+    }
+
+  if (entry == NULL)
+    {
+      entry = &g_webclient_sessions[g_webclient_sessionnext];
+      g_webclient_sessionnext = (g_webclient_sessionnext + 1) %
+                                CONFIG_WEBCLIENT_TLS_SESSIONS;
+    }
+
+  old = *entry;
+  strlcpy(entry->hostname, ws->target.hostname, sizeof(entry->hostname));
+  entry->port    = ws->target.port;
+  entry->tls_ops = tls_ops;
+  entry->tls_ctx = ctx->tls_ctx;
+  entry->session = session;
+  pthread_mutex_unlock(&g_webclient_lock);
+
+  if (old.session != NULL)
+    {
+      old.tls_ops->free_session(old.tls_ctx, old.session);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: wget_tlsconnect
+ *
+ * Description:
+ *   Establish a TLS connection, resuming a saved session when the TLS
+ *   implementation supports it.
+ *
+ ****************************************************************************/
+
+static int wget_tlsconnect(FAR struct webclient_context *ctx,
+                           FAR struct wget_s *ws,
+                           FAR struct webclient_conn_s *conn,
+                           FAR const char *port_str)
+{
+  FAR const struct webclient_tls_ops *tls_ops = ctx->tls_ops;
+#if CONFIG_WEBCLIENT_TLS_SESSIONS > 0
+  FAR struct webclient_tls_session *session;
+  int ret;
+
+  if (tls_ops->connect_with_session != NULL &&
+      tls_ops->get_session != NULL && tls_ops->free_session != NULL)
+    {
+      session = webclient_session_take(ctx, ws);
+      ret = tls_ops->connect_with_session(ctx->tls_ctx,
+                                          ws->target.hostname, port_str,
+                                          ctx->timeout_sec, session,
+                                          &conn->tls_conn);
+      if (session != NULL)
+        {
+          tls_ops->free_session(ctx->tls_ctx, session);
+        }
+
+      if (ret == 0)
+        {
+          webclient_session_save(ctx, ws, conn);
+        }
+
+      return ret;
+    }
+#endif
+
+  return tls_ops->connect(ctx->tls_ctx, ws->target.hostname, port_str,
+                          ctx->timeout_sec, &conn->tls_conn);
+}
+
 /****************************************************************************
  * Name: wget_gethostip
  *
@@ -1042,6 +1683,13 @@ static int wget_gethostip(FAR char *hostname, FAR struct in_addr *dest)
   FAR struct addrinfo *info;
   FAR struct sockaddr_in *addr;
 
+#if CONFIG_WEBCLIENT_DNSCACHE > 0
+  if (webclient_dns_get(hostname, dest))
+    {
+      return OK;
+    }
+#endif
+
   memset(&hint, 0, sizeof(hint));
   hint.ai_family = AF_INET;
 
@@ -1054,6 +1702,9 @@ static int wget_gethostip(FAR char *hostname, FAR struct in_addr *dest)
   memcpy(dest, &addr->sin_addr, sizeof(struct in_addr));
 
   freeaddrinfo(info);
+#if CONFIG_WEBCLIENT_DNSCACHE > 0
+  webclient_dns_put(hostname, dest);
+#endif
   return OK;
 #else
   /* No host name support */
@@ -1170,6 +1821,63 @@ void webclient_conn_free(FAR struct webclient_conn_s *conn)
   free(conn);
 }
 
+/****************************************************************************
+ * Name: webclient_flush_cache
+ ****************************************************************************/
+
+void webclient_flush_cache(void)
+{
+#ifdef WEBCLIENT_HAVE_CACHE
+  int i;
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+  for (i = 0; i < CONFIG_WEBCLIENT_KEEPALIVE_MAXCONNS; i++)
+    {
+      struct webclient_conn_s idle;
+      bool found;
+
+      pthread_mutex_lock(&g_webclient_lock);
+      found = g_webclient_pool[i].inuse;
+      idle  = g_webclient_pool[i].conn;
+      g_webclient_pool[i].inuse = false;
+      pthread_mutex_unlock(&g_webclient_lock);
+
+      if (found)
+        {
+          webclient_conn_close(&idle);
+        }
+    }
+#endif
+
+#if CONFIG_WEBCLIENT_DNSCACHE > 0
+  pthread_mutex_lock(&g_webclient_lock);
+  for (i = 0; i < CONFIG_WEBCLIENT_DNSCACHE; i++)
+    {
+      g_webclient_dns[i].hostname[0] = '\0';
+    }
+
+  pthread_mutex_unlock(&g_webclient_lock);
+#endif
+
+#if CONFIG_WEBCLIENT_TLS_SESSIONS > 0
+  for (i = 0; i < CONFIG_WEBCLIENT_TLS_SESSIONS; i++)
+    {
+      struct webclient_session_s old;
+
+      pthread_mutex_lock(&g_webclient_lock);
+      old = g_webclient_sessions[i];
+      g_webclient_sessions[i].session = NULL;
+      pthread_mutex_unlock(&g_webclient_lock);
+
+      if (old.session != NULL)
+        {
+          old.tls_ops->free_session(old.tls_ctx, old.session);
+        }
+    }
+#endif
+#endif
+}
+
 /****************************************************************************
  * Name: webclient_perform
  *
@@ -1321,8 +2029,25 @@ int webclient_perform(FAR struct webclient_context *ctx)
           ws->datend     = 0;
           ws->ndx        = 0;
           ws->redirected = 0;
+          ws->internal_flags &= ~(WGET_FLAG_REUSED | WGET_FLAG_KEEP_CONN);
 
-          if (conn->tls)
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+          /* Prefer an idle connection to the same server */
+
+          if (wget_keepalive(ctx) &&
+              (ws->internal_flags & WGET_FLAG_NO_REUSE) == 0 &&
+              webclient_pool_get(ctx, ws, conn))
+            {
+              ws->internal_flags |= WGET_FLAG_REUSED;
+              ws->need_conn_close = true;
+            }
+#endif
+
+          if ((ws->internal_flags & WGET_FLAG_REUSED) != 0)
+            {
+              /* Already connected, there is no socket to create */
+            }
+          else if (conn->tls)
             {
 #if defined(CONFIG_WEBCLIENT_NET_LOCAL)
               if (ctx->unix_socket_path != NULL)
@@ -1456,7 +2181,13 @@ int webclient_perform(FAR struct webclient_context *ctx)
 
       if (ws->state == WEBCLIENT_STATE_CONNECT)
         {
-          if (ws->tunnel != NULL)
+          if ((ws->internal_flags & WGET_FLAG_REUSED) != 0)
+            {
+              /* Already connected */
+
+              ret = 0;
+            }
+          else if (ws->tunnel != NULL)
             {
               ret = webclient_perform(ws->tunnel);
               if (ret == 0)
@@ -1547,9 +2278,7 @@ int webclient_perform(FAR struct webclient_context *ctx)
 #endif
 
               snprintf(port_str, sizeof(port_str), "%u", ws->target.port);
-              ret = tls_ops->connect(tls_ctx, ws->target.hostname, port_str,
-                                     ctx->timeout_sec,
-                                     &conn->tls_conn);
+              ret = wget_tlsconnect(ctx, ws, conn, port_str);
               if (ret == 0)
                 {
                   ws->need_conn_close = true;
@@ -1635,6 +2364,14 @@ int webclient_perform(FAR struct webclient_context *ctx)
                     }
                   break;
                 }
+
+              /* The cached address may be stale */
+
+              if (ret < 0 && ret != -EAGAIN && ret != -EINPROGRESS &&
+                  ret != -EALREADY && ctx->proxy == NULL)
+                {
+                  webclient_dns_forget(ws->target.hostname);
+                }
             }
 
           if (ret < 0)
@@ -1779,9 +2516,10 @@ int webclient_perform(FAR struct webclient_context *ctx)
               dest = append(dest, ep, g_httpcrnl);
             }
 
-          if (ctx->protocol_version == WEBCLIENT_PROTOCOL_VERSION_HTTP_1_1)
+          if (ctx->protocol_version == WEBCLIENT_PROTOCOL_VERSION_HTTP_1_1 &&
+              !wget_keepalive(ctx))
             {
-              /* We don't implement persistect connections. */
+              /* Persistent connections are the default for HTTP/1.1 */
 
               dest = append(dest, ep, g_httpconn_close);
               dest = append(dest, ep, g_httpcrnl);
@@ -1811,6 +2549,11 @@ int webclient_perform(FAR struct webclient_context *ctx)
                                     ws->state_len);
           if (ssz < 0)
             {
+              if (wget_retry(ctx, ws))
+                {
+                  continue;
+                }
+
               ret = ssz;
               nerr("ERROR: send failed: %d\n", -ret);
               goto errout_with_errno;
@@ -1887,6 +2630,11 @@ int webclient_perform(FAR struct webclient_context *ctx)
                                                 bytes_to_send);
               if (ssz < 0)
                 {
+                  if (wget_retry(ctx, ws))
+                    {
+                      continue;
+                    }
+
                   ret = ssz;
                   nerr("ERROR: send failed: %d\n", -ret);
                   goto errout_with_errno;
@@ -1940,6 +2688,11 @@ int webclient_perform(FAR struct webclient_context *ctx)
                     }
 
                   ssz = webclient_conn_recv(conn, ws->buffer, want);
+                  if (ssz <= 0 && wget_retry(ctx, ws))
+                    {
+                      break;
+                    }
+
                   if (ssz < 0)
                     {
                       ret = ssz;
@@ -2071,6 +2824,21 @@ int webclient_perform(FAR struct webclient_context *ctx)
                           ws->chunk_received += received;
                         }
 
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+                      /* Data beyond the end of the body is not passed on */
+
+                      if (ws->state == WEBCLIENT_STATE_DATA &&
+                          (ws->internal_flags &
+                           WGET_FLAG_GOT_CONTENT_LENGTH) != 0 &&
+                          wget_keepalive(ctx) &&
+                          received > ws->expected_resp_body_len -
+                                     ws->received_body_len)
+                        {
+                          received = ws->expected_resp_body_len -
+                                     ws->received_body_len;
+                        }
+#endif
+
                       ninfo("Processing resp body %ju - %ju\n",
                             ws->received_body_len,
                             ws->received_body_len + received);
@@ -2157,12 +2925,43 @@ int webclient_perform(FAR struct webclient_context *ctx)
                 {
                   break;
                 }
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+              /* Without waiting for EOF, finish a complete response and
+               * keep the connection unless the server closes it.
+               */
+
+              if (wget_keepalive(ctx) && wget_responsedone(ctx, ws))
+                {
+                  if ((ws->internal_flags & WGET_FLAG_CONN_CLOSE) == 0 &&
+                      ws->datend == ws->offset)
+                    {
+                      ws->internal_flags |= WGET_FLAG_KEEP_CONN;
+                    }
+
+                  ws->state = WEBCLIENT_STATE_CLOSE;
+                  ws->redirected = 0;
+                  break;
+                }
+#endif
             }
         }
 
       if (ws->state == WEBCLIENT_STATE_CLOSE)
         {
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+          if ((ws->internal_flags & WGET_FLAG_KEEP_CONN) != 0)
+            {
+              webclient_pool_put(ws, conn);
+            }
+          else
+            {
+              webclient_conn_close(conn);
+            }
+#else
           webclient_conn_close(conn);
+#endif
+
           ws->need_conn_close = false;
           if (ws->redirected)
             {
@@ -44,6 +44,7 @@
 #include <string.h>
 #include <errno.h>
 #include <time.h>
+#include <pthread.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -58,6 +59,15 @@
 
 #define DEFAULT_SECTSIZE 512
 
+/* Buffers used with O_DIRECT must be aligned for DMA to/from the device */
+
+#define DD_DIRECT_ALIGN  4096
+#define DD_BUFFER_ALIGN  sizeof(uintptr_t)
+
+/* Largest ring of buffers accepted with nbufs= */
+
+#define DD_MAX_NBUFS     64
+
 #if !defined(CONFIG_SYSTEM_DD_PROGNAME)
 #define CONFIG_SYSTEM_DD_PROGNAME "dd"
 #endif
@@ -74,6 +84,8 @@
 #  ifndef NSEC_PER_SEC
 #    define NSEC_PER_SEC 1000000000
 #  endif
+#  define CONFIG_SYSTEM_DD_STATS 1
+#  define CONFIG_SYSTEM_DD_PIPELINE 1
 #endif
 
 #define g_dd CONFIG_SYSTEM_DD_PROGNAME
@@ -89,44 +101,141 @@ struct dd_s
   uint32_t     nsectors;   /* Number of sectors to transfer */
   uint32_t     skip;       /* The number of sectors skipped on input */
   uint32_t     seek;       /* The number of sectors seeked on output */
+  uint32_t     sector;     /* The number of sectors written */
+  int          iflags;     /* The open flags on input device */
   int          oflags;     /* The open flags on output device */
   bool         eof;        /* true: The end of the input or output file has been hit */
+  bool         verify;     /* true: Verify the output after the transfer */
+  bool         progress;   /* true: Report progress during the transfer */
   size_t       sectsize;   /* Size of one sector */
-  size_t       nbytes;     /* Number of valid bytes in the buffer */
-  FAR uint8_t *buffer;     /* Buffer of data to write to the output file */
+  unsigned int nbufs;      /* Number of buffers (> 1: reader thread) */
+  uint64_t     total;      /* Number of bytes written */
+  uint64_t     cksum;      /* Running checksum of the data written */
+  FAR uint8_t *buffer;     /* Buffer(s) of data to write to the output file */
+#ifdef CONFIG_SYSTEM_DD_STATS
+  struct timespec ts0;     /* Start time of the transfer */
+  time_t       lastprog;   /* Time of the last progress report */
+#endif
+#ifdef CONFIG_SYSTEM_DD_PIPELINE
+  /* Ring of nbufs buffers passed from the reader thread to the writer */
+
+  pthread_mutex_t lock;    /* Protects the ring state */
+  pthread_cond_t  cond;    /* Signalled on any change of the ring state */
+  FAR size_t  *nbytes;     /* Number of valid bytes in each buffer */
+  uint32_t     head;       /* Count of buffers filled by the reader */
+  uint32_t     tail;       /* Count of buffers drained by the writer */
+  bool         rdone;      /* Reader has finished */
+  bool         rerror;     /* Reader failed */
+  bool         wabort;     /* Writer failed, reader should stop */
+#endif
 };
 
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: dd_elapsed
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSTEM_DD_STATS
+static uint64_t dd_elapsed(FAR struct dd_s *dd)
+{
+  struct timespec ts1;
+  uint64_t elapsed;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts1);
+
+  elapsed  = (((uint64_t)ts1.tv_sec * NSEC_PER_SEC) + ts1.tv_nsec);
+  elapsed -= (((uint64_t)dd->ts0.tv_sec * NSEC_PER_SEC) + dd->ts0.tv_nsec);
+  return elapsed / NSEC_PER_USEC; /* usec */
+}
+
+/****************************************************************************
+ * Name: dd_report
+ ****************************************************************************/
+
+static void dd_report(FAR struct dd_s *dd, FAR const char *eol)
+{
+  uint64_t elapsed = dd_elapsed(dd);
+
+  if (elapsed == 0)
+    {
+      elapsed = 1;
+    }
+
+  fprintf(stderr, "%" PRIu64 " bytes (%" PRIu32 " blocks) copied, %u usec, ",
+         dd->total, dd->sector, (unsigned int)elapsed);
+  fprintf(stderr, "%u KB/s%s" ,
+         (unsigned int)(((double)dd->total / 1024)
+         / ((double)elapsed / USEC_PER_SEC)), eol);
+}
+#endif
+
+/****************************************************************************
+ * Name: dd_checksum
+ *
+ * Description:
+ *   Accumulate a Fletcher-style checksum of the data, a word at a time.
+ *   All blocks except the last are a multiple of the sector size so the
+ *   result does not depend on where the data is split.
+ *
+ ****************************************************************************/
+
+static uint64_t dd_checksum(uint64_t cksum, FAR const uint8_t *buffer,
+                            size_t nbytes)
+{
+  uint32_t sum1 = (uint32_t)cksum;
+  uint32_t sum2 = (uint32_t)(cksum >> 32);
+  uint32_t word;
+
+  while (nbytes >= sizeof(word))
+    {
+      memcpy(&word, buffer, sizeof(word));
+      sum1   += word;
+      sum2   += sum1;
+      buffer += sizeof(word);
+      nbytes -= sizeof(word);
+    }
+
+  if (nbytes > 0)
+    {
+      word = 0;
+      memcpy(&word, buffer, nbytes);
+      sum1 += word;
+      sum2 += sum1;
+    }
+
+  return ((uint64_t)sum2 << 32) | sum1;
+}
+
 /****************************************************************************
  * Name: dd_write
  ****************************************************************************/
 
-static int dd_write(FAR struct dd_s *dd)
+static int dd_write(FAR struct dd_s *dd, FAR const uint8_t *buffer,
+                    size_t nbytes)
 {
-  FAR uint8_t *buffer = dd->buffer;
   size_t written;
-  ssize_t nbytes;
+  ssize_t nwritten;
 
   /* Is the out buffer full (or is this the last one)? */
 
   written = 0;
   do
     {
-      nbytes = write(dd->outfd, buffer, dd->nbytes - written);
-      if (nbytes < 0)
+      nwritten = write(dd->outfd, buffer, nbytes - written);
+      if (nwritten < 0)
         {
           fprintf(stderr, "%s: failed to write: %s\n", g_dd,
               strerror(errno));
           return ERROR;
         }
 
-      written += nbytes;
-      buffer  += nbytes;
+      written += nwritten;
+      buffer  += nwritten;
     }
-  while (written < dd->nbytes);
+  while (written < nbytes);
 
   return OK;
 }
@@ -135,15 +244,15 @@ static int dd_write(FAR struct dd_s *dd)
  * Name: dd_read
  ****************************************************************************/
 
-static int dd_read(FAR struct dd_s *dd)
+static int dd_read(FAR struct dd_s *dd, int fd, FAR uint8_t *buffer,
+                   FAR size_t *pnbytes)
 {
-  FAR uint8_t *buffer = dd->buffer;
   ssize_t nbytes;
+  size_t nread = 0;
 
-  dd->nbytes = 0;
   do
     {
-      nbytes = read(dd->infd, buffer, dd->sectsize - dd->nbytes);
+      nbytes = read(fd, buffer, dd->sectsize - nread);
       if (nbytes < 0)
         {
           if (errno == EINTR)
@@ -155,19 +264,264 @@ static int dd_read(FAR struct dd_s *dd)
           return ERROR;
         }
 
-      dd->nbytes += nbytes;
-      buffer     += nbytes;
+      nread  += nbytes;
+      buffer += nbytes;
       if (nbytes == 0)
         {
           dd->eof = true;
           break;
         }
     }
-  while (dd->nbytes < dd->sectsize && nbytes != 0);
+  while (nread < dd->sectsize && nbytes != 0);
 
+  *pnbytes = nread;
   return OK;
 }
 
+/****************************************************************************
+ * Name: dd_output
+ *
+ * Description:
+ *   Write one block to the output and account for it.
+ *
+ ****************************************************************************/
+
+static int dd_output(FAR struct dd_s *dd, FAR const uint8_t *buffer,
+                     size_t nbytes)
+{
+  int ret;
+
+#ifdef O_DIRECT
+  /* A short final block cannot be written with direct I/O */
+
+  if (nbytes < dd->sectsize && (dd->oflags & O_DIRECT) != 0)
+    {
+      dd->oflags &= ~O_DIRECT;
+      fcntl(dd->outfd, F_SETFL, fcntl(dd->outfd, F_GETFL) & ~O_DIRECT);
+    }
+#endif
+
+  ret = dd_write(dd, buffer, nbytes);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* Checksum the data on the fly so that the verification needs to read
+   * back only the output.
+   */
+
+  if (dd->verify)
+    {
+      dd->cksum = dd_checksum(dd->cksum, buffer, nbytes);
+    }
+
+  dd->sector++;
+  dd->total += nbytes;
+
+#ifdef CONFIG_SYSTEM_DD_STATS
+  if (dd->progress)
+    {
+      struct timespec now;
+
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      if (now.tv_sec != dd->lastprog)
+        {
+          dd->lastprog = now.tv_sec;
+          dd_report(dd, "\r");
+        }
+    }
+#endif
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: dd_copy
+ *
+ * Description:
+ *   Transfer the data, alternating reads and writes of a single buffer.
+ *
+ ****************************************************************************/
+
+static int dd_copy(FAR struct dd_s *dd)
+{
+  size_t nbytes;
+  int ret;
+
+  while (!dd->eof && dd->sector < dd->nsectors)
+    {
+      /* Read one sector from from the input */
+
+      ret = dd_read(dd, dd->infd, dd->buffer, &nbytes);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      /* Has the incoming data stream ended? */
+
+      if (nbytes > 0)
+        {
+          /* Write one sector to the output file */
+
+          ret = dd_output(dd, dd->buffer, nbytes);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+    }
+
+  return OK;
+}
+
+#ifdef CONFIG_SYSTEM_DD_PIPELINE
+/****************************************************************************
+ * Name: dd_reader
+ *
+ * Description:
+ *   Reader thread:  fill the free buffers of the ring from the input.
+ *
+ ****************************************************************************/
+
+static FAR void *dd_reader(FAR void *arg)
+{
+  FAR struct dd_s *dd = arg;
+  FAR uint8_t *buffer;
+  uint32_t nread = 0;
+  unsigned int slot;
+  int ret;
+
+  pthread_mutex_lock(&dd->lock);
+  while (!dd->rdone)
+    {
+      /* Wait for a free buffer */
+
+      while (dd->head - dd->tail >= dd->nbufs && !dd->wabort)
+        {
+          pthread_cond_wait(&dd->cond, &dd->lock);
+        }
+
+      if (dd->wabort)
+        {
+          break;
+        }
+
+      slot   = dd->head % dd->nbufs;
+      buffer = dd->buffer + slot * dd->sectsize;
+      pthread_mutex_unlock(&dd->lock);
+
+      ret = dd_read(dd, dd->infd, buffer, &dd->nbytes[slot]);
+
+      pthread_mutex_lock(&dd->lock);
+      if (ret < 0)
+        {
+          dd->rerror = true;
+          dd->rdone  = true;
+        }
+      else
+        {
+          if (dd->nbytes[slot] > 0)
+            {
+              dd->head++;
+              nread++;
+            }
+
+          if (dd->eof || nread >= dd->nsectors)
+            {
+              dd->rdone = true;
+            }
+        }
+
+      pthread_cond_broadcast(&dd->cond);
+    }
+
+  pthread_mutex_unlock(&dd->lock);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: dd_pipeline
+ *
+ * Description:
+ *   Transfer the data with a reader thread filling a ring of buffers while
+ *   the calling thread writes them out, so that reads and writes overlap.
+ *
+ ****************************************************************************/
+
+static int dd_pipeline(FAR struct dd_s *dd)
+{
+  pthread_t reader;
+  unsigned int slot;
+  size_t nbytes;
+  int ret;
+
+  dd->nbytes = calloc(dd->nbufs, sizeof(size_t));
+  if (dd->nbytes == NULL)
+    {
+      fprintf(stderr, "%s: failed to malloc: %s\n", g_dd, strerror(errno));
+      return ERROR;
+    }
+
+  pthread_mutex_init(&dd->lock, NULL);
+  pthread_cond_init(&dd->cond, NULL);
+
+  ret = pthread_create(&reader, NULL, dd_reader, dd);
+  if (ret != 0)
+    {
+      fprintf(stderr, "%s: failed to create reader: %s\n", g_dd,
+              strerror(ret));
+      ret = ERROR;
+      goto errout;
+    }
+
+  pthread_mutex_lock(&dd->lock);
+  for (; ; )
+    {
+      /* Wait for a filled buffer */
+
+      while (dd->head == dd->tail && !dd->rdone)
+        {
+          pthread_cond_wait(&dd->cond, &dd->lock);
+        }
+
+      if (dd->head == dd->tail)
+        {
+          break;
+        }
+
+      slot   = dd->tail % dd->nbufs;
+      nbytes = dd->nbytes[slot];
+      pthread_mutex_unlock(&dd->lock);
+
+      ret = dd_output(dd, dd->buffer + slot * dd->sectsize, nbytes);
+
+      pthread_mutex_lock(&dd->lock);
+      if (ret < 0)
+        {
+          dd->wabort = true;
+          pthread_cond_broadcast(&dd->cond);
+          break;
+        }
+
+      dd->tail++;
+      pthread_cond_broadcast(&dd->cond);
+    }
+
+  pthread_mutex_unlock(&dd->lock);
+  pthread_join(reader, NULL);
+
+  ret = (dd->rerror || dd->wabort) ? ERROR : OK;
+
+errout:
+  pthread_cond_destroy(&dd->cond);
+  pthread_mutex_destroy(&dd->lock);
+  free(dd->nbytes);
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: dd_infopen
  ****************************************************************************/
@@ -180,7 +534,7 @@ static inline int dd_infopen(FAR const char *name, FAR struct dd_s *dd)
       return OK;
     }
 
-  dd->infd = open(name, O_RDONLY);
+  dd->infd = open(name, dd->iflags);
   if (dd->infd < 0)
     {
       fprintf(stderr, "%s: failed to open '%s': %s\n", g_dd, name,
@@ -214,22 +568,23 @@ static inline int dd_outfopen(FAR const char *name, FAR struct dd_s *dd)
   return OK;
 }
 
+/****************************************************************************
+ * Name: dd_verify
+ *
+ * Description:
+ *   Read back the output and compare its checksum with the checksum of the
+ *   data that was written.
+ *
+ ****************************************************************************/
+
 static int dd_verify(FAR struct dd_s *dd)
 {
-  FAR uint8_t *buffer;
-  unsigned sector = 0;
-  int ret = OK;
+  uint64_t remaining = dd->total;
+  uint64_t cksum = 0;
+  size_t nbytes;
+  int ret;
 
-  ret = lseek(dd->infd, dd->skip ? dd->skip * dd->sectsize : 0, SEEK_SET);
-  if (ret < 0)
-    {
-      fprintf(stderr, "%s: failed to infd lseek: %s\n", g_dd,
-          strerror(errno));
-      return ret;
-    }
-
-  dd->eof = 0;
-  ret = lseek(dd->outfd, 0, SEEK_SET);
+  ret = lseek(dd->outfd, (off_t)dd->seek * dd->sectsize, SEEK_SET);
   if (ret < 0)
     {
       fprintf(stderr, "%s: failed to outfd lseek: %s\n", g_dd,
@@ -237,45 +592,30 @@ static int dd_verify(FAR struct dd_s *dd)
       return ret;
     }
 
-  buffer = malloc(dd->sectsize);
-  if (buffer == NULL)
-    {
-      return ERROR;
-    }
-
-  while (!dd->eof && sector < dd->nsectors)
+  dd->eof = false;
+  while (remaining > 0 && !dd->eof)
     {
-      ret = dd_read(dd);
+      ret = dd_read(dd, dd->outfd, dd->buffer, &nbytes);
       if (ret < 0)
         {
           break;
         }
 
-      ret = read(dd->outfd, buffer, dd->nbytes);
-      if (ret != dd->nbytes)
+      if (nbytes > remaining)
         {
-          fprintf(stderr, "%s: failed to outfd read: %d\n",
-                 g_dd, ret < 0 ? errno : ret);
-          break;
+          nbytes = remaining;
         }
 
-      if (memcmp(dd->buffer, buffer, dd->nbytes) != 0)
-        {
-#ifdef __NuttX__
-          char msg[32];
-          snprintf(msg, sizeof(msg), "infile sector %d", sector);
-          lib_dumpbuffer(msg, dd->buffer, dd->nbytes);
-          snprintf(msg, sizeof(msg), "\noutfile sector %d", sector);
-          lib_dumpbuffer(msg, buffer, dd->nbytes);
-#else
-          fprintf(stderr, "%s: sector %d differs unexpectedly\n", g_dd,
-              sector);
-#endif
-          ret = ERROR;
-          break;
-        }
+      cksum      = dd_checksum(cksum, dd->buffer, nbytes);
+      remaining -= nbytes;
+    }
 
-      sector++;
+  if (ret == OK && (remaining > 0 || cksum != dd->cksum))
+    {
+      fprintf(stderr, "%s: output differs from input: "
+              "checksum %016" PRIx64 " expected %016" PRIx64 "\n",
+              g_dd, cksum, dd->cksum);
+      ret = ERROR;
     }
 
   if (ret < 0)
@@ -283,10 +623,30 @@ static int dd_verify(FAR struct dd_s *dd)
       fprintf(stderr, "%s: failed to dd verify: %d\n", g_dd, ret);
     }
 
-  free(buffer);
   return ret;
 }
 
+/****************************************************************************
+ * Name: dd_setflag
+ ****************************************************************************/
+
+static int dd_setflag(FAR const char *flags, FAR int *oflags)
+{
+  if (strcmp(flags, "direct") == 0)
+    {
+#ifdef O_DIRECT
+      *oflags |= O_DIRECT;
+      return OK;
+#else
+      fprintf(stderr, "%s: direct I/O not supported\n", g_dd);
+      return ERROR;
+#endif
+    }
+
+  fprintf(stderr, "%s: unknown flag '%s'\n", g_dd, flags);
+  return ERROR;
+}
+
 /****************************************************************************
  * Name: print_usage
  ****************************************************************************/
@@ -296,7 +656,14 @@ static void print_usage(FAR FILE *stream)
   fprintf(stream, "usage:\n");
   fprintf(stream, "  %s [if=<infile>] [of=<outfile>] [bs=<sectsize>] "
          "[count=<sectors>] [skip=<sectors>] [seek=<sectors>] [verify] "
-         "[conv=<nocreat,notrunc>]\n", g_dd);
+         "[conv=<nocreat,notrunc>] [iflag=direct] [oflag=direct] "
+#ifdef CONFIG_SYSTEM_DD_PIPELINE
+         "[nbufs=<buffers>] "
+#endif
+#ifdef CONFIG_SYSTEM_DD_STATS
+         "[status=progress]"
+#endif
+         "\n", g_dd);
 }
 
 /****************************************************************************
@@ -308,13 +675,7 @@ int main(int argc, FAR char **argv)
   struct dd_s dd;
   FAR char *infile = NULL;
   FAR char *outfile = NULL;
-#ifdef CONFIG_SYSTEM_DD_STATS
-  struct timespec ts0;
-  struct timespec ts1;
-  uint64_t elapsed;
-  uint64_t total = 0;
-#endif
-  uint32_t sector = 0;
+  size_t align;
   int ret = ERROR;
   int i;
   bool show_help = false;
@@ -324,6 +685,8 @@ int main(int argc, FAR char **argv)
   memset(&dd, 0, sizeof(struct dd_s));
   dd.sectsize  = DEFAULT_SECTSIZE;  /* Sector size if 'bs=' not provided */
   dd.nsectors  = 0xffffffff;        /* MAX_UINT32 */
+  dd.nbufs     = 1;
+  dd.iflags    = O_RDONLY;
   dd.oflags    = O_WRONLY | O_CREAT | O_TRUNC;
 
   /* Parse command line parameters */
@@ -356,8 +719,43 @@ int main(int argc, FAR char **argv)
         }
       else if (strncmp(argv[i], "verify", 6) == 0)
         {
-          dd.oflags |= O_RDONLY;
+          dd.verify = true;
+        }
+      else if (strncmp(argv[i], "iflag=", 6) == 0)
+        {
+          if (dd_setflag(&argv[i][6], &dd.iflags) < 0)
+            {
+              goto errout_with_paths;
+            }
+        }
+      else if (strncmp(argv[i], "oflag=", 6) == 0)
+        {
+          if (dd_setflag(&argv[i][6], &dd.oflags) < 0)
+            {
+              goto errout_with_paths;
+            }
+        }
+#ifdef CONFIG_SYSTEM_DD_PIPELINE
+      else if (strncmp(argv[i], "nbufs=", 6) == 0)
+        {
+          int nbufs = atoi(&argv[i][6]);
+
+          if (nbufs < 1 || nbufs > DD_MAX_NBUFS)
+            {
+              fprintf(stderr, "%s: nbufs must be 1..%d\n", g_dd,
+                      DD_MAX_NBUFS);
+              goto errout_with_paths;
+            }
+
+          dd.nbufs = nbufs;
+        }
+#endif
+#ifdef CONFIG_SYSTEM_DD_STATS
+      else if (strcmp(argv[i], "status=progress") == 0)
+        {
+          dd.progress = true;
         }
+#endif
       else if (strncmp(argv[i], "conv=", 5) == 0)
         {
           const char *cur = &argv[i][5];
@@ -407,22 +805,34 @@ int main(int argc, FAR char **argv)
       return 0;
     }
 
-  /* If verify enabled, infile and outfile are mandatory */
+  /* If verify enabled, outfile is mandatory and must be readable */
 
-  if ((dd.oflags & O_RDONLY) && (infile == NULL || outfile == NULL))
+  if (dd.verify)
     {
-      fprintf(stderr, "%s: invalid parameters: %s\n", g_dd,
-          strerror(EINVAL));
-      print_usage(stderr);
-      goto errout_with_paths;
+      if (outfile == NULL)
+        {
+          fprintf(stderr, "%s: invalid parameters: %s\n", g_dd,
+              strerror(EINVAL));
+          print_usage(stderr);
+          goto errout_with_paths;
+        }
+
+      dd.oflags = (dd.oflags & ~O_WRONLY) | O_RDWR;
     }
 
-  /* Allocate the I/O buffer */
+  /* Allocate the I/O buffer(s) */
 
-  dd.buffer = malloc(dd.sectsize);
-  if (!dd.buffer)
+#ifdef O_DIRECT
+  align = ((dd.iflags | dd.oflags) & O_DIRECT) != 0 ?
+          DD_DIRECT_ALIGN : DD_BUFFER_ALIGN;
+#else
+  align = DD_BUFFER_ALIGN;
+#endif
+
+  if (posix_memalign((FAR void **)&dd.buffer, align,
+                     dd.sectsize * dd.nbufs) != 0)
     {
-      fprintf(stderr, "%s: failed to malloc: %s\n", g_dd, strerror(errno));
+      fprintf(stderr, "%s: failed to malloc: %s\n", g_dd, strerror(ENOMEM));
       goto errout_with_paths;
     }
 
@@ -444,7 +854,7 @@ int main(int argc, FAR char **argv)
 
   if (dd.skip)
     {
-      ret = lseek(dd.infd, dd.skip * dd.sectsize, SEEK_SET);
+      ret = lseek(dd.infd, (off_t)dd.skip * dd.sectsize, SEEK_SET);
       if (ret < 0)
         {
           fprintf(stderr, "%s: failed to lseek: %s\n", g_dd,
@@ -456,7 +866,7 @@ int main(int argc, FAR char **argv)
 
   if (dd.seek)
     {
-      ret = lseek(dd.outfd, dd.seek * dd.sectsize, SEEK_SET);
+      ret = lseek(dd.outfd, (off_t)dd.seek * dd.sectsize, SEEK_SET);
       if (ret < 0)
         {
           fprintf(stderr, "%s: failed to lseek on output: %s\n",
@@ -469,57 +879,31 @@ int main(int argc, FAR char **argv)
   /* Then perform the data transfer */
 
 #ifdef CONFIG_SYSTEM_DD_STATS
-  clock_gettime(CLOCK_MONOTONIC, &ts0);
+  clock_gettime(CLOCK_MONOTONIC, &dd.ts0);
+  dd.lastprog = dd.ts0.tv_sec;
 #endif
 
-  while (!dd.eof && sector < dd.nsectors)
+#ifdef CONFIG_SYSTEM_DD_PIPELINE
+  if (dd.nbufs > 1)
     {
-      /* Read one sector from from the input */
-
-      ret = dd_read(&dd);
-      if (ret < 0)
-        {
-          goto errout_with_outf;
-        }
-
-      /* Has the incoming data stream ended? */
-
-      if (dd.nbytes > 0)
-        {
-          /* Write one sector to the output file */
-
-          ret = dd_write(&dd);
-          if (ret < 0)
-            {
-              goto errout_with_outf;
-            }
-
-          /* Increment the sector number */
-
-          sector++;
-#ifdef CONFIG_SYSTEM_DD_STATS
-          total += dd.nbytes;
+      ret = dd_pipeline(&dd);
+    }
+  else
 #endif
-        }
+    {
+      ret = dd_copy(&dd);
     }
 
-  ret = OK;
+  if (ret < 0)
+    {
+      goto errout_with_outf;
+    }
 
 #ifdef CONFIG_SYSTEM_DD_STATS
-  clock_gettime(CLOCK_MONOTONIC, &ts1);
-
-  elapsed  = (((uint64_t)ts1.tv_sec * NSEC_PER_SEC) + ts1.tv_nsec);
-  elapsed -= (((uint64_t)ts0.tv_sec * NSEC_PER_SEC) + ts0.tv_nsec);
-  elapsed /= NSEC_PER_USEC; /* usec */
-
-  fprintf(stderr, "%" PRIu64 " bytes (%" PRIu32 " blocks) copied, %u usec, ",
-         total, sector, (unsigned int)elapsed);
-  fprintf(stderr, "%u KB/s\n" ,
-         (unsigned int)(((double)total / 1024)
-         / ((double)elapsed / USEC_PER_SEC)));
+  dd_report(&dd, "\n");
 #endif
 
-  if (ret == 0 && (dd.oflags & O_RDONLY) != 0)
+  if (dd.verify)
     {
       ret = dd_verify(&dd);
     }
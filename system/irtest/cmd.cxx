@@ -29,10 +29,14 @@
 #include <sys/types.h>
 #include <sys/time.h>
 #include <pthread.h>
+#include <inttypes.h>
+#include <signal.h>
 #include <stdio.h>
 #include <fcntl.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "decoder.hpp"
 #include "enum.hpp"
 #include "cmd.hpp"
 
@@ -47,6 +51,8 @@
 static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
 static int g_irdevs[CONFIG_SYSTEM_IRTEST_MAX_NIRDEV];
+static bool g_toggle[CONFIG_SYSTEM_IRTEST_MAX_NIRDEV];
+static volatile bool g_stop;
 
 /****************************************************************************
  * Private Functions
@@ -59,6 +65,127 @@ static void wake(int)
   pthread_mutex_unlock(&mutex);
 }
 
+static void stop(int)
+{
+  g_stop = true;
+}
+
+static void print_scancode(const ir_scancode *code)
+{
+  printf("%s 0x%06" PRIx32 "%s%s\n", ir_protocol_name(code->protocol),
+         code->scancode, code->toggle ? " toggle" : "",
+         code->repeat ? " repeat" : "");
+}
+
+static uint64_t elapsed_ns(const struct timespec *start)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)(now.tv_sec - start->tv_sec) * 1000000000 +
+         now.tv_nsec - start->tv_nsec;
+}
+
+/* Load a recorded pulse file into mode2 samples.  The file holds either
+ * "pulse N", "space N" and "timeout N" words as written by record_data,
+ * or the numbers printed by read_data:  mode2 samples, or durations that
+ * alternate between pulse and space.  Other words and their number are
+ * skipped.
+ */
+
+static int load_samples(const char *file_name, unsigned int **samples,
+                        size_t *nsamples)
+{
+  unsigned int *buf = NULL;
+  size_t size = 0;
+  size_t n = 0;
+  bool mode2 = false;
+  bool pulse = true;
+  char word[16];
+
+  FILE *file = fopen(file_name, "r");
+  if (file == NULL)
+    {
+      return -errno;
+    }
+
+  while (fscanf(file, "%15s", word) == 1)
+    {
+      unsigned int value;
+      unsigned int sample;
+
+      if (word[0] >= 'a' && word[0] <= 'z')
+        {
+          char number[16];
+
+          if (fscanf(file, "%15s", number) != 1)
+            {
+              break;
+            }
+
+          value = strtoul(number, 0, 0);
+          if (strcmp(word, "pulse") == 0)
+            {
+              sample = LIRC_PULSE(value);
+            }
+          else if (strcmp(word, "space") == 0)
+            {
+              sample = LIRC_SPACE(value);
+            }
+          else if (strcmp(word, "timeout") == 0)
+            {
+              sample = LIRC_TIMEOUT(value);
+            }
+          else
+            {
+              continue;
+            }
+        }
+      else
+        {
+          value = strtoul(word, 0, 0);
+          if (LIRC_MODE2(value) != 0)
+            {
+              sample = value;
+              mode2  = true;
+            }
+          else if (mode2)
+            {
+              sample = LIRC_SPACE(value);
+            }
+          else
+            {
+              sample = pulse ? LIRC_PULSE(value) : LIRC_SPACE(value);
+              pulse  = !pulse;
+            }
+        }
+
+      if (n == size)
+        {
+          size_t newsize = size ? size * 2 : 256;
+          unsigned int *newbuf;
+
+          newbuf = (unsigned int *)realloc(buf, newsize * sizeof(*buf));
+          if (newbuf == NULL)
+            {
+              free(buf);
+              fclose(file);
+              return -ENOMEM;
+            }
+
+          buf  = newbuf;
+          size = newsize;
+        }
+
+      buf[n++] = sample;
+    }
+
+  fclose(file);
+  *samples  = buf;
+  *nsamples = n;
+  return n > 0 ? 0 : -ENODATA;
+}
+
 static void print_cmd(const cmd *cmd)
 {
   printf("%s(", cmd->name);
@@ -508,6 +635,213 @@ CMD2(set_rec_carrier_range, size_t, index, unsigned int, carrier)
   return ioctl(g_irdevs[index], LIRC_SET_REC_CARRIER_RANGE, &carrier);
 }
 
+CMD3(send_scancode, size_t, index, protocol_t, protocol,
+     unsigned int, scancode)
+{
+  unsigned int data[IR_ENCODE_MAX];
+
+  if (index >= CONFIG_SYSTEM_IRTEST_MAX_NIRDEV)
+    {
+      return ERROR;
+    }
+
+  int size = ir_encode(protocol, scancode, g_toggle[index], data,
+                       IR_ENCODE_MAX);
+  if (size < 0)
+    {
+      return size;
+    }
+
+  /* RC5/RC6 receivers tell a new key press by the toggle bit */
+
+  g_toggle[index] = !g_toggle[index];
+  return write(g_irdevs[index], data, sizeof(unsigned int) * size);
+}
+
+CMD2(decode, size_t, index, size_t, count)
+{
+  unsigned int data[CONFIG_SYSTEM_IRTEST_MAX_SIRDATA];
+  ir_scancode codes[IR_PROTOCOL_NUM];
+  ir_decoder decoder;
+  size_t nframes = 0;
+  int result = 0;
+
+  if (index >= CONFIG_SYSTEM_IRTEST_MAX_NIRDEV)
+    {
+      return ERROR;
+    }
+
+  /* Decode the mode2 samples as they are received, until count frames
+   * are decoded or until SIGINT if count is zero.
+   */
+
+  g_stop = false;
+  signal(SIGINT, stop);
+
+  while (!g_stop && (count == 0 || nframes < count))
+    {
+      result = read(g_irdevs[index], data, sizeof(data));
+      if (result < 0)
+        {
+          result = errno == EINTR ? 0 : -errno;
+          break;
+        }
+
+      result /= sizeof(unsigned int);
+      for (int i = 0; i < result; i++)
+        {
+          int n = decoder.feed(data[i], codes);
+          for (int j = 0; j < n; j++)
+            {
+              print_scancode(&codes[j]);
+              nframes++;
+            }
+        }
+    }
+
+  signal(SIGINT, SIG_DFL);
+  return result < 0 ? result : (int)nframes;
+}
+
+CMD3(record_data, size_t, index, const char *, file_name, size_t, count)
+{
+  unsigned int data[CONFIG_SYSTEM_IRTEST_MAX_SIRDATA];
+  size_t nsamples = 0;
+  int result = 0;
+
+  if (index >= CONFIG_SYSTEM_IRTEST_MAX_NIRDEV)
+    {
+      return ERROR;
+    }
+
+  FILE *file = fopen(file_name, "w");
+  if (file == NULL)
+    {
+      return -errno;
+    }
+
+  /* Write count mode2 samples (until SIGINT if zero) for bench_file */
+
+  g_stop = false;
+  signal(SIGINT, stop);
+
+  while (!g_stop && (count == 0 || nsamples < count))
+    {
+      result = read(g_irdevs[index], data, sizeof(data));
+      if (result < 0)
+        {
+          result = errno == EINTR ? 0 : -errno;
+          break;
+        }
+
+      result /= sizeof(unsigned int);
+      for (int i = 0; i < result; i++)
+        {
+          const char *word = LIRC_IS_PULSE(data[i]) ? "pulse" :
+                             LIRC_IS_SPACE(data[i]) ? "space" :
+                             LIRC_IS_TIMEOUT(data[i]) ? "timeout" : 0;
+
+          if (word != 0)
+            {
+              fprintf(file, "%s %u\n", word, LIRC_VALUE(data[i]));
+              nsamples++;
+            }
+        }
+    }
+
+  signal(SIGINT, SIG_DFL);
+  fclose(file);
+  return result < 0 ? result : (int)nsamples;
+}
+
+CMD2(bench_file, const char *, file_name, size_t, loops)
+{
+  size_t frames[IR_PROTOCOL_NUM] =
+  {
+  };
+
+  ir_scancode codes[IR_PROTOCOL_NUM];
+  ir_decoder decoder;
+  struct timespec start;
+  unsigned int *samples;
+  size_t nsamples;
+  uint64_t overhead = UINT64_MAX;
+  uint64_t total;
+  uint64_t worst = 0;
+  uint64_t sum = 0;
+
+  int ret = load_samples(file_name, &samples, &nsamples);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (loops == 0)
+    {
+      loops = 1;
+    }
+
+  /* Throughput:  decode the whole file loops times */
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t l = 0; l < loops; l++)
+    {
+      decoder.reset();
+      for (size_t i = 0; i < nsamples; i++)
+        {
+          int n = decoder.feed(samples[i], codes);
+          for (int j = 0; j < n; j++)
+            {
+              frames[codes[j].protocol]++;
+            }
+        }
+    }
+
+  total = elapsed_ns(&start);
+
+  /* Latency:  the time of each sample, less that of reading the clock */
+
+  for (int i = 0; i < 16; i++)
+    {
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      uint64_t ns = elapsed_ns(&start);
+      if (ns < overhead)
+        {
+          overhead = ns;
+        }
+    }
+
+  decoder.reset();
+  for (size_t i = 0; i < nsamples; i++)
+    {
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      decoder.feed(samples[i], codes);
+      uint64_t ns = elapsed_ns(&start);
+
+      ns     = ns > overhead ? ns - overhead : 0;
+      sum   += ns;
+      worst  = ns > worst ? ns : worst;
+    }
+
+  printf("%zu samples x %zu: %" PRIu64 " ns, %" PRIu64 " samples/s\n",
+         nsamples, loops, total,
+         total ? (uint64_t)nsamples * loops * 1000000000 / total : 0);
+  printf("latency per sample: avg %" PRIu64 " ns, max %" PRIu64 " ns\n",
+         sum / nsamples, worst);
+
+  for (int i = 0; i < IR_PROTOCOL_NUM; i++)
+    {
+      if (frames[i] != 0)
+        {
+          printf("%s: %zu frames\n", ir_protocol_name((protocol_t)i),
+                 frames[i] / loops);
+        }
+    }
+
+  free(samples);
+  return OK;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -545,6 +879,9 @@ const struct cmd *g_cmd_table[] =
 
   /* CMD2 */
 
+  &g_decode_cmd,
+  &g_bench_file_cmd,
+
   &g_read_data_cmd,
   &g_set_send_mode_cmd,
   &g_set_rec_mode_cmd,
@@ -559,5 +896,7 @@ const struct cmd *g_cmd_table[] =
 
   /* CMD3 */
 
+  &g_send_scancode_cmd,
+  &g_record_data_cmd,
   NULL,
 };
@@ -101,7 +101,7 @@
   };                                                       \
   static struct cmd g_##func##_cmd =                       \
   {                                                        \
-    #func, func##_args, func##_exec                        \
+    #func, g_##func##_args, func##_exec                    \
   };                                                       \
   static int func(type1 arg1, type2 arg2, type3 arg3)
 
@@ -0,0 +1,768 @@
+/****************************************************************************
+ * apps/system/irtest/decoder.cxx
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/lirc.h>
+#include <errno.h>
+#include <string.h>
+
+#include "decoder.hpp"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Protocol codings */
+
+#define IR_CODING_DISTANCE  0  /* Bit value in the space length (NEC) */
+#define IR_CODING_WIDTH     1  /* Bit value in the pulse length (Sony) */
+#define IR_CODING_BIPHASE   2  /* Manchester coded half-bits (RC5, RC6) */
+
+/* Accepted range of a duration t (us) of a protocol with time unit u:
+ * 25% of t, but at least a third of the unit.  Closer than that, the
+ * frames of one protocol start to look like those of another.
+ */
+
+#define IR_TOL(t, u)        ((t) / 4 > (u) / 3 ? (t) / 4 : (u) / 3)
+#define IR_RANGE(t, u)      { (t) - IR_TOL(t, u), (t) + IR_TOL(t, u) }
+#define IR_NONE             { 0, 0 }
+
+/* Biphase runs of n time units, within tol */
+
+#define IR_HALF(n, u, tol)  { (n) * (u) - (tol), (n) * (u) + (tol) }
+
+#define IR_NOTRAILER        0xff
+
+/* Pulse coded states */
+
+#define IR_IDLE             0
+#define IR_HDR_SPACE        1
+#define IR_BIT_PULSE        2
+#define IR_BIT_SPACE        3
+#define IR_STOP_PULSE       4
+#define IR_RPT_PULSE        5
+#define IR_TRAILING_GAP     6
+
+/* Biphase states, besides IR_IDLE and IR_HDR_SPACE */
+
+#define IR_DATA             7
+
+/* Pending half-bit of biphase coding */
+
+#define IR_HALF_NONE        0xff
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct ir_range
+{
+  uint32_t min;
+  uint32_t max;
+};
+
+/* Timing and framing of a protocol.  Ranges that a protocol does not use
+ * are empty.
+ */
+
+struct ir_protocol
+{
+  const char *name;
+  uint8_t coding;           /* IR_CODING_* */
+  uint8_t nbits;            /* Data bits of a frame */
+  uint8_t trailer;          /* Biphase: index of the double length bit */
+  uint8_t onefirst;         /* Biphase: level of the first half of a 1 */
+  uint16_t unit;            /* Time unit (us) */
+  ir_range hdr_pulse;       /* Header pulse */
+  ir_range hdr_space;       /* Header space */
+  ir_range rpt_space;       /* Header space of a repeat code */
+  ir_range pulse[2];        /* Pulse of a 0 and of a 1 bit */
+  ir_range space[2];        /* Space of a 0 and of a 1 bit */
+  ir_range stop;            /* Stop pulse after the data */
+  uint32_t gap;             /* Shortest space after a frame */
+  ir_range half[4];         /* Biphase: runs of 1 to 4 time units */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const ir_protocol g_ir_protocols[IR_PROTOCOL_NUM] =
+{
+  {
+    "NEC", IR_CODING_DISTANCE, 32, IR_NOTRAILER, 0, 560,
+    IR_RANGE(9000, 560), IR_RANGE(4500, 560), IR_RANGE(2250, 560),
+    {IR_RANGE(560, 560), IR_RANGE(560, 560)},
+    {IR_RANGE(560, 560), IR_RANGE(1690, 560)},
+    IR_RANGE(560, 560), 0,
+    {IR_NONE, IR_NONE, IR_NONE, IR_NONE}
+  },
+  {
+    "RC5", IR_CODING_BIPHASE, 14, IR_NOTRAILER, 0, 889,
+    IR_NONE, IR_NONE, IR_NONE,
+    {IR_NONE, IR_NONE}, {IR_NONE, IR_NONE}, IR_NONE, 0,
+    {
+      IR_HALF(1, 889, 296), IR_HALF(2, 889, 296),
+      IR_HALF(3, 889, 296), IR_HALF(4, 889, 296)
+    }
+  },
+  {
+    "RC6_0", IR_CODING_BIPHASE, 21, 4, 1, 444,
+    IR_RANGE(2666, 444), IR_RANGE(889, 444), IR_NONE,
+    {IR_NONE, IR_NONE}, {IR_NONE, IR_NONE}, IR_NONE, 0,
+    {
+      IR_HALF(1, 444, 221), IR_HALF(2, 444, 221),
+      IR_HALF(3, 444, 221), IR_HALF(4, 444, 221)
+    }
+  },
+  {
+    "SONY12", IR_CODING_WIDTH, 12, IR_NOTRAILER, 0, 600,
+    IR_RANGE(2400, 600), IR_RANGE(600, 600), IR_NONE,
+    {IR_RANGE(600, 600), IR_RANGE(1200, 600)},
+    {IR_RANGE(600, 600), IR_RANGE(600, 600)},
+    IR_NONE, 1500,
+    {IR_NONE, IR_NONE, IR_NONE, IR_NONE}
+  },
+  {
+    "SONY15", IR_CODING_WIDTH, 15, IR_NOTRAILER, 0, 600,
+    IR_RANGE(2400, 600), IR_RANGE(600, 600), IR_NONE,
+    {IR_RANGE(600, 600), IR_RANGE(1200, 600)},
+    {IR_RANGE(600, 600), IR_RANGE(600, 600)},
+    IR_NONE, 1500,
+    {IR_NONE, IR_NONE, IR_NONE, IR_NONE}
+  },
+  {
+    "SONY20", IR_CODING_WIDTH, 20, IR_NOTRAILER, 0, 600,
+    IR_RANGE(2400, 600), IR_RANGE(600, 600), IR_NONE,
+    {IR_RANGE(600, 600), IR_RANGE(1200, 600)},
+    {IR_RANGE(600, 600), IR_RANGE(600, 600)},
+    IR_NONE, 1500,
+    {IR_NONE, IR_NONE, IR_NONE, IR_NONE}
+  },
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static inline bool ir_match(const ir_range &range, unsigned int duration)
+{
+  return duration >= range.min && duration <= range.max;
+}
+
+static inline unsigned int ir_nominal(const ir_range &range)
+{
+  return (range.min + range.max) / 2;
+}
+
+/* The bit value of a pulse or space, or -1 if it is neither */
+
+static inline int ir_bitvalue(const ir_range *range, unsigned int duration)
+{
+  if (ir_match(range[0], duration))
+    {
+      return 0;
+    }
+  else if (ir_match(range[1], duration))
+    {
+      return 1;
+    }
+
+  return -1;
+}
+
+/* Append a duration of the given level to an encoded frame, merging it
+ * with the previous one of the same level.
+ */
+
+static int ir_put(unsigned int *buf, size_t size, int n, bool pulse,
+                  unsigned int duration)
+{
+  if (n < 0)
+    {
+      return n;
+    }
+
+  if (n > 0 && (n & 1) == pulse)
+    {
+      buf[n - 1] += duration;
+      return n;
+    }
+
+  if (n == 0 && !pulse)
+    {
+      return 0;         /* Leading space is idle */
+    }
+
+  if ((size_t)n >= size)
+    {
+      return -ENOSPC;
+    }
+
+  buf[n] = duration;
+  return n + 1;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+ir_decoder::ir_decoder()
+{
+  reset();
+}
+
+void ir_decoder::reset()
+{
+  memset(m_state, 0, sizeof(m_state));
+  m_space = UINT32_MAX;
+  for (int i = 0; i < IR_PROTOCOL_NUM; i++)
+    {
+      m_state[i].half = IR_HALF_NONE;
+    }
+}
+
+int ir_decoder::feed(unsigned int sample, ir_scancode *out)
+{
+  if (LIRC_IS_PULSE(sample))
+    {
+      return feed(true, LIRC_VALUE(sample), out);
+    }
+  else if (LIRC_IS_SPACE(sample))
+    {
+      return feed(false, LIRC_VALUE(sample), out);
+    }
+  else if (LIRC_IS_TIMEOUT(sample))
+    {
+      /* The receiver has seen no pulse for the timeout: a long space */
+
+      return feed(false, UINT32_MAX, out);
+    }
+  else if (LIRC_IS_OVERFLOW(sample))
+    {
+      reset();
+    }
+
+  return 0;
+}
+
+int ir_decoder::feed(bool pulse, unsigned int duration, ir_scancode *out)
+{
+  int n = 0;
+
+  for (int i = 0; i < IR_PROTOCOL_NUM; i++)
+    {
+      bool done;
+
+      if (g_ir_protocols[i].coding == IR_CODING_BIPHASE)
+        {
+          done = feed_biphase(i, pulse, duration, &out[n]);
+        }
+      else
+        {
+          done = feed_pulsecoded(i, pulse, duration, &out[n]);
+        }
+
+      if (done)
+        {
+          n++;
+        }
+    }
+
+  m_space = pulse ? 0 : duration;
+  return n;
+}
+
+/* The state machine of the pulse distance and pulse width codings:
+ *
+ *   IDLE -hdr pulse-> HDR_SPACE -hdr space-> BIT_PULSE <-> BIT_SPACE
+ *   HDR_SPACE -rpt space-> RPT_PULSE -stop-> IDLE (repeat code)
+ *   Last bit, distance coding:  BIT_SPACE -> STOP_PULSE -stop-> IDLE
+ *   Last bit, width coding:  BIT_PULSE -> TRAILING_GAP -gap-> IDLE
+ *
+ * Anything else restarts from IDLE with the same duration.
+ */
+
+bool ir_decoder::feed_pulsecoded(int proto, bool pulse,
+                                 unsigned int duration, ir_scancode *out)
+{
+  const ir_protocol *p = &g_ir_protocols[proto];
+  ir_state *s = &m_state[proto];
+  int bit;
+
+  switch (s->state)
+    {
+      case IR_HDR_SPACE:
+        if (!pulse && ir_match(p->hdr_space, duration))
+          {
+            s->state = IR_BIT_PULSE;
+            s->nbits = 0;
+            s->bits  = 0;
+            return false;
+          }
+
+        if (!pulse && ir_match(p->rpt_space, duration))
+          {
+            s->state = IR_RPT_PULSE;
+            return false;
+          }
+
+        break;
+
+      case IR_BIT_PULSE:
+        if (!pulse)
+          {
+            break;
+          }
+
+        if (p->coding == IR_CODING_DISTANCE)
+          {
+            if (ir_match(p->pulse[0], duration))
+              {
+                s->state = IR_BIT_SPACE;
+                return false;
+              }
+
+            break;
+          }
+
+        bit = ir_bitvalue(p->pulse, duration);
+        if (bit < 0)
+          {
+            break;
+          }
+
+        s->bits |= (uint32_t)bit << s->nbits++;
+        s->state = s->nbits == p->nbits ? IR_TRAILING_GAP : IR_BIT_SPACE;
+        return false;
+
+      case IR_BIT_SPACE:
+        if (pulse)
+          {
+            break;
+          }
+
+        if (p->coding == IR_CODING_WIDTH)
+          {
+            if (ir_match(p->space[0], duration))
+              {
+                s->state = IR_BIT_PULSE;
+                return false;
+              }
+
+            break;
+          }
+
+        bit = ir_bitvalue(p->space, duration);
+        if (bit < 0)
+          {
+            break;
+          }
+
+        s->bits |= (uint32_t)bit << s->nbits++;
+        s->state = s->nbits == p->nbits ? IR_STOP_PULSE : IR_BIT_PULSE;
+        return false;
+
+      case IR_STOP_PULSE:
+        if (pulse && ir_match(p->stop, duration))
+          {
+            s->state = IR_IDLE;
+            return finish(proto, out);
+          }
+
+        break;
+
+      case IR_TRAILING_GAP:
+        if (!pulse && duration >= p->gap)
+          {
+            s->state = IR_IDLE;
+            return finish(proto, out);
+          }
+
+        break;
+
+      case IR_RPT_PULSE:
+        if (pulse && ir_match(p->stop, duration) && s->haslast)
+          {
+            s->state      = IR_IDLE;
+            out->protocol = (protocol_t)proto;
+            out->scancode = s->last;
+            out->toggle   = false;
+            out->repeat   = true;
+            return true;
+          }
+
+        break;
+
+      default:
+        break;
+    }
+
+  /* Not part of a frame here, maybe the start of the next one */
+
+  s->state = pulse && ir_match(p->hdr_pulse, duration) ?
+             IR_HDR_SPACE : IR_IDLE;
+  return false;
+}
+
+/* The state machine of the biphase coding.  After the header (RC6) or the
+ * idle first half of the start bit (RC5), the pulses and spaces are split
+ * into half-bits, pairs of which are the bits.  A space too long for the
+ * coding ends the frame, completing a last bit whose second half is a
+ * space.
+ */
+
+bool ir_decoder::feed_biphase(int proto, bool pulse,
+                              unsigned int duration, ir_scancode *out)
+{
+  const ir_protocol *p = &g_ir_protocols[proto];
+  ir_state *s = &m_state[proto];
+  unsigned int units;
+  uint8_t level = pulse;
+  bool start = false;
+
+  switch (s->state)
+    {
+      case IR_IDLE:
+        if (!pulse)
+          {
+            return false;
+          }
+
+        if (p->hdr_pulse.max != 0)
+          {
+            if (ir_match(p->hdr_pulse, duration))
+              {
+                s->state = IR_HDR_SPACE;
+              }
+
+            return false;
+          }
+
+        /* No header:  The first half of the start bit was the idle space,
+         * which must be longer than any space of a frame.
+         */
+
+        if (m_space <= p->half[3].max)
+          {
+            return false;
+          }
+
+        s->state = IR_DATA;
+        s->nbits = 0;
+        s->bits  = 0;
+        s->half  = 0;
+        start    = true;
+        break;
+
+      case IR_HDR_SPACE:
+        if (!pulse && ir_match(p->hdr_space, duration))
+          {
+            s->state = IR_DATA;
+            s->nbits = 0;
+            s->bits  = 0;
+            s->half  = IR_HALF_NONE;
+            return false;
+          }
+
+        goto restart;
+
+      default:
+        break;
+    }
+
+  /* The length of the run in time units */
+
+  for (units = 0; units < 4; units++)
+    {
+      if (ir_match(p->half[units], duration))
+        {
+          break;
+        }
+    }
+
+  if (units == 4)
+    {
+      if (!pulse && duration > p->half[3].max &&
+          s->half == 1 && s->nbits + 1 == p->nbits)
+        {
+          s->state = IR_IDLE;
+          s->bits  = s->bits << 1 | (p->onefirst == 1);
+          s->nbits++;
+          return finish(proto, out);
+        }
+
+      goto restart;
+    }
+
+  /* Take the half-bits from the run */
+
+  for (units++; units > 0; )
+    {
+      unsigned int len = s->nbits == p->trailer ? 2 : 1;
+
+      if (units < len || s->half == level)
+        {
+          goto restart;
+        }
+
+      units -= len;
+      if (s->half == IR_HALF_NONE)
+        {
+          s->half = level;
+          continue;
+        }
+
+      s->bits = s->bits << 1 | (s->half == p->onefirst);
+      s->half = IR_HALF_NONE;
+      if (++s->nbits == p->nbits)
+        {
+          /* The rest of a space is the gap after the frame */
+
+          s->state = IR_IDLE;
+          return (units == 0 || !pulse) && finish(proto, out);
+        }
+    }
+
+  return false;
+
+restart:
+
+  /* Not part of a frame here, maybe the start of the next one */
+
+  s->state = IR_IDLE;
+  s->half  = IR_HALF_NONE;
+  return pulse && !start ? feed_biphase(proto, pulse, duration, out) :
+                           false;
+}
+
+/* Check a complete frame and convert it to a scancode */
+
+bool ir_decoder::finish(int proto, ir_scancode *out)
+{
+  ir_state *s = &m_state[proto];
+  uint32_t bits = s->bits;
+  uint32_t scancode;
+  bool toggle = false;
+
+  switch (proto)
+    {
+      case IR_PROTOCOL_NEC:
+        {
+          uint32_t addr  = bits & 0xff;
+          uint32_t naddr = (bits >> 8) & 0xff;
+          uint32_t cmd   = (bits >> 16) & 0xff;
+
+          if ((cmd ^ (bits >> 24)) != 0xff)
+            {
+              return false;
+            }
+
+          scancode = (addr ^ naddr) == 0xff ? addr << 8 | cmd :
+                     addr << 16 | naddr << 8 | cmd;
+        }
+        break;
+
+      case IR_PROTOCOL_RC5:
+        if ((bits >> 13) == 0)
+          {
+            return false;         /* Start bit */
+          }
+
+        toggle   = (bits >> 11) & 1;
+        scancode = ((bits >> 6) & 0x1f) << 8 | (bits & 0x3f) |
+                   (((bits >> 12) & 1) ^ 1) << 6;
+        break;
+
+      case IR_PROTOCOL_RC6_0:
+        if ((bits >> 17) != 0x8)
+          {
+            return false;         /* Start bit and mode 0 */
+          }
+
+        toggle   = (bits >> 16) & 1;
+        scancode = bits & 0xffff;
+        break;
+
+      case IR_PROTOCOL_SONY20:
+        scancode = ((bits >> 12) & 0xff) << 16 |
+                   ((bits >> 7) & 0x1f) << 8 | (bits & 0x7f);
+        break;
+
+      default:                    /* SONY12, SONY15 */
+        scancode = (bits >> 7) << 8 | (bits & 0x7f);
+        break;
+    }
+
+  s->last       = scancode;
+  s->haslast    = true;
+
+  out->protocol = (protocol_t)proto;
+  out->scancode = scancode;
+  out->toggle   = toggle;
+  out->repeat   = false;
+  return true;
+}
+
+const char *ir_protocol_name(protocol_t protocol)
+{
+  return (unsigned int)protocol < IR_PROTOCOL_NUM ?
+         g_ir_protocols[protocol].name : "?";
+}
+
+int ir_encode(protocol_t protocol, uint32_t scancode, bool toggle,
+              unsigned int *buf, size_t size)
+{
+  const ir_protocol *p;
+  uint32_t bits;
+  int n = 0;
+  int i;
+
+  if ((unsigned int)protocol >= IR_PROTOCOL_NUM)
+    {
+      return -EINVAL;
+    }
+
+  p = &g_ir_protocols[protocol];
+
+  /* The bits of the frame, in the order they are sent */
+
+  switch (protocol)
+    {
+      case IR_PROTOCOL_NEC:
+        {
+          uint32_t cmd = scancode & 0xff;
+          uint32_t addr;
+
+          if (scancode > 0xffffff)
+            {
+              return -EINVAL;
+            }
+
+          addr = scancode > 0xffff ?
+                 ((scancode >> 16) | (scancode & 0xff00)) :
+                 (scancode >> 8) | ((~scancode >> 8) & 0xff) << 8;
+          bits = addr | cmd << 16 | (cmd ^ 0xff) << 24;
+        }
+        break;
+
+      case IR_PROTOCOL_RC5:
+        if ((scancode & ~0x1f7f) != 0)
+          {
+            return -EINVAL;
+          }
+
+        bits = 1 << 13 | (((scancode >> 6) & 1) ^ 1) << 12 |
+               (uint32_t)toggle << 11 | ((scancode >> 8) & 0x1f) << 6 |
+               (scancode & 0x3f);
+        break;
+
+      case IR_PROTOCOL_RC6_0:
+        if (scancode > 0xffff)
+          {
+            return -EINVAL;
+          }
+
+        bits = 1 << 20 | (uint32_t)toggle << 16 | scancode;
+        break;
+
+      case IR_PROTOCOL_SONY20:
+        if ((scancode & ~0xff1f7f) != 0)
+          {
+            return -EINVAL;
+          }
+
+        bits = (scancode & 0x7f) | ((scancode >> 8) & 0x1f) << 7 |
+               ((scancode >> 16) & 0xff) << 12;
+        break;
+
+      default:
+        if ((scancode & ~0xff7f) != 0 ||
+            (protocol == IR_PROTOCOL_SONY12 && scancode > 0x1f7f))
+          {
+            return -EINVAL;
+          }
+
+        bits = (scancode & 0x7f) | (scancode >> 8) << 7;
+        break;
+    }
+
+  if (p->coding == IR_CODING_BIPHASE)
+    {
+      /* Most significant bit first, each bit two half-bits */
+
+      if (p->hdr_pulse.max != 0)
+        {
+          n = ir_put(buf, size, n, true, ir_nominal(p->hdr_pulse));
+          n = ir_put(buf, size, n, false, ir_nominal(p->hdr_space));
+        }
+
+      for (i = p->nbits - 1; i >= 0; i--)
+        {
+          unsigned int len = p->unit;
+          bool first = ((bits >> i) & 1) == p->onefirst;
+
+          if (p->nbits - 1 - i == p->trailer)
+            {
+              len *= 2;
+            }
+
+          n = ir_put(buf, size, n, first, len);
+          n = ir_put(buf, size, n, !first, len);
+        }
+    }
+  else
+    {
+      /* Least significant bit first */
+
+      n = ir_put(buf, size, n, true, ir_nominal(p->hdr_pulse));
+      n = ir_put(buf, size, n, false, ir_nominal(p->hdr_space));
+
+      for (i = 0; i < p->nbits; i++)
+        {
+          int bit = (bits >> i) & 1;
+
+          n = ir_put(buf, size, n, true, ir_nominal(p->pulse[bit]));
+          if (p->coding == IR_CODING_DISTANCE || i + 1 < p->nbits)
+            {
+              n = ir_put(buf, size, n, false, ir_nominal(p->space[bit]));
+            }
+        }
+
+      if (p->stop.max != 0)
+        {
+          n = ir_put(buf, size, n, true, ir_nominal(p->stop));
+        }
+    }
+
+  /* A trailing space is not sent */
+
+  if (n > 0 && (n & 1) == 0)
+    {
+      n--;
+    }
+
+  return n;
+}
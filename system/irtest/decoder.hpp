@@ -0,0 +1,137 @@
+/****************************************************************************
+ * apps/system/irtest/decoder.hpp
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_SYSTEM_IRTEST_DECODER_HPP
+#define __APPS_SYSTEM_IRTEST_DECODER_HPP
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The most durations an encoded frame has (NEC: header, 32 bits, stop) */
+
+#define IR_ENCODE_MAX  72
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* The protocols, the order of g_ir_protocols.  Scancodes are:
+ *
+ *   NEC:     address << 8 | command, or for extended NEC (address not
+ *            inverted) address << 16 | address2 << 8 | command
+ *   RC5:     address << 8 | command (7 bits, bit 6 from the field bit)
+ *   RC6_0:   address << 8 | command (RC6 mode 0)
+ *   SONYxx:  extended << 16 | address << 8 | command
+ */
+
+enum protocol_t
+{
+  IR_PROTOCOL_NEC,
+  IR_PROTOCOL_RC5,
+  IR_PROTOCOL_RC6_0,
+  IR_PROTOCOL_SONY12,
+  IR_PROTOCOL_SONY15,
+  IR_PROTOCOL_SONY20,
+  IR_PROTOCOL_NUM
+};
+
+/* A decoded frame */
+
+struct ir_scancode
+{
+  protocol_t protocol;
+  uint32_t scancode;
+  bool toggle;            /* RC5/RC6 toggle bit */
+  bool repeat;            /* NEC repeat code, scancode of the last frame */
+};
+
+/* State of the state machine of one protocol */
+
+struct ir_state
+{
+  uint8_t state;
+  uint8_t nbits;          /* Bits received */
+  uint8_t half;           /* Biphase: level of the pending first half-bit */
+  uint32_t bits;          /* The bits received */
+  uint32_t last;          /* Last scancode, for repeat codes */
+  bool haslast;
+};
+
+/* Decodes all protocols from a stream of LIRC mode2 samples.  Each
+ * protocol has its own state machine, driven by its entry in the protocol
+ * table, and all of them see every sample.
+ */
+
+class ir_decoder
+{
+public:
+  ir_decoder();
+
+  void reset();
+
+  /* Feed one mode2 sample (LIRC_PULSE/SPACE/TIMEOUT/...).  The frames
+   * completed by it are stored in out[IR_PROTOCOL_NUM]; returns their
+   * number.
+   */
+
+  int feed(unsigned int sample, ir_scancode *out);
+
+  /* Feed one pulse or space duration in microseconds */
+
+  int feed(bool pulse, unsigned int duration, ir_scancode *out);
+
+private:
+  bool feed_pulsecoded(int proto, bool pulse, unsigned int duration,
+                       ir_scancode *out);
+  bool feed_biphase(int proto, bool pulse, unsigned int duration,
+                    ir_scancode *out);
+  bool finish(int proto, ir_scancode *out);
+
+  ir_state m_state[IR_PROTOCOL_NUM];
+  unsigned int m_space;   /* Length of the previous space, 0 if a pulse */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/* The name of a protocol */
+
+const char *ir_protocol_name(protocol_t protocol);
+
+/* Encode a frame as alternating pulse and space durations (microseconds)
+ * starting and ending with a pulse, as LIRC_MODE_PULSE transmits them.
+ * Returns the number of durations or a negated errno value.
+ */
+
+int ir_encode(protocol_t protocol, uint32_t scancode, bool toggle,
+              unsigned int *buf, size_t size);
+
+#endif /* __APPS_SYSTEM_IRTEST_DECODER_HPP */
@@ -25,6 +25,7 @@
  ****************************************************************************/
 
 #include "enum.hpp"
+#include "decoder.hpp"
 #include <nuttx/lirc.h>
 #include <stdio.h>
 
@@ -66,6 +67,15 @@ ENUM_START(features_t)
     ENUM_VALUE(LIRC_CAN_NOTIFY_DECODE)
 ENUM_END(features_t, "0x%08x")
 
+ENUM_START(protocol_t)
+    ENUM_VALUE(IR_PROTOCOL_NEC)
+    ENUM_VALUE(IR_PROTOCOL_RC5)
+    ENUM_VALUE(IR_PROTOCOL_RC6_0)
+    ENUM_VALUE(IR_PROTOCOL_SONY12)
+    ENUM_VALUE(IR_PROTOCOL_SONY15)
+    ENUM_VALUE(IR_PROTOCOL_SONY20)
+ENUM_END(protocol_t, "%u")
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -74,6 +84,7 @@ const struct enum_type *g_enum_table[] =
 {
   &g_mode_t_type,
   &g_features_t_type,
+  &g_protocol_t_type,
   NULL,
 };
 
@@ -122,8 +122,14 @@ int main(int argc, FAR char *argv[])
                           offset_buf, sizeof(offset_buf));
       format_ntptimestamp(status.samples[i].delay,
                           delay_buf, sizeof(delay_buf));
-      printf("[%u] srv %s offset %s delay %s\n",
-             i, name, offset_buf, delay_buf);
+      printf("[%u] srv %s offset %s delay %s%s\n",
+             i, name, offset_buf, delay_buf,
+             status.samples[i].selected ? "" : " falseticker");
+    }
+
+  if (status.poll > 0)
+    {
+      printf("Poll interval: %u seconds\n", status.poll);
     }
 
   return EXIT_SUCCESS;
@@ -26,6 +26,7 @@
 
 #include <nuttx/config.h>
 
+#include <inttypes.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <sys/socket.h>
@@ -49,6 +50,27 @@ static int do_ptpd_start(FAR const struct ptpd_config_s *config)
   return EXIT_FAILURE;
 }
 
+static void print_histogram(FAR const char *name,
+                            FAR const uint32_t *histogram)
+{
+  long limit = 1 << PTPD_HISTOGRAM_SHIFT;
+  int i;
+
+  printf("- %s:\n", name);
+  for (i = 0; i < PTPD_HISTOGRAM_BINS - 1; i++, limit <<= 1)
+    {
+      if (histogram[i] != 0)
+        {
+          printf("|  < %8ld ns: %" PRIu32 "\n", limit, histogram[i]);
+        }
+    }
+
+  if (histogram[i] != 0)
+    {
+      printf("| >= %8ld ns: %" PRIu32 "\n", limit >> 1, histogram[i]);
+    }
+}
+
 static int do_ptpd_status(int pid)
 {
   struct ptpd_status_s status;
@@ -103,6 +125,14 @@ static int do_ptpd_status(int pid)
   printf("- last_adjtime_ns: %lld\n", (long long)status.last_adjtime_ns);
   printf("- drift_ppb: %ld\n", status.drift_ppb);
   printf("- path_delay_ns: %ld\n", status.path_delay_ns);
+  printf("- samples: %lu\n", status.samples);
+  printf("- offset_min_ns: %lld\n", (long long)status.offset_min_ns);
+  printf("- offset_max_ns: %lld\n", (long long)status.offset_max_ns);
+  printf("- jitter_ns: %ld\n", status.jitter_ns);
+  print_histogram("offset_histogram", status.offset_histogram);
+  print_histogram("jitter_histogram", status.jitter_histogram);
+  printf("- unicast_clients: %d\n", status.unicast_clients);
+  printf("- delayresp_count: %lu\n", status.delayresp_count);
 
   clock_gettime(CLOCK_MONOTONIC, &time_now);
 
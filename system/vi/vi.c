@@ -76,10 +76,13 @@
 #define MAX_FILENAME    128  /* The maximum size of a filename or search string */
 #define SCRATCH_BUFSIZE 128  /* The maximum size of the scratch buffer */
 #define CMD_BUFSIZE     128  /* The maximum size of the scratch buffer */
+#define OUT_BUFSIZE     128  /* Display output is collected in this buffer */
+#define LINECOL_BUFSIZE 24   /* Size of the line/column status cache */
 
 #define TEXT_GULP_SIZE  512  /* Text buffer allocations are managed with this unit */
 #define TEXT_GULP_MASK  511  /* Mask for aligning buffer allocation sizes */
 #define ALIGN_GULP(x)   (((x) + TEXT_GULP_MASK) & ~TEXT_GULP_MASK)
+#define NL_GULP_SIZE    64   /* Newline index allocation unit */
 
 #define VI_TABSIZE      8    /* A TAB is eight characters */
 #define TABMASK         7    /* Mask for TAB alignment */
@@ -311,10 +314,33 @@ struct vi_s
 
   FAR char *text;           /* Dynamically allocated text buffer */
   size_t txtalloc;          /* Current allocated size of the text buffer */
+  off_t gappos;             /* Text offset of the gap in the text buffer */
+  FAR off_t *nl;            /* Offsets of the newlines in the text */
+  size_t nlalloc;           /* Current allocated entries of nl[] */
+  size_t nlcount;           /* Number of newlines in the text */
+  size_t nlgap;             /* Index of the gap in nl[] */
   FAR char *yank;           /* Dynamically allocated yank buffer */
   size_t yankalloc;         /* Current allocated size of the yank buffer */
   size_t yanksize;          /* Current size of the text in the yank buffer */
 
+  /* Display state.  shadow[] holds the text rows as they are on the
+   * display, followed by one row in which the next row is composed.
+   */
+
+  FAR char *shadow;         /* Dynamically allocated display shadow */
+  uint16_t termrow;         /* Display cursor row, if termvalid */
+  uint16_t termcol;         /* Display cursor column, if termvalid */
+  bool termvalid;           /* True: The display cursor position is known */
+  bool cursorhidden;        /* True: The cursor is off during an update */
+  bool message;             /* True: A search message is on the bottom line */
+  uint8_t linecollen;       /* Length of linecol[], 0 if not shown */
+  char linecol[LINECOL_BUFSIZE]; /* Line/column shown on the bottom line */
+  uint16_t outlen;          /* Number of bytes in outbuf[] */
+  char outbuf[OUT_BUFSIZE]; /* Display output not yet written */
+  uint32_t nwritten;        /* Total bytes written to the display */
+  uint32_t keymark;         /* Value of nwritten at the last keystroke */
+  uint32_t keybytes;        /* Bytes written for the last keystroke */
+
   char filename[MAX_FILENAME];    /* Holds the currently selected filename */
   char findstr[MAX_STRING];       /* Holds the current search string */
   char scratch[SCRATCH_BUFSIZE];  /* For general, scratch usage */
@@ -340,6 +366,7 @@ struct vi_s
 
 /* Low-level display and data entry functions */
 
+static void     vi_flush(FAR struct vi_s *vi);
 static void     vi_write(FAR struct vi_s *vi, FAR const char *buffer,
                   size_t buflen);
 static void     vi_putch(FAR struct vi_s *vi, char ch);
@@ -358,6 +385,12 @@ static void     vi_cursorhome(FAR struct vi_s *vi);
 static void     vi_setcursor(FAR struct vi_s *vi, uint16_t row,
                   uint16_t column);
 static void     vi_clrtoeol(FAR struct vi_s *vi);
+static void     vi_scrollup(FAR struct vi_s *vi, uint16_t nlines);
+static void     vi_scrolldown(FAR struct vi_s *vi, uint16_t nlines);
+static bool     vi_initdisplay(FAR struct vi_s *vi);
+static void     vi_invalidate(FAR struct vi_s *vi);
+static void     vi_updaterow(FAR struct vi_s *vi, uint16_t row,
+                  uint16_t len);
 #if 0 /* Not used */
 static void     vi_clrscreen(FAR struct vi_s *vi);
 #endif
@@ -369,6 +402,9 @@ static void     vi_printf(FAR struct vi_s *vi, FAR const char *prefix,
 
 /* Line positioning */
 
+static off_t    vi_nlget(FAR struct vi_s *vi, size_t index);
+static size_t   vi_nlfind(FAR struct vi_s *vi, off_t pos);
+static off_t    vi_linepos(FAR struct vi_s *vi, size_t line);
 static off_t    vi_linebegin(FAR struct vi_s *vi, off_t pos);
 static off_t    vi_prevline(FAR struct vi_s *vi, off_t pos);
 static off_t    vi_lineend(FAR struct vi_s *vi, off_t pos);
@@ -376,8 +412,18 @@ static off_t    vi_nextline(FAR struct vi_s *vi, off_t pos);
 
 /* Text buffer management */
 
+static char     vi_charat(FAR struct vi_s *vi, off_t pos);
+static void     vi_setcharat(FAR struct vi_s *vi, off_t pos, char ch);
+static void     vi_copytext(FAR struct vi_s *vi, FAR char *dest, off_t pos,
+                  size_t size);
+static bool     vi_matchtext(FAR struct vi_s *vi, off_t pos,
+                  FAR const char *str, size_t len);
+static void     vi_movegap(FAR struct vi_s *vi, off_t pos);
+static void     vi_nlmovegap(FAR struct vi_s *vi, size_t index);
+static bool     vi_nlreserve(FAR struct vi_s *vi, size_t count);
+static bool     vi_indextext(FAR struct vi_s *vi, off_t pos, size_t size);
 static bool     vi_extendtext(FAR struct vi_s *vi, off_t pos,
-                  size_t increment);
+                  FAR const char *src, size_t increment);
 static void     vi_shrinkpos(FAR struct vi_s *vi, off_t delpos,
                   size_t delsize, FAR off_t *pos);
 static void     vi_shrinktext(FAR struct vi_s *vi, off_t pos, size_t size);
@@ -501,6 +547,11 @@ static const char g_blinkoff[]      = VT100_BLINKOFF;
 
 static const char g_fmtcursorpos[]  = VT100_FMT_CURSORPOS;
 
+/* Set and reset the scrolling region (DECSTBM) */
+
+static const char g_fmtscrollwin[]  = "\033[%d;%dr";
+static const char g_resetscroll[]   = "\033[r";
+
 /* Error format strings */
 
 static const char g_fmtallocfail[]  = "Failed to allocate memory";
@@ -524,28 +575,35 @@ static const char g_fmtinsert[]     = "--INSERT--";
  ****************************************************************************/
 
 /****************************************************************************
- * Name: vi_write
+ * Name: vi_flush
  *
  * Description:
- *   Write a sequence of bytes to the console device (stdout, fd = 1).
+ *   Write the collected display output to the console device (stdout,
+ *   fd = 1).
  *
  ****************************************************************************/
 
-static void vi_write(FAR struct vi_s *vi, FAR const char *buffer,
-                     size_t buflen)
+static void vi_flush(FAR struct vi_s *vi)
 {
+  FAR const char *buffer = vi->outbuf;
+  size_t nremaining = vi->outlen;
   ssize_t nwritten;
-  size_t  nremaining = buflen;
+
+  /* Empty the buffer first so that vi_release() on the error path does
+   * not try to write it again.
+   */
+
+  vi->outlen = 0;
 
   /* Loop until all bytes have been successfully written (or until a
    * unrecoverable error is encountered)
    */
 
-  do
+  while (nremaining > 0)
     {
       /* Take the next gulp */
 
-      nwritten = write(1, buffer, buflen);
+      nwritten = write(1, buffer, nremaining);
 
       /* Handle write errors.  write() should neve return 0. */
 
@@ -565,16 +623,50 @@ static void vi_write(FAR struct vi_s *vi, FAR const char *buffer,
             }
         }
 
-      /* Decrement the count of bytes remaining to be sent (to handle the
-       * case of a partial write)
+      /* Advance past the bytes sent (to handle the case of a partial
+       * write)
        */
 
       else
         {
+          buffer     += nwritten;
           nremaining -= nwritten;
         }
     }
-  while (nremaining > 0);
+}
+
+/****************************************************************************
+ * Name: vi_write
+ *
+ * Description:
+ *   Queue a sequence of bytes for the console device.  The output is
+ *   written when the buffer fills and before waiting for the next key.
+ *
+ ****************************************************************************/
+
+static void vi_write(FAR struct vi_s *vi, FAR const char *buffer,
+                     size_t buflen)
+{
+  size_t nbytes;
+
+  /* Any output moves the display cursor */
+
+  vi->nwritten  += buflen;
+  vi->termvalid  = false;
+
+  while (buflen > 0)
+    {
+      if (vi->outlen >= OUT_BUFSIZE)
+        {
+          vi_flush(vi);
+        }
+
+      nbytes = MIN(buflen, OUT_BUFSIZE - vi->outlen);
+      memcpy(&vi->outbuf[vi->outlen], buffer, nbytes);
+      vi->outlen += nbytes;
+      buffer     += nbytes;
+      buflen     -= nbytes;
+    }
 }
 
 /****************************************************************************
@@ -603,6 +695,16 @@ static int vi_getch(FAR struct vi_s *vi)
   char buffer;
   ssize_t nread;
 
+  /* Account the display output of the last keystroke and send it before
+   * waiting for the next one.
+   */
+
+  vi->keybytes = vi->nwritten - vi->keymark;
+  vi->keymark  = vi->nwritten;
+  viinfo("Last key wrote %lu bytes\n", (unsigned long)vi->keybytes);
+
+  vi_flush(vi);
+
   /* Loop until we successfully read a character (or until an unexpected
    * error occurs).
    */
@@ -663,6 +765,7 @@ static void vi_clearbottomline(FAR struct vi_s *vi)
 {
   vi_setcursor(vi, vi->display.row - 1, 0);
   vi_clrtoeol(vi);
+  vi->message = false;
 }
 
 /****************************************************************************
@@ -677,7 +780,7 @@ static void vi_boldon(FAR struct vi_s *vi)
 {
   /* Send the VT100 BOLDON command */
 
-  vi_write(vi, g_boldon, sizeof(g_boldon));
+  vi_write(vi, g_boldon, sizeof(g_boldon) - 1);
 }
 
 /****************************************************************************
@@ -692,7 +795,7 @@ static void vi_reverseon(FAR struct vi_s *vi)
 {
   /* Send the VT100 REVERSON command */
 
-  vi_write(vi, g_reverseon, sizeof(g_reverseon));
+  vi_write(vi, g_reverseon, sizeof(g_reverseon) - 1);
 }
 
 /****************************************************************************
@@ -707,7 +810,7 @@ static void vi_attriboff(FAR struct vi_s *vi)
 {
   /* Send the VT100 ATTRIBOFF command */
 
-  vi_write(vi, g_attriboff, sizeof(g_attriboff));
+  vi_write(vi, g_attriboff, sizeof(g_attriboff) - 1);
 }
 
 /****************************************************************************
@@ -722,7 +825,7 @@ static void vi_cursoron(FAR struct vi_s *vi)
 {
   /* Send the VT100 CURSORON command */
 
-  vi_write(vi, g_cursoron, sizeof(g_cursoron));
+  vi_write(vi, g_cursoron, sizeof(g_cursoron) - 1);
 }
 
 /****************************************************************************
@@ -737,7 +840,7 @@ static void vi_cursoroff(FAR struct vi_s *vi)
 {
   /* Send the VT100 CURSOROFF command */
 
-  vi_write(vi, g_cursoroff, sizeof(g_cursoroff));
+  vi_write(vi, g_cursoroff, sizeof(g_cursoroff) - 1);
 }
 
 /****************************************************************************
@@ -755,6 +858,20 @@ static void vi_setcursor(FAR struct vi_s *vi, uint16_t row, uint16_t column)
 
   viinfo("row=%d column=%d\n", row, column);
 
+  /* Nothing to send if the cursor is already there */
+
+  if (vi->termvalid && vi->termrow == row && vi->termcol == column)
+    {
+      return;
+    }
+
+  /* Anything written to the bottom line replaces the line/column status */
+
+  if (row == vi->display.row - 1)
+    {
+      vi->linecollen = 0;
+    }
+
   /* Format the cursor position command.  The origin is (1,1). */
 
   len = snprintf(buffer, sizeof(buffer), g_fmtcursorpos,
@@ -763,6 +880,10 @@ static void vi_setcursor(FAR struct vi_s *vi, uint16_t row, uint16_t column)
   /* Send the VT100 CURSORPOS command */
 
   vi_write(vi, buffer, MIN(len, sizeof(buffer)));
+
+  vi->termrow   = row;
+  vi->termcol   = column;
+  vi->termvalid = true;
 }
 
 /****************************************************************************
@@ -778,63 +899,208 @@ static void vi_clrtoeol(FAR struct vi_s *vi)
 {
   /* Send the VT100 ERASETOEOL command */
 
-  vi_write(vi, g_erasetoeol, sizeof(g_erasetoeol));
+  vi_write(vi, g_erasetoeol, sizeof(g_erasetoeol) - 1);
 }
 
 /****************************************************************************
  * Name: vi_scrollup
  *
  * Description:
- *   Scroll the display up 'nlines' by sending the VT100 INDEX command.
+ *   Scroll the text rows of the display up 'nlines' by sending the VT100
+ *   INDEX command at the bottom of the scrolling region.  The bottom line
+ *   lies outside of the scrolling region and is not affected, a search
+ *   message on it is cleared here as scrolling the whole display would.
  *
  ****************************************************************************/
 
 static void vi_scrollup(FAR struct vi_s *vi, uint16_t nlines)
 {
+  uint16_t nrows = vi->display.row - 1;
+  size_t ncols = vi->display.column;
+
   viinfo("nlines=%d\n", nlines);
+  DEBUGASSERT(nlines < nrows);
+
+  if (vi->message)
+    {
+      vi_clearbottomline(vi);
+    }
 
   /* Scroll for the specified number of lines */
 
+  vi_setcursor(vi, nrows - 1, 0);
   for (; nlines; nlines--)
     {
       /* Send the VT100 INDEX command */
 
-      vi_write(vi, g_index, sizeof(g_index));
-    }
+      vi_write(vi, g_index, sizeof(g_index) - 1);
 
-  /* Ensure bottom line is cleared */
+      /* The display shadow scrolls with it, a blank row comes in */
 
-  vi_setcursor(vi, vi->display.row - 1, 0);
-  vi_clrtoeol(vi);
+      memmove(vi->shadow, &vi->shadow[ncols], (nrows - 1) * ncols);
+      memset(&vi->shadow[(nrows - 1) * ncols], ' ', ncols);
+    }
 }
 
 /****************************************************************************
  * Name: vi_scrolldown
  *
  * Description:
- *   Scroll the display down 'nlines' by sending the VT100 REVINDEX command.
+ *   Scroll the text rows of the display down 'nlines' by sending the VT100
+ *   REVINDEX command at the top of the scrolling region.  Like
+ *   vi_scrollup(), this clears a search message on the bottom line.
  *
  ****************************************************************************/
 
 static void vi_scrolldown(FAR struct vi_s *vi, uint16_t nlines)
 {
-  viinfo("nlines=%d\n", nlines);
+  uint16_t nrows = vi->display.row - 1;
+  size_t ncols = vi->display.column;
 
-  /* Ensure the bottom line is cleared after the scroll */
+  viinfo("nlines=%d\n", nlines);
+  DEBUGASSERT(nlines < nrows);
 
-  vi_setcursor(vi, vi->display.row - 2, 0);
-  vi_clrtoeol(vi);
+  if (vi->message)
+    {
+      vi_clearbottomline(vi);
+    }
 
   /* Scroll for the specified number of lines */
 
+  vi_setcursor(vi, 0, 0);
   for (; nlines; nlines--)
     {
       /* Send the VT100 REVINDEX command */
 
-      vi_write(vi, g_revindex, sizeof(g_revindex));
+      vi_write(vi, g_revindex, sizeof(g_revindex) - 1);
+
+      memmove(&vi->shadow[ncols], vi->shadow, (nrows - 1) * ncols);
+      memset(vi->shadow, ' ', ncols);
     }
 }
 
+/****************************************************************************
+ * Name: vi_initdisplay
+ *
+ * Description:
+ *   Allocate the display shadow and limit scrolling to the text rows.  The
+ *   shadow starts out invalid so that the first update draws every row.
+ *
+ ****************************************************************************/
+
+static bool vi_initdisplay(FAR struct vi_s *vi)
+{
+  char buffer[16];
+  int len;
+
+  vi->shadow = malloc(vi->display.row * vi->display.column);
+  if (vi->shadow == NULL)
+    {
+      return false;
+    }
+
+  vi_invalidate(vi);
+
+  len = snprintf(buffer, sizeof(buffer), g_fmtscrollwin, 1,
+                 vi->display.row - 1);
+  vi_write(vi, buffer, MIN(len, sizeof(buffer)));
+  return true;
+}
+
+/****************************************************************************
+ * Name: vi_invalidate
+ *
+ * Description:
+ *   Forget what is on the display so that the next update redraws all of
+ *   it.  The shadow is filled with NULs, which never match a text row.
+ *
+ ****************************************************************************/
+
+static void vi_invalidate(FAR struct vi_s *vi)
+{
+  memset(vi->shadow, 0, (vi->display.row - 1) * vi->display.column);
+  vi->linecollen = 0;
+  vi->termvalid  = false;
+}
+
+/****************************************************************************
+ * Name: vi_updaterow
+ *
+ * Description:
+ *   Bring one text row of the display up to date with the first 'len'
+ *   characters of the composed row, sending only the columns that differ
+ *   from the display shadow.
+ *
+ ****************************************************************************/
+
+static void vi_updaterow(FAR struct vi_s *vi, uint16_t row, uint16_t len)
+{
+  uint16_t ncols = vi->display.column;
+  FAR char *line = &vi->shadow[(vi->display.row - 1) * ncols];
+  FAR char *shadow = &vi->shadow[row * ncols];
+  uint16_t oldlen;
+  uint16_t first;
+  uint16_t last;
+
+  /* Pad the composed row with blanks and find its visible length */
+
+  memset(&line[len], ' ', ncols - len);
+  while (len > 0 && line[len - 1] == ' ')
+    {
+      len--;
+    }
+
+  /* Find the first column that differs.  Nothing to do if none does. */
+
+  for (first = 0; first < ncols && shadow[first] == line[first]; first++)
+    {
+    }
+
+  if (first >= ncols)
+    {
+      return;
+    }
+
+  for (oldlen = ncols; oldlen > 0 && shadow[oldlen - 1] == ' '; oldlen--)
+    {
+    }
+
+  /* Turn off attributes and the cursor once per update */
+
+  if (!vi->cursorhidden)
+    {
+      vi_attriboff(vi);
+      vi_cursoroff(vi);
+      vi->cursorhidden = true;
+    }
+
+  vi_setcursor(vi, row, first);
+
+  /* If the row got shorter, write up to its end and clear the rest.
+   * Otherwise write up to the last column that differs.
+   */
+
+  if (oldlen > len)
+    {
+      if (first < len)
+        {
+          vi_write(vi, &line[first], len - first);
+        }
+
+      vi_clrtoeol(vi);
+    }
+  else
+    {
+      for (last = len; shadow[last - 1] == line[last - 1]; last--)
+        {
+        }
+
+      vi_write(vi, &line[first], last - first);
+    }
+
+  memcpy(shadow, line, ncols);
+}
+
 /****************************************************************************
  * Name: vi_printf
  *
@@ -897,6 +1163,85 @@ static void vi_printf(FAR struct vi_s *vi, FAR const char *prefix,
  * Line positioning
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: vi_nlget
+ *
+ * Description:
+ *   Return the text offset of the newline with the given index.  The
+ *   newline index has a gap at the position of the last edit:  Entries
+ *   before the gap hold the offset of the newline, entries after the gap
+ *   hold the distance from the newline to the end of the text so that
+ *   neither need to be adjusted when text is inserted or deleted at the
+ *   gap.
+ *
+ ****************************************************************************/
+
+static off_t vi_nlget(FAR struct vi_s *vi, size_t index)
+{
+  if (index < vi->nlgap)
+    {
+      return vi->nl[index];
+    }
+
+  return vi->textsize - vi->nl[index + vi->nlalloc - vi->nlcount];
+}
+
+/****************************************************************************
+ * Name: vi_nlfind
+ *
+ * Description:
+ *   Return the number of newlines before the text offset 'pos'.  This is
+ *   also the (zero-based) number of the line containing 'pos'.
+ *
+ ****************************************************************************/
+
+static size_t vi_nlfind(FAR struct vi_s *vi, off_t pos)
+{
+  size_t low = 0;
+  size_t high = vi->nlcount;
+  size_t mid;
+
+  while (low < high)
+    {
+      mid = low + (high - low) / 2;
+      if (vi_nlget(vi, mid) < pos)
+        {
+          low = mid + 1;
+        }
+      else
+        {
+          high = mid;
+        }
+    }
+
+  return low;
+}
+
+/****************************************************************************
+ * Name: vi_linepos
+ *
+ * Description:
+ *   Return the text offset of the beginning of the (zero-based) line
+ *   number 'line'.  The end of the text is returned if there is no such
+ *   line.
+ *
+ ****************************************************************************/
+
+static off_t vi_linepos(FAR struct vi_s *vi, size_t line)
+{
+  if (line == 0)
+    {
+      return 0;
+    }
+
+  if (line > vi->nlcount)
+    {
+      return vi->textsize;
+    }
+
+  return vi_nlget(vi, line - 1) + 1;
+}
+
 /****************************************************************************
  * Name: vi_linebegin
  *
@@ -907,14 +1252,11 @@ static void vi_printf(FAR struct vi_s *vi, FAR const char *prefix,
 
 static off_t vi_linebegin(FAR struct vi_s *vi, off_t pos)
 {
-  /* Search backward to find the previous newline character (or, possibly,
-   * the beginning of the text buffer).
+  /* The line begins after the last newline preceding pos (or, possibly,
+   * at the beginning of the text buffer).
    */
 
-  while (pos && vi->text[pos - 1] != '\n')
-    {
-      pos--;
-    }
+  pos = vi_linepos(vi, vi_nlfind(vi, pos));
 
   viinfo("Return pos=%ld\n", (long)pos);
   return pos;
@@ -957,18 +1299,22 @@ static off_t vi_prevline(FAR struct vi_s *vi, off_t pos)
 
 static off_t vi_lineend(FAR struct vi_s *vi, off_t pos)
 {
-  /* Search forward to find the next newline character. (or, possibly,
-   * the end of the text buffer).
+  size_t index;
+
+  /* Find the next newline character (or, possibly, the end of the text
+   * buffer).
    */
 
-  while (pos < vi->textsize && vi->text[pos] != '\n')
+  index = vi_nlfind(vi, pos);
+  if (index < vi->nlcount)
     {
-      pos++;
+      pos = vi_nlget(vi, index) - 1;
     }
-
-  if (vi->text[pos] == '\n')
+  else if (pos < vi->textsize)
     {
-      pos--;
+      /* The last line has no newline, end on its last character */
+
+      pos = vi->textsize - 1;
     }
 
   viinfo("Return pos=%ld\n", (long)pos);
@@ -1006,19 +1352,317 @@ static off_t vi_nextline(FAR struct vi_s *vi, off_t pos)
  * Text buffer management
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: vi_charat
+ *
+ * Description:
+ *   Return the character at the text offset 'pos'.  The text buffer is a
+ *   gap buffer:  The unused part of the allocation lies at 'gappos' so that
+ *   insertions and deletions near the cursor move only the text between
+ *   the cursor and the previous edit.  NUL is returned for offsets outside
+ *   of the text.
+ *
+ ****************************************************************************/
+
+static char vi_charat(FAR struct vi_s *vi, off_t pos)
+{
+  if (pos < 0 || pos >= vi->textsize)
+    {
+      return '\0';
+    }
+
+  if (pos >= vi->gappos)
+    {
+      pos += vi->txtalloc - vi->textsize;
+    }
+
+  return vi->text[pos];
+}
+
+/****************************************************************************
+ * Name: vi_setcharat
+ *
+ * Description:
+ *   Replace the character at the text offset 'pos', keeping the newline
+ *   index up to date.
+ *
+ ****************************************************************************/
+
+static void vi_setcharat(FAR struct vi_s *vi, off_t pos, char ch)
+{
+  char oldch;
+
+  DEBUGASSERT(pos >= 0 && pos < vi->textsize);
+  if (pos < 0 || pos >= vi->textsize)
+    {
+      return;
+    }
+
+  oldch = vi_charat(vi, pos);
+  if (oldch == ch)
+    {
+      return;
+    }
+
+  if (oldch == '\n' || ch == '\n')
+    {
+      if (ch == '\n' && !vi_nlreserve(vi, 1))
+        {
+          vi_error(vi, g_fmtallocfail);
+          return;
+        }
+
+      vi_nlmovegap(vi, vi_nlfind(vi, pos));
+      if (oldch == '\n')
+        {
+          /* The newline at pos is the first entry after the gap */
+
+          vi->nlcount--;
+        }
+      else
+        {
+          vi->nl[vi->nlgap++] = pos;
+          vi->nlcount++;
+        }
+    }
+
+  if (pos >= vi->gappos)
+    {
+      pos += vi->txtalloc - vi->textsize;
+    }
+
+  vi->text[pos] = ch;
+  vi->modified = true;
+}
+
+/****************************************************************************
+ * Name: vi_copytext
+ *
+ * Description:
+ *   Copy 'size' bytes of text beginning at 'pos' to 'dest'.
+ *
+ ****************************************************************************/
+
+static void vi_copytext(FAR struct vi_s *vi, FAR char *dest, off_t pos,
+                        size_t size)
+{
+  size_t gapsize = vi->txtalloc - vi->textsize;
+  size_t nbytes;
+
+  /* Anything beyond the end of the text reads as NUL */
+
+  nbytes = pos < vi->textsize ? vi->textsize - pos : 0;
+  if (size > nbytes)
+    {
+      memset(dest + nbytes, 0, size - nbytes);
+      size = nbytes;
+    }
+
+  /* Copy the part before the gap */
+
+  if (pos < vi->gappos)
+    {
+      nbytes = MIN(size, vi->gappos - pos);
+      memcpy(dest, &vi->text[pos], nbytes);
+      dest += nbytes;
+      pos  += nbytes;
+      size -= nbytes;
+    }
+
+  /* Then the part after the gap */
+
+  if (size > 0)
+    {
+      memcpy(dest, &vi->text[pos + gapsize], size);
+    }
+}
+
+/****************************************************************************
+ * Name: vi_matchtext
+ *
+ * Description:
+ *   Compare the text beginning at 'pos' with the first 'len' bytes of
+ *   'str'.  Returns true if they are the same.
+ *
+ ****************************************************************************/
+
+static bool vi_matchtext(FAR struct vi_s *vi, off_t pos,
+                         FAR const char *str, size_t len)
+{
+  size_t gapsize = vi->txtalloc - vi->textsize;
+  size_t nbytes;
+
+  if (pos < 0 || pos + len > vi->textsize)
+    {
+      return false;
+    }
+
+  if (pos < vi->gappos)
+    {
+      nbytes = MIN(len, vi->gappos - pos);
+      if (memcmp(&vi->text[pos], str, nbytes) != 0)
+        {
+          return false;
+        }
+
+      str += nbytes;
+      pos += nbytes;
+      len -= nbytes;
+    }
+
+  return len == 0 || memcmp(&vi->text[pos + gapsize], str, len) == 0;
+}
+
+/****************************************************************************
+ * Name: vi_movegap
+ *
+ * Description:
+ *   Move the gap in the text buffer to the text offset 'pos'.  Only the
+ *   text between the old and the new position of the gap is moved.
+ *
+ ****************************************************************************/
+
+static void vi_movegap(FAR struct vi_s *vi, off_t pos)
+{
+  size_t gapsize = vi->txtalloc - vi->textsize;
+
+  if (pos < vi->gappos)
+    {
+      memmove(&vi->text[pos + gapsize], &vi->text[pos], vi->gappos - pos);
+    }
+  else if (pos > vi->gappos)
+    {
+      memmove(&vi->text[vi->gappos], &vi->text[vi->gappos + gapsize],
+              pos - vi->gappos);
+    }
+
+  vi->gappos = pos;
+}
+
+/****************************************************************************
+ * Name: vi_nlmovegap
+ *
+ * Description:
+ *   Move the gap in the newline index to 'index', converting the entries
+ *   that move across the gap.
+ *
+ ****************************************************************************/
+
+static void vi_nlmovegap(FAR struct vi_s *vi, size_t index)
+{
+  size_t offset = vi->nlalloc - vi->nlcount;
+
+  while (vi->nlgap > index)
+    {
+      vi->nlgap--;
+      vi->nl[vi->nlgap + offset] = vi->textsize - vi->nl[vi->nlgap];
+    }
+
+  while (vi->nlgap < index)
+    {
+      vi->nl[vi->nlgap] = vi->textsize - vi->nl[vi->nlgap + offset];
+      vi->nlgap++;
+    }
+}
+
+/****************************************************************************
+ * Name: vi_nlreserve
+ *
+ * Description:
+ *   Make sure that there is space for 'count' more entries in the newline
+ *   index.
+ *
+ ****************************************************************************/
+
+static bool vi_nlreserve(FAR struct vi_s *vi, size_t count)
+{
+  FAR off_t *alloc;
+  size_t allocsize;
+  size_t after;
+
+  if (vi->nlcount + count <= vi->nlalloc)
+    {
+      return true;
+    }
+
+  allocsize = vi->nlcount + count + (vi->nlcount >> 1) + NL_GULP_SIZE;
+  alloc = realloc(vi->nl, allocsize * sizeof(off_t));
+  if (alloc == NULL)
+    {
+      return false;
+    }
+
+  /* Keep the entries after the gap at the end of the allocation */
+
+  after = vi->nlcount - vi->nlgap;
+  memmove(&alloc[allocsize - after], &alloc[vi->nlalloc - after],
+          after * sizeof(off_t));
+
+  vi->nl      = alloc;
+  vi->nlalloc = allocsize;
+  return true;
+}
+
+/****************************************************************************
+ * Name: vi_indextext
+ *
+ * Description:
+ *   Add the newlines of the 'size' bytes of new text at 'pos' to the
+ *   newline index.  The new text must lie just before the gaps in the text
+ *   buffer and in the newline index, as left by vi_extendtext.  The new
+ *   text is removed again if the index cannot be extended.
+ *
+ ****************************************************************************/
+
+static bool vi_indextext(FAR struct vi_s *vi, off_t pos, size_t size)
+{
+  FAR const char *start = &vi->text[pos];
+  FAR const char *end = start + size;
+  FAR const char *ptr;
+  size_t count = 0;
+
+  DEBUGASSERT(pos + size == vi->gappos);
+
+  for (ptr = start; (ptr = memchr(ptr, '\n', end - ptr)) != NULL; ptr++)
+    {
+      count++;
+    }
+
+  if (!vi_nlreserve(vi, count))
+    {
+      vi_error(vi, g_fmtallocfail);
+      vi_shrinktext(vi, pos, size);
+      return false;
+    }
+
+  for (ptr = start; (ptr = memchr(ptr, '\n', end - ptr)) != NULL; ptr++)
+    {
+      vi->nl[vi->nlgap++] = ptr - vi->text;
+      vi->nlcount++;
+    }
+
+  return true;
+}
+
 /****************************************************************************
  * Name: vi_extendtext
  *
  * Description:
- *   Reallocate the in-memory file memory by (at least) 'increment' and make
- *   space for new text of size 'increment' at the specified cursor position.
+ *   Make space for new text of size 'increment' at the specified cursor
+ *   position, reallocating the in-memory file if the gap is too small.
+ *   The space is taken from the front of the gap so that it is contiguous
+ *   at vi->text + pos.  If 'src' is not NULL, the new text is copied from
+ *   'src' and indexed; otherwise the caller fills it and calls
+ *   vi_indextext.
  *
  ****************************************************************************/
 
-static bool vi_extendtext(FAR struct vi_s *vi, off_t pos, size_t increment)
+static bool vi_extendtext(FAR struct vi_s *vi, off_t pos,
+                          FAR const char *src, size_t increment)
 {
   FAR char *alloc;
-  int i;
+  size_t allocsize;
+  size_t after;
 
   viinfo("pos=%ld increment=%ld\n", (long)pos, (long)increment);
 
@@ -1026,11 +1670,17 @@ static bool vi_extendtext(FAR struct vi_s *vi, off_t pos, size_t increment)
 
   if (!vi->text || vi->textsize + increment > vi->txtalloc)
     {
-      /* Allocate in chunksize so that we do not have to reallocate so
-       * often.
+      /* Allocate in chunksize with some headroom so that we do not have to
+       * reallocate so often.
        */
 
-      size_t allocsize = ALIGN_GULP(vi->textsize + increment);
+      allocsize = ALIGN_GULP(vi->textsize + increment +
+                             (vi->textsize >> 4));
+      if (allocsize < TEXT_GULP_SIZE)
+        {
+          allocsize = TEXT_GULP_SIZE;
+        }
+
       alloc = realloc(vi->text, allocsize);
       if (alloc == NULL)
         {
@@ -1040,25 +1690,37 @@ static bool vi_extendtext(FAR struct vi_s *vi, off_t pos, size_t increment)
           return false;
         }
 
+      /* Keep the text after the gap at the end of the buffer */
+
+      after = vi->textsize - vi->gappos;
+      memmove(&alloc[allocsize - after], &alloc[vi->txtalloc - after],
+              after);
+
       /* Save the new buffer information */
 
-      vi->text    = alloc;
+      vi->text     = alloc;
       vi->txtalloc = allocsize;
     }
 
-  /* Move text to make space for new text of size 'increment' at the current
-   * cursor position
+  /* Move both gaps to the current cursor position and take the space for
+   * the new text from the front of the gap.
    */
 
-  for (i = vi->textsize - 1; i >= pos; i--)
-    {
-      vi->text[i + increment] = vi->text[i];
-    }
+  vi_nlmovegap(vi, vi_nlfind(vi, pos));
+  vi_movegap(vi, pos);
 
   /* Adjust end of file position */
 
+  vi->gappos   += increment;
   vi->textsize += increment;
   vi->modified  = true;
+
+  if (src != NULL)
+    {
+      memcpy(&vi->text[pos], src, increment);
+      return vi_indextext(vi, pos, increment);
+    }
+
   return true;
 }
 
@@ -1123,9 +1785,9 @@ static void vi_shrinkpos(FAR struct vi_s *vi, off_t delpos, size_t delsize,
  * Name: vi_shrinktext
  *
  * Description:
- *   Delete a region in the text buffer by copying the end of the text buffer
- *   over the deleted region and adjusting the size of the region.  The text
- *   region may be reallocated in order to recover the unused memory.
+ *   Delete a region in the text buffer by moving the gap to the region and
+ *   growing it over the deleted text.  The text region may be reallocated
+ *   in order to recover the unused memory.
  *
  ****************************************************************************/
 
@@ -1133,24 +1795,31 @@ static void vi_shrinktext(FAR struct vi_s *vi, off_t pos, size_t size)
 {
   FAR char *alloc;
   size_t allocsize;
-  int i;
+  size_t after;
 
   viinfo("pos=%ld size=%ld\n", (long)pos, (long)size);
 
-  /* Close up the gap to remove 'size' characters at 'pos' */
+  /* Ensure we are not shrinking more than we have */
 
-  for (i = pos + size; i < vi->textsize; i++)
+  if (pos + size > vi->textsize)
     {
-      vi->text[i - size] = vi->text[i];
+      size = vi->textsize - pos;
     }
 
-  /* Ensure we are not shrinking more than we have */
+  /* Drop the newlines of the deleted region from the index.  They are the
+   * first entries after the gap.
+   */
 
-  if (size > vi->textsize)
+  vi_nlmovegap(vi, vi_nlfind(vi, pos));
+  while (vi->nlgap < vi->nlcount && vi_nlget(vi, vi->nlgap) < pos + size)
     {
-      size = vi->textsize;
+      vi->nlcount--;
     }
 
+  /* Grow the gap over the 'size' characters at 'pos' */
+
+  vi_movegap(vi, pos);
+
   /* Adjust sizes and positions */
 
   vi->textsize -= size;
@@ -1159,26 +1828,33 @@ static void vi_shrinktext(FAR struct vi_s *vi, off_t pos, size_t size)
   vi_shrinkpos(vi, pos, size, &vi->winpos);
   vi_shrinkpos(vi, pos, size, &vi->prevpos);
 
-  /* Reallocate the buffer to free up memory no longer in use */
+  /* Reallocate the buffer to free up memory no longer in use, but only
+   * when more than half of it is unused so that alternating inserts and
+   * deletes do not reallocate each time.
+   */
 
-  allocsize = ALIGN_GULP(vi->textsize);
-  if (allocsize == 0)
+  allocsize = ALIGN_GULP(vi->textsize + (vi->textsize >> 4));
+  if (allocsize < TEXT_GULP_SIZE)
     {
       allocsize = TEXT_GULP_SIZE;
     }
 
-  if (allocsize < vi->txtalloc)
+  if (vi->txtalloc > 2 * allocsize)
     {
+      /* Move the text after the gap to the end of the smaller buffer */
+
+      after = vi->textsize - vi->gappos;
+      memmove(&vi->text[allocsize - after], &vi->text[vi->txtalloc - after],
+              after);
+
+      /* If realloc fails, the larger buffer is simply still in use */
+
       alloc = realloc(vi->text, allocsize);
-      if (!alloc)
+      if (alloc != NULL)
         {
-          vi_error(vi, g_fmtallocfail);
-          return;
+          vi->text = alloc;
         }
 
-      /* Save the new buffer information */
-
-      vi->text    = alloc;
       vi->txtalloc = allocsize;
     }
 }
@@ -1238,7 +1914,7 @@ static bool vi_insertfile(FAR struct vi_s *vi, off_t pos,
    */
 
   ret = false;
-  if (vi_extendtext(vi, pos, filesize))
+  if (vi_extendtext(vi, pos, NULL, filesize))
     {
       /* Read the contents of the file into the text buffer at the
        * current cursor position.
@@ -1254,7 +1930,7 @@ static bool vi_insertfile(FAR struct vi_s *vi, off_t pos,
         }
       else
         {
-          ret = true;
+          ret = vi_indextext(vi, pos, filesize);
         }
     }
 
@@ -1294,7 +1970,20 @@ static bool vi_savetext(FAR struct vi_s *vi, FAR const char *filename,
    * through pos + size -1.
    */
 
-  nwritten = fwrite(vi->text + pos, 1, size, stream);
+  nwritten = 0;
+  if (pos < vi->gappos)
+    {
+      nwritten = fwrite(vi->text + pos, 1, MIN(size, vi->gappos - pos),
+                        stream);
+    }
+
+  if (nwritten < size && pos + nwritten >= vi->gappos)
+    {
+      nwritten += fwrite(vi->text + pos + nwritten +
+                         vi->txtalloc - vi->textsize,
+                         1, size - nwritten, stream);
+    }
+
   if (nwritten < size)
     {
       /* Report the error (or partial write).  EINTR is not handled. */
@@ -1489,7 +2178,7 @@ static void vi_windowpos(FAR struct vi_s *vi, off_t start, off_t end,
     {
       /* Is there a newline terminator at this position? */
 
-      if (vi->text[pos] == '\n')
+      if (vi_charat(vi, pos) == '\n')
         {
           /* Yes... break out of the loop return the cursor column */
 
@@ -1505,7 +2194,7 @@ static void vi_windowpos(FAR struct vi_s *vi, off_t start, off_t end,
 
       /* No... Is there a TAB at this position? */
 
-      else if (vi->text[pos] == '\t')
+      else if (vi_charat(vi, pos) == '\t')
         {
           /* Yes.. expand the TAB */
 
@@ -1523,7 +2212,7 @@ static void vi_windowpos(FAR struct vi_s *vi, off_t start, off_t end,
   /* Keep cursor in bounds of text (i.e. not at the '\n') */
 
   if (((pos == vi->textsize && column != 0) ||
-       (vi->text[pos] == '\n' && pos != start)) &&
+       (vi_charat(vi, pos) == '\n' && pos != start)) &&
         vi->mode != MODE_INSERT && vi->mode != MODE_REPLACE)
     {
       pos--;
@@ -1559,6 +2248,8 @@ static void vi_windowpos(FAR struct vi_s *vi, off_t start, off_t end,
 
 static void vi_scrollcheck(FAR struct vi_s *vi)
 {
+  size_t curlineno;
+  size_t winlineno;
   off_t curline;
   off_t pos;
   uint16_t tmp;
@@ -1578,38 +2269,43 @@ static void vi_scrollcheck(FAR struct vi_s *vi)
 
   /* Check if the current line is above the first line on the display */
 
-  while (curline < vi->winpos)
+  curlineno = vi_nlfind(vi, curline);
+  winlineno = vi_nlfind(vi, vi->winpos);
+
+  if (curline < vi->winpos)
     {
-      /* Yes.. move the window position up to the beginning of the previous
-       * line line and check again
+      /* Yes.. move the window position up to the beginning of the current
+       * line.
        */
 
-      vi->winpos = vi_prevline(vi, vi->winpos);
-      vi->vscroll--;
+      vi->winpos     = curline;
+      winlineno      = curlineno;
       vi->fullredraw = true;
     }
 
-  /* Reset the cursor row position so that it is relative to the
-   * top of the display.
+  /* Set the cursor row position so that it is relative to the top of the
+   * display.  The line numbers come from the newline index.
    */
 
-  vi->cursor.row = 0;
-  for (pos = vi->winpos; pos < curline; pos = vi_nextline(vi, pos))
-    {
-      vi->cursor.row++;
-    }
+  nlines = curlineno - winlineno;
 
   /* Check if the cursor row position is below the bottom of the display */
 
-  for (; vi->cursor.row >= vi->display.row - 1; vi->cursor.row--)
+  if (nlines >= vi->display.row - 1)
     {
-      /* Yes.. move the window position down by one line and check again */
+      /* Yes.. move the window position down so that the cursor is on the
+       * last text row.
+       */
 
-      vi->winpos = vi_nextline(vi, vi->winpos);
-      vi->vscroll++;
+      winlineno     += nlines - (vi->display.row - 2);
+      vi->winpos     = vi_linepos(vi, winlineno);
+      nlines         = vi->display.row - 2;
       vi->fullredraw = true;
     }
 
+  vi->cursor.row = nlines;
+  vi->vscroll    = winlineno;
+
   /* Check if the cursor column is on the display.  vi_windowpos returns the
    * unrestricted column number of cursor.  hscroll is the horizontal offset
    * in characters.
@@ -1718,14 +2414,15 @@ static void vi_scrollcheck(FAR struct vi_s *vi)
 
 static void vi_showtext(FAR struct vi_s *vi)
 {
+  FAR char *line;
   off_t pos;
-  off_t writefrom;
   uint16_t row;
   uint16_t endrow;
   uint16_t column;
   uint16_t endcol;
   uint16_t tabcol;
   bool redraw_line;
+  char ch;
 
   /* Check if any of the preceding operations will cause the display to
    * scroll.
@@ -1746,12 +2443,11 @@ static void vi_showtext(FAR struct vi_s *vi)
 
   endrow = vi->display.row - 1;
 
-  /* Make sure that all character attributes are disabled; Turn off the
-   * cursor during the update.
+  /* Each row is composed in the spare row after the display shadow and
+   * only its differences to what is on the display are sent.
    */
 
-  vi_attriboff(vi);
-  vi_cursoroff(vi);
+  line = &vi->shadow[endrow * vi->display.column];
 
   /* Set loop control variables based on draw mode */
 
@@ -1828,48 +2524,35 @@ static void vi_showtext(FAR struct vi_s *vi)
 
       vi_windowpos(vi, pos, pos + vi->hscroll, NULL, &pos);
 
-      /* Set the cursor position to the beginning of this row and clear to
-       * the end of the line.
-       */
+      /* Compose this row and update the display from it */
 
       if (redraw_line)
         {
-          vi_setcursor(vi, row, 0);
-
           /* Loop for each column */
 
-          writefrom = pos;
           for (column = 0; pos < vi->textsize && column < endcol; pos++)
             {
               /* Break out of the loop if we encounter the newline before the
                * last column is encountered.
                */
 
-              if (vi->text[pos] == '\n')
+              ch = vi_charat(vi, pos);
+              if (ch == '\n')
                 {
                   break;
                 }
 
               /* Perform TAB expansion */
 
-              else if (vi->text[pos] == '\t')
+              else if (ch == '\t')
                 {
-                  /* Write collected characters */
-
-                  if (writefrom != pos)
-                    {
-                      vi_write(vi, &vi->text[writefrom], pos - writefrom);
-                    }
-
                   tabcol = NEXT_TAB(column);
                   if (tabcol < endcol)
                     {
                       for (; column < tabcol; column++)
                         {
-                          vi_putch(vi, ' ');
+                          line[column] = ' ';
                         }
-
-                      writefrom = pos + 1;
                     }
                   else
                     {
@@ -1877,27 +2560,23 @@ static void vi_showtext(FAR struct vi_s *vi)
                        * the line but whitespace.
                        */
 
-                      writefrom = pos;
                       break;
                     }
                 }
 
-              /* Add the normal character to the display */
+              /* Add the normal character to the display.  Other control
+               * characters are shown as '.' so that each character takes
+               * one column on the display as in the shadow.
+               */
 
               else
                 {
-                  column++;
+                  line[column++] = ((unsigned char)ch < ' ' ||
+                                    ch == ASCII_DEL) ? '.' : ch;
                 }
             }
 
-          /* Write collected characters */
-
-          if (writefrom != pos)
-            {
-              vi_write(vi, &vi->text[writefrom], pos - writefrom);
-            }
-
-          vi_clrtoeol(vi);
+          vi_updaterow(vi, row, column);
         }
 
       /* Skip to the beginning of the next line */
@@ -1905,10 +2584,10 @@ static void vi_showtext(FAR struct vi_s *vi)
       pos = vi_nextline(vi, pos);
     }
 
-  if (pos == vi->textsize && vi->text[pos - 1] == '\n')
+  if (pos == vi->textsize && vi_charat(vi, pos - 1) == '\n' &&
+      row < vi->display.row - 1)
     {
-      vi_setcursor(vi, row, 0);
-      vi_clrtoeol(vi);
+      vi_updaterow(vi, row, 0);
       row++;
     }
 
@@ -1923,23 +2602,28 @@ static void vi_showtext(FAR struct vi_s *vi)
 
       for (; row < endrow; row++)
         {
-          /* Set the cursor position to the beginning of the row and clear to
-           * the end of the line.
-           */
+          /* Rows after the text show only a '~' */
 
-          vi_setcursor(vi, row, 0);
-          if (row != endrow && row != 0)
+          if (row != 0)
             {
-              vi_putch(vi, '~');
+              line[0] = '~';
+              vi_updaterow(vi, row, 1);
+            }
+          else
+            {
+              vi_updaterow(vi, row, 0);
             }
-
-          vi_clrtoeol(vi);
         }
     }
 
-  /* Turn the cursor back on */
+  /* Turn the cursor back on if anything was sent */
+
+  if (vi->cursorhidden)
+    {
+      vi_cursoron(vi);
+      vi->cursorhidden = false;
+    }
 
-  vi_cursoron(vi);
   vi->fullredraw = false;
   vi->drawtoeos = false;
   vi->redrawline = false;
@@ -1957,18 +2641,37 @@ static void vi_showlinecol(FAR struct vi_s *vi)
 {
   size_t len;
 
-  /* Move to bototm line for display */
-
-  vi_cursoroff(vi);
-  vi_setcursor(vi, vi->display.row - 1, vi->display.column - 15);
-
   len = snprintf(vi->scratch, sizeof(vi->scratch), "%jd,%d",
                  (uintmax_t)(vi->cursor.row + vi->vscroll + 1),
                  vi->cursor.column + vi->hscroll + 1);
-  vi_write(vi, vi->scratch, MIN(len, sizeof(vi->scratch)));
+#ifdef CONFIG_SYSTEM_VI_WRITESTATS
+  len += snprintf(vi->scratch + len, sizeof(vi->scratch) - len, " %luB",
+                  (unsigned long)vi->keybytes);
+#endif
+  len = MIN(len, sizeof(vi->scratch));
+
+  /* Nothing to do if the same is already on the bottom line */
 
+  if (len == vi->linecollen && memcmp(vi->linecol, vi->scratch, len) == 0)
+    {
+      return;
+    }
+
+  /* Move to bototm line for display */
+
+  vi_cursoroff(vi);
+  vi_setcursor(vi, vi->display.row - 1, vi->display.column - 15);
+  vi_write(vi, vi->scratch, len);
   vi_clrtoeol(vi);
   vi_cursoron(vi);
+
+  /* Remember what was shown, setcursor above has cleared linecol[] */
+
+  if (len <= sizeof(vi->linecol))
+    {
+      memcpy(vi->linecol, vi->scratch, len);
+      vi->linecollen = len;
+    }
 }
 
 /****************************************************************************
@@ -2079,7 +2782,7 @@ static off_t vi_cursorleft(FAR struct vi_s *vi, off_t curpos, int ncolumns)
    */
 
   for (remaining = (ncolumns < 1 ? 1 : ncolumns);
-       curpos > 0 && remaining > 0 && vi->text[curpos - 1] != '\n';
+       curpos > 0 && remaining > 0 && vi_charat(vi, curpos - 1) != '\n';
        curpos--, remaining--)
     {
     }
@@ -2109,13 +2812,14 @@ static off_t vi_cursorright(FAR struct vi_s *vi, off_t curpos, int ncolumns)
    */
 
   for (remaining = (ncolumns < 1 ? 1 : ncolumns);
-       curpos < vi->textsize && remaining > 0 && vi->text[curpos] != '\n';
+       curpos < vi->textsize && remaining > 0 &&
+       vi_charat(vi, curpos) != '\n';
        curpos++, remaining--)
     {
     }
 
 #if 0
-  if (vi->text[curpos] == '\n' || (curpos == vi->textsize &&
+  if (vi_charat(vi, curpos) == '\n' || (curpos == vi->textsize &&
       vi->mode != MODE_INSERT && vi->mode != MODE_REPLACE))
     {
       curpos--;
@@ -2185,8 +2889,8 @@ static int vi_gotoscreenbottom(FAR struct vi_s *vi, int rows)
 static void vi_gotofirstnonwhite(FAR struct vi_s *vi)
 {
   vi->curpos = vi_linebegin(vi, vi->curpos);
-  while (vi->curpos <= vi->textsize && (vi->text[vi->curpos] == ' ' ||
-         vi->text[vi->curpos] == '\t'))
+  while (vi->curpos <= vi->textsize && (vi_charat(vi, vi->curpos) == ' ' ||
+         vi_charat(vi, vi->curpos) == '\t'))
     {
       vi->curpos++;
     }
@@ -2222,7 +2926,7 @@ static void vi_delforward(FAR struct vi_s *vi)
       /* If at end of file, just return */
 
       if (vi->curpos == vi->textsize ||
-          vi->text[vi->curpos] == '\n')
+          vi_charat(vi, vi->curpos) == '\n')
         {
           return;
         }
@@ -2276,8 +2980,8 @@ static void vi_delbackward(FAR struct vi_s *vi)
 
   /* Test if we are at beginning of line */
 
-  if (vi->curpos == 0 || vi->text[vi->curpos] == '\n' ||
-      vi->text[vi->curpos - 1] == '\n')
+  if (vi->curpos == 0 || vi_charat(vi, vi->curpos) == '\n' ||
+      vi_charat(vi, vi->curpos - 1) == '\n')
     {
       return;
     }
@@ -2303,7 +3007,7 @@ static void vi_delbackward(FAR struct vi_s *vi)
     {
       /* Test if \n' in the range.  Don't delete through \n */
 
-      if (vi->text[x] == '\n')
+      if (vi_charat(vi, x) == '\n')
         {
           start = x + 1;
           break;
@@ -2386,7 +3090,7 @@ static void vi_deltoeol(FAR struct vi_s *vi)
 
   /* If we are at the end of the line, then return */
 
-  if (vi->curpos == vi->textsize || vi->text[vi->curpos] == '\n')
+  if (vi->curpos == vi->textsize || vi_charat(vi, vi->curpos) == '\n')
     {
       return;
     }
@@ -2395,7 +3099,7 @@ static void vi_deltoeol(FAR struct vi_s *vi)
 
   start = vi->curpos;
   end   = vi_lineend(vi, vi->curpos);
-  if (end == vi->textsize || vi->text[end] == '\n')
+  if (end == vi->textsize || vi_charat(vi, end) == '\n')
     {
       end--;
     }
@@ -2403,7 +3107,7 @@ static void vi_deltoeol(FAR struct vi_s *vi)
   /* Yank and remove text from the buffer */
 
   vi_yanktext(vi, start, end, true, true);
-  if (start > 0 && start != vi->textsize && vi->text[start - 1] != '\n')
+  if (start > 0 && vi_charat(vi, start - 1) != '\n')
     {
       vi->curpos = start - 1;
     }
@@ -2432,7 +3136,7 @@ static void vi_yanktext(FAR struct vi_s *vi, off_t start, off_t end,
 
   /* At end of file, in line yank mode, if there is no LF, we append one */
 
-  if (vi->text[end] != '\n' && !yankcharmode)
+  if (vi_charat(vi, end) != '\n' && !yankcharmode)
     {
       append_lf = 1;
     }
@@ -2485,7 +3189,7 @@ static void vi_yanktext(FAR struct vi_s *vi, off_t start, off_t end,
   /* Copy the block from the text buffer to the yank buffer */
 
   vi->yanksize = size;
-  memcpy(vi->yank, &vi->text[start], size);
+  vi_copytext(vi, vi->yank, start, size);
 
   /* Append \n if needed */
 
@@ -2547,7 +3251,7 @@ static void vi_yank(FAR struct vi_s *vi, bool del_after_yank)
 
   yank_end = end;
   if (del_after_yank && end == textsize - 1 && start != end &&
-      vi->text[end] == '\n')
+      vi_charat(vi, end) == '\n')
     {
       yank_end--;
       pos_increment = 1;
@@ -2558,8 +3262,8 @@ static void vi_yank(FAR struct vi_s *vi, bool del_after_yank)
   /* Test if deleting last line with empty line above it */
 
   if ((end > 0 && start == end && end == vi->textsize -1 &&
-      vi->text[end - 1] == '\n') || (start > 1 && end + 1 ==
-      vi->textsize && vi->text[start - 2] == '\n'))
+      vi_charat(vi, end - 1) == '\n') || (start > 1 && end + 1 ==
+      vi->textsize && vi_charat(vi, start - 2) == '\n'))
     {
       empty_last_line = true;
     }
@@ -2632,7 +3336,8 @@ static void vi_paste(FAR struct vi_s *vi, bool paste_before)
 
           /* Paste at next col to the right of cursor */
 
-          if (vi->text[vi->curpos] == '\n' || vi->curpos == vi->textsize ||
+          if (vi_charat(vi, vi->curpos) == '\n' ||
+              vi->curpos == vi->textsize ||
               paste_before)
             {
               pos = vi->curpos;
@@ -2642,18 +3347,17 @@ static void vi_paste(FAR struct vi_s *vi, bool paste_before)
               pos = vi->curpos + 1;
             }
 
-          if (vi_extendtext(vi, pos, vi->yanksize))
-            {
-              /* Copy the contents of the yank buffer into the text buffer
-               * at the position where the start of the next line was.
-               */
-
-              memcpy(&vi->text[pos], vi->yank, vi->yanksize);
+          /* Copy the contents of the yank buffer into the text buffer
+           * at the position where the start of the next line was.
+           */
 
+          if (vi_extendtext(vi, pos, vi->yank, vi->yanksize))
+            {
               /* Advance the cursor */
 
               vi->curpos = vi->curpos + vi->yanksize;
-              if (vi->curpos > vi->textsize || vi->text[vi->curpos] == '\n')
+              if (vi->curpos > vi->textsize ||
+                  vi_charat(vi, vi->curpos) == '\n')
                 {
                   vi->curpos--;
                 }
@@ -2679,7 +3383,8 @@ static void vi_paste(FAR struct vi_s *vi, bool paste_before)
           /* Test if pasting at end of file */
 
           new_curpos = start;
-          if ((start >= vi->textsize && vi->text[vi->textsize - 1] != '\n')
+          if ((start >= vi->textsize &&
+               vi_charat(vi, vi->textsize - 1) != '\n')
               || vi->curpos == vi->textsize)
             {
               off_t textsize = vi->textsize;
@@ -2692,7 +3397,7 @@ static void vi_paste(FAR struct vi_s *vi, bool paste_before)
 
               /* Don't append the \n' in the yank buffer */
 
-              if (vi->text[textsize - 1] != '\n' || at_end)
+              if (vi_charat(vi, textsize - 1) != '\n' || at_end)
                 {
                   size--;
                 }
@@ -2707,18 +3412,12 @@ static void vi_paste(FAR struct vi_s *vi, bool paste_before)
               vi->fullredraw = true;
             }
 
-          /* Reallocate the text buffer to hold the yank buffer contents at
-           * the beginning of the next line.
+          /* Reallocate the text buffer and copy the yank buffer contents
+           * to the beginning of the next line.
            */
 
-          if (vi_extendtext(vi, start, size))
+          if (vi_extendtext(vi, start, vi->yank, size))
             {
-              /* Copy the contents of the yank buffer into the text buffer
-               * at the position where the start of the next line was.
-               */
-
-              memcpy(&vi->text[start], vi->yank, size);
-
               /* Advance to next line */
 
               vi->curpos = new_curpos;
@@ -2757,19 +3456,19 @@ static void vi_join(FAR struct vi_s *vi)
 
   /* Ensure the line ends with '\n' */
 
-  if (vi->text[start + 1] != '\n')
+  if (vi_charat(vi, start + 1) != '\n')
     {
       return;
     }
 
   /* Convert the '\n' to a space */
 
-  vi->text[++start] = ' ';
+  vi_setcharat(vi, ++start, ' ');
   end = start + 1;
 
   /* Skip all spaces and tabs on next line */
 
-  while ((vi->text[end] == ' ' || vi->text[end] == '\t') &&
+  while ((vi_charat(vi, end) == ' ' || vi_charat(vi, end) == '\t') &&
       end < vi->textsize)
     {
       end++;
@@ -2809,16 +3508,11 @@ static void vi_gotoline(FAR struct vi_s *vi)
 
   else if (vi->value > 0)
     {
-      uint32_t line;
-
-      /* Got to the line == value */
+      /* Go to the line == value, or the end of the text if there are
+       * fewer lines.
+       */
 
-      for (line = vi->value, vi->curpos = 0;
-          --line > 0 && vi->curpos < vi->textsize;
-          )
-        {
-          vi->curpos = vi_nextline(vi, vi->curpos);
-        }
+      vi->curpos = vi_linepos(vi, vi->value - 1);
     }
 
   /* No value means to go to beginning of the last line */
@@ -2893,14 +3587,14 @@ static off_t vi_findnextword(FAR struct vi_s *vi)
    * next "word" looks like.
    */
 
-  srch_type = vi_chartype(vi->text[vi->curpos]);
+  srch_type = vi_chartype(vi_charat(vi, vi->curpos));
   pos = vi->curpos + 1;
 
   for (; pos < vi->textsize; pos++)
     {
       /* Get type of the next character */
 
-      pos_type = vi_chartype(vi->text[pos]);
+      pos_type = vi_chartype(vi_charat(vi, pos));
 
       /* Skip CR and NL */
 
@@ -2995,13 +3689,14 @@ static void vi_gotonextword(FAR struct vi_s *vi)
       pos     = vi->curpos;
       crfound = false;
 
-      while ((vi->text[pos - 1] == ' ' || vi->text[pos - 1] == '\t' ||
-             vi->text[pos - 1] == '\n') && pos > start)
+      while ((vi_charat(vi, pos - 1) == ' ' ||
+              vi_charat(vi, pos - 1) == '\t' ||
+              vi_charat(vi, pos - 1) == '\n') && pos > start)
         {
           /* We rewind only if '\n' found before non-space */
 
           pos--;
-          if (vi->text[pos] == '\n')
+          if (vi_charat(vi, pos) == '\n')
             {
               crfound = true;
             }
@@ -3024,7 +3719,7 @@ static void vi_gotonextword(FAR struct vi_s *vi)
             {
               /* Test for '\n' */
 
-              if (vi->text[x] == '\n')
+              if (vi_charat(vi, x) == '\n')
                 {
                   /* Modify the yank / delete range */
 
@@ -3050,7 +3745,7 @@ static void vi_gotonextword(FAR struct vi_s *vi)
 
       /* Yank text if it isn't a single \n character */
 
-      if (!(start == end && vi->text[start] == '\n'))
+      if (!(start == end && vi_charat(vi, start) == '\n'))
         {
           vi_yanktext(vi, start, end, 1, vi->delarm | vi->chgarm);
         }
@@ -3116,9 +3811,9 @@ static off_t vi_findprevword(FAR struct vi_s *vi)
    * next "word" looks like.
    */
 
-  srch_type = vi_chartype(vi->text[vi->curpos]);
+  srch_type = vi_chartype(vi_charat(vi, vi->curpos));
   pos       = vi->curpos - 1;
-  pos_type  = vi_chartype(vi->text[pos]);
+  pos_type  = vi_chartype(vi_charat(vi, pos));
 
   /* Test if we are at the beginning of a word */
 
@@ -3128,7 +3823,7 @@ static off_t vi_findprevword(FAR struct vi_s *vi)
 
       while (pos > 0)
         {
-          pos_type = vi_chartype(vi->text[pos - 1]);
+          pos_type = vi_chartype(vi_charat(vi, pos - 1));
 
           if (pos_type != srch_type && pos_type != VI_CHAR_CRLF)
             {
@@ -3148,14 +3843,14 @@ static off_t vi_findprevword(FAR struct vi_s *vi)
        * non-space character.
        */
 
-      pos_type = vi_chartype(vi->text[--pos]);
+      pos_type = vi_chartype(vi_charat(vi, --pos));
     }
 
   /* If the previous char is space, then skip them */
 
   while ((pos_type == VI_CHAR_SPACE || pos_type == VI_CHAR_CRLF) && pos > 0)
     {
-      pos_type = vi_chartype(vi->text[--pos]);
+      pos_type = vi_chartype(vi_charat(vi, --pos));
     }
 
   if (pos == 0)
@@ -3165,8 +3860,8 @@ static off_t vi_findprevword(FAR struct vi_s *vi)
 
   /* Now find beginning of this new type */
 
-  srch_type = vi_chartype(vi->text[pos]);
-  while (pos > 0 && vi_chartype(vi->text[pos - 1]) == srch_type)
+  srch_type = vi_chartype(vi_charat(vi, pos));
+  while (pos > 0 && vi_chartype(vi_charat(vi, pos - 1)) == srch_type)
     {
       pos--;
     }
@@ -3222,19 +3917,19 @@ static void vi_bottom_line_debug(FAR struct vi_s *vi)
 
   while (pos < vi->textsize && column < vi->display.column)
     {
-      if (vi->text[pos] == '\n')
+      if (vi_charat(vi, pos) == '\n')
         {
           vi_putch(vi, '\\');
           vi_putch(vi, 'n');
         }
-      else if (vi->text[pos] == '\t')
+      else if (vi_charat(vi, pos) == '\t')
         {
           vi_putch(vi, '\\');
           vi_putch(vi, 'n');
         }
       else
         {
-          vi_putch(vi, vi->text[pos]);
+          vi_putch(vi, vi_charat(vi, pos));
         }
 
       pos++;
@@ -3558,8 +4253,8 @@ static void vi_cmd_mode(FAR struct vi_s *vi)
         case KEY_CMDMODE_RIGHT: /* Move the cursor right one character */
         case KEY_RIGHT:         /* Move the cursor right one character */
           {
-            if (vi->text[vi->curpos] != '\n' &&
-                vi->text[vi->curpos + 1] != '\n')
+            if (vi_charat(vi, vi->curpos) != '\n' &&
+                vi_charat(vi, vi->curpos + 1) != '\n')
               {
                 vi->curpos = vi_cursorright(vi, vi->curpos, vi->value);
                 if (vi->curpos >= vi->textsize)
@@ -3695,7 +4390,7 @@ static void vi_cmd_mode(FAR struct vi_s *vi)
 
                 /* If we moved to \n on the previous line, skip it */
 
-                if (vi->curpos > 0 && vi->text[vi->curpos] == '\n')
+                if (vi->curpos > 0 && vi_charat(vi, vi->curpos) == '\n')
                   {
                     vi->curpos--;
                   }
@@ -3947,13 +4642,14 @@ static void vi_cmd_mode(FAR struct vi_s *vi)
 #endif
             /* If we are at the end of the line, then delete backward */
 
-            if (vi->text[pos] == '\n')
+            if (vi_charat(vi, pos) == '\n')
               {
                 /* Nothing to do */
 
                 break;
               }
-            else if (pos + 1 != vi->textsize && vi->text[pos + 1] == '\n')
+            else if (pos + 1 != vi->textsize &&
+                     vi_charat(vi, pos + 1) == '\n')
               {
                 if (pos > 0)
                   {
@@ -4094,10 +4790,17 @@ static void vi_cmd_mode(FAR struct vi_s *vi)
           }
           break;
 
-        /* Unimplemented and invalid commands */
-
         case KEY_CMDMODE_REDRAW:  /* Redraws the screen */
         case KEY_CMDMODE_REDRAW2: /* Redraws the screen, removing deleted lines */
+          {
+            vi_invalidate(vi);
+            vi_clearbottomline(vi);
+            vi->fullredraw = true;
+          }
+          break;
+
+        /* Unimplemented and invalid commands */
+
         case KEY_CMDMODE_MARK:    /* Place a mark beginning at the current cursor position */
         default:
           {
@@ -4502,9 +5205,8 @@ static void vi_parsecolon(FAR struct vi_s *vi)
 
   if (IS_QUIT(cmd))
     {
-      /* Yes... free resources and exit */
+      /* Yes... restore the display, free resources and exit. */
 
-      vi_putch(vi, '\n');
       vi_release(vi);
       exit(EXIT_SUCCESS);
     }
@@ -4645,7 +5347,7 @@ static bool vi_findstring(FAR struct vi_s *vi)
     {
       /* Check for the matching sub-string */
 
-      if (strncmp(vi->text + pos, vi->scratch, len) == 0)
+      if (vi_matchtext(vi, pos, vi->scratch, len))
         {
           /* Found it... save the cursor position and
            * return success.
@@ -4664,9 +5366,10 @@ static bool vi_findstring(FAR struct vi_s *vi)
     {
       /* Check for the matching sub-string */
 
-      if (strncmp(vi->text + pos, vi->scratch, len) == 0)
+      if (vi_matchtext(vi, pos, vi->scratch, len))
         {
-          vi_write(vi, g_fmtsrcbot, sizeof(g_fmtsrcbot));
+          vi_write(vi, g_fmtsrcbot, sizeof(g_fmtsrcbot) - 1);
+          vi->message = true;
 
           /* Found it... save the cursor position and
            * return success.
@@ -4715,7 +5418,7 @@ static bool vi_revfindstring(FAR struct vi_s *vi)
     {
       /* Check for the matching sub-string */
 
-      if (strncmp(vi->text + pos, vi->scratch, len) == 0)
+      if (vi_matchtext(vi, pos, vi->scratch, len))
         {
           /* Found it... save the cursor position and
            * return success.
@@ -4734,9 +5437,9 @@ static bool vi_revfindstring(FAR struct vi_s *vi)
     {
       /* Check for the matching sub-string */
 
-      if (strncmp(vi->text + pos, vi->scratch, len) == 0)
+      if (vi_matchtext(vi, pos, vi->scratch, len))
         {
-          vi_write(vi, g_fmtsrctop, sizeof(g_fmtsrctop));
+          vi_write(vi, g_fmtsrctop, sizeof(g_fmtsrctop) - 1);
 
           /* Found it... save the cursor position and
            * return success.
@@ -4898,7 +5601,7 @@ static void vi_replacech(FAR struct vi_s *vi, char ch)
 
   /* Is there a newline at the current cursor position? */
 
-  if (vi->text[vi->curpos] == '\n')
+  if (vi_charat(vi, vi->curpos) == '\n')
     {
       /* Yes, then insert the new character before the newline */
 
@@ -4909,7 +5612,7 @@ static void vi_replacech(FAR struct vi_s *vi, char ch)
     {
       /* No, just replace the character and increment the cursor position */
 
-      vi->text[vi->curpos++] = ch;
+      vi_setcharat(vi, vi->curpos++, ch);
       vi->redrawline = true;
     }
 }
@@ -4938,7 +5641,7 @@ static void vi_replacech_submode(FAR struct vi_s *vi)
   /* Are there that many characters left on the line to be replaced? */
 
   end = vi_lineend(vi, vi->curpos) + 1;
-  if (vi->curpos + nchars > end)
+  if (vi->curpos + nchars > end || end > vi->textsize)
     {
       vi_error(vi, g_fmtnotvalid);
       vi_setmode(vi, MODE_COMMAND, 0);
@@ -5065,7 +5768,7 @@ static void vi_findinline_mode(FAR struct vi_s *vi)
   pos = vi->curpos + 1;
   count = vi->value > 0 ? vi->value : 1;
 
-  while (count > 0 && pos < vi->textsize - 1 && vi->text[pos] != '\n')
+  while (count > 0 && pos < vi->textsize - 1 && vi_charat(vi, pos) != '\n')
     {
       /* Increment to next character */
 
@@ -5073,7 +5776,7 @@ static void vi_findinline_mode(FAR struct vi_s *vi)
 
       /* Test if this character matches */
 
-      if (vi->text[pos] == ch)
+      if (vi_charat(vi, pos) == ch)
         {
           count--;
         }
@@ -5154,13 +5857,11 @@ static void vi_insertch(FAR struct vi_s *vi, char ch)
 {
   viinfo("curpos=%ld ch=%c[%02x]\n", vi->curpos, isprint(ch) ? ch : '.', ch);
 
-  /* Make space in the buffer for the new character */
+  /* Add the new character to the buffer */
 
-  if (vi_extendtext(vi, vi->curpos, 1))
+  if (vi_extendtext(vi, vi->curpos, &ch, 1))
     {
-      /* Add the new character to the buffer */
-
-      vi->text[vi->curpos++] = ch;
+      vi->curpos++;
     }
 }
 
@@ -5182,7 +5883,7 @@ static void vi_insert_mode(FAR struct vi_s *vi)
   /* Print insert message */
 
   vi_clearbottomline(vi);
-  vi_write(vi, g_fmtinsert, sizeof(g_fmtinsert));
+  vi_write(vi, g_fmtinsert, sizeof(g_fmtinsert) - 1);
   vi_setcursor(vi, vi->cursor.row, vi->cursor.column);
   vi->redrawline = true;
 
@@ -5242,9 +5943,11 @@ static void vi_insert_mode(FAR struct vi_s *vi)
       vi->updatereqcol = true;
       if (isprint(ch) || ch == '\t')
         {
-          /* Insert the filtered character into the buffer */
+          /* Insert the filtered character into the buffer.  Replace mode
+           * also inserts past the end of the last line.
+           */
 
-          if (vi->mode == MODE_INSERT)
+          if (vi->mode == MODE_INSERT || vi->curpos >= vi->textsize)
             {
               vi_insertch(vi, ch);
             }
@@ -5260,9 +5963,11 @@ static void vi_insert_mode(FAR struct vi_s *vi)
 
           if (vi->cursor.column + 1 < vi->display.column && ch != '\t' &&
               (vi->curpos + 1 == vi->textsize ||
-               vi->text[vi->curpos + 1] == '\n'))
+               vi_charat(vi, vi->curpos + 1) == '\n'))
             {
               vi_putch(vi, ch);
+              vi->shadow[vi->cursor.row * vi->display.column +
+                         vi->cursor.column] = ch;
             }
           else
             {
@@ -5295,7 +6000,7 @@ static void vi_insert_mode(FAR struct vi_s *vi)
             {
               if (vi->curpos < vi->textsize)
                 {
-                  if (vi->text[vi->curpos] == '\n')
+                  if (vi_charat(vi, vi->curpos) == '\n')
                     {
                       vi->drawtoeos = true;
                     }
@@ -5315,7 +6020,7 @@ static void vi_insert_mode(FAR struct vi_s *vi)
 
                   if (vi->curpos > 0)
                     {
-                      if (vi->text[vi->curpos - 1] == '\n')
+                      if (vi_charat(vi, vi->curpos - 1) == '\n')
                         {
                           vi->drawtoeos = true;
                         }
@@ -5342,7 +6047,7 @@ static void vi_insert_mode(FAR struct vi_s *vi)
 
               /* Move cursor 1 space to the left when exiting insert mode */
 
-              if (vi->curpos > 0 && vi->text[vi->curpos - 1] != '\n')
+              if (vi->curpos > 0 && vi_charat(vi, vi->curpos - 1) != '\n')
                 {
                   --vi->curpos;
                 }
@@ -5353,7 +6058,7 @@ static void vi_insert_mode(FAR struct vi_s *vi)
 
           case '\n': /* LF terminates line */
             {
-              if (vi->mode == MODE_INSERT)
+              if (vi->mode == MODE_INSERT || vi->curpos >= vi->textsize)
                 {
                   vi_insertch(vi, '\n');
                 }
@@ -5458,11 +6163,33 @@ static void vi_release(FAR struct vi_s *vi)
 {
   if (vi)
     {
+      /* Restore scrolling of the whole display and leave the cursor below
+       * the text.  The shadow is freed first so that a write error while
+       * flushing cannot get back here.
+       */
+
+      if (vi->shadow)
+        {
+          free(vi->shadow);
+          vi->shadow = NULL;
+
+          vi_write(vi, g_resetscroll, sizeof(g_resetscroll) - 1);
+          vi_setcursor(vi, vi->display.row - 1, 0);
+          vi_putch(vi, '\n');
+        }
+
+      vi_flush(vi);
+
       if (vi->text)
         {
           free(vi->text);
         }
 
+      if (vi->nl)
+        {
+          free(vi->nl);
+        }
+
       if (vi->yank)
         {
           free(vi->yank);
@@ -5657,8 +6384,7 @@ int main(int argc, FAR char *argv[])
 
   if (vi->text == NULL)
     {
-      vi_extendtext(vi, 0, TEXT_GULP_SIZE);
-      vi->textsize = 0;
+      vi_extendtext(vi, 0, NULL, 0);
       vi->modified = 0;
     }
 
@@ -5668,6 +6394,17 @@ int main(int argc, FAR char *argv[])
       vi_showusage(vi, argv[0], EXIT_FAILURE);
     }
 
+  /* Allocate the display shadow */
+
+  if (vi->display.row < 2 || vi->display.column < 16 ||
+      !vi_initdisplay(vi))
+    {
+      fprintf(stderr, "ERROR: Failed to set up a %ux%u display\n",
+              vi->display.column, vi->display.row);
+      vi_release(vi);
+      return EXIT_FAILURE;
+    }
+
   /* The editor loop */
 
   vi->fullredraw = true;
@@ -125,6 +125,27 @@ uint16_t crc16part(const uint8_t *src, size_t len, uint16_t crc16val)
   return crc16val;
 }
 
+/************************************************************************************************
+ * Name: crc16xmodempart
+ *
+ * Description:
+ *   Continue CRC-16/XMODEM calculation on a part of the buffer (as used by the NuttX
+ *   libc crc16xmodempart()).
+ *
+ ************************************************************************************************/
+
+uint16_t crc16xmodempart(const uint8_t *src, size_t len, uint16_t crc16val)
+{
+  size_t i;
+
+  for (i = 0;  i < len;  i++)
+    {
+      crc16val = crc16_tab[((crc16val >> 8) ^ src[i]) & 255] ^ (crc16val << 8);
+    }
+
+  return crc16val;
+}
+
 /************************************************************************************************
  * Name: crc16
  *
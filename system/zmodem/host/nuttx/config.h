@@ -50,6 +50,7 @@
 #define CONFIG_SYSTEM_ZMODEM_RCVBUFSIZE 512
 #define CONFIG_SYSTEM_ZMODEM_PKTBUFSIZE 1024
 #define CONFIG_SYSTEM_ZMODEM_SNDBUFSIZE 512
+#define CONFIG_SYSTEM_ZMODEM_SNDWINDOW 16384
 #define CONFIG_SYSTEM_ZMODEM_MOUNTPOINT "/tmp"
 #undef  CONFIG_SYSTEM_ZMODEM_RCVSAMPLE
 #undef  CONFIG_SYSTEM_ZMODEM_SENDATTN
@@ -52,6 +52,16 @@ extern "C"
 
 uint16_t crc16part(const uint8_t *src, size_t len, uint16_t crc16val);
 
+/****************************************************************************
+ * Name: crc16xmodempart
+ *
+ * Description:
+ *   Continue CRC-16/XMODEM calculation on a part of the buffer.
+ *
+ ****************************************************************************/
+
+uint16_t crc16xmodempart(const uint8_t *src, size_t len, uint16_t crc16val);
+
 /****************************************************************************
  * Name: crc16
  *
@@ -0,0 +1,243 @@
+/****************************************************************************
+ * apps/system/zmodem/host/zm_bench.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Loopback throughput benchmark.  A sender and a receiver process are
+ * connected through a socket pair and a file of pseudo-random data is
+ * transferred between them.  The received file is compared against the
+ * original and the throughput is reported.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#include "system/zmodem.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define ZMBENCH_INFILE   "/tmp/zmbench.in"
+#define ZMBENCH_RNAME    "zmbench.out"
+#define ZMBENCH_OUTFILE  CONFIG_SYSTEM_ZMODEM_MOUNTPOINT "/" ZMBENCH_RNAME
+#define ZMBENCH_DEFSIZE  (4 * 1024 * 1024)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int zmbench_mkfile(FAR const char *path, size_t size)
+{
+  uint8_t buffer[4096];
+  uint32_t seed = 0x12345678;
+  size_t nwrite;
+  size_t i;
+  int fd;
+
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    {
+      return ERROR;
+    }
+
+  while (size > 0)
+    {
+      /* Random data exercises the escaping of all byte values */
+
+      for (i = 0; i < sizeof(buffer); i++)
+        {
+          seed      = seed * 1103515245 + 12345;
+          buffer[i] = seed >> 16;
+        }
+
+      nwrite = size < sizeof(buffer) ? size : sizeof(buffer);
+      if (write(fd, buffer, nwrite) != (ssize_t)nwrite)
+        {
+          close(fd);
+          return ERROR;
+        }
+
+      size -= nwrite;
+    }
+
+  close(fd);
+  return OK;
+}
+
+static int zmbench_compare(FAR const char *path1, FAR const char *path2)
+{
+  uint8_t buf1[4096];
+  uint8_t buf2[4096];
+  ssize_t n1;
+  ssize_t n2;
+  int ret = ERROR;
+  int fd1;
+  int fd2;
+
+  fd1 = open(path1, O_RDONLY);
+  fd2 = open(path2, O_RDONLY);
+  if (fd1 >= 0 && fd2 >= 0)
+    {
+      do
+        {
+          n1 = read(fd1, buf1, sizeof(buf1));
+          n2 = read(fd2, buf2, sizeof(buf2));
+          if (n1 != n2 || (n1 > 0 && memcmp(buf1, buf2, n1) != 0))
+            {
+              break;
+            }
+        }
+      while (n1 > 0);
+
+      if (n1 == 0 && n2 == 0)
+        {
+          ret = OK;
+        }
+    }
+
+  if (fd1 >= 0)
+    {
+      close(fd1);
+    }
+
+  if (fd2 >= 0)
+    {
+      close(fd2);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  struct timespec start;
+  struct timespec end;
+  ZMSHANDLE shandle;
+  ZMRHANDLE rhandle;
+  size_t size = ZMBENCH_DEFSIZE;
+  double elapsed;
+  pid_t pid;
+  int status;
+  int sv[2];
+  int ret;
+
+  if (argc > 1)
+    {
+      size = strtoul(argv[1], NULL, 0);
+    }
+
+  if (zmbench_mkfile(ZMBENCH_INFILE, size) < 0)
+    {
+      fprintf(stderr, "ERROR: Failed to create %s\n", ZMBENCH_INFILE);
+      return EXIT_FAILURE;
+    }
+
+  unlink(ZMBENCH_OUTFILE);
+
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+    {
+      fprintf(stderr, "ERROR: socketpair failed\n");
+      return EXIT_FAILURE;
+    }
+
+  pid = fork();
+  if (pid < 0)
+    {
+      fprintf(stderr, "ERROR: fork failed\n");
+      return EXIT_FAILURE;
+    }
+
+  if (pid == 0)
+    {
+      /* Child: the receiver */
+
+      close(sv[0]);
+      rhandle = zmr_initialize(sv[1]);
+      if (!rhandle)
+        {
+          _exit(EXIT_FAILURE);
+        }
+
+      ret = zmr_receive(rhandle, CONFIG_SYSTEM_ZMODEM_MOUNTPOINT);
+      zmr_release(rhandle);
+      _exit(ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+
+  /* Parent: the sender */
+
+  close(sv[1]);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  shandle = zms_initialize(sv[0]);
+  if (!shandle)
+    {
+      fprintf(stderr, "ERROR: Failed to get Zmodem handle\n");
+      return EXIT_FAILURE;
+    }
+
+  ret = zms_send(shandle, ZMBENCH_INFILE, ZMBENCH_RNAME,
+                 XM_XFERTYPE_BINARY, XM_OPTION_REPLACE, false);
+  zms_release(shandle);
+  waitpid(pid, &status, 0);
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  close(sv[0]);
+
+  if (ret < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+      fprintf(stderr, "ERROR: Transfer failed: %d\n", ret);
+      return EXIT_FAILURE;
+    }
+
+  if (zmbench_compare(ZMBENCH_INFILE, ZMBENCH_OUTFILE) < 0)
+    {
+      fprintf(stderr, "ERROR: %s differs from %s\n",
+              ZMBENCH_OUTFILE, ZMBENCH_INFILE);
+      return EXIT_FAILURE;
+    }
+
+  elapsed = (end.tv_sec - start.tv_sec) +
+            (end.tv_nsec - start.tv_nsec) / 1e9;
+
+  printf("%zu bytes in %.3f s: %.1f KiB/s (window %d)\n",
+         size, elapsed, size / elapsed / 1024.0,
+         CONFIG_SYSTEM_ZMODEM_SNDWINDOW);
+
+  unlink(ZMBENCH_INFILE);
+  unlink(ZMBENCH_OUTFILE);
+  return EXIT_SUCCESS;
+}
@@ -609,6 +609,31 @@ void zm_flowc(int fd);
 FAR uint8_t *zm_putzdle(FAR struct zm_state_s *pzm, FAR uint8_t *buffer,
                         uint8_t ch);
 
+/****************************************************************************
+ * Name: zm_putzdlerun
+ *
+ * Description:
+ *   Transfer as much of a block of data as will fit into a buffer,
+ *   performing ZDLE escaping as necessary.  Runs of characters that do not
+ *   require escaping are copied as a block.
+ *
+ * Input Parameters:
+ *   pzm     - Zmodem session state
+ *   buffer  - Buffer in which to add the possibly escaped data
+ *   bufsize - The space available in buffer
+ *   src     - The raw, unescaped data to be added
+ *   srclen  - On input, the number of bytes in src.  On return, the
+ *             number of bytes of src that were consumed.
+ *
+ * Returned Value:
+ *   The new position in the buffer.
+ *
+ ****************************************************************************/
+
+FAR uint8_t *zm_putzdlerun(FAR struct zm_state_s *pzm, FAR uint8_t *buffer,
+                           size_t bufsize, FAR const uint8_t *src,
+                           FAR size_t *srclen);
+
 /****************************************************************************
  * Name: zm_senddata
  *
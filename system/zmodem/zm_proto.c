@@ -32,12 +32,56 @@
 #include <nuttx/config.h>
 
 #include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
 
 #include <nuttx/crc16.h>
 #include <nuttx/crc32.h>
 
 #include "zm.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Classification of each byte value in g_zdletab[] */
+
+#define ZDLE_NONE     0  /* Never escaped */
+#define ZDLE_ALWAYS   1  /* Always escaped (ZDLE, DLE, XON, XOFF, GS, DEL) */
+#define ZDLE_CTRL     2  /* Escaped only if the peer requested ESCCTL */
+#define ZDLE_CR       3  /* CR: escaped after '@' or if ESCCTL requested */
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Escape classification of every 8-bit value.  This replaces the chain of
+ * comparisons that used to be performed on every outgoing byte so that runs
+ * of bytes that need no escaping can be located with one lookup per byte
+ * and then copied as a block.
+ */
+
+static const uint8_t g_zdletab[256] =
+{
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 2,  /* 0x00-0x0f */
+  1, 1, 2, 1, 2, 2, 2, 2, 1, 2, 2, 2, 2, 1, 2, 2,  /* 0x10-0x1f */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 0x20-0x2f */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 0x30-0x3f */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 0x40-0x4f */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 0x50-0x5f */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 0x60-0x6f */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,  /* 0x70-0x7f */
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 2,  /* 0x80-0x8f */
+  1, 1, 2, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 2, 2,  /* 0x90-0x9f */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 0xa0-0xaf */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 0xb0-0xbf */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 0xc0-0xcf */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 0xd0-0xdf */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 0xe0-0xef */
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,  /* 0xf0-0xff */
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -87,7 +131,7 @@ const uint8_t g_canistr[CANISTR_SIZE] =
 FAR uint8_t *zm_putzdle(FAR struct zm_state_s *pzm, FAR uint8_t *buffer,
                         uint8_t ch)
 {
-  uint8_t ch7 = ch & 0x7f;
+  uint8_t esc = g_zdletab[ch];
 
   /* Check if this character requires ZDLE escaping.
    *
@@ -95,16 +139,9 @@ FAR uint8_t *zm_putzdle(FAR struct zm_state_s *pzm, FAR uint8_t *buffer,
    * following '@' be escaped.
    */
 
-  if (ch   == ZDLE ||
-      ch7  == ASCII_DLE ||
-      ch7  == ASCII_DC1 ||
-      ch7  == ASCII_DC3 ||
-      ch7  == ASCII_GS ||
-      (ch7 == '\r' && (pzm->flags & ZM_FLAG_ATSIGN)  != 0) ||
-      (ch7 <  ' '  && (pzm->flags & ZM_FLAG_ESCCTRL) != 0) ||
-      ch7  == ASCII_DEL ||
-      ch   == 0xff
-      )
+  if (esc == ZDLE_ALWAYS ||
+      (esc != ZDLE_NONE && (pzm->flags & ZM_FLAG_ESCCTRL) != 0) ||
+      (esc == ZDLE_CR && (pzm->flags & ZM_FLAG_ATSIGN) != 0))
     {
       /* Yes... save the data link escape the character */
 
@@ -124,15 +161,19 @@ FAR uint8_t *zm_putzdle(FAR struct zm_state_s *pzm, FAR uint8_t *buffer,
         {
           ch ^= 0x40;
         }
+
+      *buffer++ = ch;
+      pzm->flags &= ~ZM_FLAG_ATSIGN;
+      return buffer;
     }
 
-  /* Save the possibly escaped character */
+  /* Save the unescaped character */
 
   *buffer++ = ch;
 
   /* Check if the character is the AT sign */
 
-  if (ch7 == '@')
+  if ((ch & 0x7f) == '@')
     {
       pzm->flags |= ZM_FLAG_ATSIGN;
     }
@@ -144,6 +185,105 @@ FAR uint8_t *zm_putzdle(FAR struct zm_state_s *pzm, FAR uint8_t *buffer,
   return buffer;
 }
 
+/****************************************************************************
+ * Name: zm_putzdlerun
+ *
+ * Description:
+ *   Transfer as much of a block of data as will fit into a buffer,
+ *   performing ZDLE escaping as necessary.  Runs of characters that do not
+ *   require escaping are copied as a block.
+ *
+ * Input Parameters:
+ *   pzm     - Zmodem session state
+ *   buffer  - Buffer in which to add the possibly escaped data
+ *   bufsize - The space available in buffer
+ *   src     - The raw, unescaped data to be added
+ *   srclen  - On input, the number of bytes in src.  On return, the
+ *             number of bytes of src that were consumed.
+ *
+ * Returned Value:
+ *   The new position in the buffer.
+ *
+ ****************************************************************************/
+
+FAR uint8_t *zm_putzdlerun(FAR struct zm_state_s *pzm, FAR uint8_t *buffer,
+                           size_t bufsize, FAR const uint8_t *src,
+                           FAR size_t *srclen)
+{
+  FAR uint8_t *end = buffer + bufsize;
+  size_t nsrc = *srclen;
+  size_t ndx = 0;
+  size_t start;
+  size_t nrun;
+  bool escctrl;
+  bool atsign;
+  uint8_t esc;
+
+  escctrl = (pzm->flags & ZM_FLAG_ESCCTRL) != 0;
+  atsign  = (pzm->flags & ZM_FLAG_ATSIGN) != 0;
+
+  while (ndx < nsrc)
+    {
+      /* Find the run of characters that can be copied without escaping.
+       * A CR needs escaping only if it follows an '@'.
+       */
+
+      start = ndx;
+      while (ndx < nsrc)
+        {
+          esc = g_zdletab[src[ndx]];
+          if (esc != ZDLE_NONE)
+            {
+              if (esc == ZDLE_ALWAYS || escctrl)
+                {
+                  break;
+                }
+
+              if (esc == ZDLE_CR &&
+                  (ndx > start ? (src[ndx - 1] & 0x7f) == '@' : atsign))
+                {
+                  break;
+                }
+            }
+
+          ndx++;
+        }
+
+      /* Copy the run, clipping it to the space available */
+
+      nrun = ndx - start;
+      if (nrun > 0)
+        {
+          if (nrun > (size_t)(end - buffer))
+            {
+              nrun = end - buffer;
+              ndx  = start + nrun;
+            }
+
+          memmove(buffer, &src[start], nrun);
+          buffer += nrun;
+          atsign  = (src[ndx - 1] & 0x7f) == '@';
+        }
+
+      /* Then escape the character that terminated the run */
+
+      if (ndx >= nsrc || end - buffer < 2)
+        {
+          break;
+        }
+
+      pzm->flags = atsign ? (pzm->flags | ZM_FLAG_ATSIGN) :
+                            (pzm->flags & ~ZM_FLAG_ATSIGN);
+      buffer = zm_putzdle(pzm, buffer, src[ndx++]);
+      atsign = false;
+    }
+
+  pzm->flags = atsign ? (pzm->flags | ZM_FLAG_ATSIGN) :
+                        (pzm->flags & ~ZM_FLAG_ATSIGN);
+  *srclen = ndx;
+  return buffer;
+}
+
 /****************************************************************************
  * Name: zm_senddata
  *
@@ -161,8 +301,12 @@ FAR uint8_t *zm_putzdle(FAR struct zm_state_s *pzm, FAR uint8_t *buffer,
 int zm_senddata(FAR struct zm_state_s *pzm, FAR const uint8_t *buffer,
                 size_t buflen)
 {
-  uint8_t *ptr = pzm->scratch;
+  FAR uint8_t *ptr = pzm->scratch;
+  FAR uint8_t *end = pzm->scratch + CONFIG_SYSTEM_ZMODEM_SNDBUFSIZE;
+  FAR uint8_t *limit;
   ssize_t nwritten;
+  size_t nsrc;
+  bool inplace;
   uint32_t crc;
   uint8_t zbin;
   uint8_t term;
@@ -185,20 +329,75 @@ int zm_senddata(FAR struct zm_state_s *pzm, FAR const uint8_t *buffer,
   zmdbg("zbin=%c, buflen=%zu, term=%c flags=%04x\n",
         zbin, buflen, term, pzm->flags);
 
-  /* Transfer the data to the I/O buffer, accumulating the CRC */
+  /* Accumulate the CRC over the whole buffer in one pass, then transfer
+   * the data to the I/O buffer with escaping.
+   */
 
-  while (buflen-- > 0)
+  if (zbin == ZBIN)
+    {
+      crc = (uint32_t)crc16xmodempart(buffer, buflen, (uint16_t)crc);
+    }
+  else /* zbin = ZBIN32 */
     {
-      if (zbin == ZBIN)
+      crc = crc32part(buffer, buflen, crc);
+    }
+
+  /* Data composed in the scratch buffer is first moved to its end, so
+   * that the escaped data written in front of it never overtakes it.  A
+   * character may be overwritten as soon as it has been read.
+   */
+
+  inplace = buffer >= pzm->scratch && buffer < end;
+  if (inplace)
+    {
+      DEBUGASSERT(buflen < CONFIG_SYSTEM_ZMODEM_SNDBUFSIZE);
+      buffer = memmove(end - buflen, buffer, buflen);
+    }
+
+  /* Escaping may double the size of the data.  Send the I/O buffer each
+   * time it fills up.
+   */
+
+  while (buflen > 0)
+    {
+      limit = inplace ? (FAR uint8_t *)buffer + 1 : end;
+      nsrc  = buflen;
+      ptr   = zm_putzdlerun(pzm, ptr, limit - ptr, buffer, &nsrc);
+
+      buffer += nsrc;
+      buflen -= nsrc;
+
+      if (buflen > 0)
         {
-          crc = (uint32_t)crc16xmodempart(buffer, 1, (uint16_t)crc);
+          if (ptr == pzm->scratch)
+            {
+              /* No room to escape even one character */
+
+              return -ENOSPC;
+            }
+
+          nwritten = zm_remwrite(pzm->remfd, pzm->scratch,
+                                 ptr - pzm->scratch);
+          if (nwritten < 0)
+            {
+              return (int)nwritten;
+            }
+
+          ptr = pzm->scratch;
         }
-      else /* zbin = ZBIN32 */
+    }
+
+  /* The terminator and the escaped CRC take up to 10 bytes */
+
+  if (end - ptr < 10)
+    {
+      nwritten = zm_remwrite(pzm->remfd, pzm->scratch, ptr - pzm->scratch);
+      if (nwritten < 0)
         {
-          crc = crc32part(buffer, 1, crc);
+          return (int)nwritten;
         }
 
-      ptr = zm_putzdle(pzm, ptr, *buffer++);
+      ptr = pzm->scratch;
     }
 
   /* Trasnfer the data link escape character (without updating the CRC) */
@@ -60,6 +60,30 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* File data is read in blocks into a raw buffer before it is escaped into
+ * the transmit buffer.  The packet buffer is not otherwise used while the
+ * sender is streaming data, so it is borrowed unless a dedicated file
+ * buffer has been configured.
+ */
+
+#ifdef CONFIG_SYSTEM_ZMODEM_SNDFILEBUF
+#  define ZMS_RAWBUF(p)        ((p)->filebuf)
+#  define ZMS_RAWBUFSIZE       CONFIG_SYSTEM_ZMODEM_SNDBUFSIZE
+#else
+#  define ZMS_RAWBUF(p)        ((p)->pktbuf)
+#  define ZMS_RAWBUFSIZE       CONFIG_SYSTEM_ZMODEM_PKTBUFSIZE
+#endif
+
+/* When streaming with a sliding window, a ZCRCQ is sent to solicit a ZACK
+ * each time this many bytes have been sent.
+ */
+
+#if CONFIG_SYSTEM_ZMODEM_SNDWINDOW > 0
+#  define ZMS_ACKINTERVAL \
+     (CONFIG_SYSTEM_ZMODEM_SNDWINDOW >= 4 ? \
+      CONFIG_SYSTEM_ZMODEM_SNDWINDOW / 4 : 1)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -137,6 +161,8 @@ static int zms_endoftransfer(FAR struct zm_state_s *pzm);
 static int zms_fileskip(FAR struct zm_state_s *pzm);
 static int zms_sendfiledata(FAR struct zm_state_s *pzm);
 static int zms_sendpacket(FAR struct zm_state_s *pzm);
+static int zms_sendack(FAR struct zm_state_s *pzm);
+static int zms_streamtimeout(FAR struct zm_state_s *pzm);
 static int zms_filecrc(FAR struct zm_state_s *pzm);
 static int zms_sendwaitack(FAR struct zm_state_s *pzm);
 static int zms_sendnak(FAR struct zm_state_s *pzm);
@@ -251,14 +277,14 @@ static const struct zm_transition_s g_zms_crcwait[] =
 static const struct zm_transition_s g_zmr_sending[] =
 {
   {ZME_SINIT,     false, ZMS_START,    zms_attention},
-  {ZME_ACK,       false, ZMS_SENDING,  zms_sendpacket},
+  {ZME_ACK,       false, ZMS_SENDING,  zms_sendack},
   {ZME_RPOS,      true,  ZMS_SENDING,  zms_sendrpos},
   {ZME_SKIP,      true,  ZMS_FILEWAIT, zms_fileskip},
   {ZME_NAK,       true,  ZMS_SENDING,  zms_sendnak},
   {ZME_RINIT,     true,  ZMS_FILEWAIT, zms_sendfilename},
   {ZME_ABORT,     true,  ZMS_FINISH,   zms_abort},
   {ZME_FERR,      true,  ZMS_FINISH,   zms_abort},
-  {ZME_TIMEOUT,   false, ZMS_SENDING,  zms_sendpacket},
+  {ZME_TIMEOUT,   false, ZMS_SENDING,  zms_streamtimeout},
   {ZME_ERROR,     false, ZMS_SENDING,  zms_error},
 };
 
@@ -452,8 +478,12 @@ static int zms_zrinit(FAR struct zm_state_s *pzm)
    *    receiver does not indicate FDX ability with the CANFDX bit.
    */
 
-#ifdef CONFIG_SYSTEM_ZMODEM_RCVSAMPLE
-  /* We support CANFDX.  We can do ZCRCG if the remote sender does too */
+#if defined(CONFIG_SYSTEM_ZMODEM_RCVSAMPLE) || \
+    CONFIG_SYSTEM_ZMODEM_SNDWINDOW > 0
+  /* We support CANFDX, either by sampling the reverse channel or by
+   * limiting the unacknowledged data to a sliding window.  We can do ZCRCG
+   * if the remote sender does too.
+   */
 
   if ((rcaps & (CANFDX | CANOVIO)) ==
       (CANFDX | CANOVIO) && pzms->rcvmax == 0)
@@ -855,8 +885,11 @@ static int zms_sendfiledata(FAR struct zm_state_s *pzm)
 static int zms_sendpacket(FAR struct zm_state_s *pzm)
 {
   FAR struct zms_state_s *pzms = (FAR struct zms_state_s *)pzm;
+  FAR uint8_t *rawbuf = ZMS_RAWBUF(pzm);
   ssize_t nwritten;
+  ssize_t nread;
   int32_t unacked;
+  size_t nsrc;
   bool bcrc32;
   uint32_t crc;
   uint8_t by[4];
@@ -903,7 +936,7 @@ static int zms_sendpacket(FAR struct zm_state_s *pzm)
               /* Yes... clip the maximum so that we stay within that limit */
 
               int maximum = pzms->rcvmax - unacked;
-              if (sndsize < maximum)
+              if (sndsize > maximum)
                 {
                   sndsize = maximum;
                 }
@@ -912,6 +945,22 @@ static int zms_sendpacket(FAR struct zm_state_s *pzm)
               zmdbg("Clipped sndsize: %d\n", sndsize);
             }
         }
+#if CONFIG_SYSTEM_ZMODEM_SNDWINDOW > 0
+      else if (pzms->dpkttype == ZCRCG &&
+               (pzm->flags & ZM_FLAG_WAIT) == 0 &&
+               unacked >= CONFIG_SYSTEM_ZMODEM_SNDWINDOW)
+        {
+          /* The sliding window is full.  The last subpacket sent was a
+           * ZCRCQ, so keep the frame open and wait for its ZACK.
+           */
+
+          zmdbg("Window full: unacked %d\n", unacked);
+
+          pzm->state   = ZMS_SENDING;
+          pzm->timeout = CONFIG_SYSTEM_ZMODEM_RESPTIME;
+          return OK;
+        }
+#endif
 
       /* Can we send anything? */
 
@@ -962,65 +1011,71 @@ static int zms_sendpacket(FAR struct zm_state_s *pzm)
           type = pzms->dpkttype;
         }
 
-      /* Read characters from file and put into buffer until buffer is full
-       * or file is exhausted
+      /* Read a block of the file.  It may not all fit into the packet after
+       * escaping;  the unused tail is read again for the next packet.
        */
 
-      bcrc32      = ((pzm->flags & ZM_FLAG_CRC32) != 0);
-      crc         = bcrc32 ? 0xffffffff : 0;
-      pzm->flags &= ~ZM_FLAG_ATSIGN;
-
-      ptr         = pzm->scratch;
-      pktsize     = 0;
-
-#ifdef CONFIG_SYSTEM_ZMODEM_SNDFILEBUF
-      /* Read multiple bytes of file and store into the temporal buffer */
-
-      zm_read(pzms->infd, pzm->filebuf, CONFIG_SYSTEM_ZMODEM_SNDBUFSIZE);
-
-      i = 0;
-#endif
+      if (sndsize > ZMS_RAWBUFSIZE)
+        {
+          sndsize = ZMS_RAWBUFSIZE;
+        }
 
-      while (pktsize <= (CONFIG_SYSTEM_ZMODEM_SNDBUFSIZE - 10) &&
-             (pzms->offset < pzms->filesize))
+      nread = zm_read(pzms->infd, rawbuf, sndsize);
+      if (nread <= 0)
         {
-          /* Add the new value to the accumulated CRC */
+          zmdbg("ERROR: zm_read failed: %d\n", (int)nread);
+          return nread < 0 ? (int)nread : -EIO;
+        }
 
-#ifdef CONFIG_SYSTEM_ZMODEM_SNDFILEBUF
-          uint8_t ch = pzm->filebuf[i++];
-#else
-          uint8_t ch = zm_getc(pzms->infd);
-#endif
-          if (!bcrc32)
-            {
-              crc = (uint32_t)crc16xmodempart(&ch, 1, (uint16_t)crc);
-            }
-          else
-            {
-              crc = crc32part(&ch, 1, crc);
-            }
+      /* Put the data into the transmit buffer, escaping as necessary, and
+       * leaving room for the packet trailer.
+       */
 
-          /* Put the character into the buffer, escaping as necessary */
+      pzm->flags &= ~ZM_FLAG_ATSIGN;
 
-          ptr = zm_putzdle(pzm, ptr, ch);
+      nsrc = nread;
+      ptr  = zm_putzdlerun(pzm, pzm->scratch,
+                           CONFIG_SYSTEM_ZMODEM_SNDBUFSIZE - 12,
+                           rawbuf, &nsrc);
+      pktsize = ptr - pzm->scratch;
 
-          /* Recalculate the accumulated packet size to handle expansion due
-           * to escaping.
-           */
+      /* Accumulate the CRC over the data in a single pass */
 
-          pktsize = (int32_t)(ptr - pzm->scratch);
+      bcrc32 = ((pzm->flags & ZM_FLAG_CRC32) != 0);
+      if (!bcrc32)
+        {
+          crc = (uint32_t)crc16xmodempart(rawbuf, nsrc, 0);
+        }
+      else
+        {
+          crc = crc32part(rawbuf, nsrc, 0xffffffff);
+        }
 
-          /* And increment the file offset */
+      /* Restore file position to be read next time */
 
-          pzms->offset++;
+      if (nsrc < (size_t)nread)
+        {
+          lseek(pzms->infd, pzms->offset + nsrc, SEEK_SET);
         }
 
-#ifdef CONFIG_SYSTEM_ZMODEM_SNDFILEBUF
-      /* Restore file position to be read next time */
+#if CONFIG_SYSTEM_ZMODEM_SNDWINDOW > 0
+      /* When streaming with a window, solicit a ZACK each time another
+       * quarter of the window has been sent and when the window fills.
+       */
 
-      lseek(pzms->infd, pzms->offset, SEEK_SET);
+      if (type == ZCRCG &&
+          (unacked + nsrc >= CONFIG_SYSTEM_ZMODEM_SNDWINDOW ||
+           pzms->offset / ZMS_ACKINTERVAL !=
+           (pzms->offset + nsrc) / ZMS_ACKINTERVAL))
+        {
+          type = ZCRCQ;
+        }
 #endif
 
+      /* And increment the file offset */
+
+      pzms->offset += nsrc;
+
       /* If we've reached file end, a ZEOF header will follow.  If there's
        * room in the outgoing buffer for it, end the packet with ZCRCE and
        * append the ZEOF header.  If there isn't room, we'll have to do a
@@ -1079,7 +1134,7 @@ static int zms_sendpacket(FAR struct zm_state_s *pzm)
       /* Get the final packet size */
 
       pktsize = ptr - pzm->scratch;
-      DEBUGASSERT(pktsize < CONFIG_SYSTEM_ZMODEM_SNDBUFSIZE);
+      DEBUGASSERT(pktsize <= CONFIG_SYSTEM_ZMODEM_SNDBUFSIZE);
 
       /* And send the packet */
 
@@ -1137,8 +1192,10 @@ static int zms_sendpacket(FAR struct zm_state_s *pzm)
           break;
         }
     }
-#ifdef CONFIG_SYSTEM_ZMODEM_RCVSAMPLE
+#if defined(CONFIG_SYSTEM_ZMODEM_RCVSAMPLE)
   while (pzm->state == ZMS_SENDING && !zm_rcvpending(pzm));
+#elif CONFIG_SYSTEM_ZMODEM_SNDWINDOW > 0
+  while (pzm->state == ZMS_SENDING && pzms->dpkttype == ZCRCG);
 #else
   while (0);
 #endif
@@ -1146,6 +1203,45 @@ static int zms_sendpacket(FAR struct zm_state_s *pzm)
   return OK;
 }
 
+/****************************************************************************
+ * Name: zms_sendack
+ *
+ * Description:
+ *   A ZACK arrived in response to a ZCRCQ while streaming.  Update last
+ *   known receiver offset, sliding the window, and continue the frame.
+ *
+ ****************************************************************************/
+
+static int zms_sendack(FAR struct zm_state_s *pzm)
+{
+  FAR struct zms_state_s *pzms = (FAR struct zms_state_s *)pzm;
+  off_t offset;
+
+  offset = zm_bytobe32(pzm->hdrdata + 1);
+  if (offset > pzms->lastoffs && offset <= pzms->offset)
+    {
+      pzms->lastoffs = offset;
+    }
+
+  zmdbg("ZMS_STATE %d: offset: %ld\n", pzm->state, (unsigned long)offset);
+  return zms_sendpacket(pzm);
+}
+
+/****************************************************************************
+ * Name: zms_streamtimeout
+ *
+ * Description:
+ *   No ZACK arrived while streaming.  The next data subpacket is sent with
+ *   ZCRCW so that the receiver must respond, even if the window is full.
+ *
+ ****************************************************************************/
+
+static int zms_streamtimeout(FAR struct zm_state_s *pzm)
+{
+  pzm->flags |= ZM_FLAG_WAIT;
+  return zms_sendpacket(pzm);
+}
+
 /****************************************************************************
  * Name: zms_filecrc
  *